@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Tiny benchmark harness for mbgl-slint-bench. A benchmark body loops on
+// keep_running() and reports how much work one iteration did; the runner
+// repeats it for at least `min_time` and prints per-iteration time plus
+// item and byte throughput:
+//
+//   MBGL_SLINT_BENCH(QoiEncode512) {
+//       auto image = make_image(512, 512);
+//       while (state.keep_running()) {
+//           encode_qoi(image);
+//       }
+//       state.set_items_processed(state.iterations());
+//       state.set_bytes_processed(state.iterations() * image.bytes());
+//   }
+namespace bench {
+
+class State {
+public:
+    explicit State(std::chrono::nanoseconds min_time_)
+        : min_time(min_time_) {
+    }
+
+    bool keep_running() {
+        const auto now = std::chrono::steady_clock::now();
+        if (count == 0) {
+            start = now;
+        } else if (now - start >= min_time) {
+            stop = now;
+            return false;
+        }
+        ++count;
+        return true;
+    }
+
+    uint64_t iterations() const {
+        return count;
+    }
+    void set_items_processed(uint64_t items_) {
+        items = items_;
+    }
+    void set_bytes_processed(uint64_t bytes_) {
+        bytes = bytes_;
+    }
+    // Extra "name=value" column, e.g. queue depth or steals.
+    void set_label(std::string label_) {
+        label = std::move(label_);
+    }
+
+    // For pipelined benchmarks: call after draining the pipeline so the
+    // measured time includes work still in flight when the loop ended.
+    void stop_timer() {
+        stop = std::chrono::steady_clock::now();
+    }
+
+    double seconds() const {
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    std::chrono::nanoseconds min_time;
+    uint64_t count = 0;
+    uint64_t items = 0;
+    uint64_t bytes = 0;
+    std::string label;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point stop;
+};
+
+using Function = std::function<void(State&)>;
+
+struct Benchmark {
+    std::string name;
+    Function function;
+};
+
+std::vector<Benchmark>& registry();
+
+struct Registrar {
+    Registrar(const char* name, Function function) {
+        registry().push_back({name, std::move(function)});
+    }
+};
+
+}  // namespace bench
+
+#define MBGL_SLINT_BENCH(name)                                         \
+    static void name(bench::State& state);                             \
+    static const bench::Registrar name##_registrar(#name, name);       \
+    static void name([[maybe_unused]] bench::State& state)
@@ -0,0 +1,57 @@
+// mbgl-slint-bench [FILTER] [--min-time SECONDS]
+//
+// Runs every registered benchmark whose name contains FILTER and prints one
+// line per benchmark.
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "bench.hpp"
+
+namespace bench {
+
+std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+}  // namespace bench
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double min_time = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::atof(argv[++i]);
+        } else {
+            filter = arg;
+        }
+    }
+
+    std::printf("%-40s %10s %14s %14s %12s\n", "benchmark", "iters",
+                "time/iter", "items/s", "MB/s");
+    for (const auto& benchmark : bench::registry()) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+            continue;
+        bench::State state(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double>(min_time)));
+        benchmark.function(state);
+        const double seconds = state.seconds();
+        const double per_iter_us =
+            state.count ? seconds * 1e6 / static_cast<double>(state.count)
+                        : 0.0;
+        const double items_per_s =
+            seconds > 0.0 ? static_cast<double>(state.items) / seconds : 0.0;
+        const double mb_per_s =
+            seconds > 0.0 ? static_cast<double>(state.bytes) / seconds / 1e6
+                          : 0.0;
+        std::printf("%-40s %10llu %12.1fus %14.1f %12.1f  %s\n",
+                    benchmark.name.c_str(),
+                    static_cast<unsigned long long>(state.count), per_iter_us,
+                    items_per_s, mb_per_s, state.label.c_str());
+    }
+    return 0;
+}
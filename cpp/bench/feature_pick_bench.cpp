@@ -0,0 +1,127 @@
+#include <cstddef>
+#include <cstdint>
+#include <mbgl/map/camera.hpp>
+#include <mbgl/util/geo.hpp>
+#include <string>
+#include <utility>
+
+#include "bench.hpp"
+#include "slint_maplibre_headless.hpp"
+
+namespace {
+
+constexpr int kWidth = 1024;
+constexpr int kHeight = 768;
+constexpr int kColumns = 256;
+constexpr int kRows = 192;  // ~49k POIs, one every 4 px at zoom 10
+
+// A grid of point features around 0,0 filling the whole view, drawn as
+// overlapping circles: every pick hits a few of them.
+mbgl::GeoJSON make_pois() {
+    mbgl::FeatureCollection pois;
+    pois.reserve(static_cast<std::size_t>(kColumns) * kRows);
+    const double span_lon = 360.0 * kWidth / (512.0 * 1024.0);
+    const double span_lat = span_lon * kHeight / kWidth;
+    uint64_t id = 0;
+    for (int row = 0; row < kRows; ++row) {
+        for (int col = 0; col < kColumns; ++col) {
+            mbgl::Feature poi;
+            poi.geometry = mapbox::geometry::point<double>(
+                -span_lon / 2 + span_lon * col / kColumns,
+                -span_lat / 2 + span_lat * row / kRows);
+            poi.id = id;
+            poi.properties["name"] = "poi " + std::to_string(id);
+            poi.properties["rank"] = static_cast<uint64_t>(id % 10);
+            pois.push_back(std::move(poi));
+            ++id;
+        }
+    }
+    return pois;
+}
+
+struct PoiMap {
+    SlintMapLibre map;
+
+    bool start() {
+        map.set_frame_logging(false);
+        map.initialize(kWidth, kHeight);
+        map.update_style(R"({"version":8,"sources":{},"layers":[)"
+                         R"({"id":"bg","type":"background",)"
+                         R"("paint":{"background-color":"#f4f1ea"}}]})");
+        SlintMapLibre::GeoJsonOverlayOptions overlay;
+        overlay.layers_json = R"([{"id":"pois","type":"circle",)"
+                              R"("paint":{"circle-radius":3,)"
+                              R"("circle-color":"#e4572e"}}])";
+        GeoJsonInput input;
+        input.generate = make_pois;
+        map.set_geojson("pois", std::move(input), overlay);
+        if (auto* m = map.get_map()) {
+            m->jumpTo(mbgl::CameraOptions()
+                          .withCenter(mbgl::LatLng{0.0, 0.0})
+                          .withZoom(10.0));
+        }
+        // Until the points are indexed, attached and drawn.
+        for (int i = 0; i < 20000; ++i) {
+            map.run_map_loop();
+            map.render_map();
+            if (map.style_is_loaded() && map.map_is_idle() &&
+                !map.pending_geojson() && !map.take_repaint_request())
+                return true;
+        }
+        return false;
+    }
+};
+
+std::string per_pick(const bench::State& state, std::size_t features) {
+    if (!state.iterations())
+        return {};
+    return "features_per_pick=" +
+           std::to_string(features / state.iterations());
+}
+
+}  // namespace
+
+// Click latency: every pick is at a new position, so each one runs
+// queryRenderedFeatures() over the dense POI layer.
+MBGL_SLINT_BENCH(FeaturePickDensePois) {
+    PoiMap m;
+    if (!m.start()) {
+        state.set_label("map did not load");
+        return;
+    }
+    std::size_t features = 0;
+    uint64_t i = 0;
+    while (state.keep_running()) {
+        // Steps through the view without repeating within the cache.
+        const float x = static_cast<float>((i * 37) % kWidth);
+        const float y = static_cast<float>((i * 53) % kHeight);
+        ++i;
+        m.map.request_pick(x, y, false, [&](const PickResult& result) {
+            features += result.features.size();
+        });
+        m.map.answer_picks();
+    }
+    state.set_items_processed(state.iterations());
+    state.set_label(per_pick(state, features) + " cache_hits=" +
+                    std::to_string(m.map.pick_stats().hits));
+}
+
+// Hovering over the same spot within one frame: answered from the cache.
+MBGL_SLINT_BENCH(FeaturePickHoverCached) {
+    PoiMap m;
+    if (!m.start()) {
+        state.set_label("map did not load");
+        return;
+    }
+    std::size_t features = 0;
+    while (state.keep_running()) {
+        m.map.request_pick(512.0f, 384.0f, true,
+                           [&](const PickResult& result) {
+                               features += result.features.size();
+                           });
+        m.map.answer_picks();
+    }
+    state.set_items_processed(state.iterations());
+    state.set_label(per_pick(state, features) + " cache_hits=" +
+                    std::to_string(m.map.pick_stats().hits));
+}
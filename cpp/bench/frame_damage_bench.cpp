@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "frame_damage.hpp"
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+
+// Premultiplied frame with translucent pixels, so unpremultiplying it does
+// the division work a real map frame (labels, halos) needs.
+std::vector<uint8_t> make_frame() {
+    std::vector<uint8_t> frame(static_cast<std::size_t>(kWidth) * kHeight * 4);
+    uint32_t noise = 0x12345678u;
+    for (std::size_t i = 0; i < frame.size(); i += 4) {
+        noise = noise * 1664525u + 1013904223u;
+        const uint8_t a = (noise >> 28) == 0 ? 160 : 255;
+        frame[i] = static_cast<uint8_t>((200 + i % 40) * a / 255);
+        frame[i + 1] = static_cast<uint8_t>((220 - i % 30) * a / 255);
+        frame[i + 2] = static_cast<uint8_t>((noise >> 8) % 256 * a / 255);
+        frame[i + 3] = a;
+    }
+    return frame;
+}
+
+// What render_map() does per frame: diff against the previous readback,
+// then convert the damaged rects (`changed` pixels flipped in the middle).
+void update(bench::State& state, int changed) {
+    const auto prev = make_frame();
+    auto next = prev;
+    for (int i = 0; i < changed; ++i)
+        next[((kHeight / 2) * kWidth + kWidth / 2 + i * 37) * 4] ^= 1;
+    std::vector<uint8_t> out(next.size());
+    long long converted = 0;
+    while (state.keep_running()) {
+        const auto damage = diff_frames(prev.data(), next.data(), kWidth,
+                                        kHeight);
+        for (const auto& rect : damage)
+            unpremultiply_rect(next.data(), out.data(), kWidth, rect);
+        converted += damage_area(damage);
+    }
+    state.set_items_processed(state.iterations());
+    state.set_bytes_processed(state.iterations() * next.size());
+    if (state.iterations())
+        state.set_label("converted_px=" +
+                        std::to_string(converted / state.iterations()));
+}
+
+// The previous behaviour: unpremultiply every pixel of every frame.
+void full(bench::State& state) {
+    const auto frame = make_frame();
+    std::vector<uint8_t> out(frame.size());
+    while (state.keep_running())
+        unpremultiply_rect(frame.data(), out.data(), kWidth,
+                           {0, 0, kWidth, kHeight});
+    state.set_items_processed(state.iterations());
+    state.set_bytes_processed(state.iterations() * frame.size());
+}
+
+// The opaque path: alpha scan plus RGBA -> RGB pack, no division.
+void full_opaque(bench::State& state) {
+    auto frame = make_frame();
+    for (std::size_t i = 3; i < frame.size(); i += 4)
+        frame[i] = 255;
+    std::vector<uint8_t> out(static_cast<std::size_t>(kWidth) * kHeight * 3);
+    const DamageRect all{0, 0, kWidth, kHeight};
+    while (state.keep_running()) {
+        if (rect_is_opaque(frame.data(), kWidth, all))
+            pack_rgb_rect(frame.data(), out.data(), kWidth, all);
+    }
+    state.set_items_processed(state.iterations());
+    state.set_bytes_processed(state.iterations() * frame.size());
+}
+
+}  // namespace
+
+MBGL_SLINT_BENCH(FrameUpdateFull720p) {
+    full(state);
+}
+
+MBGL_SLINT_BENCH(FrameUpdateFullOpaque720p) {
+    full_opaque(state);
+}
+
+MBGL_SLINT_BENCH(FrameUpdateUnchanged720p) {
+    update(state, 0);
+}
+
+MBGL_SLINT_BENCH(FrameUpdateLabel720p) {
+    update(state, 4);
+}
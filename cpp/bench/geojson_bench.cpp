@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "bench.hpp"
+#include "geojson_loader.hpp"
+
+namespace {
+
+constexpr int kPoints = 1000000;
+
+// A FeatureCollection of `count` points spread over the world, each with
+// an id and a category property, as an application export would have.
+std::string make_points(int count) {
+    std::string json = R"({"type":"FeatureCollection","features":[)";
+    json.reserve(static_cast<std::size_t>(count) * 110);
+    uint32_t noise = 0x12345678u;
+    char feature[160];
+    for (int i = 0; i < count; ++i) {
+        noise = noise * 1664525u + 1013904223u;
+        const double lon = (noise >> 8) / 16777216.0 * 360.0 - 180.0;
+        noise = noise * 1664525u + 1013904223u;
+        const double lat = (noise >> 8) / 16777216.0 * 170.0 - 85.0;
+        std::snprintf(feature, sizeof(feature),
+                      R"(%s{"type":"Feature","properties":{"id":%d,)"
+                      R"("kind":%d},"geometry":{"type":"Point",)"
+                      R"("coordinates":[%.6f,%.6f]}})",
+                      i ? "," : "", i, i % 7, lon, lat);
+        json += feature;
+    }
+    return json + "]}";
+}
+
+// Resident set size in MiB, or -1 where it cannot be read.
+double resident_mb() {
+#ifdef __linux__
+    long pages = 0;
+    long resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        const int read = std::fscanf(statm, "%ld %ld", &pages, &resident);
+        std::fclose(statm);
+        const long page_size = sysconf(_SC_PAGESIZE);
+        if (read == 2 && page_size > 0)
+            return static_cast<double>(resident) * page_size /
+                   (1024.0 * 1024.0);
+    }
+#endif
+    return -1.0;
+}
+
+// What GeoJsonLoader does on a worker per dataset: parse the text, then
+// build the tile index (geojson-vt, or supercluster when clustering). The
+// label splits the time and gives the growth of the resident set over a
+// load, with the text released: the index plus any parse memory the
+// allocator has not returned to the system.
+void load(bench::State& state, bool cluster) {
+    const std::string text = make_points(kPoints);
+    auto options = mbgl::makeMutable<mbgl::style::GeoJSONOptions>();
+    options->cluster = cluster;
+    const mbgl::Immutable<mbgl::style::GeoJSONOptions> immutable =
+        std::move(options);
+    double parse_ms = 0.0;
+    double index_ms = 0.0;
+    double rss_delta_mb = 0.0;
+    while (state.keep_running()) {
+        const double before = resident_mb();
+        GeoJsonInput input;
+        input.json = text;
+        const auto result = build_geojson_data(std::move(input), immutable);
+        if (!result.data) {
+            state.stop_timer();
+            state.set_label("error=" + result.error);
+            return;
+        }
+        parse_ms += result.parse_ms;
+        index_ms += result.index_ms;
+        rss_delta_mb += resident_mb() - before;
+    }
+    state.set_items_processed(state.iterations() * kPoints);
+    state.set_bytes_processed(state.iterations() * text.size());
+    if (state.iterations()) {
+        const double n = static_cast<double>(state.iterations());
+        state.set_label("parse_ms=" + std::to_string(parse_ms / n) +
+                        " index_ms=" + std::to_string(index_ms / n) +
+                        " rss_delta_mb=" + std::to_string(rss_delta_mb / n));
+    }
+}
+
+}  // namespace
+
+MBGL_SLINT_BENCH(GeoJsonLoad1MPoints) {
+    load(state, false);
+}
+
+MBGL_SLINT_BENCH(GeoJsonLoad1MPointsClustered) {
+    load(state, true);
+}
@@ -0,0 +1,113 @@
+#include <GLES3/gl3.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "egl_headless_context.hpp"
+#include "gl_layer_projection.hpp"
+#include "gl_point_cloud_layer.hpp"
+#include "gl_render_target.hpp"
+
+namespace {
+
+constexpr int kWidth = 1024;
+constexpr int kHeight = 768;
+constexpr double kZoom = 9.0;
+constexpr double kLat = 35.7;
+constexpr double kLon = 139.75;
+
+// What MapLibre hands a custom layer for a flat map rotated by `bearing`:
+// world pixels at kZoom around (kLat, kLon) to clip space.
+mbgl::style::CustomLayerRenderParameters camera(double bearing) {
+    mbgl::style::CustomLayerRenderParameters params{};
+    params.width = kWidth;
+    params.height = kHeight;
+    params.latitude = kLat;
+    params.longitude = kLon;
+    params.zoom = kZoom;
+    params.bearing = bearing;
+
+    const double world = 512.0 * std::pow(2.0, kZoom);
+    const auto centre = GLLayerProjection::mercator(kLat, kLon);
+    const double cx = centre[0] * world;
+    const double cy = centre[1] * world;
+    const double c = std::cos(bearing * M_PI / 180.0);
+    const double s = std::sin(bearing * M_PI / 180.0);
+    const double sx = 2.0 / kWidth;
+    const double sy = 2.0 / kHeight;
+    // Column-major, like mbgl::mat4.
+    auto& m = params.projectionMatrix;
+    m = {};
+    m[0] = c * sx;
+    m[1] = -s * sy;
+    m[4] = -s * sx;
+    m[5] = -c * sy;
+    m[10] = 1.0;
+    m[12] = -(cx * c - cy * s) * sx;
+    m[13] = (cx * s + cy * c) * sy;
+    m[15] = 1.0;
+    return params;
+}
+
+// GLPointCloudLayer on its own: `count` points drawn into a 1024x768 FBO
+// per frame, without MapLibre's pass around it. The difference to
+// GLMapPointCloud* is the map's share of a frame.
+void layer_frames(bench::State& state, std::size_t count) {
+    EGLHeadlessContext gl;
+    if (!gl.ok()) {
+        state.set_label("no EGL/GLES 3");
+        return;
+    }
+    GLRenderTarget target;
+    target.resize(kWidth, kHeight);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo());
+    glViewport(0, target.layout().viewport_y(), kWidth, kHeight);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> dlat(35.4, 36.0);
+    std::uniform_real_distribution<double> dlon(139.3, 140.2);
+    std::vector<double> lat(count);
+    std::vector<double> lon(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        lat[i] = dlat(rng);
+        lon[i] = dlon(rng);
+    }
+    GLPointCloudLayer::Style style;
+    style.size = 2.0f;
+    GLPointCloudLayer points(lat, lon, style);
+    points.initialize();
+
+    double bearing = 0.0;
+    while (state.keep_running()) {
+        glClearColor(0.91f, 0.93f, 0.95f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        points.render(camera(bearing += 0.5));
+        glFlush();
+    }
+    glFinish();
+    state.stop_timer();
+    state.set_items_processed(state.iterations() * count);
+    const auto& stats = points.stats();
+    const uint64_t frames = state.iterations() ? state.iterations() : 1;
+    state.set_label("draw_calls_per_frame=" +
+                    std::to_string(stats.draw_calls / frames) +
+                    " points_per_frame=" +
+                    std::to_string(stats.instances / frames) + " " +
+                    gl.renderer());
+    points.deinitialize();
+    target.destroy();
+}
+
+}  // namespace
+
+MBGL_SLINT_BENCH(GLPointCloudLayer100k) {
+    layer_frames(state, 100000);
+}
+
+MBGL_SLINT_BENCH(GLPointCloudLayer1M) {
+    layer_frames(state, 1000000);
+}
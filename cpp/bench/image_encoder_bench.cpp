@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <string>
+
+#include "bench.hpp"
+#include "image_encoder.hpp"
+
+namespace {
+
+// 512x512 frame with map-like content: large flat areas, gradients and a
+// sprinkle of high-frequency detail.
+mbgl::PremultipliedImage make_frame() {
+    constexpr uint32_t kSize = 512;
+    mbgl::PremultipliedImage image({kSize, kSize});
+    uint8_t* p = image.data.get();
+    uint32_t noise = 0x12345678u;
+    for (uint32_t y = 0; y < kSize; ++y) {
+        for (uint32_t x = 0; x < kSize; ++x, p += 4) {
+            noise = noise * 1664525u + 1013904223u;
+            const bool road = (x + y / 3) % 97 < 3 || (y + x / 5) % 131 < 2;
+            const bool label = (noise >> 24) < 6;
+            p[0] = road ? 250 : static_cast<uint8_t>(200 + x / 32);
+            p[1] = road ? 220 : static_cast<uint8_t>(230 - y / 32);
+            p[2] = label ? static_cast<uint8_t>(noise >> 8)
+                         : static_cast<uint8_t>(190 + (x ^ y) % 8);
+            p[3] = 255;
+        }
+    }
+    return image;
+}
+
+void encode_sync(bench::State& state, ImageFormat format) {
+    if (!image_format_supported(format)) {
+        state.set_label("unsupported");
+        return;
+    }
+    const auto frame = make_frame();
+    uint64_t out = 0;
+    while (state.keep_running()) {
+        out += encode_image(frame, format).size();
+    }
+    state.set_items_processed(state.iterations());
+    state.set_bytes_processed(state.iterations() * frame.bytes());
+    if (state.iterations()) {
+        state.set_label("ratio=" +
+                        std::to_string(static_cast<double>(out) /
+                                       (state.iterations() * frame.bytes())));
+    }
+}
+
+// Producer hands frames over by move, the way a render loop would; the
+// measured rate is what a renderer could sustain if encoding were the only
+// bottleneck.
+void encode_pipelined(bench::State& state,
+                      ImageFormat format,
+                      std::size_t threads) {
+    const auto frame = make_frame();
+    ImageEncoder::Options options;
+    options.threads = threads;
+    options.queue_depth = threads * 2;
+    options.format = format;
+    ImageEncoder encoder(options);
+    while (state.keep_running()) {
+        encoder.submit(frame.clone(), ImageEncoder::Callback{});
+    }
+    encoder.wait_idle();
+    state.stop_timer();
+    state.set_items_processed(state.iterations());
+    state.set_bytes_processed(state.iterations() * frame.bytes());
+    state.set_label("threads=" + std::to_string(threads));
+}
+
+}  // namespace
+
+MBGL_SLINT_BENCH(EncodePng512) {
+    encode_sync(state, ImageFormat::PNG);
+}
+
+MBGL_SLINT_BENCH(EncodeQoi512) {
+    encode_sync(state, ImageFormat::QOI);
+}
+
+MBGL_SLINT_BENCH(EncodeWebp512) {
+    encode_sync(state, ImageFormat::WebP);
+}
+
+MBGL_SLINT_BENCH(EncoderPipelinePng512x1) {
+    encode_pipelined(state, ImageFormat::PNG, 1);
+}
+
+MBGL_SLINT_BENCH(EncoderPipelinePng512x4) {
+    encode_pipelined(state, ImageFormat::PNG, 4);
+}
+
+MBGL_SLINT_BENCH(EncoderPipelineQoi512x4) {
+    encode_pipelined(state, ImageFormat::QOI, 4);
+}
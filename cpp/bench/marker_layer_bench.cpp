@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "marker_layer.hpp"
+
+namespace {
+
+constexpr int kMarkers = 50000;
+
+// 50k markers scattered over about 110 x 110 km around Tokyo.
+MarkerPositions make_markers() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> offset(-0.5, 0.5);
+    std::uniform_real_distribution<float> rank(0.0f, 10.0f);
+    MarkerPositions markers;
+    markers.reserve(kMarkers);
+    for (int i = 0; i < kMarkers; ++i) {
+        markers.push(static_cast<uint64_t>(i), 139.7 + offset(rng),
+                     35.68 + offset(rng), rank(rng));
+    }
+    return markers;
+}
+
+// One update per frame of a pan across the data at 1280x720.
+void pan(bench::State& state, double zoom, bool spatial_index) {
+    MarkerLayer layer;
+    MarkerLayer::Options options;
+    options.spatial_index = spatial_index;
+    layer.set_markers(make_markers(), options);
+    MarkerViewport view;
+    view.zoom = zoom;
+    view.width = 1280.0f;
+    view.height = 720.0f;
+    view.lat = 35.68;
+    uint64_t candidates = 0;
+    uint64_t visible = 0;
+    uint64_t frame = 0;
+    while (state.keep_running()) {
+        // West to east and back, about 4 px per frame at zoom 14.
+        const double t = static_cast<double>(frame++ % 2000) / 2000.0;
+        view.lon = 139.3 + 0.8 * (t < 0.5 ? 2 * t : 2 - 2 * t);
+        layer.update(view);
+        candidates += layer.stats().candidates;
+        visible += layer.stats().visible;
+    }
+    state.set_items_processed(state.iterations());
+    if (state.iterations()) {
+        state.set_label("candidates=" +
+                        std::to_string(candidates / state.iterations()) +
+                        " visible=" +
+                        std::to_string(visible / state.iterations()));
+    }
+}
+
+}  // namespace
+
+// Street level: the index narrows 50k markers to the few hundred in view.
+MBGL_SLINT_BENCH(MarkerLayer50kPanZoom14) {
+    pan(state, 14.0, true);
+}
+
+// The same pan projecting every marker, as without the index.
+MBGL_SLINT_BENCH(MarkerLayer50kPanZoom14NoIndex) {
+    pan(state, 14.0, false);
+}
+
+// Zoomed out so all 50k are in view: collision culling does the work.
+MBGL_SLINT_BENCH(MarkerLayer50kPanZoom9) {
+    pan(state, 9.0, true);
+}
@@ -0,0 +1,79 @@
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "bench.hpp"
+#include "geojson_loader.hpp"
+#include "moving_objects.hpp"
+
+namespace {
+
+constexpr uint64_t kObjects = 10000;
+constexpr double kUpdatesPerSecond = 10.0;
+
+// Every object moves a little per tick, as a fleet feed at 10 Hz reports.
+void make_tick(ObjectPositions& deltas, int tick) {
+    deltas.clear();
+    for (uint64_t id = 0; id < kObjects; ++id) {
+        const double t = tick * 0.0001;
+        deltas.push(id, 139.0 + (id % 100) * 0.01 + t,
+                    35.0 + static_cast<double>(id / 100) * 0.01 + t,
+                    static_cast<float>((id + tick) % 360));
+    }
+}
+
+// Share of one core the per-second work would take at 10 Hz.
+std::string share_at_10hz(const bench::State& state) {
+    if (!state.iterations())
+        return {};
+    const double per_update_s =
+        state.seconds() / static_cast<double>(state.iterations());
+    return "core_at_10hz=" +
+           std::to_string(per_update_s * kUpdatesPerSecond * 100.0) + "%";
+}
+
+}  // namespace
+
+// UI thread side of one 10 Hz tick: apply 10k deltas, then the snapshot
+// render_map() takes for the source update.
+MBGL_SLINT_BENCH(MovingObjects10kTick) {
+    MovingObjects objects;
+    std::array<ObjectPositions, 2> ticks;
+    make_tick(ticks[0], 0);
+    make_tick(ticks[1], 1);
+    ObjectPositions snapshot;
+    objects.apply(ticks[0]);
+    std::size_t tick = 0;
+    while (state.keep_running()) {
+        objects.apply(ticks[++tick % 2]);
+        objects.snapshot(snapshot);
+    }
+    state.set_items_processed(state.iterations() * kObjects);
+    state.set_label(share_at_10hz(state));
+}
+
+// Worker side of one source update: features from the snapshot and the
+// source's tile index.
+MBGL_SLINT_BENCH(MovingObjects10kIndex) {
+    MovingObjects objects;
+    ObjectPositions deltas;
+    make_tick(deltas, 0);
+    objects.apply(deltas);
+    auto snapshot = std::make_shared<ObjectPositions>();
+    objects.snapshot(*snapshot);
+    const auto options = mbgl::style::GeoJSONOptions::defaultOptions();
+    while (state.keep_running()) {
+        GeoJsonInput input;
+        input.generate = [snapshot] { return to_point_features(*snapshot); };
+        const auto result = build_geojson_data(std::move(input), options);
+        if (!result.data) {
+            state.stop_timer();
+            state.set_label("error=" + result.error);
+            return;
+        }
+    }
+    state.set_items_processed(state.iterations() * kObjects);
+    state.set_label(share_at_10hz(state));
+}
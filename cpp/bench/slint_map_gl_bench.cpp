@@ -0,0 +1,193 @@
+#include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "egl_headless_context.hpp"
+#include "gl_point_cloud_layer.hpp"
+#include "slint_map_gl.hpp"
+
+namespace {
+
+// Background plus an inline GeoJSON grid of lines: offline, and enough draw
+// calls that the GPU (llvmpipe on CI) has real work per frame.
+std::string make_style() {
+    std::string features;
+    for (int i = 0; i < 64; ++i) {
+        const double lon = -180.0 + i * (360.0 / 64);
+        const double lat = -85.0 + i * (170.0 / 64);
+        if (!features.empty())
+            features += ",";
+        features += R"({"type":"Feature","properties":{},"geometry":)"
+                    R"({"type":"LineString","coordinates":[[)" +
+                    std::to_string(lon) + ",-85],[" + std::to_string(lon) +
+                    R"(,85]]}},{"type":"Feature","properties":{},"geometry":)"
+                    R"({"type":"LineString","coordinates":[[-180,)" +
+                    std::to_string(lat) + "],[180," + std::to_string(lat) +
+                    "]]}}";
+    }
+    return R"({"version":8,"sources":{"grid":{"type":"geojson","data":)"
+           R"({"type":"FeatureCollection","features":[)" +
+           features +
+           R"(]}}},"layers":[{"id":"bg","type":"background",)"
+           R"("paint":{"background-color":"#e8eef2"}},)"
+           R"({"id":"grid","type":"line","source":"grid",)"
+           R"("paint":{"line-color":"#36c","line-width":3}}]})";
+}
+
+struct GLMap {
+    EGLHeadlessContext gl;
+    SlintMapGL map;
+
+    bool start(std::size_t ring) {
+        if (!gl.ok())
+            return false;
+        map.set_fbo_ring(ring);
+        map.setup(1024, 768, "");
+        map.setStyleJSON(make_style());
+        // Until the style and its source are in and the map is idle.
+        for (int i = 0; i < 10000 && (!map.style_is_loaded() ||
+                                      map.needs_render() || !map.texture());
+             ++i) {
+            map.render();
+            map.frame_composited();
+        }
+        return map.style_is_loaded();
+    }
+    ~GLMap() {
+        map.release_gl();
+    }
+};
+
+// Throughput of a continuously changing map: one Slint frame per iteration
+// (render, then the composite's fence). glFinish only at the end, so a ring
+// can overlap the map's draw with the previous frame's composite.
+void frames(bench::State& state, std::size_t ring) {
+    GLMap m;
+    if (!m.start(ring)) {
+        state.set_label("no EGL/GLES 3");
+        return;
+    }
+    double bearing = 0.0;
+    while (state.keep_running()) {
+        m.map.set_bearing(bearing += 0.5);
+        m.map.render();
+        m.map.frame_composited();
+    }
+    glFinish();
+    state.stop_timer();
+    state.set_items_processed(state.iterations());
+    const auto& stats = m.map.ring_stats();
+    state.set_label("fence_waits=" + std::to_string(stats.fence_waits) +
+                    " " + m.gl.renderer());
+}
+
+// Latency from a camera change to the frame that shows it being complete
+// on the GPU; with a ring that is one extra Slint frame.
+void latency(bench::State& state, std::size_t ring) {
+    GLMap m;
+    if (!m.start(ring)) {
+        state.set_label("no EGL/GLES 3");
+        return;
+    }
+    double bearing = 0.0;
+    uint64_t slint_frames = 0;
+    while (state.keep_running()) {
+        m.map.set_bearing(bearing += 0.5);
+        do {
+            m.map.render();
+            m.map.frame_composited();
+            ++slint_frames;
+        } while (m.map.needs_render());
+        glFinish();
+    }
+    state.set_items_processed(state.iterations());
+    // Slint frames from a change until its frame is shown, as measured.
+    const double per_change =
+        state.iterations()
+            ? static_cast<double>(slint_frames) / state.iterations()
+            : 0.0;
+    state.set_label("frames_per_change=" + std::to_string(per_change));
+}
+
+// Frames with `count` custom-layer points spread over the view, drawn with
+// one instanced call per frame in the map's own pass.
+void point_cloud(bench::State& state, std::size_t count) {
+    GLMap m;
+    if (!m.start(2)) {
+        state.set_label("no EGL/GLES 3");
+        return;
+    }
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> dlat(35.4, 36.0);
+    std::uniform_real_distribution<double> dlon(139.3, 140.2);
+    std::vector<double> lat(count);
+    std::vector<double> lon(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        lat[i] = dlat(rng);
+        lon[i] = dlon(rng);
+    }
+    GLPointCloudLayer::Style style;
+    style.size = 2.0f;
+    auto points = std::make_shared<GLPointCloudLayer>(lat, lon, style);
+    m.map.add_custom_layer("points", points);
+    m.map.render();
+    m.map.frame_composited();
+
+    const auto before = points->stats();
+    double bearing = 0.0;
+    while (state.keep_running()) {
+        m.map.set_bearing(bearing += 0.5);
+        m.map.render();
+        m.map.frame_composited();
+    }
+    glFinish();
+    state.stop_timer();
+    state.set_items_processed(state.iterations() * count);
+    const auto& stats = points->stats();
+    const uint64_t draws = stats.draw_calls - before.draw_calls;
+    const uint64_t frames = state.iterations() ? state.iterations() : 1;
+    state.set_label("draw_calls_per_frame=" + std::to_string(draws / frames) +
+                    " points_per_frame=" +
+                    std::to_string((stats.instances - before.instances) /
+                                   frames) +
+                    " " + m.gl.renderer());
+}
+
+}  // namespace
+
+MBGL_SLINT_BENCH(GLMapFramesRing1) {
+    frames(state, 1);
+}
+
+MBGL_SLINT_BENCH(GLMapFramesRing2) {
+    frames(state, 2);
+}
+
+MBGL_SLINT_BENCH(GLMapFramesRing3) {
+    frames(state, 3);
+}
+
+MBGL_SLINT_BENCH(GLMapLatencyRing1) {
+    latency(state, 1);
+}
+
+MBGL_SLINT_BENCH(GLMapLatencyRing2) {
+    latency(state, 2);
+}
+
+MBGL_SLINT_BENCH(GLMapLatencyRing3) {
+    latency(state, 3);
+}
+
+MBGL_SLINT_BENCH(GLMapPointCloud100k) {
+    point_cloud(state, 100000);
+}
+
+MBGL_SLINT_BENCH(GLMapPointCloud1M) {
+    point_cloud(state, 1000000);
+}
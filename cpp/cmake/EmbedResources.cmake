@@ -0,0 +1,53 @@
+# mbgl_slint_embed_resources(<target> BASE_DIR <dir> [FILES <file>...])
+#
+# Packs files into <target> as gzip-compressed constexpr byte arrays that are
+# registered with mbgl::EmbeddedResources at startup and served to MapLibre as
+# embedded://<path relative to BASE_DIR> (see
+# cpp/platform/embedded_file_source.hpp). FILES defaults to every file below
+# BASE_DIR. Typical bundle layout for a kiosk build:
+#
+#   style.json                  -> embedded://style.json
+#   sprites/sprite{,@2x}.{json,png}
+#   fonts/<fontstack>/<range>.pbf
+#   tiles/<z>/<x>/<y>.pbf       (optional low-zoom tiles)
+#
+# with the style referencing those embedded:// URLs. The bundle is regenerated
+# whenever one of the listed files changes.
+
+set(_MBGL_SLINT_EMBED_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/embed_resources.cmake")
+
+function(mbgl_slint_embed_resources target)
+    cmake_parse_arguments(ARG "" "BASE_DIR" "FILES" ${ARGN})
+    if(NOT ARG_BASE_DIR)
+        message(FATAL_ERROR "mbgl_slint_embed_resources: BASE_DIR is required")
+    endif()
+    get_filename_component(_base "${ARG_BASE_DIR}" ABSOLUTE)
+    if(NOT ARG_FILES)
+        file(GLOB_RECURSE ARG_FILES LIST_DIRECTORIES false "${_base}/*")
+    endif()
+
+    set(_inputs)
+    foreach(_file IN LISTS ARG_FILES)
+        get_filename_component(_abs "${_file}" ABSOLUTE BASE_DIR "${_base}")
+        list(APPEND _inputs "${_abs}")
+    endforeach()
+    list(SORT _inputs)
+
+    set(_out "${CMAKE_CURRENT_BINARY_DIR}/${target}_embedded_resources.cpp")
+    set(_list "${CMAKE_CURRENT_BINARY_DIR}/${target}_embedded_resources.txt")
+    string(REPLACE ";" "\n" _list_content "${_inputs}")
+    file(GENERATE OUTPUT "${_list}" CONTENT "${_list_content}\n")
+
+    add_custom_command(
+        OUTPUT "${_out}"
+        COMMAND ${CMAKE_COMMAND}
+            -DBASE_DIR=${_base}
+            -DFILE_LIST=${_list}
+            -DOUTPUT=${_out}
+            -P "${_MBGL_SLINT_EMBED_SCRIPT}"
+        DEPENDS ${_inputs} "${_list}" "${_MBGL_SLINT_EMBED_SCRIPT}"
+        COMMENT "Embedding ${target} resources from ${_base}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE "${_out}")
+endfunction()
@@ -0,0 +1,56 @@
+# Build-time helper for mbgl_slint_embed_resources() (EmbedResources.cmake).
+# Usage: cmake -DBASE_DIR=... -DFILE_LIST=... -DOUTPUT=... -P embed_resources.cmake
+
+file(STRINGS "${FILE_LIST}" _files)
+get_filename_component(_out_dir "${OUTPUT}" DIRECTORY)
+set(_tmp "${_out_dir}/embed_tmp")
+file(MAKE_DIRECTORY "${_tmp}")
+
+# CMake regexes have no {n} quantifier; spell out one 16-byte output row.
+string(REPEAT "0x..," 16 _row)
+
+set(_blobs "")
+set(_table "")
+set(_index 0)
+foreach(_file IN LISTS _files)
+    file(RELATIVE_PATH _rel "${BASE_DIR}" "${_file}")
+    file(SIZE "${_file}" _size)
+
+    # A raw archive holding a single entry is just that entry's bytes, so
+    # this yields a plain gzip stream of the file.
+    set(_gz "${_tmp}/${_index}.gz")
+    file(ARCHIVE_CREATE OUTPUT "${_gz}" PATHS "${_file}"
+         FORMAT raw COMPRESSION GZip)
+    file(SIZE "${_gz}" _gz_size)
+    file(READ "${_gz}" _hex HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," _bytes "${_hex}")
+    # Wrap long lines so compilers and editors stay happy.
+    string(REGEX REPLACE "(${_row})" "\\1\n    " _bytes "${_bytes}")
+
+    string(APPEND _blobs
+        "// ${_rel} (${_size} bytes, ${_gz_size} gzipped)\n"
+        "constexpr unsigned char kBlob${_index}[] = {\n    ${_bytes}\n};\n\n")
+    string(APPEND _table
+        "    {\"${_rel}\", kBlob${_index}, sizeof(kBlob${_index}), ${_size}, true},\n")
+    math(EXPR _index "${_index} + 1")
+endforeach()
+file(REMOVE_RECURSE "${_tmp}")
+
+if(_index EQUAL 0)
+    set(_registration "// No resources embedded.\n")
+else()
+    string(CONCAT _registration
+        "const mbgl::EmbeddedResource kResources[] = {\n${_table}};\n\n"
+        "const mbgl::EmbeddedResourceRegistrar kRegistrar(\n"
+        "    kResources, sizeof(kResources) / sizeof(kResources[0]));\n")
+endif()
+
+file(WRITE "${OUTPUT}.tmp"
+    "// Generated by cpp/cmake/embed_resources.cmake - do not edit.\n"
+    "#include \"embedded_file_source.hpp\"\n\n"
+    "namespace {\n\n"
+    "${_blobs}"
+    "${_registration}\n"
+    "}  // namespace\n")
+file(COPY_FILE "${OUTPUT}.tmp" "${OUTPUT}" ONLY_IF_DIFFERENT)
+file(REMOVE "${OUTPUT}.tmp")
@@ -1,19 +1,134 @@
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <random>
+#include <string>
+#include <utility>
 
+#include "embedded_file_source.hpp"
 #include "map_window.h"
+#include "slint_map_engine.hpp"
+#include "slint_map_views.hpp"
 #include "slint_maplibre_headless.hpp"
 
+// Set by CMake when MLN_SLINT_EMBED_DIR bundles a style into the binary.
+#ifdef MLN_SLINT_EMBEDDED_STYLE
+constexpr const char* kStartupStyleUrl = MLN_SLINT_EMBEDDED_STYLE;
+constexpr bool kStyleIsEmbedded = true;
+#else
+constexpr const char* kStartupStyleUrl = SlintMapLibre::kDefaultStyleUrl;
+constexpr bool kStyleIsEmbedded = false;
+#endif
+
 int main(int argc, char** argv) {
     std::cout << "[main] Starting application" << std::endl;
+    // Serve embedded:// before the first map (and its file sources) exists.
+    mbgl::install_embedded_file_source();
+    // Every map of the window (the default MMapView plus any MMapView with a
+    // map-id) shares one RunLoop and MapLibre's file sources/cache.
+    auto engine = std::make_shared<SlintMapEngine>();
+    auto slint_map = std::make_shared<SlintMapLibre>(engine);
+    // Start the style download and GL context bring-up while Slint creates
+    // the window; initialize() below only has to apply the real map size.
+    slint_map->prewarm(kStartupStyleUrl, 800, 600);
     auto main_window = MapWindow::create();
-    auto slint_map = std::make_shared<SlintMapLibre>();
+    auto views = SlintMapViews<MapWindow, MMapAdapter, MMapViewState>::bind(
+        main_window, engine);
 
     auto initialized = std::make_shared<bool>(false);
 
+    // Optional interaction recording for mbgl-slint-replay.
+    std::shared_ptr<InputRecorder> recorder;
+    const char* record_path = std::getenv("MAPLIBRE_RECORD_INPUT");
+    if (record_path && record_path[0] != '\0') {
+        recorder = std::make_shared<InputRecorder>();
+        slint_map->set_input_recorder(recorder);
+        std::cout << "[main] Recording input to " << record_path << std::endl;
+    }
+
+    // Partial frame updates (only changed tiles are converted for Slint)
+    // are on unless MAPLIBRE_PARTIAL_UPDATES=0.
+    const char* partial = std::getenv("MAPLIBRE_PARTIAL_UPDATES");
+    if (partial && std::string(partial) == "0")
+        slint_map->set_partial_updates(false);
+    // Opaque frames are handed over as RGB unless MAPLIBRE_OPAQUE_RGB=0.
+    const char* opaque_rgb = std::getenv("MAPLIBRE_OPAQUE_RGB");
+    if (opaque_rgb && std::string(opaque_rgb) == "0")
+        slint_map->set_opaque_fast_path(false);
+    // MAPLIBRE_ALIGN_SOURCES=1 keeps the tiles of sources shared across a
+    // style switch by renaming them to the previous style's IDs.
+    const char* align_sources = std::getenv("MAPLIBRE_ALIGN_SOURCES");
+    if (align_sources && std::string(align_sources) == "1")
+        slint_map->set_align_style_sources(true);
+
+    // MAPLIBRE_GEOJSON=<file> overlays a GeoJSON dataset, with points
+    // clustered. It is read and indexed in the background; the map shows it
+    // once that is done.
+    const char* geojson_path = std::getenv("MAPLIBRE_GEOJSON");
+    if (geojson_path && geojson_path[0] != '\0') {
+        SlintMapLibre::GeoJsonOverlayOptions overlay;
+        overlay.source.cluster = true;
+        overlay.layers_json = R"JSON([
+            {"id": "app-data-fill", "type": "fill",
+             "filter": ["==", ["geometry-type"], "Polygon"],
+             "paint": {"fill-color": "#e4572e", "fill-opacity": 0.3}},
+            {"id": "app-data-line", "type": "line",
+             "filter": ["==", ["geometry-type"], "LineString"],
+             "paint": {"line-color": "#e4572e", "line-width": 2}},
+            {"id": "app-data-points", "type": "circle",
+             "filter": ["==", ["geometry-type"], "Point"],
+             "paint": {
+                "circle-color": "#e4572e",
+                "circle-stroke-color": "#ffffff",
+                "circle-stroke-width": 1,
+                "circle-radius": ["step",
+                    ["coalesce", ["get", "point_count"], 1],
+                    4, 100, 8, 1000, 12]}}])JSON";
+        GeoJsonInput input;
+        input.path = geojson_path;
+        slint_map->set_geojson(
+            "app-data", std::move(input), overlay,
+            [](GeoJsonLoadResult&& result) {
+                if (!result.error.empty())
+                    std::cerr << "[main] GeoJSON overlay: " << result.error
+                              << std::endl;
+            });
+    }
+
+    // MAPLIBRE_MARKERS=<count> scatters that many Slint markers around
+    // Tokyo (see map_window.slint); only the visible ones reach Slint.
+    const char* marker_count = std::getenv("MAPLIBRE_MARKERS");
+    if (marker_count && std::atoi(marker_count) > 0) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> offset(-0.3, 0.3);
+        std::uniform_real_distribution<float> rank(0.0f, 1.0f);
+        MarkerPositions markers;
+        const int count = std::atoi(marker_count);
+        markers.reserve(static_cast<std::size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            markers.push(static_cast<uint64_t>(i), 139.69 + offset(rng),
+                         35.69 + offset(rng), rank(rng), i % 3,
+                         "#" + std::to_string(i));
+        }
+        MarkerLayer::Options options;
+        options.marker_width = 16.0f;
+        options.marker_height = 16.0f;
+        slint_map->set_markers(std::move(markers), options);
+    }
+    // Synced in place each frame, so marker instances are reused.
+    auto marker_model = std::make_shared<slint::VecModel<MMapMarker>>();
+    main_window->global<MMapAdapter>().set_markers(marker_model);
+
     // Render: read frame from MapLibre and push to MMapAdapter
     auto render_function = [=]() {
         auto image = slint_map->render_map();
+        if (slint_map->markers_changed())
+            sync_marker_model(*marker_model, slint_map->markers());
+        // Unchanged frame: leaving `frame` alone gives Slint nothing to
+        // redraw.
+        if (!slint_map->last_frame_changed())
+            return;
         main_window->global<MMapAdapter>().set_frame(image);
 
         // Update reactive camera state
@@ -46,6 +161,11 @@ int main(int argc, char** argv) {
             slint_map->consume_forced_repaint()) {
             render_function();
         }
+        // Feature queries for clicks and hovers, after the frame so they
+        // never hold one up.
+        slint_map->answer_picks();
+        // The default view shares the engine and has pumped its run loop.
+        views->tick(false);
     });
 
     // User interactions
@@ -63,6 +183,25 @@ int main(int argc, char** argv) {
             slint_map->handle_double_click(x, y, shift);
         });
 
+    // Clicks and hovers are answered from the tick, see answer_picks().
+    main_window->global<MMapAdapter>().on_map_clicked([=](float x, float y) {
+        slint_map->request_pick(x, y, false, [=](const PickResult& result) {
+            auto& adapter = main_window->global<MMapAdapter>();
+            adapter.set_clicked_lat(static_cast<float>(result.lat));
+            adapter.set_clicked_lon(static_cast<float>(result.lon));
+            adapter.set_picked_features(
+                feature_model<MMapFeature>(result.features));
+            adapter.set_click_count(adapter.get_click_count() + 1);
+        });
+    });
+
+    main_window->global<MMapAdapter>().on_mouse_hovered([=](float x, float y) {
+        slint_map->request_pick(x, y, true, [=](const PickResult& result) {
+            main_window->global<MMapAdapter>().set_hovered_features(
+                feature_model<MMapFeature>(result.features));
+        });
+    });
+
     main_window->global<MMapAdapter>().on_wheel_zoomed(
         [=](float x, float y, float dy) {
             slint_map->handle_wheel_zoom(x, y, dy);
@@ -106,9 +245,12 @@ int main(int argc, char** argv) {
                 auto& adapter = main_window->global<MMapAdapter>();
                 if (adapter.get_initial_config_set()) {
                     const auto url = adapter.get_initial_style_url();
-                    if (url.size() > 0) {
-                        slint_map->setStyleUrl(
-                            std::string(url.data(), url.size()));
+                    const std::string initial_url(url.data(), url.size());
+                    // Skip the reload when the pre-warmed style matches, and
+                    // never leave an embedded (offline) style for a remote one.
+                    if (!kStyleIsEmbedded && !initial_url.empty() &&
+                        initial_url != slint_map->style_url()) {
+                        slint_map->setStyleUrl(initial_url);
                     }
                     if (auto* m = slint_map->get_map()) {
                         mbgl::CameraOptions cam;
@@ -135,5 +277,10 @@ int main(int argc, char** argv) {
 
     std::cout << "[main] Entering UI event loop" << std::endl;
     main_window->run();
+
+    if (recorder && !recorder->save(record_path)) {
+        std::cerr << "[main] Failed to write input recording to "
+                  << record_path << std::endl;
+    }
     return 0;
 }
@@ -1,12 +1,17 @@
 #include <GLES3/gl3.h>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <slint.h>
 #include <string>
+#include <utility>
 
+#include "feature_model.hpp"
 #include "gl_map_window.h"
+#include "gl_state_shadow.hpp"
 #include "slint_map_gl.hpp"
 
 int main(int /*argc*/, char** /*argv*/) {
@@ -30,11 +35,45 @@ int main(int /*argc*/, char** /*argv*/) {
         envH = std::atoi(e);
 
     auto gl_ready = std::make_shared<bool>(false);
-    auto tex = std::make_shared<GLuint>(0);
-    auto fbo = std::make_shared<GLuint>(0);
-    auto rbo = std::make_shared<GLuint>(0);
-    auto Wp = std::make_shared<int>(0);
-    auto Hp = std::make_shared<int>(0);
+    // What Slint currently shows: the texture, its size and the map inside.
+    auto published = std::make_shared<FramebufferLayout>();
+    auto published_texture = std::make_shared<GLuint>(0);
+    auto gl_state = std::make_shared<GLStateShadow>();
+    auto last_size = std::make_shared<slint::PhysicalSize>();
+
+    // MAPLIBRE_GL_STATE_CHECK=1 queries Slint's GL state every frame anyway
+    // and logs when it no longer matches the shadow (debugging aid).
+    bool check_gl_state = false;
+    if (const char* e = std::getenv("MAPLIBRE_GL_STATE_CHECK"))
+        check_gl_state = e[0] == '1';
+
+    // Elsewhere the map is redrawn only when it changes, but V3D (the Pi's
+    // tiled GPU) treats the FBO colour attachment as transient: skipping a
+    // render there loses the borrowed texture and the map turns white or
+    // black. So V3D re-renders on every frame Slint draws; Slint still only
+    // draws when something (e.g. the map's invalidation) requested it, so a
+    // static map stays idle. MAPLIBRE_GL_RENDER_EVERY_FRAME=1/0 overrides
+    // the detection.
+    int render_every_frame_env = -1;
+    if (const char* e = std::getenv("MAPLIBRE_GL_RENDER_EVERY_FRAME");
+        e && e[0] != '\0')
+        render_every_frame_env = e[0] == '1' ? 1 : 0;
+    auto render_every_frame = std::make_shared<bool>(false);
+
+    // The map element's size in physical pixels (the map renders at pixel
+    // ratio 1).
+    const auto map_pixels = [win]() {
+        const auto s = win->get_map_size();
+        const float scale = win->window().scale_factor();
+        return std::pair{static_cast<int>(std::lround(s.width * scale)),
+                         static_cast<int>(std::lround(s.height * scale))};
+    };
+
+    // A weak handle: smap is owned by the window's callbacks.
+    smap->set_redraw_callback([weak = slint::ComponentWeakHandle(win)]() {
+        if (auto w = weak.lock())
+            (*w)->window().request_redraw();
+    });
 
     win->window().set_rendering_notifier([=](slint::RenderingState state,
                                              slint::GraphicsAPI api) {
@@ -47,50 +86,35 @@ int main(int /*argc*/, char** /*argv*/) {
                 return;
             }
 
+            // Size the map to its element; MAPLIBRE_WIDTH/HEIGHT pin it.
             auto ps = win->window().size();
-            int w = envW > 0
-                        ? envW
-                        : (ps.width > 0 ? static_cast<int>(ps.width) : 1280);
-            int h = envH > 0
-                        ? envH
-                        : (ps.height > 0 ? static_cast<int>(ps.height) : 720);
-            *Wp = w;
-            *Hp = h;
+            const auto [mw, mh] = map_pixels();
+            int w = envW > 0 ? envW
+                    : mw > 0 ? mw
+                    : (ps.width > 0 ? static_cast<int>(ps.width) : 1280);
+            int h = envH > 0 ? envH
+                    : mh > 0 ? mh
+                    : (ps.height > 0 ? static_cast<int>(ps.height) : 720);
             std::cout << "[main_gl] RenderingSetup: NativeOpenGL acquired, "
                          "render size "
                       << w << "x" << h << std::endl;
 
-            glGenTextures(1, tex.get());
-            glBindTexture(GL_TEXTURE_2D, *tex);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
-                         GL_UNSIGNED_BYTE, nullptr);
-
-            glGenRenderbuffers(1, rbo.get());
-            glBindRenderbuffer(GL_RENDERBUFFER, *rbo);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
-
-            glGenFramebuffers(1, fbo.get());
-            glBindFramebuffer(GL_FRAMEBUFFER, *fbo);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                                   GL_TEXTURE_2D, *tex, 0);
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER,
-                                      GL_DEPTH_STENCIL_ATTACHMENT,
-                                      GL_RENDERBUFFER, *rbo);
-
-            GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-            std::cout << "[main_gl] FBO status="
-                      << (status == GL_FRAMEBUFFER_COMPLETE
-                              ? "GL_FRAMEBUFFER_COMPLETE"
-                              : std::to_string(status))
-                      << " fbo=" << *fbo << " tex=" << *tex << std::endl;
-
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-            smap->setup(*fbo, w, h, styleUrl);
+            const auto* renderer = reinterpret_cast<const char*>(
+                glGetString(GL_RENDERER));
+            const bool v3d =
+                renderer && std::string(renderer).find("V3D") !=
+                                std::string::npos;
+            *render_every_frame = render_every_frame_env >= 0
+                                      ? render_every_frame_env == 1
+                                      : v3d;
+            std::cout << "[main_gl] GL_RENDERER="
+                      << (renderer ? renderer : "?") << " render "
+                      << (*render_every_frame ? "every frame"
+                                              : "on change")
+                      << std::endl;
+
+            smap->setup(w, h, styleUrl);
+            gl_state->invalidate();
             *gl_ready = true;
             break;
         }
@@ -98,67 +122,64 @@ int main(int /*argc*/, char** /*argv*/) {
             if (!*gl_ready)
                 return;
 
-            GLint pf = 0;
-            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &pf);
-            GLint vp[4] = {0, 0, 0, 0};
-            glGetIntegerv(GL_VIEWPORT, vp);
-            GLint prog = 0;
-            glGetIntegerv(GL_CURRENT_PROGRAM, &prog);
-            GLint arrayBuf = 0;
-            glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuf);
-            GLint elemBuf = 0;
-            glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elemBuf);
-            GLint activeTex = 0;
-            glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTex);
-            GLboolean blend = glIsEnabled(GL_BLEND);
-            GLboolean depth = glIsEnabled(GL_DEPTH_TEST);
-            GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
-            GLboolean cull = glIsEnabled(GL_CULL_FACE);
-
-            smap->render();
-
-            glBindFramebuffer(GL_FRAMEBUFFER, pf);
-            glViewport(vp[0], vp[1], vp[2], vp[3]);
-            glUseProgram(prog);
-            glBindBuffer(GL_ARRAY_BUFFER, arrayBuf);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elemBuf);
-            glActiveTexture(activeTex);
-            if (blend)
-                glEnable(GL_BLEND);
-            else
-                glDisable(GL_BLEND);
-            if (depth)
-                glEnable(GL_DEPTH_TEST);
-            else
-                glDisable(GL_DEPTH_TEST);
-            if (scissor)
-                glEnable(GL_SCISSOR_TEST);
-            else
-                glDisable(GL_SCISSOR_TEST);
-            if (cull)
-                glEnable(GL_CULL_FACE);
-            else
-                glDisable(GL_CULL_FACE);
-
-            win->global<MMapAdapter>().set_frame(
-                slint::Image::create_from_borrowed_gl_2d_rgba_texture(
-                    *tex,
-                    {static_cast<uint32_t>(*Wp), static_cast<uint32_t>(*Hp)},
-                    slint::Image::BorrowedOpenGLTextureOrigin::BottomLeft));
-            win->window().request_redraw();
+            // Unless every drawn frame renders (V3D), only redraw the FBO
+            // when the map changed. Otherwise the texture still holds the
+            // last frame and Slint re-composites it.
+            smap->poll();
+            if (*render_every_frame || smap->needs_render()) {
+                // Slint's target and capabilities are read once per window
+                // size; the object bindings it last used are re-read every
+                // frame, since nothing keeps them stable.
+                auto ws = win->window().size();
+                if (ws.width != last_size->width ||
+                    ws.height != last_size->height) {
+                    *last_size = ws;
+                    gl_state->invalidate();
+                }
+                if (check_gl_state)
+                    gl_state->verify();
+                else
+                    gl_state->refresh_bindings();
+
+                // Already polled above: draw without polling again.
+                smap->draw(*render_every_frame);
+
+                gl_state->restore();
+            }
+
+            // The image changes when the front buffer of the FBO ring flips
+            // or on a resize; otherwise a redraw is enough, and SlintMapGL
+            // requests that itself.
+            const GLuint texture = smap->texture();
+            const FramebufferLayout layout = smap->frame_layout();
+            if (texture != 0 &&
+                (texture != *published_texture || layout != *published)) {
+                auto& adapter = win->global<MMapAdapter>();
+                adapter.set_frame(
+                    slint::Image::create_from_borrowed_gl_2d_rgba_texture(
+                        texture,
+                        {static_cast<uint32_t>(layout.texture_width),
+                         static_cast<uint32_t>(layout.texture_height)},
+                        slint::Image::BorrowedOpenGLTextureOrigin::
+                            BottomLeft));
+                adapter.set_frame_clip_width(layout.width);
+                adapter.set_frame_clip_height(layout.height);
+                *published = layout;
+                *published_texture = texture;
+            }
             break;
         }
         case slint::RenderingState::AfterRendering:
+            // Slint has sampled the front texture; fence it before reuse.
+            if (*gl_ready)
+                smap->frame_composited();
             break;
         case slint::RenderingState::RenderingTeardown: {
             std::cout << "[main_gl] RenderingTeardown" << std::endl;
-            if (*fbo)
-                glDeleteFramebuffers(1, fbo.get());
-            if (*rbo)
-                glDeleteRenderbuffers(1, rbo.get());
-            if (*tex)
-                glDeleteTextures(1, tex.get());
-            *fbo = *rbo = *tex = 0;
+            smap->release_gl();
+            *published = {};
+            *published_texture = 0;
+            gl_state->invalidate();
             *gl_ready = false;
             break;
         }
@@ -179,6 +200,30 @@ int main(int /*argc*/, char** /*argv*/) {
     win->global<MMapAdapter>().on_wheel_zoomed(
         [=](float x, float y, float dy) { smap->handle_wheel_zoom(x, y, dy); });
 
+    // Clicks and hovers are answered from the map pump below, outside
+    // Slint's rendering; MMapView fires `clicked` once click-count changes.
+    const auto weak_win = slint::ComponentWeakHandle(win);
+    win->global<MMapAdapter>().on_map_clicked([=](float x, float y) {
+        smap->request_pick(x, y, false, [=](const PickResult& result) {
+            auto w = weak_win.lock();
+            if (!w)
+                return;
+            auto& adapter = (*w)->global<MMapAdapter>();
+            adapter.set_clicked_lat(static_cast<float>(result.lat));
+            adapter.set_clicked_lon(static_cast<float>(result.lon));
+            adapter.set_picked_features(
+                feature_model<MMapFeature>(result.features));
+            adapter.set_click_count(adapter.get_click_count() + 1);
+        });
+    });
+    win->global<MMapAdapter>().on_mouse_hovered([=](float x, float y) {
+        smap->request_pick(x, y, true, [=](const PickResult& result) {
+            if (auto w = weak_win.lock())
+                (*w)->global<MMapAdapter>().set_hovered_features(
+                    feature_model<MMapFeature>(result.features));
+        });
+    });
+
     // Toolbar commands (dropdown / buttons / sliders).
     win->global<MMapAdapter>().on_request_style_change(
         [=](const slint::SharedString& u) {
@@ -193,7 +238,25 @@ int main(int /*argc*/, char** /*argv*/) {
     win->global<MMapAdapter>().on_request_bearing_change(
         [=](float b) { smap->set_bearing(b); });
 
-    win->on_map_size_changed([=]() {});
+    // Live resize, unless MAPLIBRE_WIDTH/HEIGHT pinned the size. SlintMapGL
+    // debounces the stream of sizes a drag-resize produces.
+    win->on_map_size_changed([=]() {
+        if (envW > 0 || envH > 0)
+            return;
+        const auto [w, h] = map_pixels();
+        smap->resize(w, h);
+    });
+
+    // Without a redraw on every frame, MapLibre's RunLoop still has to run so
+    // tiles arrive and animations advance; their invalidations then request
+    // a redraw through the callback above. Queued picks are answered here
+    // too, against the frame drawn last.
+    slint::Timer map_pump(std::chrono::milliseconds(16), [=]() {
+        if (*gl_ready) {
+            smap->poll();
+            smap->answer_picks();
+        }
+    });
 
     std::cout << "[main_gl] Entering UI event loop" << std::endl;
     win->run();
@@ -1,7 +1,9 @@
 #include "custom_file_source.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <cpr/cpr.h>
+#include <curl/curl.h>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/util/thread.hpp>
 #include <memory>
@@ -24,9 +26,40 @@ public:
     std::shared_ptr<std::atomic_bool> cancelled;
 };
 
+namespace {
+
+std::chrono::microseconds elapsed_us(std::chrono::steady_clock::time_point from,
+                                     std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from);
+}
+
+// Connect and time-to-first-byte come straight from libcurl's timers, which
+// count from the start of the transfer (i.e. after the queue wait).
+void record_transfer_times(FileSourceMetrics& metrics, Resource::Kind kind,
+                           cpr::Session& session) {
+    CURL* curl = session.GetCurlHolder()->handle;
+    curl_off_t connect_us = 0;
+    curl_off_t first_byte_us = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect_us) ==
+        CURLE_OK) {
+        metrics.record_latency(kind, FileSourceMetrics::Phase::Connect,
+                               std::chrono::microseconds(connect_us));
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T,
+                          &first_byte_us) == CURLE_OK &&
+        first_byte_us > 0) {
+        metrics.record_latency(kind, FileSourceMetrics::Phase::FirstByte,
+                               std::chrono::microseconds(first_byte_us));
+    }
+}
+
+}  // namespace
+
 class CustomFileSource::Impl {
 public:
-    Impl() = default;
+    explicit Impl(std::shared_ptr<FileSourceMetrics> metrics_)
+        : metrics(std::move(metrics_)) {
+    }
     ~Impl() {
         std::lock_guard<std::mutex> lock(threadsMutex);
         for (auto& thread : threads) {
@@ -38,13 +71,23 @@ public:
 
     void request(const Resource& resource, Callback callback,
                  std::shared_ptr<std::atomic_bool> cancelled) {
+        const auto queued_at = std::chrono::steady_clock::now();
+        metrics->record_request(resource.kind);
         std::lock_guard<std::mutex> lock(threadsMutex);
-        threads.emplace_back([url = resource.url,
+        threads.emplace_back([resource, queued_at, metrics = metrics,
                               callback = std::move(callback),
                               cancelled = std::move(cancelled)]() {
-            cpr::Response r = cpr::Get(cpr::Url{url});
-            Response response;
+            const auto kind = resource.kind;
+            const auto started_at = std::chrono::steady_clock::now();
+            metrics->record_latency(kind, FileSourceMetrics::Phase::QueueWait,
+                                    elapsed_us(queued_at, started_at));
+
+            cpr::Session session;
+            session.SetUrl(cpr::Url{resource.url});
+            cpr::Response r = session.Get();
+            record_transfer_times(*metrics, kind, session);
 
+            Response response;
             if (r.error.code != cpr::ErrorCode::OK) {
                 response.error = std::make_unique<Response::Error>(
                     Response::Error::Reason::Connection, r.error.message);
@@ -56,18 +99,37 @@ public:
                 response.data = std::make_shared<std::string>(r.text);
             }
 
-            if (!cancelled->load()) {
-                callback(response);
+            metrics->record_latency(
+                kind, FileSourceMetrics::Phase::Total,
+                elapsed_us(queued_at, std::chrono::steady_clock::now()));
+            if (cancelled->load()) {
+                metrics->record_cancelled(kind);
+                return;
             }
+            if (response.error) {
+                metrics->record_error(kind, response.error->reason);
+            }
+            // MapLibre only asks for what its cache lacks or wants
+            // revalidated; a revalidation that returns the cached body
+            // unchanged is the hit this file source can see.
+            const bool cache_hit = response.data && resource.priorData &&
+                                   *response.data == *resource.priorData;
+            metrics->record_response(kind, r.text.size(), cache_hit);
+            callback(response);
         });
     }
 
+    const std::shared_ptr<FileSourceMetrics> metrics;
+
 private:
     std::mutex threadsMutex;
     std::vector<std::thread> threads;
 };
 
-CustomFileSource::CustomFileSource() : impl(std::make_unique<Impl>()) {
+CustomFileSource::CustomFileSource(std::shared_ptr<FileSourceMetrics> metrics)
+    : impl(std::make_unique<Impl>(
+          metrics ? std::move(metrics)
+                  : std::make_shared<FileSourceMetrics>())) {
 }
 
 CustomFileSource::~CustomFileSource() = default;
@@ -79,6 +141,14 @@ std::unique_ptr<AsyncRequest> CustomFileSource::request(
     return req;
 }
 
+const FileSourceMetrics& CustomFileSource::metrics() const {
+    return *impl->metrics;
+}
+
+FileSourceMetrics::Snapshot CustomFileSource::metrics_snapshot() const {
+    return impl->metrics->snapshot();
+}
+
 bool CustomFileSource::canRequest(const Resource& resource) const {
     const std::string& url = resource.url;
     if (url.rfind("http://", 0) != 0 && url.rfind("https://", 0) != 0) {
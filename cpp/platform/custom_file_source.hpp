@@ -8,11 +8,16 @@
 #include <memory>
 #include <string>
 
+#include "file_source_metrics.hpp"
+
 namespace mbgl {
 
 class CustomFileSource : public FileSource {
 public:
-    CustomFileSource();
+    // Pass `metrics` to aggregate several file sources into one set of
+    // counters; by default each instance keeps its own.
+    explicit CustomFileSource(
+        std::shared_ptr<FileSourceMetrics> metrics = nullptr);
     ~CustomFileSource() override;
 
     std::unique_ptr<AsyncRequest> request(const Resource&, Callback) override;
@@ -23,6 +28,11 @@ public:
     void setClientOptions(ClientOptions options) override;
     ClientOptions getClientOptions() override;
 
+    // Per-Resource::Kind request counts, latency histograms, bytes, errors,
+    // cancellations and cache hits. Safe to read from any thread.
+    const FileSourceMetrics& metrics() const;
+    FileSourceMetrics::Snapshot metrics_snapshot() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl;
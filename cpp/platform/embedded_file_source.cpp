@@ -0,0 +1,177 @@
+#include "embedded_file_source.hpp"
+
+#include <map>
+#include <mbgl/storage/file_source_manager.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mutex>
+#include <zlib.h>
+
+namespace mbgl {
+
+namespace {
+
+struct Entry {
+    EmbeddedResource resource;
+    std::shared_ptr<const std::string> decoded;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+};
+
+Registry& registry() {
+    // Function-local so generated bundles can register from their own static
+    // initializers regardless of translation-unit order.
+    static Registry instance;
+    return instance;
+}
+
+std::shared_ptr<const std::string> gunzip(const EmbeddedResource& res) {
+    auto out = std::make_shared<std::string>();
+    out->resize(res.uncompressed_size);
+
+    z_stream stream{};
+    // 16 + MAX_WBITS: expect a gzip header (CMake's raw+GZip archive output).
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+        return nullptr;
+    stream.next_in = const_cast<Bytef*>(res.data);
+    stream.avail_in = static_cast<uInt>(res.size);
+    stream.next_out = reinterpret_cast<Bytef*>(out->data());
+    stream.avail_out = static_cast<uInt>(out->size());
+    const int rc = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (rc != Z_STREAM_END || stream.total_out != res.uncompressed_size)
+        return nullptr;
+    return out;
+}
+
+// "embedded://sprites/sprite@2x.png?fresh=true" -> "sprites/sprite@2x.png"
+std::string embedded_path(const std::string& url) {
+    std::string path = url.substr(std::char_traits<char>::length(
+        EmbeddedFileSource::kScheme));
+    const auto query = path.find_first_of("?#");
+    if (query != std::string::npos)
+        path.resize(query);
+    return path;
+}
+
+}  // namespace
+
+void EmbeddedResources::add(const EmbeddedResource* resources,
+                            std::size_t count) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (std::size_t i = 0; i < count; ++i) {
+        reg.entries[resources[i].path] = Entry{resources[i], nullptr};
+    }
+}
+
+bool EmbeddedResources::contains(const std::string& path) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.entries.count(path) != 0;
+}
+
+std::shared_ptr<const std::string> EmbeddedResources::get(
+    const std::string& path) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto it = reg.entries.find(path);
+    if (it == reg.entries.end())
+        return nullptr;
+    Entry& entry = it->second;
+    if (!entry.decoded) {
+        const auto& res = entry.resource;
+        entry.decoded =
+            res.gzip ? gunzip(res)
+                     : std::make_shared<const std::string>(
+                           reinterpret_cast<const char*>(res.data), res.size);
+    }
+    return entry.decoded;
+}
+
+EmbeddedFileSource::EmbeddedFileSource(std::unique_ptr<FileSource> fallback_)
+    : fallback(std::move(fallback_)) {
+}
+
+EmbeddedFileSource::~EmbeddedFileSource() = default;
+
+std::unique_ptr<AsyncRequest> EmbeddedFileSource::request(
+    const Resource& resource, Callback callback) {
+    if (resource.url.rfind(kScheme, 0) != 0) {
+        if (fallback)
+            return fallback->request(resource, std::move(callback));
+        return nullptr;
+    }
+
+    Response response;
+    if (auto data = EmbeddedResources::get(embedded_path(resource.url))) {
+        response.data = std::move(data);
+    } else if (resource.kind == Resource::Kind::Tile) {
+        // Bundles usually carry only a few zoom levels; treat missing tiles
+        // as empty instead of failing the source.
+        response.noContent = true;
+    } else {
+        response.error = std::make_unique<Response::Error>(
+            Response::Error::Reason::NotFound,
+            "embedded resource not found: " + resource.url);
+    }
+
+    // FileSource callbacks must not fire synchronously from request().
+    return util::RunLoop::Get()->invokeCancellable(
+        [callback = std::move(callback), response = std::move(response)]() {
+            callback(response);
+        });
+}
+
+bool EmbeddedFileSource::canRequest(const Resource& resource) const {
+    if (resource.url.rfind(kScheme, 0) == 0)
+        return true;
+    return fallback && fallback->canRequest(resource);
+}
+
+void EmbeddedFileSource::setResourceOptions(ResourceOptions options) {
+    if (fallback)
+        fallback->setResourceOptions(options.clone());
+    resourceOptions = std::move(options);
+}
+
+ResourceOptions EmbeddedFileSource::getResourceOptions() {
+    return resourceOptions.clone();
+}
+
+void EmbeddedFileSource::setClientOptions(ClientOptions options) {
+    if (fallback)
+        fallback->setClientOptions(options.clone());
+    clientOptions = std::move(options);
+}
+
+ClientOptions EmbeddedFileSource::getClientOptions() {
+    return clientOptions.clone();
+}
+
+void install_embedded_file_source() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        auto* manager = FileSourceManager::get();
+        auto previous =
+            manager->unRegisterFileSourceFactory(FileSourceType::Asset);
+        manager->registerFileSourceFactory(
+            FileSourceType::Asset,
+            [previous](const ResourceOptions& resourceOptions,
+                       const ClientOptions& clientOptions)
+                -> std::unique_ptr<FileSource> {
+                auto source = std::make_unique<EmbeddedFileSource>(
+                    previous ? previous(resourceOptions, clientOptions)
+                             : nullptr);
+                source->setResourceOptions(resourceOptions.clone());
+                source->setClientOptions(clientOptions.clone());
+                return source;
+            });
+    });
+}
+
+}  // namespace mbgl
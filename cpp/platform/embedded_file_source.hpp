@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/resource_options.hpp>
+#include <mbgl/util/client_options.hpp>
+#include <memory>
+#include <string>
+
+namespace mbgl {
+
+// A resource compiled into the binary by mbgl_slint_embed_resources()
+// (cpp/cmake/EmbedResources.cmake). `path` is relative to the bundle root and
+// is served as embedded://<path>.
+struct EmbeddedResource {
+    const char* path;
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t uncompressed_size;
+    bool gzip;
+};
+
+// Process-wide registry of embedded resources. Generated bundles register
+// themselves during static initialization through EmbeddedResourceRegistrar.
+class EmbeddedResources {
+public:
+    static void add(const EmbeddedResource* resources, std::size_t count);
+    static bool contains(const std::string& path);
+
+    // Returns the (decompressed) bytes for `path`, or nullptr if it is not
+    // embedded. Decompression happens once; later lookups share the buffer.
+    static std::shared_ptr<const std::string> get(const std::string& path);
+};
+
+struct EmbeddedResourceRegistrar {
+    EmbeddedResourceRegistrar(const EmbeddedResource* resources,
+                              std::size_t count) {
+        EmbeddedResources::add(resources, count);
+    }
+};
+
+// Serves embedded:// URLs from EmbeddedResources without any filesystem or
+// network I/O. Everything else is forwarded to `fallback` (the file source
+// previously registered for the same slot), if any.
+class EmbeddedFileSource : public FileSource {
+public:
+    static constexpr const char* kScheme = "embedded://";
+
+    explicit EmbeddedFileSource(std::unique_ptr<FileSource> fallback = {});
+    ~EmbeddedFileSource() override;
+
+    std::unique_ptr<AsyncRequest> request(const Resource&, Callback) override;
+    bool canRequest(const Resource&) const override;
+
+    void setResourceOptions(ResourceOptions options) override;
+    ResourceOptions getResourceOptions() override;
+    void setClientOptions(ClientOptions options) override;
+    ClientOptions getClientOptions() override;
+
+private:
+    std::unique_ptr<FileSource> fallback;
+    ResourceOptions resourceOptions;
+    ClientOptions clientOptions;
+};
+
+// Registers EmbeddedFileSource in MapLibre's FileSourceManager in the asset
+// slot, wrapping the asset file source that was registered before, so maps
+// resolve embedded:// alongside asset://, file:// and http(s)://. Must run
+// before the first map is created; calling it again is a no-op.
+void install_embedded_file_source();
+
+}  // namespace mbgl
@@ -0,0 +1,151 @@
+#include "file_source_metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace mbgl {
+
+namespace {
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+void add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.fetch_add(value, kRelaxed);
+}
+
+}  // namespace
+
+double FileSourceMetrics::Histogram::mean_ms() const {
+    return count ? static_cast<double>(sum_us) / 1000.0 /
+                       static_cast<double>(count)
+                 : 0.0;
+}
+
+double FileSourceMetrics::Histogram::percentile_ms(double p) const {
+    if (count == 0)
+        return 0.0;
+    const auto rank = static_cast<uint64_t>(
+        std::clamp(p, 0.0, 1.0) * static_cast<double>(count - 1));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > rank)
+            return static_cast<double>(uint64_t{2} << i) / 1000.0;
+    }
+    return static_cast<double>(uint64_t{2} << (buckets.size() - 1)) / 1000.0;
+}
+
+double FileSourceMetrics::KindSnapshot::cache_hit_ratio() const {
+    return completed ? static_cast<double>(cache_hits) /
+                           static_cast<double>(completed)
+                     : 0.0;
+}
+
+FileSourceMetrics::KindSnapshot FileSourceMetrics::Snapshot::total() const {
+    KindSnapshot sum;
+    for (const auto& k : kinds) {
+        sum.requests += k.requests;
+        sum.completed += k.completed;
+        sum.errors += k.errors;
+        sum.cancelled += k.cancelled;
+        sum.bytes += k.bytes;
+        sum.cache_hits += k.cache_hits;
+        for (std::size_t p = 0; p < kPhaseCount; ++p) {
+            for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+                sum.latency[p].buckets[b] += k.latency[p].buckets[b];
+            }
+            sum.latency[p].count += k.latency[p].count;
+            sum.latency[p].sum_us += k.latency[p].sum_us;
+        }
+    }
+    return sum;
+}
+
+std::size_t FileSourceMetrics::bucket_for(std::chrono::microseconds latency) {
+    const auto us = static_cast<uint64_t>(std::max<int64_t>(
+        latency.count(), 0));
+    if (us < 2)
+        return 0;
+    const auto log2 = static_cast<std::size_t>(std::bit_width(us) - 1);
+    return std::min(log2, kLatencyBuckets - 1);
+}
+
+void FileSourceMetrics::record_request(Resource::Kind kind) {
+    add(kinds[index(kind)].requests, 1);
+}
+
+void FileSourceMetrics::record_latency(Resource::Kind kind, Phase phase,
+                                       std::chrono::microseconds latency) {
+    auto& h = kinds[index(kind)].latency[static_cast<std::size_t>(phase)];
+    add(h.buckets[bucket_for(latency)], 1);
+    add(h.count, 1);
+    add(h.sum_us, static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)));
+}
+
+void FileSourceMetrics::record_response(Resource::Kind kind, std::size_t bytes,
+                                        bool cache_hit) {
+    auto& k = kinds[index(kind)];
+    add(k.completed, 1);
+    add(k.bytes, bytes);
+    if (cache_hit)
+        add(k.cache_hits, 1);
+}
+
+void FileSourceMetrics::record_error(Resource::Kind kind,
+                                     Response::Error::Reason reason) {
+    add(kinds[index(kind)].errors, 1);
+    add(errors_by_reason[index(reason)], 1);
+}
+
+void FileSourceMetrics::record_cancelled(Resource::Kind kind) {
+    add(kinds[index(kind)].cancelled, 1);
+}
+
+FileSourceMetrics::Snapshot FileSourceMetrics::snapshot() const {
+    Snapshot snap;
+    for (std::size_t i = 0; i < kKindCount; ++i) {
+        const auto& src = kinds[i];
+        auto& dst = snap.kinds[i];
+        dst.requests = src.requests.load(kRelaxed);
+        dst.completed = src.completed.load(kRelaxed);
+        dst.errors = src.errors.load(kRelaxed);
+        dst.cancelled = src.cancelled.load(kRelaxed);
+        dst.bytes = src.bytes.load(kRelaxed);
+        dst.cache_hits = src.cache_hits.load(kRelaxed);
+        for (std::size_t p = 0; p < kPhaseCount; ++p) {
+            for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+                dst.latency[p].buckets[b] =
+                    src.latency[p].buckets[b].load(kRelaxed);
+            }
+            dst.latency[p].count = src.latency[p].count.load(kRelaxed);
+            dst.latency[p].sum_us = src.latency[p].sum_us.load(kRelaxed);
+        }
+    }
+    for (std::size_t r = 0; r < kReasonCount; ++r) {
+        snap.errors_by_reason[r] = errors_by_reason[r].load(kRelaxed);
+    }
+    return snap;
+}
+
+void FileSourceMetrics::reset() {
+    for (auto& k : kinds) {
+        k.requests.store(0, kRelaxed);
+        k.completed.store(0, kRelaxed);
+        k.errors.store(0, kRelaxed);
+        k.cancelled.store(0, kRelaxed);
+        k.bytes.store(0, kRelaxed);
+        k.cache_hits.store(0, kRelaxed);
+        for (auto& h : k.latency) {
+            for (auto& b : h.buckets) {
+                b.store(0, kRelaxed);
+            }
+            h.count.store(0, kRelaxed);
+            h.sum_us.store(0, kRelaxed);
+        }
+    }
+    for (auto& r : errors_by_reason) {
+        r.store(0, kRelaxed);
+    }
+}
+
+}  // namespace mbgl
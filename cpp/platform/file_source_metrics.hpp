@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+
+namespace mbgl {
+
+// Request counters and latency histograms for a file source, kept in relaxed
+// atomics so recording from request threads never takes a lock. Readers take
+// a snapshot(); counters of one snapshot are individually exact but may be a
+// few requests apart from each other while requests are in flight.
+class FileSourceMetrics {
+public:
+    // Resource::Kind runs from Unknown (0) to Image (7).
+    static constexpr std::size_t kKindCount = 8;
+    // Response::Error::Reason runs from Success (1) to Other (6).
+    static constexpr std::size_t kReasonCount = 7;
+    // Bucket 0 holds latencies below 2 us, bucket i holds [2^i, 2^(i+1)) us;
+    // the last bucket also takes everything above ~36 minutes.
+    static constexpr std::size_t kLatencyBuckets = 32;
+
+    enum class Phase : std::size_t {
+        QueueWait,  // request() until a worker starts on it
+        Connect,    // DNS + TCP (+ TLS) handshake
+        FirstByte,  // worker start until the first response byte
+        Total,      // request() until the response is ready
+    };
+    static constexpr std::size_t kPhaseCount = 4;
+
+    struct Histogram {
+        std::array<uint64_t, kLatencyBuckets> buckets{};
+        uint64_t count = 0;
+        uint64_t sum_us = 0;
+
+        double mean_ms() const;
+        // Upper bound of the bucket containing the p-quantile (0 <= p <= 1).
+        double percentile_ms(double p) const;
+    };
+
+    struct KindSnapshot {
+        uint64_t requests = 0;
+        uint64_t completed = 0;  // responses delivered, including errors
+        uint64_t errors = 0;
+        uint64_t cancelled = 0;
+        uint64_t bytes = 0;
+        // Revalidations that returned MapLibre's cached copy unchanged.
+        uint64_t cache_hits = 0;
+        std::array<Histogram, kPhaseCount> latency{};
+
+        const Histogram& histogram(Phase phase) const {
+            return latency[static_cast<std::size_t>(phase)];
+        }
+        // cache_hits / completed, 0 when nothing completed yet.
+        double cache_hit_ratio() const;
+    };
+
+    struct Snapshot {
+        std::array<KindSnapshot, kKindCount> kinds{};
+        std::array<uint64_t, kReasonCount> errors_by_reason{};
+
+        const KindSnapshot& kind(Resource::Kind k) const {
+            return kinds[index(k)];
+        }
+        uint64_t errors(Response::Error::Reason reason) const {
+            return errors_by_reason[index(reason)];
+        }
+        // Sum over all kinds.
+        KindSnapshot total() const;
+    };
+
+    void record_request(Resource::Kind kind);
+    void record_latency(Resource::Kind kind, Phase phase,
+                        std::chrono::microseconds latency);
+    // A response handed to MapLibre; `bytes` is the body size.
+    void record_response(Resource::Kind kind, std::size_t bytes,
+                         bool cache_hit);
+    void record_error(Resource::Kind kind, Response::Error::Reason reason);
+    void record_cancelled(Resource::Kind kind);
+
+    Snapshot snapshot() const;
+    void reset();
+
+    static std::size_t bucket_for(std::chrono::microseconds latency);
+
+private:
+    struct AtomicHistogram {
+        std::array<std::atomic<uint64_t>, kLatencyBuckets> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_us{0};
+    };
+
+    struct KindCounters {
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> cancelled{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> cache_hits{0};
+        std::array<AtomicHistogram, kPhaseCount> latency{};
+    };
+
+    static std::size_t index(Resource::Kind kind) {
+        const auto i = static_cast<std::size_t>(kind);
+        return i < kKindCount ? i : 0;
+    }
+    static std::size_t index(Response::Error::Reason reason) {
+        const auto i = static_cast<std::size_t>(reason);
+        return i < kReasonCount ? i : kReasonCount - 1;
+    }
+
+    std::array<KindCounters, kKindCount> kinds{};
+    std::array<std::atomic<uint64_t>, kReasonCount> errors_by_reason{};
+};
+
+}  // namespace mbgl
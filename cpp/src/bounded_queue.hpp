@@ -0,0 +1,84 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Multi-producer/multi-consumer FIFO with a fixed capacity. push() blocks
+// while the queue is full, which is how pipeline stages apply backpressure to
+// the stage in front of them. close() wakes everyone: pending items can still
+// be popped, further pushes fail, and pop() returns nullopt once drained.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity)
+        : capacity_(capacity == 0 ? 1 : capacity) {
+    }
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock,
+                      [&] { return closed || items.size() < capacity_; });
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Non-blocking variant: fails instead of waiting when full.
+    bool try_push(T item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed || items.size() >= capacity_)
+            return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [&] { return closed || !items.empty(); });
+        return take(lock);
+    }
+
+    std::optional<T> try_pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return take(lock);
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    std::optional<T> take(std::unique_lock<std::mutex>&) {
+        if (items.empty())
+            return std::nullopt;
+        T item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return item;
+    }
+
+    const std::size_t capacity_;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<T> items;
+    bool closed = false;
+};
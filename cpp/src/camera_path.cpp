@@ -0,0 +1,87 @@
+#include "camera_path.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+double smoothstep(double t) {
+    return t * t * (3.0 - 2.0 * t);
+}
+
+double lerp(double a, double b, double k) {
+    return a + (b - a) * k;
+}
+
+// Interpolates angles in degrees along the shorter arc.
+double lerp_bearing(double a, double b, double k) {
+    double delta = std::fmod(b - a, 360.0);
+    if (delta > 180.0)
+        delta -= 360.0;
+    else if (delta < -180.0)
+        delta += 360.0;
+    return a + delta * k;
+}
+
+mbgl::CameraOptions camera_at(const CameraKeyframe& k) {
+    return mbgl::CameraOptions()
+        .withCenter(k.center)
+        .withZoom(k.zoom)
+        .withBearing(k.bearing)
+        .withPitch(k.pitch);
+}
+
+}  // namespace
+
+CameraPath::CameraPath(std::vector<CameraKeyframe> keyframes_)
+    : keyframes(std::move(keyframes_)) {
+}
+
+std::optional<CameraPath> CameraPath::parse(std::istream& in) {
+    std::vector<CameraKeyframe> keyframes;
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        std::istringstream fields(line);
+        CameraKeyframe k;
+        double lat = 0.0, lon = 0.0;
+        if (!(fields >> k.time_s >> lat >> lon >> k.zoom))
+            return std::nullopt;
+        // Optional trailing bearing and pitch.
+        if (fields >> k.bearing)
+            fields >> k.pitch;
+        k.center = mbgl::LatLng{lat, lon};
+        if (!keyframes.empty() && k.time_s <= keyframes.back().time_s)
+            return std::nullopt;
+        keyframes.push_back(k);
+    }
+    if (keyframes.empty())
+        return std::nullopt;
+    return CameraPath(std::move(keyframes));
+}
+
+mbgl::CameraOptions CameraPath::sample(double time_s) const {
+    if (keyframes.empty())
+        return {};
+    if (time_s <= keyframes.front().time_s)
+        return camera_at(keyframes.front());
+    if (time_s >= keyframes.back().time_s)
+        return camera_at(keyframes.back());
+
+    const auto next = std::upper_bound(
+        keyframes.begin(), keyframes.end(), time_s,
+        [](double t, const CameraKeyframe& k) { return t < k.time_s; });
+    const CameraKeyframe& b = *next;
+    const CameraKeyframe& a = *(next - 1);
+    const double k = smoothstep((time_s - a.time_s) / (b.time_s - a.time_s));
+    return mbgl::CameraOptions()
+        .withCenter(mbgl::LatLng{
+            lerp(a.center.latitude(), b.center.latitude(), k),
+            lerp(a.center.longitude(), b.center.longitude(), k)})
+        .withZoom(lerp(a.zoom, b.zoom, k))
+        .withBearing(lerp_bearing(a.bearing, b.bearing, k))
+        .withPitch(lerp(a.pitch, b.pitch, k));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <istream>
+#include <mbgl/map/camera.hpp>
+#include <mbgl/util/geo.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A camera flight through keyframes, sampled by time. Between two keyframes
+// centre and zoom follow a smoothstep ease; bearing takes the shorter way
+// round. Used to script video exports and benchmark flights.
+struct CameraKeyframe {
+    double time_s = 0.0;
+    mbgl::LatLng center{};
+    double zoom = 0.0;
+    double bearing = 0.0;
+    double pitch = 0.0;
+};
+
+class CameraPath {
+public:
+    CameraPath() = default;
+    explicit CameraPath(std::vector<CameraKeyframe> keyframes);
+
+    // One keyframe per line: "time_s lat lon zoom [bearing [pitch]]".
+    // Blank lines and lines starting with '#' are skipped. nullopt if a line
+    // does not parse or times are not increasing.
+    static std::optional<CameraPath> parse(std::istream& in);
+
+    bool empty() const {
+        return keyframes.empty();
+    }
+    double duration_s() const {
+        return keyframes.empty() ? 0.0 : keyframes.back().time_s;
+    }
+    const std::vector<CameraKeyframe>& get_keyframes() const {
+        return keyframes;
+    }
+
+    // Clamped to the first/last keyframe outside the path's time range.
+    mbgl::CameraOptions sample(double time_s) const;
+
+private:
+    std::vector<CameraKeyframe> keyframes;
+};
@@ -0,0 +1,129 @@
+#include "egl_headless_context.hpp"
+
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+bool has_extension(const char* list, const char* name) {
+    if (!list)
+        return false;
+    const std::size_t len = std::strlen(name);
+    for (const char* p = list; (p = std::strstr(p, name)); p += len) {
+        if ((p == list || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+std::string egl_error(const char* what) {
+    char code[16];
+    std::snprintf(code, sizeof(code), "0x%04x", eglGetError());
+    return std::string(what) + " failed (" + code + ")";
+}
+
+}  // namespace
+
+EGLHeadlessContext::EGLHeadlessContext() {
+    // Surfaceless first: no window system, works under llvmpipe in CI.
+    const char* client = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (has_extension(client, "EGL_MESA_platform_surfaceless")) {
+        auto get_platform_display =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display &&
+            init_display(get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                              EGL_DEFAULT_DISPLAY, nullptr)))
+            return;
+    }
+    init_display(eglGetDisplay(EGL_DEFAULT_DISPLAY));
+}
+
+bool EGLHeadlessContext::init_display(EGLDisplay candidate) {
+    if (candidate == EGL_NO_DISPLAY) {
+        error_ = "no EGL display";
+        return false;
+    }
+    EGLint major = 0, minor = 0;
+    if (!eglInitialize(candidate, &major, &minor)) {
+        error_ = egl_error("eglInitialize");
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+        error_ = egl_error("eglBindAPI");
+        eglTerminate(candidate);
+        return false;
+    }
+
+    const EGLint config_attribs[] = {EGL_RENDERABLE_TYPE,
+                                     EGL_OPENGL_ES3_BIT,
+                                     EGL_SURFACE_TYPE,
+                                     EGL_PBUFFER_BIT,
+                                     EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configs = 0;
+    eglChooseConfig(candidate, config_attribs, &config, 1, &configs);
+
+    const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_NONE};
+    // Surfaceless contexts may have no pbuffer config; that is fine with
+    // EGL_KHR_no_config_context.
+    EGLContext created = eglCreateContext(
+        candidate, configs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+        context_attribs);
+    if (created == EGL_NO_CONTEXT) {
+        error_ = egl_error("eglCreateContext");
+        eglTerminate(candidate);
+        return false;
+    }
+
+    EGLSurface pbuffer = EGL_NO_SURFACE;
+    const char* extensions = eglQueryString(candidate, EGL_EXTENSIONS);
+    if (!has_extension(extensions, "EGL_KHR_surfaceless_context") &&
+        configs > 0) {
+        const EGLint pbuffer_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1,
+                                          EGL_NONE};
+        pbuffer = eglCreatePbufferSurface(candidate, config, pbuffer_attribs);
+    }
+
+    display = candidate;
+    surface = pbuffer;
+    context = created;
+    if (!make_current()) {
+        error_ = egl_error("eglMakeCurrent");
+        eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+        surface = EGL_NO_SURFACE;
+        context = EGL_NO_CONTEXT;
+        return false;
+    }
+    error_.clear();
+    return true;
+}
+
+EGLHeadlessContext::~EGLHeadlessContext() {
+    if (display == EGL_NO_DISPLAY)
+        return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT)
+        eglDestroyContext(display, context);
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+    eglTerminate(display);
+}
+
+bool EGLHeadlessContext::make_current() {
+    return eglMakeCurrent(display, surface, surface, context) == EGL_TRUE;
+}
+
+std::string EGLHeadlessContext::renderer() const {
+    if (!ok())
+        return {};
+    const auto* name =
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    return name ? name : "";
+}
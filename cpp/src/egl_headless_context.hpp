@@ -0,0 +1,49 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <string>
+
+// A GLES 3 context without a window, for driving SlintMapGL outside Slint:
+// tests and benchmarks on GPU-less CI (Mesa llvmpipe), or offscreen tools.
+// Uses a surfaceless display (EGL_MESA_platform_surfaceless) when available
+// and falls back to the default display with a 1x1 pbuffer. SlintMapGL
+// renders into its own FBOs, so the surface never matters.
+//
+//   EGLHeadlessContext gl;
+//   if (!gl.ok()) return;         // no EGL/GLES 3 on this machine
+//   SlintMapGL map;
+//   map.setup(512, 512, "");      // context is current
+//   map.setStyleJSON(style);
+//   map.render(true);
+//
+// Set EGL_PLATFORM=surfaceless and LIBGL_ALWAYS_SOFTWARE=1 to force
+// llvmpipe on machines with a GPU.
+class EGLHeadlessContext {
+public:
+    // Creates the context and makes it current on the calling thread.
+    EGLHeadlessContext();
+    ~EGLHeadlessContext();
+
+    EGLHeadlessContext(const EGLHeadlessContext&) = delete;
+    EGLHeadlessContext& operator=(const EGLHeadlessContext&) = delete;
+
+    bool ok() const {
+        return context != EGL_NO_CONTEXT;
+    }
+    // Why ok() is false.
+    const std::string& error() const {
+        return error_;
+    }
+    // GL_RENDERER, e.g. "llvmpipe (LLVM 15.0.6, 256 bits)".
+    std::string renderer() const;
+
+    bool make_current();
+
+private:
+    bool init_display(EGLDisplay candidate);
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLSurface surface = EGL_NO_SURFACE;
+    EGLContext context = EGL_NO_CONTEXT;
+    std::string error_;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <slint.h>
+#include <utility>
+#include <vector>
+
+#include "feature_pick.hpp"
+
+// PickResult features as a model of the application's MMapFeature, e.g.
+// adapter.set_picked_features(feature_model<MMapFeature>(result.features)).
+template <typename Feature>
+std::shared_ptr<slint::Model<Feature>> feature_model(
+    const std::vector<PickedFeature>& features) {
+    auto model = std::make_shared<slint::VecModel<Feature>>();
+    for (const auto& picked : features) {
+        Feature feature;
+        feature.source_id = slint::SharedString(picked.source_id);
+        feature.source_layer = slint::SharedString(picked.source_layer);
+        feature.feature_id = slint::SharedString(picked.id);
+        feature.geometry_type = slint::SharedString(picked.geometry_type);
+        feature.name = slint::SharedString(picked.name);
+        feature.properties = slint::SharedString(picked.properties);
+        model->push_back(std::move(feature));
+    }
+    return model;
+}
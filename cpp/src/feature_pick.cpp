@@ -0,0 +1,114 @@
+#include "feature_pick.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mbgl/renderer/query.hpp>
+#include <mbgl/renderer/renderer.hpp>
+#include <utility>
+
+#include "json_conversion.hpp"
+#include "json_value.hpp"
+
+PickCache::PickCache(std::size_t capacity_)
+    : capacity(capacity_ == 0 ? 1 : capacity_) {
+    entries.reserve(capacity);
+}
+
+void PickCache::begin_frame(uint64_t frame) {
+    current_frame = frame;
+    clear();
+}
+
+void PickCache::clear() {
+    entries.clear();
+    next_slot = 0;
+}
+
+const std::vector<PickedFeature>* PickCache::find(float x, float y) {
+    const int px = static_cast<int>(std::lround(x));
+    const int py = static_cast<int>(std::lround(y));
+    for (const auto& entry : entries) {
+        if (entry.x == px && entry.y == py) {
+            totals.hits++;
+            return &entry.features;
+        }
+    }
+    totals.misses++;
+    return nullptr;
+}
+
+void PickCache::insert(float x, float y, std::vector<PickedFeature> features) {
+    Entry entry{static_cast<int>(std::lround(x)),
+                static_cast<int>(std::lround(y)), std::move(features)};
+    if (entries.size() < capacity) {
+        entries.push_back(std::move(entry));
+        return;
+    }
+    // Full: replace the oldest.
+    entries[next_slot] = std::move(entry);
+    next_slot = (next_slot + 1) % capacity;
+}
+
+namespace {
+
+const char* geometry_type_name(const mbgl::Feature::geometry_type& g) {
+    using namespace mapbox::geometry;
+    return g.match([](const empty&) { return ""; },
+                   [](const point<double>&) { return "Point"; },
+                   [](const line_string<double>&) { return "LineString"; },
+                   [](const polygon<double>&) { return "Polygon"; },
+                   [](const multi_point<double>&) { return "MultiPoint"; },
+                   [](const multi_line_string<double>&) {
+                       return "MultiLineString";
+                   },
+                   [](const multi_polygon<double>&) { return "MultiPolygon"; },
+                   [](const geometry_collection<double>&) {
+                       return "GeometryCollection";
+                   });
+}
+
+std::string feature_id_text(const mbgl::FeatureIdentifier& id) {
+    return id.match([](const mbgl::NullValue&) { return std::string(); },
+                    [](uint64_t n) { return std::to_string(n); },
+                    [](int64_t n) { return std::to_string(n); },
+                    [](double n) { return JsonValue(n).dump(); },
+                    [](const std::string& s) { return s; });
+}
+
+}  // namespace
+
+PickedFeature to_picked_feature(const mbgl::Feature& feature) {
+    PickedFeature picked;
+    picked.source_id = feature.source;
+    picked.source_layer = feature.sourceLayer;
+    picked.id = feature_id_text(feature.id);
+    picked.geometry_type = geometry_type_name(feature.geometry);
+    JsonValue::Object properties;
+    properties.reserve(feature.properties.size());
+    for (const auto& [name, value] : feature.properties) {
+        if (name == "name" && value.is<std::string>())
+            picked.name = value.get<std::string>();
+        properties.emplace_back(name, to_json_value(value));
+    }
+    // Stable output; the property map is unordered.
+    std::sort(properties.begin(), properties.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    picked.properties = JsonValue(std::move(properties)).dump();
+    return picked;
+}
+
+std::vector<PickedFeature> query_picked_features(
+    mbgl::Renderer& renderer, float x, float y, float radius,
+    const std::vector<std::string>& layer_ids) {
+    mbgl::RenderedQueryOptions options;
+    if (!layer_ids.empty())
+        options.layerIDs = layer_ids;
+    const double r = radius;
+    const mbgl::ScreenBox box{{x - r, y - r}, {x + r, y + r}};
+    const auto features = renderer.queryRenderedFeatures(box, options);
+    std::vector<PickedFeature> picked;
+    picked.reserve(features.size());
+    for (const auto& feature : features)
+        picked.push_back(to_picked_feature(feature));
+    return picked;
+}
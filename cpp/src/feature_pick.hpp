@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mbgl/util/feature.hpp>
+#include <string>
+#include <vector>
+
+namespace mbgl {
+class Renderer;
+}  // namespace mbgl
+
+// One rendered feature under a click or hover, flattened to what a UI list
+// shows.
+struct PickedFeature {
+    std::string source_id;
+    std::string source_layer;
+    std::string id;             // feature ID as text; empty if it has none
+    std::string geometry_type;  // "Point", "LineString", "Polygon", ...
+    std::string name;           // the "name" property, if a string
+    std::string properties;     // all properties as a JSON object
+};
+
+// A queried feature as a PickedFeature, properties sorted by name.
+PickedFeature to_picked_feature(const mbgl::Feature& feature);
+
+// The rendered features within `radius` pixels of (x, y), from the style
+// layers `layer_ids` (all when empty). Shared by SlintMapLibre and
+// SlintMapGL; throws what queryRenderedFeatures() throws.
+std::vector<PickedFeature> query_picked_features(
+    mbgl::Renderer& renderer, float x, float y, float radius,
+    const std::vector<std::string>& layer_ids);
+
+struct PickResult {
+    uint64_t id = 0;  // as returned by request_pick()
+    bool hover = false;
+    float x = 0.0f;  // logical pixels
+    float y = 0.0f;
+    double lat = 0.0;
+    double lon = 0.0;
+    std::vector<PickedFeature> features;
+    uint64_t frame = 0;     // the rendered frame the features are from
+    bool cached = false;    // answered from PickCache, without a query
+    double query_ms = 0.0;  // queryRenderedFeatures(), 0 when cached
+};
+
+// queryRenderedFeatures() results for the current frame by pixel, so that
+// a pointer hovering over the same spot costs one query per frame instead
+// of one per pointer event. Everything is dropped when a new frame is
+// rendered (begin_frame()), since the features under a pixel may have
+// moved.
+class PickCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    explicit PickCache(std::size_t capacity = 32);
+
+    void begin_frame(uint64_t frame);
+    uint64_t frame() const {
+        return current_frame;
+    }
+    // Drops the entries but keeps the frame, e.g. when the query changes.
+    void clear();
+
+    // Positions are rounded to whole pixels.
+    const std::vector<PickedFeature>* find(float x, float y);
+    void insert(float x, float y, std::vector<PickedFeature> features);
+
+    std::size_t size() const {
+        return entries.size();
+    }
+    const Stats& stats() const {
+        return totals;
+    }
+
+private:
+    struct Entry {
+        int x;
+        int y;
+        std::vector<PickedFeature> features;
+    };
+
+    std::size_t capacity;
+    std::vector<Entry> entries;
+    std::size_t next_slot = 0;  // oldest entry once full
+    uint64_t current_frame = 0;
+    Stats totals;
+};
@@ -0,0 +1,95 @@
+#include "fly_to_animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double ease_in_out(double t) {
+    // Smoothstep-like cubic easing
+    return t < 0.5 ? 4 * t * t * t : 1 - std::pow(-2 * t + 2, 3) / 2;
+}
+
+double lerp(double a, double b, double k) {
+    return a + (b - a) * k;
+}
+
+double deg2rad(double d) {
+    return d * M_PI / 180.0;
+}
+
+// Rough angular distance in degrees (equirectangular approximation).
+double approx_distance_deg(const mbgl::LatLng& a, const mbgl::LatLng& b) {
+    const double lat1 = deg2rad(a.latitude());
+    const double lat2 = deg2rad(b.latitude());
+    const double dlon = deg2rad(b.longitude() - a.longitude());
+    const double x = dlon * std::cos((lat1 + lat2) * 0.5);
+    const double y = lat2 - lat1;
+    return std::sqrt(x * x + y * y) * 180.0 / M_PI;
+}
+
+}  // namespace
+
+FlyToAnimation FlyToAnimation::plan(const mbgl::LatLng& from,
+                                    double from_zoom,
+                                    const mbgl::LatLng& to,
+                                    double to_zoom,
+                                    double min_zoom,
+                                    double max_zoom) {
+    FlyToAnimation anim;
+    anim.start_center = from;
+    anim.target_center = to;
+    anim.start_zoom = from_zoom;
+    anim.target_zoom = to_zoom;
+    // Bold pull-back: a high base plus a distance term, and at least two
+    // levels even for short hops.
+    const double dist = approx_distance_deg(from, to);
+    const double zoom_out_delta =
+        std::max(2.0, 8.0 + std::min(3.0, dist / 8.0));
+    anim.mid_zoom =
+        std::max(min_zoom, std::min(max_zoom, from_zoom - zoom_out_delta));
+    return anim;
+}
+
+double FlyToAnimation::progress(
+    std::chrono::steady_clock::duration elapsed) const {
+    if (duration.count() <= 0)
+        return 1.0;
+    const double ms =
+        std::chrono::duration<double, std::milli>(elapsed).count();
+    return std::clamp(ms / static_cast<double>(duration.count()), 0.0, 1.0);
+}
+
+mbgl::CameraOptions FlyToAnimation::sample(double t) const {
+    t = std::clamp(t, 0.0, 1.0);
+
+    // Delay centre movement at the beginning to accentuate the zoom-out.
+    double k_center;
+    if (t <= center_hold_ratio) {
+        const double t_hold =
+            center_hold_ratio > 0.0 ? t / center_hold_ratio : 1.0;
+        k_center = 0.10 * ease_in_out(t_hold);  // only 10% move during hold
+    } else {
+        const double t_rest =
+            (t - center_hold_ratio) / std::max(1e-6, 1.0 - center_hold_ratio);
+        k_center = 0.10 + 0.90 * ease_in_out(t_rest);
+    }
+    const mbgl::LatLng center{
+        lerp(start_center.latitude(), target_center.latitude(), k_center),
+        lerp(start_center.longitude(), target_center.longitude(), k_center)};
+
+    // Two-phase zoom: out then in.
+    double zoom;
+    if (t <= mid_ratio) {
+        const double t0 = mid_ratio > 0.0 ? t / mid_ratio : 1.0;
+        zoom = lerp(start_zoom, mid_zoom, ease_in_out(t0));
+    } else {
+        const double t1 = (t - mid_ratio) / std::max(1e-6, 1.0 - mid_ratio);
+        zoom = lerp(mid_zoom, target_zoom, ease_in_out(t1));
+    }
+
+    mbgl::CameraOptions camera;
+    camera.center = center;
+    camera.zoom = zoom;
+    return camera;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <mbgl/map/camera.hpp>
+#include <mbgl/util/geo.hpp>
+
+// The fly_to camera path: zoom out to a mid level while the centre starts
+// moving slowly, then zoom back in on the target. Pure function of time, so
+// it can be driven by any MapClock and unit-tested without a map.
+struct FlyToAnimation {
+    mbgl::LatLng start_center{};
+    mbgl::LatLng target_center{};
+    double start_zoom = 0.0;
+    double target_zoom = 0.0;
+    double mid_zoom = 0.0;
+    double mid_ratio = 0.60;  // fraction of duration for the zoom-out phase
+    double center_hold_ratio = 0.20;  // centre barely moves during this part
+    std::chrono::milliseconds duration{2500};
+
+    // Plans a flight whose pull-back grows with the distance travelled.
+    static FlyToAnimation plan(const mbgl::LatLng& from,
+                               double from_zoom,
+                               const mbgl::LatLng& to,
+                               double to_zoom,
+                               double min_zoom,
+                               double max_zoom);
+
+    // Normalised progress in [0, 1] after `elapsed`.
+    double progress(std::chrono::steady_clock::duration elapsed) const;
+
+    // Camera (centre and zoom) at normalised time t in [0, 1].
+    mbgl::CameraOptions sample(double t) const;
+};
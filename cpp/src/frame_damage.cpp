@@ -0,0 +1,276 @@
+#include "frame_damage.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+bool spans_equal(const uint8_t* a, const uint8_t* b, std::size_t bytes) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // Four vectors per test, so the branch is taken once per 64 bytes.
+    for (; i + 64 <= bytes; i += 64) {
+        auto x = [&](std::size_t o) {
+            return _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + o)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + o)));
+        };
+        const __m128i diff =
+            _mm_or_si128(_mm_or_si128(x(0), x(16)), _mm_or_si128(x(32), x(48)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) !=
+            0xffff)
+            return false;
+    }
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i diff = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) !=
+            0xffff)
+            return false;
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= bytes; i += 16) {
+        const uint64x2_t diff = vreinterpretq_u64_u8(
+            veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+        if ((vgetq_lane_u64(diff, 0) | vgetq_lane_u64(diff, 1)) != 0)
+            return false;
+    }
+#endif
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y)
+            return false;
+    }
+    return std::memcmp(a + i, b + i, bytes - i) == 0;
+}
+
+std::vector<DamageRect> diff_frames(const uint8_t* prev, const uint8_t* next,
+                                    int width, int height, int tile) {
+    if (!prev || !next || width <= 0 || height <= 0 || tile <= 0)
+        return {};
+    const int columns = (width + tile - 1) / tile;
+    const int rows = (height + tile - 1) / tile;
+    const std::size_t row_bytes = static_cast<std::size_t>(width) * 4;
+    std::vector<uint8_t> dirty(static_cast<std::size_t>(columns) * rows, 0);
+    bool any = false;
+
+    for (int y = 0; y < height; ++y) {
+        const std::size_t offset = y * row_bytes;
+        // Whole rows first: most rows of a mostly unchanged frame are equal.
+        if (spans_equal(prev + offset, next + offset, row_bytes))
+            continue;
+        uint8_t* band = dirty.data() + static_cast<std::size_t>(y / tile) *
+                                           columns;
+        for (int c = 0; c < columns; ++c) {
+            if (band[c])
+                continue;
+            const int x = c * tile;
+            const std::size_t bytes =
+                static_cast<std::size_t>(std::min(tile, width - x)) * 4;
+            if (!spans_equal(prev + offset + x * 4, next + offset + x * 4,
+                             bytes)) {
+                band[c] = 1;
+                any = true;
+            }
+        }
+    }
+    if (!any)
+        return {};
+    return merge_damage_tiles(dirty, columns, rows, tile, width, height);
+}
+
+std::vector<DamageRect> merge_damage_tiles(const std::vector<uint8_t>& dirty,
+                                           int columns, int rows, int tile,
+                                           int width, int height) {
+    std::vector<DamageRect> rects;  // in tiles until clipped below
+    std::vector<std::size_t> open, still_open;
+    for (int r = 0; r < rows; ++r) {
+        still_open.clear();
+        for (int c = 0; c < columns;) {
+            if (!dirty[static_cast<std::size_t>(r) * columns + c]) {
+                ++c;
+                continue;
+            }
+            const int start = c;
+            while (c < columns &&
+                   dirty[static_cast<std::size_t>(r) * columns + c])
+                ++c;
+            // Extend the run above when it spans the same columns.
+            auto above = std::find_if(open.begin(), open.end(),
+                                      [&](std::size_t i) {
+                                          return rects[i].x == start &&
+                                                 rects[i].width == c - start;
+                                      });
+            if (above != open.end()) {
+                rects[*above].height++;
+                still_open.push_back(*above);
+            } else {
+                rects.push_back({start, r, c - start, 1});
+                still_open.push_back(rects.size() - 1);
+            }
+        }
+        open.swap(still_open);
+    }
+
+    for (auto& rect : rects) {
+        rect.x *= tile;
+        rect.y *= tile;
+        rect.width = std::min(rect.width * tile, width - rect.x);
+        rect.height = std::min(rect.height * tile, height - rect.y);
+    }
+    if (rects.size() > kMaxDamageRects) {
+        DamageRect box = rects.front();
+        int right = box.x + box.width, bottom = box.y + box.height;
+        for (const auto& rect : rects) {
+            box.x = std::min(box.x, rect.x);
+            box.y = std::min(box.y, rect.y);
+            right = std::max(right, rect.x + rect.width);
+            bottom = std::max(bottom, rect.y + rect.height);
+        }
+        box.width = right - box.x;
+        box.height = bottom - box.y;
+        rects.assign(1, box);
+    }
+    return rects;
+}
+
+long long damage_area(const std::vector<DamageRect>& rects) {
+    long long total = 0;
+    for (const auto& rect : rects)
+        total += rect.area();
+    return total;
+}
+
+void unpremultiply_rect(const uint8_t* src, uint8_t* dst, int width,
+                        const DamageRect& rect) {
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        const std::size_t offset =
+            (static_cast<std::size_t>(y) * width + rect.x) * 4;
+        const uint8_t* s = src + offset;
+        uint8_t* d = dst + offset;
+        for (int x = 0; x < rect.width; ++x, s += 4, d += 4) {
+            // Same rounding as mbgl::util::unpremultiply().
+            const uint32_t a = s[3];
+            if (a == 255 || a == 0) {
+                std::memcpy(d, s, 4);
+                continue;
+            }
+            auto un = [a](uint32_t c) {
+                return static_cast<uint8_t>(
+                    std::min<uint32_t>(255, (c * 255 + a / 2) / a));
+            };
+            d[0] = un(s[0]);
+            d[1] = un(s[1]);
+            d[2] = un(s[2]);
+            d[3] = static_cast<uint8_t>(a);
+        }
+    }
+}
+
+bool rect_is_opaque(const uint8_t* rgba, int width, const DamageRect& rect) {
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        const uint8_t* p =
+            rgba + (static_cast<std::size_t>(y) * width + rect.x) * 4;
+        int x = 0;
+        // AND the pixels together: opaque iff every alpha byte stays 0xff.
+#if defined(__SSE2__)
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+        __m128i all = alpha;
+        for (; x + 4 <= rect.width; x += 4, p += 16)
+            all = _mm_and_si128(
+                all, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(all, alpha),
+                                             alpha)) != 0xffff)
+            return false;
+#elif defined(__ARM_NEON)
+        const uint32x4_t alpha = vdupq_n_u32(0xff000000u);
+        uint32x4_t all = alpha;
+        for (; x + 4 <= rect.width; x += 4, p += 16)
+            all = vandq_u32(all, vreinterpretq_u32_u8(vld1q_u8(p)));
+        const uint32x4_t masked = vandq_u32(all, alpha);
+        if ((vgetq_lane_u32(masked, 0) & vgetq_lane_u32(masked, 1) &
+             vgetq_lane_u32(masked, 2) & vgetq_lane_u32(masked, 3)) !=
+            0xff000000u)
+            return false;
+#endif
+        uint8_t a = 0xff;
+        for (; x < rect.width; ++x, p += 4)
+            a &= p[3];
+        if (a != 0xff)
+            return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Packs the leading pixels of a row with SIMD; returns how many it did.
+#if defined(__SSSE3__) || (defined(__SSE2__) && defined(__GNUC__))
+#if !defined(__SSSE3__)
+// Baseline x86-64 builds: compiled for SSSE3 and picked at run time.
+__attribute__((target("ssse3")))
+#endif
+int pack_rgb_ssse3(const uint8_t* s, uint8_t* d, int count) {
+    // 4 pixels -> 12 bytes per shuffle. Each store spills 4 bytes into the
+    // next pixels, so stop while 2 more are left to overwrite them.
+    const __m128i drop_alpha = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12,
+                                             13, 14, -1, -1, -1, -1);
+    int x = 0;
+    for (; x + 6 <= count; x += 4, s += 16, d += 12)
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(d),
+            _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)),
+                drop_alpha));
+    return x;
+}
+#define MBGL_SLINT_PACK_SSSE3
+#endif
+
+int pack_rgb_simd(const uint8_t* s, uint8_t* d, int count) {
+#if defined(__SSSE3__)
+    return pack_rgb_ssse3(s, d, count);
+#elif defined(MBGL_SLINT_PACK_SSSE3)
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+    return has_ssse3 ? pack_rgb_ssse3(s, d, count) : 0;
+#elif defined(__ARM_NEON)
+    int x = 0;
+    for (; x + 16 <= count; x += 16, s += 64, d += 48) {
+        const uint8x16x4_t px = vld4q_u8(s);
+        vst3q_u8(d, uint8x16x3_t{{px.val[0], px.val[1], px.val[2]}});
+    }
+    return x;
+#else
+    (void)s;
+    (void)d;
+    (void)count;
+    return 0;
+#endif
+}
+
+}  // namespace
+
+void pack_rgb_rect(const uint8_t* rgba, uint8_t* rgb, int width,
+                   const DamageRect& rect) {
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        const std::size_t first = static_cast<std::size_t>(y) * width + rect.x;
+        const uint8_t* s = rgba + first * 4;
+        uint8_t* d = rgb + first * 3;
+        const int x = pack_rgb_simd(s, d, rect.width);
+        s += x * 4;
+        d += x * 3;
+        for (int i = x; i < rect.width; ++i, s += 4, d += 3) {
+            d[0] = s[0];
+            d[1] = s[1];
+            d[2] = s[2];
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A changed area of a frame, in pixels from the top-left.
+struct DamageRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    long long area() const {
+        return static_cast<long long>(width) * height;
+    }
+    bool operator==(const DamageRect&) const = default;
+};
+
+// Where two consecutive RGBA8 frames differ, at tile granularity. Used by
+// SlintMapLibre::render_map() to touch only the changed parts of the frame
+// it hands to Slint: a label fading in or one tile arriving is a few tiles,
+// not a full-frame unpremultiply and copy.
+//
+// Tiles are compared 16 bytes at a time (SSE2 / NEON, 8-byte words
+// elsewhere) with an early out on the first difference, so an unchanged
+// frame costs one pass over both frames at memory bandwidth.
+
+constexpr int kDamageTileSize = 32;
+// More rects than this collapse into their bounding box: past that, the
+// per-rect overhead outweighs the pixels saved.
+constexpr std::size_t kMaxDamageRects = 16;
+
+// True when `bytes` bytes at `a` and `b` are equal.
+bool spans_equal(const uint8_t* a, const uint8_t* b, std::size_t bytes);
+
+// Changed rects between two tightly packed width x height RGBA8 frames,
+// tile-aligned and clipped to the frame. Empty when the frames are equal.
+std::vector<DamageRect> diff_frames(const uint8_t* prev, const uint8_t* next,
+                                    int width, int height,
+                                    int tile = kDamageTileSize);
+
+// Merges a tile grid (row-major, `columns` x `rows`, non-zero = dirty) into
+// rects: horizontal runs per row, stacked with identical runs below.
+std::vector<DamageRect> merge_damage_tiles(const std::vector<uint8_t>& dirty,
+                                           int columns, int rows, int tile,
+                                           int width, int height);
+
+// Sum of the rects' areas (overlaps counted twice).
+long long damage_area(const std::vector<DamageRect>& rects);
+
+// Copies `rect` of a premultiplied RGBA8 frame into an unpremultiplied one;
+// both are `width` pixels wide and tightly packed.
+void unpremultiply_rect(const uint8_t* src, uint8_t* dst, int width,
+                        const DamageRect& rect);
+
+// True when every pixel of `rect` of a tightly packed, `width` pixels wide
+// RGBA8 frame has alpha 255.
+bool rect_is_opaque(const uint8_t* rgba, int width, const DamageRect& rect);
+
+// Copies `rect` of an RGBA8 frame into an RGB8 one, dropping alpha. For
+// opaque premultiplied frames this is also the unpremultiply. Uses an SSSE3
+// byte shuffle (chosen at run time on baseline x86-64 builds) or NEON
+// de-interleaving loads.
+void pack_rgb_rect(const uint8_t* rgba, uint8_t* rgb, int width,
+                   const DamageRect& rect);
@@ -0,0 +1,148 @@
+#include "geojson_loader.hpp"
+
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mbgl/style/conversion/geojson.hpp>
+
+namespace {
+
+double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - t0)
+        .count();
+}
+
+bool read_file(const std::string& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    const std::streamoff size = file.tellg();
+    if (size < 0)
+        return false;
+    out.resize(static_cast<std::size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(out.data(), size));
+}
+
+std::size_t count_features(const mbgl::GeoJSON& geojson) {
+    return geojson.match(
+        [](const mapbox::feature::feature_collection<double>& collection) {
+            return collection.size();
+        },
+        [](const auto&) { return std::size_t{1}; });
+}
+
+}  // namespace
+
+GeoJsonLoadResult build_geojson_data(
+    GeoJsonInput input,
+    const mbgl::Immutable<mbgl::style::GeoJSONOptions>& options) {
+    GeoJsonLoadResult result;
+    try {
+        if (!input.features && input.generate) {
+            const auto t0 = std::chrono::steady_clock::now();
+            input.features = input.generate();
+            result.parse_ms = ms_since(t0);
+        }
+        if (!input.features && input.json.empty() && !input.path.empty()) {
+            const auto t0 = std::chrono::steady_clock::now();
+            if (!read_file(input.path, input.json)) {
+                result.error = "cannot read " + input.path;
+                return result;
+            }
+            result.read_ms = ms_since(t0);
+        }
+        if (!input.features) {
+            if (input.json.empty()) {
+                result.error = "no GeoJSON";
+                return result;
+            }
+            const auto t0 = std::chrono::steady_clock::now();
+            mbgl::style::conversion::Error error;
+            auto parsed =
+                mbgl::style::conversion::parseGeoJSON(input.json, error);
+            // The text can be several times the size of the index; drop it
+            // before building one.
+            std::string().swap(input.json);
+            if (!parsed) {
+                result.error = error.message;
+                return result;
+            }
+            input.features = std::move(*parsed);
+            result.parse_ms = ms_since(t0);
+        }
+        result.features = count_features(*input.features);
+        const auto t0 = std::chrono::steady_clock::now();
+        result.data =
+            mbgl::style::GeoJSONData::create(*input.features, options);
+        result.index_ms = ms_since(t0);
+    } catch (const std::exception& e) {
+        result.data.reset();
+        result.error = e.what();
+    }
+    if (!result.data && result.error.empty())
+        result.error = "could not index the features";
+    return result;
+}
+
+GeoJsonLoader::GeoJsonLoader() : GeoJsonLoader(Options{}) {
+}
+
+GeoJsonLoader::GeoJsonLoader(Options options)
+    : pool(std::make_unique<WorkerPool>(options.threads,
+                                        options.max_pending)) {
+}
+
+GeoJsonLoader::~GeoJsonLoader() {
+    stopping = true;
+    pool.reset();
+}
+
+uint64_t GeoJsonLoader::load(
+    std::string id, GeoJsonInput input,
+    mbgl::Immutable<mbgl::style::GeoJSONOptions> options, Callback callback) {
+    const uint64_t generation =
+        next_generation.fetch_add(1, std::memory_order_relaxed);
+    // std::function needs a copyable callable; the input is moved exactly
+    // once, into the shared slot.
+    auto slot = std::make_shared<GeoJsonInput>(std::move(input));
+    auto task = [this, slot, generation, id = std::move(id),
+                 options = std::move(options),
+                 callback = std::move(callback)]() mutable {
+        // Queued loads are skipped at shutdown; nobody will see them.
+        if (stopping)
+            return;
+        GeoJsonLoadResult result =
+            build_geojson_data(std::move(*slot), options);
+        slot.reset();
+        result.id = std::move(id);
+        result.generation = generation;
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        completed.emplace_back(std::move(callback), std::move(result));
+    };
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+    if (!pool->try_submit(std::move(task))) {
+        outstanding.fetch_sub(1, std::memory_order_relaxed);
+        std::cout << "[GeoJsonLoader] queue full, load rejected" << std::endl;
+        return 0;
+    }
+    return generation;
+}
+
+std::size_t GeoJsonLoader::deliver_completed() {
+    std::vector<std::pair<Callback, GeoJsonLoadResult>> ready;
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        if (completed.empty())
+            return 0;
+        ready.swap(completed);
+    }
+    for (auto& [callback, result] : ready) {
+        outstanding.fetch_sub(1, std::memory_order_relaxed);
+        if (callback)
+            callback(std::move(result));
+    }
+    return ready.size();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mbgl/style/sources/geojson_source.hpp>
+#include <mbgl/util/geojson.hpp>
+#include <mbgl/util/immutable.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "worker_pool.hpp"
+
+// What a GeoJSON dataset is loaded from; the first one set is used.
+struct GeoJsonInput {
+    std::optional<mbgl::GeoJSON> features;  // built by the application
+    std::function<mbgl::GeoJSON()> generate;  // builds them on the worker
+    std::string json;                         // GeoJSON text
+    std::string path;                         // a GeoJSON file
+};
+
+struct GeoJsonLoadResult {
+    std::string id;
+    uint64_t generation = 0;
+    // The source's tile index (geojson-vt, or supercluster when clustering),
+    // ready for GeoJSONSource::setGeoJSONData(). Null on error.
+    std::shared_ptr<mbgl::style::GeoJSONData> data;
+    std::size_t features = 0;
+    double read_ms = 0.0;   // reading `path`
+    double parse_ms = 0.0;  // GeoJSON text (or generate()) -> features
+    double index_ms = 0.0;  // simplification/clustering into the index
+    std::string error;
+};
+
+// Reads, parses and indexes GeoJSON (the geojson-vt simplification or the
+// supercluster hierarchy GeoJSONSource would otherwise build on the UI
+// thread when the data is set) on the calling thread. Used by
+// GeoJsonLoader's workers and the benchmarks.
+GeoJsonLoadResult build_geojson_data(
+    GeoJsonInput input,
+    const mbgl::Immutable<mbgl::style::GeoJSONOptions>& options);
+
+// Builds GeoJSON source data on worker threads so that datasets of millions
+// of features never stall the UI thread. load() does not block: it returns
+// 0 when `max_pending` loads are already queued. Finished loads are parked
+// until the owner calls deliver_completed() (SlintMapLibre does so from
+// run_map_loop()), so callbacks always run on the UI thread.
+class GeoJsonLoader {
+public:
+    struct Options {
+        std::size_t threads = 2;
+        std::size_t max_pending = 16;
+    };
+    using Callback = std::function<void(GeoJsonLoadResult&&)>;
+
+    GeoJsonLoader();
+    explicit GeoJsonLoader(Options options);
+    // Finishes the loads already started and joins; undelivered results
+    // are dropped.
+    ~GeoJsonLoader();
+
+    GeoJsonLoader(const GeoJsonLoader&) = delete;
+    GeoJsonLoader& operator=(const GeoJsonLoader&) = delete;
+
+    // Returns the load's generation (increasing across all loads), or 0 if
+    // the queue is full.
+    uint64_t load(std::string id, GeoJsonInput input,
+                  mbgl::Immutable<mbgl::style::GeoJSONOptions> options,
+                  Callback callback);
+
+    // Runs the callbacks of finished loads on the calling thread, in the
+    // order they finished, and returns how many were delivered.
+    std::size_t deliver_completed();
+
+    // Requested but not yet delivered.
+    std::size_t pending() const {
+        return outstanding.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> next_generation{1};
+    std::atomic<std::size_t> outstanding{0};
+
+    std::mutex completed_mutex;
+    std::vector<std::pair<Callback, GeoJsonLoadResult>> completed;
+
+    // Declared last so its workers are joined before the rest goes away.
+    std::unique_ptr<WorkerPool> pool;
+};
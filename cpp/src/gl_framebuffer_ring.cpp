@@ -0,0 +1,108 @@
+#include "gl_framebuffer_ring.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// How long acquire() waits for the compositor before drawing anyway; far
+// beyond a frame, so it only matters if a fence never signals.
+constexpr GLuint64 kFenceTimeoutNs = 100'000'000;
+
+}  // namespace
+
+GLFramebufferRing::GLFramebufferRing(std::size_t count)
+    : count_(std::clamp<std::size_t>(count, 1, max_count)) {
+}
+
+void GLFramebufferRing::set_count(std::size_t count) {
+    destroy();
+    count_ = std::clamp<std::size_t>(count, 1, max_count);
+}
+
+void GLFramebufferRing::set_size(int w, int h) {
+    width_ = w;
+    height_ = h;
+}
+
+bool GLFramebufferRing::wait_fence(Slot& slot, bool block) {
+    if (!slot.fence)
+        return true;
+    const GLenum result = glClientWaitSync(
+        slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, block ? kFenceTimeoutNs : 0);
+    if (result == GL_TIMEOUT_EXPIRED && !block)
+        return false;
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return true;
+}
+
+GLRenderTarget& GLFramebufferRing::acquire() {
+    // Candidates in ring order after the front, so buffers rotate evenly.
+    const int n = static_cast<int>(count_);
+    int chosen = -1;
+    int fallback = -1;
+    for (int step = 1; step <= n; ++step) {
+        const int i = ((front_ < 0 ? 0 : front_) + step) % n;
+        if (n > 1 && i == front_)
+            continue;
+        if (fallback < 0)
+            fallback = i;
+        if (wait_fence(slots[i], false)) {
+            chosen = i;
+            break;
+        }
+    }
+    if (chosen < 0) {
+        // Every candidate is still being sampled: wait for the oldest.
+        chosen = fallback;
+        const auto t0 = std::chrono::steady_clock::now();
+        wait_fence(slots[chosen], true);
+        totals.fence_waits++;
+        totals.fence_wait_ms += std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - t0)
+                                    .count();
+    }
+
+    drawing_ = chosen;
+    slots[chosen].target.resize(width_, height_);
+    return slots[chosen].target;
+}
+
+void GLFramebufferRing::submit() {
+    if (drawing_ < 0)
+        return;
+    pending_ = drawing_;
+    drawing_ = -1;
+    totals.frames++;
+    if (count_ == 1)
+        present();
+}
+
+bool GLFramebufferRing::present() {
+    if (pending_ < 0)
+        return false;
+    const bool changed = pending_ != front_;
+    front_ = pending_;
+    pending_ = -1;
+    return changed;
+}
+
+void GLFramebufferRing::fence_front() {
+    if (front_ < 0)
+        return;
+    Slot& slot = slots[front_];
+    if (slot.fence)
+        glDeleteSync(slot.fence);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void GLFramebufferRing::destroy() {
+    for (Slot& slot : slots) {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        slot.target.destroy();
+    }
+    front_ = pending_ = drawing_ = -1;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gl_render_target.hpp"
+
+// Two or three GLRenderTargets used round-robin so MapLibre draws into a back
+// texture while Slint composites the front one. Without a ring the map
+// redraws the texture Slint samples in the same frame, and the driver has to
+// serialise the two. A frame drawn into the back buffer is shown at the next
+// present(), one redraw later. A fence inserted after Slint's composite
+// guards each buffer: acquire() prefers a buffer whose fence has signalled
+// and waits only when none has. With a single buffer the ring behaves like a
+// plain render target: frames are shown as soon as they are submitted.
+//
+// All calls need the GL context current.
+//
+//   ring.set_size(w, h);
+//   ring.present();                   // BeforeRendering: show the last frame
+//   GLRenderTarget& back = ring.acquire();
+//   ... draw into back.fbo() ...
+//   ring.submit();
+//   ring.fence_front();               // AfterRendering
+class GLFramebufferRing {
+public:
+    static constexpr std::size_t max_count = 3;
+
+    struct Stats {
+        uint64_t frames = 0;       // submitted
+        uint64_t fence_waits = 0;  // acquires that had to wait for a fence
+        double fence_wait_ms = 0.0;
+    };
+
+    // `count` is clamped to [1, max_count].
+    explicit GLFramebufferRing(std::size_t count = 2);
+    GLFramebufferRing(const GLFramebufferRing&) = delete;
+    GLFramebufferRing& operator=(const GLFramebufferRing&) = delete;
+
+    // Changes the ring length; drops all buffers (context current).
+    void set_count(std::size_t count);
+    std::size_t count() const {
+        return count_;
+    }
+
+    // The map size for buffers acquired from now on. Each buffer is resized
+    // when it is next acquired, so the front keeps its frame meanwhile.
+    void set_size(int w, int h);
+
+    // Picks the buffer for the next frame: never the front one, and
+    // preferably one Slint has finished sampling. Resized to the current size.
+    GLRenderTarget& acquire();
+
+    // The acquired buffer holds a finished frame.
+    void submit();
+
+    // Makes the newest submitted frame the front. Returns true if it changed.
+    bool present();
+
+    // A submitted frame is waiting for present().
+    bool has_pending() const {
+        return pending_ >= 0;
+    }
+
+    // Call after the compositor has issued the draw that samples front().
+    void fence_front();
+
+    // The buffer Slint should show; nullptr until the first frame.
+    const GLRenderTarget* front() const {
+        return front_ >= 0 ? &slots[front_].target : nullptr;
+    }
+
+    // Deletes the buffers and fences.
+    void destroy();
+
+    const Stats& stats() const {
+        return totals;
+    }
+
+private:
+    struct Slot {
+        GLRenderTarget target;
+        GLsync fence = nullptr;
+    };
+
+    // Waits for (and drops) the slot's fence; `block` false only polls.
+    bool wait_fence(Slot& slot, bool block);
+
+    std::array<Slot, max_count> slots;
+    std::size_t count_ = 2;
+    int front_ = -1;
+    int pending_ = -1;
+    int drawing_ = -1;
+    int width_ = 0;
+    int height_ = 0;
+    Stats totals;
+};
@@ -0,0 +1,155 @@
+#include "gl_instanced_points.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+const char* kVertexShader = R"GLSL(#version 300 es
+layout(location = 0) in vec2 a_corner;
+layout(location = 1) in vec2 a_offset;
+uniform mat4 u_matrix;
+uniform vec2 u_extent;
+out vec2 v_corner;
+void main() {
+    vec4 position = u_matrix * vec4(a_offset, 0.0, 1.0);
+    // Grow the quad in screen space, so points keep their pixel size.
+    position.xy += a_corner * u_extent * position.w;
+    gl_Position = position;
+    v_corner = a_corner;
+}
+)GLSL";
+
+const char* kFragmentShader = R"GLSL(#version 300 es
+precision mediump float;
+uniform vec4 u_color;
+in vec2 v_corner;
+out vec4 fragment;
+void main() {
+    if (dot(v_corner, v_corner) > 1.0)
+        discard;
+    fragment = u_color;
+}
+)GLSL";
+
+GLuint compile(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cout << "[GLInstancedPoints] shader: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+}  // namespace
+
+bool GLInstancedPoints::init() {
+    if (program_)
+        return true;
+    const GLuint vs = compile(GL_VERTEX_SHADER, kVertexShader);
+    const GLuint fs = compile(GL_FRAGMENT_SHADER, kFragmentShader);
+    if (!vs || !fs) {
+        if (vs)
+            glDeleteShader(vs);
+        if (fs)
+            glDeleteShader(fs);
+        return false;
+    }
+    program_ = glCreateProgram();
+    glAttachShader(program_, vs);
+    glAttachShader(program_, fs);
+    glLinkProgram(program_);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program_, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024] = {};
+        glGetProgramInfoLog(program_, sizeof(log), nullptr, log);
+        std::cout << "[GLInstancedPoints] link: " << log << std::endl;
+        glDeleteProgram(program_);
+        program_ = 0;
+        return false;
+    }
+    u_matrix_ = glGetUniformLocation(program_, "u_matrix");
+    u_extent_ = glGetUniformLocation(program_, "u_extent");
+    u_color_ = glGetUniformLocation(program_, "u_color");
+
+    static const float quad[] = {-1.0f, -1.0f, 1.0f, -1.0f,
+                                 -1.0f, 1.0f,  1.0f, 1.0f};
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &corners_);
+    glGenBuffers(1, &instances_);
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, corners_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, instances_);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    count_ = 0;
+    return true;
+}
+
+void GLInstancedPoints::set_points(const std::vector<float>& offsets) {
+    if (!program_)
+        return;
+    count_ = offsets.size() / 2;
+    glBindBuffer(GL_ARRAY_BUFFER, instances_);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(count_ * 2 * sizeof(float)),
+                 offsets.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLInstancedPoints::draw(const std::array<float, 16>& matrix,
+                             float width, float height, float size_px,
+                             const std::array<float, 4>& rgba) {
+    if (!program_ || count_ == 0 || width <= 0.0f || height <= 0.0f)
+        return;
+    glUseProgram(program_);
+    glUniformMatrix4fv(u_matrix_, 1, GL_FALSE, matrix.data());
+    glUniform2f(u_extent_, size_px / width, size_px / height);
+    // MapLibre blends premultiplied colours.
+    glUniform4f(u_color_, rgba[0] * rgba[3], rgba[1] * rgba[3],
+                rgba[2] * rgba[3], rgba[3]);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    glBindVertexArray(vao_);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                          static_cast<GLsizei>(count_));
+    glBindVertexArray(0);
+    stats_.draw_calls++;
+    stats_.instances += count_;
+}
+
+void GLInstancedPoints::release() {
+    if (instances_)
+        glDeleteBuffers(1, &instances_);
+    if (corners_)
+        glDeleteBuffers(1, &corners_);
+    if (vao_)
+        glDeleteVertexArrays(1, &vao_);
+    if (program_)
+        glDeleteProgram(program_);
+    forget();
+}
+
+void GLInstancedPoints::forget() {
+    program_ = vao_ = corners_ = instances_ = 0;
+    u_matrix_ = u_extent_ = u_color_ = -1;
+    count_ = 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draws any number of round points with one instanced draw call: a unit
+// quad expanded per point in the vertex shader, with the points' positions
+// as a per-instance attribute uploaded once. Positions are float offsets
+// from an origin, in whatever units `matrix` expects (Mercator offsets with
+// GLLayerProjection::matrix_from()). Meant for custom layers, so it sets
+// the blend/depth/stencil state it needs and leaves the rest to MapLibre,
+// which resets its state after a custom layer. The caller must have the
+// context current for every call, including release().
+class GLInstancedPoints {
+public:
+    struct Stats {
+        uint64_t draw_calls = 0;
+        uint64_t instances = 0;
+    };
+
+    GLInstancedPoints() = default;
+    GLInstancedPoints(const GLInstancedPoints&) = delete;
+    GLInstancedPoints& operator=(const GLInstancedPoints&) = delete;
+
+    // Compiles the program and creates the buffers. False (with the log on
+    // stdout) if the shaders do not compile.
+    bool init();
+    bool ready() const {
+        return program_ != 0;
+    }
+
+    // x, y pairs. Replaces the previous points.
+    void set_points(const std::vector<float>& offsets);
+    std::size_t size() const {
+        return count_;
+    }
+
+    // `size_px` is the diameter; `rgba` is straight (not premultiplied)
+    // alpha. `width` x `height` is the viewport in pixels.
+    void draw(const std::array<float, 16>& matrix, float width, float height,
+              float size_px, const std::array<float, 4>& rgba);
+
+    // Deletes the GL objects.
+    void release();
+    // The context is gone with the objects: only forget their names.
+    void forget();
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+    GLuint program_ = 0;
+    GLuint vao_ = 0;
+    GLuint corners_ = 0;
+    GLuint instances_ = 0;
+    GLint u_matrix_ = -1;
+    GLint u_extent_ = -1;
+    GLint u_color_ = -1;
+    std::size_t count_ = 0;
+    Stats stats_;
+};
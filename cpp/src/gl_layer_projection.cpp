@@ -0,0 +1,51 @@
+#include "gl_layer_projection.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMaxLat = 85.051128779806604;
+constexpr double kTileSize = 512.0;
+
+}  // namespace
+
+GLLayerProjection::GLLayerProjection(const Matrix& projection_, double zoom)
+    : projection(projection_), world(kTileSize * std::pow(2.0, zoom)) {
+}
+
+std::array<double, 2> GLLayerProjection::mercator(double lat, double lon) {
+    const double s =
+        std::sin(std::clamp(lat, -kMaxLat, kMaxLat) * kPi / 180.0);
+    return {(lon + 180.0) / 360.0,
+            0.5 - 0.25 * std::log((1.0 + s) / (1.0 - s)) / kPi};
+}
+
+std::array<float, 16> GLLayerProjection::matrix_from(double origin_x,
+                                                     double origin_y) const {
+    // projection * translate(origin * world) * scale(world, world, 1)
+    const Matrix& p = projection;
+    std::array<float, 16> m{};
+    for (int row = 0; row < 4; ++row) {
+        m[0 * 4 + row] = static_cast<float>(p[0 * 4 + row] * world);
+        m[1 * 4 + row] = static_cast<float>(p[1 * 4 + row] * world);
+        m[2 * 4 + row] = static_cast<float>(p[2 * 4 + row]);
+        m[3 * 4 + row] = static_cast<float>(
+            p[0 * 4 + row] * origin_x * world +
+            p[1 * 4 + row] * origin_y * world + p[3 * 4 + row]);
+    }
+    return m;
+}
+
+std::array<double, 4> GLLayerProjection::clip(double merc_x,
+                                              double merc_y) const {
+    const double x = merc_x * world;
+    const double y = merc_y * world;
+    std::array<double, 4> out{};
+    for (int row = 0; row < 4; ++row) {
+        out[row] = projection[0 * 4 + row] * x + projection[1 * 4 + row] * y +
+                   projection[3 * 4 + row];
+    }
+    return out;
+}
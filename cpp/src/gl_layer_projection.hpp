@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+
+// Camera math for custom GL layers (see GLPointCloudLayer), kept free of GL
+// and MapLibre types so it can be tested anywhere.
+//
+// MapLibre hands custom layers a projection matrix for "world pixels" at
+// the frame's zoom: Web Mercator (0..1 from the north-west corner) times
+// 512 * 2^zoom. Float vertex data in those units loses precision well
+// before street level. matrix_from() instead folds an origin and the world
+// scale into the matrix (in double), so vertices can be uploaded once as
+// float Mercator offsets from that origin and stay exact while the camera
+// moves:
+//
+//   GLLayerProjection view(params.projectionMatrix, params.zoom);
+//   const auto m = view.matrix_from(origin_x, origin_y);
+//   // vertex shader: gl_Position = u_matrix * vec4(a_offset, 0.0, 1.0);
+class GLLayerProjection {
+public:
+    using Matrix = std::array<double, 16>;  // column-major, like mbgl::mat4
+
+    GLLayerProjection(const Matrix& projection, double zoom);
+
+    // Web Mercator of a position, 0..1 from the north-west corner.
+    static std::array<double, 2> mercator(double lat, double lon);
+
+    // Matrix for Mercator offsets from (origin_x, origin_y).
+    std::array<float, 16> matrix_from(double origin_x, double origin_y) const;
+
+    // Clip-space position of a Mercator point (x, y, z, w).
+    std::array<double, 4> clip(double merc_x, double merc_y) const;
+
+    double world_size() const {
+        return world;
+    }
+
+private:
+    Matrix projection;
+    double world;
+};
@@ -0,0 +1,52 @@
+#include "gl_point_cloud_layer.hpp"
+
+#include <algorithm>
+
+#include "gl_layer_projection.hpp"
+
+GLPointCloudLayer::GLPointCloudLayer(const std::vector<double>& lat,
+                                     const std::vector<double>& lon,
+                                     const Style& style_)
+    : style(style_) {
+    const std::size_t n = std::min(lat.size(), lon.size());
+    std::vector<double> merc(n * 2);
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto m = GLLayerProjection::mercator(lat[i], lon[i]);
+        merc[i * 2] = m[0];
+        merc[i * 2 + 1] = m[1];
+        origin_x += m[0];
+        origin_y += m[1];
+    }
+    if (n) {
+        origin_x /= static_cast<double>(n);
+        origin_y /= static_cast<double>(n);
+    }
+    offsets.resize(n * 2);
+    for (std::size_t i = 0; i < n; ++i) {
+        offsets[i * 2] = static_cast<float>(merc[i * 2] - origin_x);
+        offsets[i * 2 + 1] = static_cast<float>(merc[i * 2 + 1] - origin_y);
+    }
+}
+
+GLPointCloudLayer::~GLPointCloudLayer() = default;
+
+void GLPointCloudLayer::initialize() {
+    if (points.init())
+        points.set_points(offsets);
+}
+
+void GLPointCloudLayer::render(
+    const mbgl::style::CustomLayerRenderParameters& params) {
+    const GLLayerProjection view(params.projectionMatrix, params.zoom);
+    points.draw(view.matrix_from(origin_x, origin_y),
+                static_cast<float>(params.width),
+                static_cast<float>(params.height), style.size, style.color);
+}
+
+void GLPointCloudLayer::contextLost() {
+    points.forget();
+}
+
+void GLPointCloudLayer::deinitialize() {
+    points.release();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mbgl/style/layers/custom_layer.hpp>
+#include <vector>
+
+#include "gl_instanced_points.hpp"
+
+// A custom layer drawing many points (tracks, point clouds, sensor data)
+// with one instanced draw call per frame, in MapLibre's own render pass and
+// framebuffer: add it with SlintMapGL::add_custom_layer() and it lands in
+// the same zero-copy texture as the rest of the map. The positions are
+// uploaded once as float Mercator offsets from their centre
+// (GLLayerProjection), so panning and zooming only change a matrix.
+class GLPointCloudLayer final : public mbgl::style::CustomLayerHost {
+public:
+    struct Style {
+        float size = 4.0f;  // diameter, pixels
+        std::array<float, 4> color{0.89f, 0.34f, 0.18f, 0.9f};  // rgba
+    };
+
+    GLPointCloudLayer(const std::vector<double>& lat,
+                      const std::vector<double>& lon, const Style& style);
+    ~GLPointCloudLayer() override;
+
+    // Called by MapLibre with the map's context current.
+    void initialize() override;
+    void render(const mbgl::style::CustomLayerRenderParameters&) override;
+    void contextLost() override;
+    void deinitialize() override;
+
+    std::size_t size() const {
+        return offsets.size() / 2;
+    }
+    // Draw calls and points drawn so far.
+    const GLInstancedPoints::Stats& stats() const {
+        return points.stats();
+    }
+
+private:
+    double origin_x = 0.0;
+    double origin_y = 0.0;
+    // Kept to upload again if the layer is re-initialized (style reload,
+    // lost context).
+    std::vector<float> offsets;
+    Style style;
+    GLInstancedPoints points;
+};
@@ -0,0 +1,61 @@
+#include "gl_render_target.hpp"
+
+#include <iostream>
+#include <string>
+
+bool GLRenderTarget::resize(int w, int h) {
+    const auto next = FramebufferLayout::for_size(w, h);
+    // Sizes within the current bucket only move the viewport.
+    const bool reallocate = !valid() ||
+                            next.texture_width != layout_.texture_width ||
+                            next.texture_height != layout_.texture_height;
+    if (reallocate)
+        allocate(next.texture_width, next.texture_height);
+    layout_ = next;
+    return reallocate;
+}
+
+void GLRenderTarget::allocate(int texture_w, int texture_h) {
+    if (!valid()) {
+        glGenTextures(1, &texture_);
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glGenRenderbuffers(1, &depth_stencil_);
+        glGenFramebuffers(1, &fbo_);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_w, texture_h, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, texture_w,
+                          texture_h);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           texture_, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                              GL_RENDERBUFFER, depth_stencil_);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    std::cout << "[GLRenderTarget] " << texture_w << "x" << texture_h
+              << " status="
+              << (status == GL_FRAMEBUFFER_COMPLETE ? "GL_FRAMEBUFFER_COMPLETE"
+                                                    : std::to_string(status))
+              << " fbo=" << fbo_ << " tex=" << texture_ << std::endl;
+}
+
+void GLRenderTarget::destroy() {
+    if (fbo_)
+        glDeleteFramebuffers(1, &fbo_);
+    if (depth_stencil_)
+        glDeleteRenderbuffers(1, &depth_stencil_);
+    if (texture_)
+        glDeleteTextures(1, &texture_);
+    fbo_ = depth_stencil_ = texture_ = 0;
+    layout_ = {};
+}
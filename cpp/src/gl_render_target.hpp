@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <cstdint>
+
+// Where a map of a given size lives inside a size-bucketed texture. The
+// texture is rounded up to `bucket` pixels per axis so drag-resizing does not
+// reallocate on every event; the map renders into the top-left w x h of the
+// image, which with a bottom-left GL origin is the viewport
+// (0, texture_height - height, width, height).
+struct FramebufferLayout {
+    static constexpr int bucket = 256;
+
+    int width = 0;
+    int height = 0;
+    int texture_width = 0;
+    int texture_height = 0;
+
+    static int round_up(int px) {
+        return px <= 0 ? bucket : (px + bucket - 1) / bucket * bucket;
+    }
+    static FramebufferLayout for_size(int w, int h) {
+        return {w, h, round_up(w), round_up(h)};
+    }
+
+    int viewport_y() const {
+        return texture_height - height;
+    }
+    bool operator==(const FramebufferLayout& o) const {
+        return width == o.width && height == o.height &&
+               texture_width == o.texture_width &&
+               texture_height == o.texture_height;
+    }
+    bool operator!=(const FramebufferLayout& o) const {
+        return !(*this == o);
+    }
+};
+
+// An FBO with an RGBA colour texture (handed to Slint as a borrowed texture)
+// and a depth/stencil renderbuffer, created in Slint's GL context. The GL
+// names stay the same across resizes; only their storage is reallocated, and
+// only when the size leaves the current bucket. The caller must have the
+// context current for every call, including destroy().
+class GLRenderTarget {
+public:
+    GLRenderTarget() = default;
+    GLRenderTarget(const GLRenderTarget&) = delete;
+    GLRenderTarget& operator=(const GLRenderTarget&) = delete;
+
+    // Makes the target hold a w x h map. Returns true if the attachments
+    // were (re)allocated.
+    bool resize(int w, int h);
+
+    // Deletes the GL objects (e.g. at RenderingTeardown).
+    void destroy();
+
+    bool valid() const {
+        return fbo_ != 0;
+    }
+    GLuint fbo() const {
+        return fbo_;
+    }
+    GLuint texture() const {
+        return texture_;
+    }
+    const FramebufferLayout& layout() const {
+        return layout_;
+    }
+
+private:
+    void allocate(int texture_w, int texture_h);
+
+    GLuint fbo_ = 0;
+    GLuint texture_ = 0;
+    GLuint depth_stencil_ = 0;
+    FramebufferLayout layout_;
+};
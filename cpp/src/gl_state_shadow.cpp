@@ -0,0 +1,113 @@
+#include "gl_state_shadow.hpp"
+
+#include <iostream>
+
+GLStateShadow::Functions GLStateShadow::Functions::native() {
+    return Functions{&glGetIntegerv,     &glIsEnabled,     &glBindFramebuffer,
+                     &glViewport,        &glUseProgram,    &glBindBuffer,
+                     &glBindVertexArray, &glActiveTexture, &glBindTexture,
+                     &glEnable,          &glDisable};
+}
+
+bool GLStateShadow::State::operator==(const State& other) const {
+    return framebuffer == other.framebuffer &&
+           viewport[0] == other.viewport[0] &&
+           viewport[1] == other.viewport[1] &&
+           viewport[2] == other.viewport[2] &&
+           viewport[3] == other.viewport[3] && program == other.program &&
+           array_buffer == other.array_buffer &&
+           element_array_buffer == other.element_array_buffer &&
+           vertex_array == other.vertex_array &&
+           active_texture == other.active_texture &&
+           texture_2d == other.texture_2d && blend == other.blend &&
+           depth_test == other.depth_test &&
+           scissor_test == other.scissor_test && cull_face == other.cull_face;
+}
+
+GLStateShadow::GLStateShadow() : GLStateShadow(Functions::native()) {
+}
+
+GLStateShadow::GLStateShadow(Functions functions) : gl(functions) {
+}
+
+void GLStateShadow::query_bindings(State& s) {
+    gl.get_integerv(GL_CURRENT_PROGRAM, &s.program);
+    gl.get_integerv(GL_VERTEX_ARRAY_BINDING, &s.vertex_array);
+    gl.get_integerv(GL_ARRAY_BUFFER_BINDING, &s.array_buffer);
+    gl.get_integerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &s.element_array_buffer);
+    gl.get_integerv(GL_ACTIVE_TEXTURE, &s.active_texture);
+    gl.get_integerv(GL_TEXTURE_BINDING_2D, &s.texture_2d);
+    totals.queries += 6;
+}
+
+GLStateShadow::State GLStateShadow::query() {
+    State s;
+    gl.get_integerv(GL_FRAMEBUFFER_BINDING, &s.framebuffer);
+    gl.get_integerv(GL_VIEWPORT, s.viewport);
+    s.blend = gl.is_enabled(GL_BLEND);
+    s.depth_test = gl.is_enabled(GL_DEPTH_TEST);
+    s.scissor_test = gl.is_enabled(GL_SCISSOR_TEST);
+    s.cull_face = gl.is_enabled(GL_CULL_FACE);
+    totals.queries += 6;
+    query_bindings(s);
+    return s;
+}
+
+void GLStateShadow::capture() {
+    shadow = query();
+    captured = true;
+    totals.captures++;
+}
+
+void GLStateShadow::refresh_bindings() {
+    if (!captured) {
+        capture();
+        return;
+    }
+    query_bindings(shadow);
+}
+
+void GLStateShadow::restore() {
+    if (!captured)
+        return;
+    const auto toggle = [this](GLenum cap, GLboolean on) {
+        if (on)
+            gl.enable(cap);
+        else
+            gl.disable(cap);
+    };
+    gl.bind_framebuffer(GL_FRAMEBUFFER,
+                        static_cast<GLuint>(shadow.framebuffer));
+    gl.viewport(shadow.viewport[0], shadow.viewport[1], shadow.viewport[2],
+                shadow.viewport[3]);
+    gl.use_program(static_cast<GLuint>(shadow.program));
+    // The element buffer binding belongs to the VAO: bind that first.
+    gl.bind_vertex_array(static_cast<GLuint>(shadow.vertex_array));
+    gl.bind_buffer(GL_ARRAY_BUFFER, static_cast<GLuint>(shadow.array_buffer));
+    gl.bind_buffer(GL_ELEMENT_ARRAY_BUFFER,
+                   static_cast<GLuint>(shadow.element_array_buffer));
+    gl.active_texture(static_cast<GLenum>(shadow.active_texture));
+    gl.bind_texture(GL_TEXTURE_2D, static_cast<GLuint>(shadow.texture_2d));
+    toggle(GL_BLEND, shadow.blend);
+    toggle(GL_DEPTH_TEST, shadow.depth_test);
+    toggle(GL_SCISSOR_TEST, shadow.scissor_test);
+    toggle(GL_CULL_FACE, shadow.cull_face);
+    totals.restores++;
+}
+
+bool GLStateShadow::verify() {
+    const State live = query();
+    if (captured && live == shadow)
+        return true;
+    if (captured) {
+        std::cout << "[GLStateShadow] host GL state changed since capture "
+                     "(fbo "
+                  << shadow.framebuffer << "->" << live.framebuffer
+                  << ", program " << shadow.program << "->" << live.program
+                  << "); re-captured" << std::endl;
+    }
+    shadow = live;
+    captured = true;
+    totals.captures++;
+    return false;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <cstdint>
+
+// Slint's GL state around SlintMapGL::render(), saved before the map draws
+// and restored afterwards with plain set calls. glGet*/glIsEnabled can stall
+// the pipeline on some drivers, so the state is split by how it changes:
+//   - the target (framebuffer, viewport) and capabilities (blend, depth,
+//     scissor, cull) follow the window and are captured once, until
+//     invalidate() (new context, window resize);
+//   - the object bindings (program, buffers, VAO, active texture and its
+//     2D texture) are whatever Slint's renderer last used, which nothing
+//     keeps stable between frames, so refresh_bindings() re-reads them
+//     every frame: six glGetIntegerv of client-side binding state.
+//
+//   if (!shadow.valid())
+//       shadow.capture();
+//   else
+//       shadow.refresh_bindings();
+//   smap->render();
+//   shadow.restore();
+class GLStateShadow {
+public:
+    // The GL entry points used, swappable so tests can trace the calls.
+    struct Functions {
+        decltype(&glGetIntegerv) get_integerv;
+        decltype(&glIsEnabled) is_enabled;
+        decltype(&glBindFramebuffer) bind_framebuffer;
+        decltype(&glViewport) viewport;
+        decltype(&glUseProgram) use_program;
+        decltype(&glBindBuffer) bind_buffer;
+        decltype(&glBindVertexArray) bind_vertex_array;
+        decltype(&glActiveTexture) active_texture;
+        decltype(&glBindTexture) bind_texture;
+        decltype(&glEnable) enable;
+        decltype(&glDisable) disable;
+
+        static Functions native();
+    };
+
+    struct State {
+        GLint framebuffer = 0;
+        GLint viewport[4] = {0, 0, 0, 0};
+        GLint program = 0;
+        GLint array_buffer = 0;
+        GLint element_array_buffer = 0;
+        GLint vertex_array = 0;
+        GLint active_texture = GL_TEXTURE0;
+        GLint texture_2d = 0;  // on active_texture
+        GLboolean blend = GL_FALSE;
+        GLboolean depth_test = GL_FALSE;
+        GLboolean scissor_test = GL_FALSE;
+        GLboolean cull_face = GL_FALSE;
+
+        bool operator==(const State& other) const;
+        bool operator!=(const State& other) const {
+            return !(*this == other);
+        }
+    };
+
+    struct Stats {
+        uint64_t captures = 0;
+        uint64_t queries = 0;  // glGetIntegerv + glIsEnabled calls issued
+        uint64_t restores = 0;
+    };
+
+    GLStateShadow();
+    explicit GLStateShadow(Functions functions);
+
+    bool valid() const {
+        return captured;
+    }
+    void invalidate() {
+        captured = false;
+    }
+
+    // Reads the whole state from the driver.
+    void capture();
+
+    // Re-reads only the object bindings; captures everything if nothing is
+    // captured yet.
+    void refresh_bindings();
+
+    // Re-applies the captured state without querying; no-op until captured.
+    void restore();
+
+    // Queries the live state and compares it with the captured one; on a
+    // mismatch the shadow is re-captured and false is returned. Meant for
+    // debugging (MAPLIBRE_GL_STATE_CHECK=1 in maplibre-slint-gl).
+    bool verify();
+
+    const State& state() const {
+        return shadow;
+    }
+    const Stats& stats() const {
+        return totals;
+    }
+
+private:
+    State query();
+    void query_bindings(State& s);
+
+    Functions gl;
+    State shadow;
+    bool captured = false;
+    Stats totals;
+};
@@ -0,0 +1,307 @@
+#include "image_encoder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+#ifdef MLN_SLINT_HAS_WEBP
+#include <webp/encode.h>
+
+#include "mbgl/util/premultiply.hpp"
+#endif
+
+namespace {
+
+constexpr uint8_t kQoiOpIndex = 0x00;
+constexpr uint8_t kQoiOpDiff = 0x40;
+constexpr uint8_t kQoiOpLuma = 0x80;
+constexpr uint8_t kQoiOpRun = 0xc0;
+constexpr uint8_t kQoiOpRgb = 0xfe;
+constexpr uint8_t kQoiOpRgba = 0xff;
+
+struct Rgba {
+    uint8_t r = 0, g = 0, b = 0, a = 0;
+
+    bool operator==(const Rgba&) const = default;
+};
+
+Rgba unpremultiplied(const uint8_t* p) {
+    const uint32_t a = p[3];
+    if (a == 255)
+        return {p[0], p[1], p[2], 255};
+    if (a == 0)
+        return {};
+    auto un = [a](uint32_t c) {
+        return static_cast<uint8_t>(
+            std::min<uint32_t>(255, (c * 255 + a / 2) / a));
+    };
+    return {un(p[0]), un(p[1]), un(p[2]), static_cast<uint8_t>(a)};
+}
+
+#ifdef MLN_SLINT_HAS_WEBP
+std::string encode_webp(const mbgl::PremultipliedImage& image, int quality) {
+    const auto rgba = mbgl::util::unpremultiply(image.clone());
+    uint8_t* out = nullptr;
+    const std::size_t size = WebPEncodeRGBA(
+        rgba.data.get(), static_cast<int>(rgba.size.width),
+        static_cast<int>(rgba.size.height),
+        static_cast<int>(rgba.stride()), static_cast<float>(quality), &out);
+    std::string data;
+    if (size > 0)
+        data.assign(reinterpret_cast<const char*>(out), size);
+    WebPFree(out);
+    return data;
+}
+#endif
+
+double ms_since(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - from)
+        .count();
+}
+
+}  // namespace
+
+std::optional<ImageFormat> parse_image_format(const std::string& name) {
+    if (name == "png")
+        return ImageFormat::PNG;
+    if (name == "webp")
+        return ImageFormat::WebP;
+    if (name == "qoi")
+        return ImageFormat::QOI;
+    return std::nullopt;
+}
+
+const char* image_format_extension(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::PNG:
+            return "png";
+        case ImageFormat::WebP:
+            return "webp";
+        case ImageFormat::QOI:
+            return "qoi";
+    }
+    return "";
+}
+
+bool image_format_supported(ImageFormat format) {
+#ifdef MLN_SLINT_HAS_WEBP
+    (void)format;
+    return true;
+#else
+    return format != ImageFormat::WebP;
+#endif
+}
+
+std::string encode_qoi(const mbgl::PremultipliedImage& image) {
+    if (!image.valid())
+        return {};
+    const uint32_t width = image.size.width;
+    const uint32_t height = image.size.height;
+    const std::size_t pixels = static_cast<std::size_t>(width) * height;
+
+    // Worst case is 5 bytes per pixel (QOI_OP_RGBA); write through a raw
+    // pointer into a buffer of that size and trim at the end.
+    std::string out(14 + pixels * 5 + 8, '\0');
+    uint8_t* o = reinterpret_cast<uint8_t*>(out.data());
+    auto be32 = [&o](uint32_t v) {
+        *o++ = static_cast<uint8_t>(v >> 24);
+        *o++ = static_cast<uint8_t>(v >> 16);
+        *o++ = static_cast<uint8_t>(v >> 8);
+        *o++ = static_cast<uint8_t>(v);
+    };
+    *o++ = 'q';
+    *o++ = 'o';
+    *o++ = 'i';
+    *o++ = 'f';
+    be32(width);
+    be32(height);
+    *o++ = 4;  // channels
+    *o++ = 0;  // sRGB with linear alpha
+
+    Rgba index[64] = {};
+    Rgba prev{0, 0, 0, 255};
+    uint32_t run = 0;
+    const uint8_t* src = image.data.get();
+    for (std::size_t i = 0; i < pixels; ++i, src += 4) {
+        const Rgba px = unpremultiplied(src);
+        if (px == prev) {
+            if (++run == 62 || i + 1 == pixels) {
+                *o++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            *o++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+            run = 0;
+        }
+        const uint32_t hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+        if (index[hash] == px) {
+            *o++ = static_cast<uint8_t>(kQoiOpIndex | hash);
+        } else {
+            index[hash] = px;
+            if (px.a == prev.a) {
+                const int8_t vr = static_cast<int8_t>(px.r - prev.r);
+                const int8_t vg = static_cast<int8_t>(px.g - prev.g);
+                const int8_t vb = static_cast<int8_t>(px.b - prev.b);
+                const int vg_r = vr - vg;
+                const int vg_b = vb - vg;
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 &&
+                    vb < 2) {
+                    *o++ = static_cast<uint8_t>(kQoiOpDiff | ((vr + 2) << 4) |
+                                                ((vg + 2) << 2) | (vb + 2));
+                } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 &&
+                           vg_b > -9 && vg_b < 8) {
+                    *o++ = static_cast<uint8_t>(kQoiOpLuma | (vg + 32));
+                    *o++ = static_cast<uint8_t>(((vg_r + 8) << 4) | (vg_b + 8));
+                } else {
+                    *o++ = kQoiOpRgb;
+                    *o++ = px.r;
+                    *o++ = px.g;
+                    *o++ = px.b;
+                }
+            } else {
+                *o++ = kQoiOpRgba;
+                *o++ = px.r;
+                *o++ = px.g;
+                *o++ = px.b;
+                *o++ = px.a;
+            }
+        }
+        prev = px;
+    }
+    for (int i = 0; i < 7; ++i) {
+        *o++ = 0;
+    }
+    *o++ = 1;
+    out.resize(static_cast<std::size_t>(o - reinterpret_cast<uint8_t*>(
+                                                 out.data())));
+    return out;
+}
+
+std::string encode_image(const mbgl::PremultipliedImage& image,
+                         ImageFormat format,
+                         int quality) {
+    if (!image.valid())
+        return {};
+    switch (format) {
+        case ImageFormat::PNG:
+            return mbgl::encodePNG(image);
+        case ImageFormat::QOI:
+            return encode_qoi(image);
+        case ImageFormat::WebP:
+#ifdef MLN_SLINT_HAS_WEBP
+            return encode_webp(image, quality);
+#else
+            (void)quality;
+            return {};
+#endif
+    }
+    return {};
+}
+
+ImageEncoder::ImageEncoder() : ImageEncoder(Options{}) {
+}
+
+ImageEncoder::ImageEncoder(Options options_) : options(std::move(options_)) {
+    if (!image_format_supported(options.format)) {
+        std::cout << "[ImageEncoder] " << image_format_extension(options.format)
+                  << " support not built in; falling back to png"
+                  << std::endl;
+        options.format = ImageFormat::PNG;
+    }
+    pool = std::make_unique<WorkerPool>(options.threads, options.queue_depth);
+}
+
+ImageEncoder::~ImageEncoder() {
+    pool.reset();
+}
+
+std::future<EncodedImage> ImageEncoder::submit(
+    mbgl::PremultipliedImage&& image, uint64_t id) {
+    auto promise = std::make_shared<std::promise<EncodedImage>>();
+    auto future = promise->get_future();
+    if (!submit(
+            std::move(image),
+            [promise](EncodedImage&& result) {
+                promise->set_value(std::move(result));
+            },
+            id)) {
+        EncodedImage failed;
+        failed.id = id;
+        failed.format = options.format;
+        promise->set_value(std::move(failed));
+    }
+    return future;
+}
+
+bool ImageEncoder::submit(mbgl::PremultipliedImage&& image,
+                          Callback callback,
+                          uint64_t id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+    // std::function needs a copyable callable; the image itself is moved
+    // exactly once, into the shared slot.
+    auto slot = std::make_shared<mbgl::PremultipliedImage>(std::move(image));
+    auto task = [this, slot, id, callback = std::move(callback)]() mutable {
+        EncodedImage result;
+        result.id = id;
+        result.format = options.format;
+        const auto t0 = std::chrono::steady_clock::now();
+        try {
+            result.data = encode_image(*slot, options.format, options.quality);
+        } catch (const std::exception& e) {
+            std::cout << "[ImageEncoder] encode failed: " << e.what()
+                      << std::endl;
+        }
+        result.encode_ms = ms_since(t0);
+        const std::size_t bytes_in = slot->bytes();
+        // Release the pixels before the callback, which may block on I/O.
+        slot.reset();
+        finish_one(result, bytes_in);
+        if (callback)
+            callback(std::move(result));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+        }
+        idle.notify_all();
+    };
+    const bool accepted = pool->submit(std::move(task));
+    if (!accepted) {
+        std::lock_guard<std::mutex> lock(mutex);
+        --pending;
+        idle.notify_all();
+    }
+    return accepted;
+}
+
+void ImageEncoder::finish_one(const EncodedImage& result,
+                              std::size_t bytes_in) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++totals.images;
+    if (!result.ok())
+        ++totals.failed;
+    totals.bytes_in += bytes_in;
+    totals.bytes_out += result.data.size();
+    totals.encode_ms += result.encode_ms;
+}
+
+void ImageEncoder::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&] { return pending == 0; });
+}
+
+std::size_t ImageEncoder::in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+ImageEncoder::Stats ImageEncoder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mbgl/util/image.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "worker_pool.hpp"
+
+enum class ImageFormat {
+    PNG,
+    WebP,  // only when built with libwebp (MLN_SLINT_HAS_WEBP)
+    QOI,
+};
+
+// "png", "webp", "qoi" (case-sensitive); nullopt for anything else.
+std::optional<ImageFormat> parse_image_format(const std::string& name);
+const char* image_format_extension(ImageFormat format);
+bool image_format_supported(ImageFormat format);
+
+// Encodes a premultiplied RGBA image synchronously. `quality` (0-100) only
+// applies to WebP. Returns an empty string on failure or for an unsupported
+// format.
+std::string encode_image(const mbgl::PremultipliedImage& image,
+                         ImageFormat format,
+                         int quality = 90);
+
+// QOI (https://qoiformat.org), 4 channels, sRGB. Several times faster than
+// PNG at a similar size for map imagery, which makes it a good intermediate
+// format for pipelines that re-encode later.
+std::string encode_qoi(const mbgl::PremultipliedImage& image);
+
+struct EncodedImage {
+    uint64_t id = 0;  // caller-supplied tag, e.g. frame or tile number
+    ImageFormat format = ImageFormat::PNG;
+    std::string data;  // empty on failure
+    double encode_ms = 0.0;
+
+    bool ok() const {
+        return !data.empty();
+    }
+};
+
+// Encoding stage for anything that saves rendered frames. Images are handed
+// over by move right after HeadlessFrontend::render(), so the render thread
+// can start the next frame while workers compress the previous one. At most
+// `queue_depth` images wait for a worker; submit() blocks beyond that, which
+// bounds memory when rendering outpaces encoding.
+//
+//   ImageEncoder encoder({.threads = 4, .format = ImageFormat::QOI});
+//   auto png = encoder.submit(frontend.render(map).image, frame_no);
+//   ...
+//   write(png.get().data);
+class ImageEncoder {
+public:
+    struct Options {
+        std::size_t threads = 0;  // 0 = hardware concurrency
+        std::size_t queue_depth = 4;
+        ImageFormat format = ImageFormat::PNG;
+        int quality = 90;
+    };
+
+    struct Stats {
+        uint64_t images = 0;
+        uint64_t failed = 0;
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        double encode_ms = 0.0;  // summed over all workers
+    };
+
+    // Runs on the worker thread that encoded the image.
+    using Callback = std::function<void(EncodedImage&&)>;
+
+    ImageEncoder();
+    explicit ImageEncoder(Options options);
+    // Finishes every accepted image before returning.
+    ~ImageEncoder();
+
+    ImageEncoder(const ImageEncoder&) = delete;
+    ImageEncoder& operator=(const ImageEncoder&) = delete;
+
+    std::future<EncodedImage> submit(mbgl::PremultipliedImage&& image,
+                                     uint64_t id = 0);
+    // Returns false (and drops the image) if the encoder is shutting down.
+    bool submit(mbgl::PremultipliedImage&& image, Callback callback,
+                uint64_t id = 0);
+
+    // Blocks until every submitted image has been encoded and delivered.
+    void wait_idle();
+
+    std::size_t in_flight() const;
+    Stats stats() const;
+    const Options& get_options() const {
+        return options;
+    }
+
+private:
+    void finish_one(const EncodedImage& result, std::size_t bytes_in);
+
+    Options options;
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::size_t pending = 0;
+    Stats totals;
+    // Declared last so its destructor drains the queue while the members
+    // above are still alive.
+    std::unique_ptr<WorkerPool> pool;
+};
@@ -0,0 +1,206 @@
+#include "input_recording.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'L', 'S', 'I'};
+constexpr uint16_t kVersion = 1;
+
+// Number of float32 arguments stored for each event type.
+int float_count(InputEventType type) {
+    switch (type) {
+    case InputEventType::Resize:
+    case InputEventType::MousePressed:
+    case InputEventType::MouseReleased:
+    case InputEventType::MouseMoved:
+    case InputEventType::DoubleClicked:
+        return 2;
+    case InputEventType::WheelZoomed:
+    case InputEventType::FlyTo:
+        return 3;
+    case InputEventType::PitchChange:
+    case InputEventType::BearingChange:
+        return 1;
+    case InputEventType::StyleChange:
+        return 0;
+    }
+    return -1;
+}
+
+void write_varint(std::ostream& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.put(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.put(static_cast<char>(v));
+}
+
+bool read_varint(std::istream& in, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int c = in.get();
+        if (c == std::char_traits<char>::eof())
+            return false;
+        v |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+void write_float(std::ostream& out, float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    for (int i = 0; i < 4; ++i) {
+        out.put(static_cast<char>((bits >> (i * 8)) & 0xff));
+    }
+}
+
+bool read_float(std::istream& in, float& f) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; ++i) {
+        const int c = in.get();
+        if (c == std::char_traits<char>::eof())
+            return false;
+        bits |= static_cast<uint32_t>(c & 0xff) << (i * 8);
+    }
+    std::memcpy(&f, &bits, sizeof(f));
+    return true;
+}
+
+}  // namespace
+
+InputRecorder::InputRecorder() : start_(std::chrono::steady_clock::now()) {
+}
+
+void InputRecorder::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    start_ = std::chrono::steady_clock::now();
+    events_.clear();
+}
+
+void InputRecorder::record(InputEventType type, float a, float b, float c,
+                           bool flag, std::string text) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    InputEvent ev;
+    ev.type = type;
+    ev.time_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - start_)
+            .count();
+    ev.a = a;
+    ev.b = b;
+    ev.c = c;
+    ev.flag = flag;
+    ev.text = std::move(text);
+    events_.push_back(std::move(ev));
+}
+
+std::vector<InputEvent> InputRecorder::events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+bool InputRecorder::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    return write_input_events(out, events()) && out.good();
+}
+
+bool write_input_events(std::ostream& out,
+                        const std::vector<InputEvent>& events) {
+    out.write(kMagic, sizeof(kMagic));
+    out.put(static_cast<char>(kVersion & 0xff));
+    out.put(static_cast<char>(kVersion >> 8));
+
+    int64_t prev_us = 0;
+    for (const auto& ev : events) {
+        const int floats = float_count(ev.type);
+        if (floats < 0)
+            return false;
+        out.put(static_cast<char>(ev.type));
+        // Events are appended in time order; clamp defensively so the delta
+        // always fits the unsigned varint.
+        const int64_t t = std::max(ev.time_us, prev_us);
+        write_varint(out, static_cast<uint64_t>(t - prev_us));
+        prev_us = t;
+
+        const float args[3] = {ev.a, ev.b, ev.c};
+        for (int i = 0; i < floats; ++i) {
+            write_float(out, args[i]);
+        }
+        if (ev.type == InputEventType::DoubleClicked) {
+            out.put(ev.flag ? 1 : 0);
+        }
+        if (ev.type == InputEventType::StyleChange) {
+            write_varint(out, ev.text.size());
+            out.write(ev.text.data(),
+                      static_cast<std::streamsize>(ev.text.size()));
+        }
+    }
+    return out.good();
+}
+
+std::optional<std::vector<InputEvent>> read_input_events(std::istream& in) {
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return std::nullopt;
+    }
+    const int lo = in.get();
+    const int hi = in.get();
+    if (hi == std::char_traits<char>::eof() ||
+        static_cast<uint16_t>(lo | (hi << 8)) != kVersion) {
+        return std::nullopt;
+    }
+
+    std::vector<InputEvent> events;
+    int64_t time_us = 0;
+    for (int type = in.get(); type != std::char_traits<char>::eof();
+         type = in.get()) {
+        InputEvent ev;
+        ev.type = static_cast<InputEventType>(type);
+        const int floats = float_count(ev.type);
+        uint64_t delta = 0;
+        if (floats < 0 || !read_varint(in, delta))
+            return std::nullopt;
+        time_us += static_cast<int64_t>(delta);
+        ev.time_us = time_us;
+
+        float* args[3] = {&ev.a, &ev.b, &ev.c};
+        for (int i = 0; i < floats; ++i) {
+            if (!read_float(in, *args[i]))
+                return std::nullopt;
+        }
+        if (ev.type == InputEventType::DoubleClicked) {
+            const int flag = in.get();
+            if (flag == std::char_traits<char>::eof())
+                return std::nullopt;
+            ev.flag = flag != 0;
+        }
+        if (ev.type == InputEventType::StyleChange) {
+            uint64_t len = 0;
+            if (!read_varint(in, len) || len > (1u << 20))
+                return std::nullopt;
+            ev.text.resize(len);
+            if (!in.read(ev.text.data(), static_cast<std::streamsize>(len)))
+                return std::nullopt;
+        }
+        events.push_back(std::move(ev));
+    }
+    return events;
+}
+
+std::optional<std::vector<InputEvent>> load_input_events(
+    const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return std::nullopt;
+    return read_input_events(in);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Records the interaction stream that reaches SlintMapLibre (the MMapAdapter
+// callbacks plus style/camera commands) so a session can be replayed
+// deterministically later (see input_replay.hpp).
+
+enum class InputEventType : uint8_t {
+    Resize = 1,          // a = width, b = height
+    MousePressed = 2,    // a = x, b = y
+    MouseReleased = 3,   // a = x, b = y
+    MouseMoved = 4,      // a = x, b = y
+    WheelZoomed = 5,     // a = x, b = y, c = delta
+    DoubleClicked = 6,   // a = x, b = y, flag = shift
+    FlyTo = 7,           // a = lat, b = lon, c = zoom
+    StyleChange = 8,     // text = style URL
+    PitchChange = 9,     // a = slider value (0-100)
+    BearingChange = 10,  // a = slider value (0-100)
+};
+
+struct InputEvent {
+    InputEventType type = InputEventType::MouseMoved;
+    // Microseconds since the start of the recording.
+    int64_t time_us = 0;
+    float a = 0.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    bool flag = false;
+    std::string text;
+};
+
+// Thread-safe, append-only event log with timestamps relative to start().
+class InputRecorder {
+public:
+    InputRecorder();
+
+    // Restarts the recording clock and drops previously recorded events.
+    void start();
+
+    void record(InputEventType type, float a = 0.0f, float b = 0.0f,
+                float c = 0.0f, bool flag = false, std::string text = {});
+
+    std::vector<InputEvent> events() const;
+
+    // Writes the binary recording to `path`. Returns false on I/O failure.
+    bool save(const std::string& path) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<InputEvent> events_;
+};
+
+// Compact binary format: "MLSI" magic, a u16 version, then one record per
+// event (u8 type, LEB128 time delta in microseconds, type-specific payload of
+// little-endian float32s / u8 flag / LEB128-length-prefixed string).
+bool write_input_events(std::ostream& out,
+                        const std::vector<InputEvent>& events);
+std::optional<std::vector<InputEvent>> read_input_events(std::istream& in);
+std::optional<std::vector<InputEvent>> load_input_events(
+    const std::string& path);
@@ -0,0 +1,176 @@
+#include "input_replay.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mbgl/util/image.hpp>
+#include <memory>
+#include <thread>
+
+#include "map_clock.hpp"
+#include "slint_maplibre_headless.hpp"
+
+namespace {
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty())
+        return 0.0;
+    const double rank = p * static_cast<double>(sorted.size() - 1);
+    const auto lo = static_cast<std::size_t>(rank);
+    const auto hi = std::min(lo + 1, sorted.size() - 1);
+    const double frac = rank - static_cast<double>(lo);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+std::string map_style_url(const std::string& url,
+                          const ReplayOptions& options) {
+    auto it = options.style_url_map.find(url);
+    return it != options.style_url_map.end() ? it->second : url;
+}
+
+}  // namespace
+
+FrameTimeStats compute_frame_time_stats(std::vector<double> frame_ms) {
+    FrameTimeStats stats;
+    stats.frames = frame_ms.size();
+    if (frame_ms.empty())
+        return stats;
+    std::sort(frame_ms.begin(), frame_ms.end());
+    for (double ms : frame_ms) {
+        stats.total_ms += ms;
+    }
+    stats.mean_ms = stats.total_ms / static_cast<double>(frame_ms.size());
+    stats.p50_ms = percentile(frame_ms, 0.50);
+    stats.p95_ms = percentile(frame_ms, 0.95);
+    stats.p99_ms = percentile(frame_ms, 0.99);
+    stats.max_ms = frame_ms.back();
+    return stats;
+}
+
+void apply_input_event(SlintMapLibre& map, const InputEvent& ev,
+                       const ReplayOptions& options) {
+    switch (ev.type) {
+    case InputEventType::Resize:
+        map.resize(static_cast<int>(ev.a), static_cast<int>(ev.b));
+        break;
+    case InputEventType::MousePressed:
+        map.handle_mouse_press(ev.a, ev.b);
+        break;
+    case InputEventType::MouseReleased:
+        map.handle_mouse_release(ev.a, ev.b);
+        break;
+    case InputEventType::MouseMoved:
+        map.handle_mouse_move(ev.a, ev.b, true);
+        break;
+    case InputEventType::WheelZoomed:
+        map.handle_wheel_zoom(ev.a, ev.b, ev.c);
+        break;
+    case InputEventType::DoubleClicked:
+        map.handle_double_click(ev.a, ev.b, ev.flag);
+        break;
+    case InputEventType::FlyTo:
+        map.fly_to(static_cast<double>(ev.a), static_cast<double>(ev.b),
+                   static_cast<double>(ev.c));
+        break;
+    case InputEventType::StyleChange:
+        map.setStyleUrl(map_style_url(ev.text, options));
+        break;
+    case InputEventType::PitchChange:
+        map.set_pitch(static_cast<int>(ev.a));
+        break;
+    case InputEventType::BearingChange:
+        map.set_bearing(ev.a);
+        break;
+    }
+}
+
+FrameTimeStats replay_input_events(SlintMapLibre& map,
+                                   const std::vector<InputEvent>& events,
+                                   const ReplayOptions& options) {
+    // A recording made through SlintMapLibre starts with its viewport size.
+    std::size_t next = 0;
+    int w = options.width;
+    int h = options.height;
+    if (!events.empty() && events.front().type == InputEventType::Resize) {
+        w = static_cast<int>(events.front().a);
+        h = static_cast<int>(events.front().b);
+        next = 1;
+    }
+
+    // Animations follow the virtual timeline, not the wall clock, so the
+    // same recording always produces the same frames.
+    const auto previous_clock = map.get_clock();
+    auto clock = std::make_shared<ManualMapClock>();
+    map.set_clock(clock);
+
+    map.set_frame_logging(false);
+    // prewarm() makes initialize() load the given style instead of the
+    // remote default, so a file:// style keeps the run off the network.
+    if (!options.style_url.empty()) {
+        map.prewarm(options.style_url, w, h);
+    }
+    map.initialize(w, h);
+    // A map created before the replay keeps its style until told otherwise.
+    if (!options.style_url.empty() && map.style_url() != options.style_url) {
+        map.setStyleUrl(options.style_url);
+    }
+
+    const auto load_deadline =
+        std::chrono::steady_clock::now() + options.load_timeout;
+    while (!map.style_is_loaded() &&
+           std::chrono::steady_clock::now() < load_deadline) {
+        map.run_map_loop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    int frame_index = 0;
+    if (!options.frame_dump_dir.empty()) {
+        map.set_frame_observer(
+            [&options, &frame_index](const mbgl::PremultipliedImage& image) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/frame_%05d.png",
+                              frame_index);
+                std::ofstream out(options.frame_dump_dir + name,
+                                  std::ios::binary);
+                out << mbgl::encodePNG(image);
+            });
+    }
+
+    std::vector<double> frame_ms;
+    if (map.style_is_loaded()) {
+        const int64_t end_us =
+            (events.empty() ? 0 : events.back().time_us) +
+            std::chrono::duration_cast<std::chrono::microseconds>(options.tail)
+                .count();
+        const int64_t step_us =
+            std::max<int64_t>(1, options.frame_interval.count());
+
+        const auto origin = clock->now();
+        for (int64_t now_us = 0; now_us <= end_us; now_us += step_us) {
+            clock->set(origin + std::chrono::microseconds(now_us));
+            while (next < events.size() && events[next].time_us <= now_us) {
+                apply_input_event(map, events[next++], options);
+            }
+            const auto t0 = std::chrono::steady_clock::now();
+            map.run_map_loop();
+            if (map.take_repaint_request() || map.consume_forced_repaint()) {
+                map.render_map();
+                const auto t1 = std::chrono::steady_clock::now();
+                frame_ms.push_back(
+                    std::chrono::duration<double, std::milli>(t1 - t0)
+                        .count());
+                ++frame_index;
+            }
+        }
+    } else {
+        std::cout << "[replay] style did not load within "
+                  << options.load_timeout.count() << " ms" << std::endl;
+    }
+
+    map.set_frame_observer(nullptr);
+    map.set_clock(previous_clock);
+    FrameTimeStats stats = compute_frame_time_stats(std::move(frame_ms));
+    stats.style_loaded = map.style_is_loaded();
+    return stats;
+}
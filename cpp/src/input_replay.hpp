@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "input_recording.hpp"
+
+class SlintMapLibre;
+
+// Deterministic replay of a recorded interaction stream (input_recording.hpp)
+// through a headless SlintMapLibre. Time is virtual: the replay advances a
+// fixed frame interval per tick and dispatches every event whose timestamp
+// has been reached, then renders exactly when the interactive app would
+// (pending repaint or forced-repaint burst). The map runs on a ManualMapClock
+// that follows the virtual time, so fly_to animations land on the same
+// frames in every run. Only the render work itself is measured in wall-clock
+// time.
+
+struct ReplayOptions {
+    // Viewport used when the recording does not start with a Resize event.
+    int width = 800;
+    int height = 600;
+
+    // Style loaded before the first event (empty keeps the backend default).
+    // Point this at a file:// style with local tiles for network-free runs.
+    std::string style_url;
+    // Rewrites recorded style-change URLs (e.g. remote -> local file://).
+    std::map<std::string, std::string> style_url_map;
+
+    std::chrono::microseconds frame_interval{16667};
+    // Extra virtual time rendered after the last event so trailing
+    // animations (fly_to runs 2.5 s) settle.
+    std::chrono::milliseconds tail{3000};
+    // Wall-clock budget for the initial style load.
+    std::chrono::milliseconds load_timeout{10000};
+
+    // When set, every rendered frame is written as <dir>/frame_NNNNN.png.
+    std::string frame_dump_dir;
+};
+
+struct FrameTimeStats {
+    std::size_t frames = 0;
+    double total_ms = 0.0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+    // False if the style never finished loading within load_timeout.
+    bool style_loaded = false;
+};
+
+FrameTimeStats compute_frame_time_stats(std::vector<double> frame_ms);
+
+// Applies one recorded event to the map (the same calls the MMapAdapter
+// wiring in cpp/main.cpp makes).
+void apply_input_event(SlintMapLibre& map, const InputEvent& event,
+                       const ReplayOptions& options = {});
+
+// Initializes `map` (it must not be initialized yet) and replays `events`.
+FrameTimeStats replay_input_events(SlintMapLibre& map,
+                                   const std::vector<InputEvent>& events,
+                                   const ReplayOptions& options);
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <mbgl/style/conversion/geojson.hpp>
+#include <mbgl/style/conversion_impl.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "json_value.hpp"
+
+// Lets MapLibre's style converters read a JsonValue directly, the way its
+// own parser reads rapidjson values: Layer::setProperty(name,
+// Convertible(&value)), convert<std::unique_ptr<Layer>>(...). Used to apply
+// StyleOps without serialising each value back to text.
+namespace mbgl {
+namespace style {
+namespace conversion {
+
+template <>
+class ConversionTraits<const JsonValue*> {
+public:
+    static bool isUndefined(const JsonValue* value) {
+        return value->is_null();
+    }
+
+    static bool isArray(const JsonValue* value) {
+        return value->is_array();
+    }
+
+    static std::size_t arrayLength(const JsonValue* value) {
+        return value->as_array().size();
+    }
+
+    static const JsonValue* arrayMember(const JsonValue* value,
+                                        std::size_t i) {
+        return &value->as_array()[i];
+    }
+
+    static bool isObject(const JsonValue* value) {
+        return value->is_object();
+    }
+
+    static std::optional<const JsonValue*> objectMember(
+        const JsonValue* value, const char* name) {
+        if (const JsonValue* member = value->find(name))
+            return member;
+        return std::nullopt;
+    }
+
+    template <class Fn>
+    static std::optional<Error> eachMember(const JsonValue* value, Fn&& fn) {
+        for (const auto& [name, member] : value->as_object()) {
+            std::optional<Error> result = fn(name, &member);
+            if (result)
+                return result;
+        }
+        return std::nullopt;
+    }
+
+    static std::optional<bool> toBool(const JsonValue* value) {
+        if (!value->is_bool())
+            return std::nullopt;
+        return value->as_bool();
+    }
+
+    static std::optional<float> toNumber(const JsonValue* value) {
+        if (!value->is_number())
+            return std::nullopt;
+        return static_cast<float>(value->as_number());
+    }
+
+    static std::optional<double> toDouble(const JsonValue* value) {
+        if (!value->is_number())
+            return std::nullopt;
+        return value->as_number();
+    }
+
+    static std::optional<std::string> toString(const JsonValue* value) {
+        if (!value->is_string())
+            return std::nullopt;
+        return value->as_string();
+    }
+
+    static std::optional<Value> toValue(const JsonValue* value) {
+        switch (value->type()) {
+        case JsonValue::Type::Null:
+            return {NullValue()};
+        case JsonValue::Type::Bool:
+            return {value->as_bool()};
+        case JsonValue::Type::Number: {
+            // Integers as integers, as MapLibre's own JSON parser does.
+            const double n = value->as_number();
+            if (n == std::floor(n) && std::fabs(n) < 9007199254740992.0) {
+                if (n >= 0)
+                    return {static_cast<uint64_t>(n)};
+                return {static_cast<int64_t>(n)};
+            }
+            return {n};
+        }
+        case JsonValue::Type::String:
+            return {value->as_string()};
+        case JsonValue::Type::Array: {
+            std::vector<Value> items;
+            items.reserve(value->as_array().size());
+            for (const auto& item : value->as_array()) {
+                std::optional<Value> converted = toValue(&item);
+                if (!converted)
+                    return std::nullopt;
+                items.push_back(std::move(*converted));
+            }
+            return {std::move(items)};
+        }
+        case JsonValue::Type::Object: {
+            std::unordered_map<std::string, Value> members;
+            for (const auto& [name, member] : value->as_object()) {
+                std::optional<Value> converted = toValue(&member);
+                if (!converted)
+                    return std::nullopt;
+                members.emplace(name, std::move(*converted));
+            }
+            return {std::move(members)};
+        }
+        }
+        return std::nullopt;
+    }
+
+    static std::optional<GeoJSON> toGeoJSON(const JsonValue* value,
+                                            Error& error) {
+        return parseGeoJSON(value->dump(), error);
+    }
+};
+
+}  // namespace conversion
+}  // namespace style
+}  // namespace mbgl
+
+// The other direction, for feature properties (queryRenderedFeatures()).
+// Integers beyond 2^53 lose precision, as in any JSON number.
+inline JsonValue to_json_value(const mbgl::Value& value) {
+    return value.match(
+        [](const mbgl::NullValue&) { return JsonValue(); },
+        [](bool b) { return JsonValue(b); },
+        [](uint64_t n) { return JsonValue(static_cast<double>(n)); },
+        [](int64_t n) { return JsonValue(static_cast<double>(n)); },
+        [](double n) { return JsonValue(n); },
+        [](const std::string& s) { return JsonValue(s); },
+        [](const std::vector<mbgl::Value>& items) {
+            JsonValue::Array array;
+            array.reserve(items.size());
+            for (const auto& item : items)
+                array.push_back(to_json_value(item));
+            return JsonValue(std::move(array));
+        },
+        [](const std::unordered_map<std::string, mbgl::Value>& members) {
+            JsonValue::Object object;
+            object.reserve(members.size());
+            for (const auto& [name, member] : members)
+                object.emplace_back(name, to_json_value(member));
+            return JsonValue(std::move(object));
+        });
+}
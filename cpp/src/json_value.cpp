@@ -0,0 +1,428 @@
+#include "json_value.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// Nesting beyond this is rejected instead of overflowing the stack.
+constexpr int kMaxDepth = 256;
+
+class Parser {
+public:
+    explicit Parser(std::string_view text_) : text(text_) {
+    }
+
+    std::optional<JsonValue> document(std::string* error) {
+        auto value = parse_value(0);
+        skip_space();
+        if (value && pos != text.size())
+            fail("trailing characters");
+        if (!failure.empty()) {
+            if (error)
+                *error = failure + " at offset " + std::to_string(pos);
+            return std::nullopt;
+        }
+        return value;
+    }
+
+private:
+    std::optional<JsonValue> parse_value(int depth) {
+        if (depth > kMaxDepth)
+            return fail("nesting too deep");
+        skip_space();
+        if (pos >= text.size())
+            return fail("unexpected end");
+        switch (text[pos]) {
+        case '{':
+            return parse_object(depth);
+        case '[':
+            return parse_array(depth);
+        case '"': {
+            auto s = parse_string();
+            if (!s)
+                return std::nullopt;
+            return JsonValue(std::move(*s));
+        }
+        case 't':
+            return literal("true", JsonValue(true));
+        case 'f':
+            return literal("false", JsonValue(false));
+        case 'n':
+            return literal("null", JsonValue());
+        default:
+            return parse_number();
+        }
+    }
+
+    std::optional<JsonValue> parse_object(int depth) {
+        ++pos;  // '{'
+        JsonValue::Object members;
+        skip_space();
+        if (consume('}'))
+            return JsonValue(std::move(members));
+        while (true) {
+            skip_space();
+            if (pos >= text.size() || text[pos] != '"')
+                return fail("expected member name");
+            auto key = parse_string();
+            if (!key)
+                return std::nullopt;
+            skip_space();
+            if (!consume(':'))
+                return fail("expected ':'");
+            auto member = parse_value(depth + 1);
+            if (!member)
+                return std::nullopt;
+            members.emplace_back(std::move(*key), std::move(*member));
+            skip_space();
+            if (consume('}'))
+                return JsonValue(std::move(members));
+            if (!consume(','))
+                return fail("expected ',' or '}'");
+        }
+    }
+
+    std::optional<JsonValue> parse_array(int depth) {
+        ++pos;  // '['
+        JsonValue::Array items;
+        skip_space();
+        if (consume(']'))
+            return JsonValue(std::move(items));
+        while (true) {
+            auto item = parse_value(depth + 1);
+            if (!item)
+                return std::nullopt;
+            items.push_back(std::move(*item));
+            skip_space();
+            if (consume(']'))
+                return JsonValue(std::move(items));
+            if (!consume(','))
+                return fail("expected ',' or ']'");
+        }
+    }
+
+    std::optional<std::string> parse_string() {
+        ++pos;  // '"'
+        std::string out;
+        while (pos < text.size()) {
+            const char c = text[pos++];
+            if (c == '"')
+                return out;
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fail("control character in string");
+                return std::nullopt;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size())
+                break;
+            switch (text[pos++]) {
+            case '"':
+                out += '"';
+                break;
+            case '\\':
+                out += '\\';
+                break;
+            case '/':
+                out += '/';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!hex4(cp))
+                    return std::nullopt;
+                // Surrogate pair.
+                if (cp >= 0xd800 && cp <= 0xdbff && pos + 1 < text.size() &&
+                    text[pos] == '\\' && text[pos + 1] == 'u') {
+                    pos += 2;
+                    uint32_t low = 0;
+                    if (!hex4(low))
+                        return std::nullopt;
+                    if (low >= 0xdc00 && low <= 0xdfff)
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                fail("bad escape");
+                return std::nullopt;
+            }
+        }
+        fail("unterminated string");
+        return std::nullopt;
+    }
+
+    std::optional<JsonValue> parse_number() {
+        const std::size_t start = pos;
+        if (pos < text.size() && text[pos] == '-')
+            ++pos;
+        auto digits = [&] {
+            const std::size_t from = pos;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9')
+                ++pos;
+            return pos > from;
+        };
+        if (!digits())
+            return fail("unexpected character");
+        if (pos < text.size() && text[pos] == '.') {
+            ++pos;
+            if (!digits())
+                return fail("bad number");
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-'))
+                ++pos;
+            if (!digits())
+                return fail("bad number");
+        }
+        const std::string number(text.substr(start, pos - start));
+        return JsonValue(std::strtod(number.c_str(), nullptr));
+    }
+
+    std::optional<JsonValue> literal(std::string_view word, JsonValue v) {
+        if (text.substr(pos, word.size()) != word)
+            return fail("unexpected character");
+        pos += word.size();
+        return v;
+    }
+
+    bool hex4(uint32_t& cp) {
+        if (pos + 4 > text.size()) {
+            fail("bad \\u escape");
+            return false;
+        }
+        for (int i = 0; i < 4; ++i) {
+            const char c = text[pos++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9')
+                cp |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                cp |= c - 'A' + 10;
+            else {
+                fail("bad \\u escape");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void append_utf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xc0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xe0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        }
+    }
+
+    void skip_space() {
+        while (pos < text.size() &&
+               (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' ||
+                text[pos] == '\r'))
+            ++pos;
+    }
+
+    bool consume(char c) {
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    std::nullopt_t fail(const char* what) {
+        if (failure.empty())
+            failure = what;
+        return std::nullopt;
+    }
+
+    std::string_view text;
+    std::size_t pos = 0;
+    std::string failure;
+};
+
+void dump_string(std::string& out, const std::string& s) {
+    out += '"';
+    for (const char c : s) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+}  // namespace
+
+const JsonValue* JsonValue::find(std::string_view key) const {
+    if (!is_object())
+        return nullptr;
+    for (const auto& [name, member] : as_object()) {
+        if (name == key)
+            return &member;
+    }
+    return nullptr;
+}
+
+JsonValue* JsonValue::find(std::string_view key) {
+    return const_cast<JsonValue*>(std::as_const(*this).find(key));
+}
+
+const std::string* JsonValue::find_string(std::string_view key) const {
+    const JsonValue* member = find(key);
+    return member && member->is_string() ? &member->as_string() : nullptr;
+}
+
+void JsonValue::set(std::string_view key, JsonValue member) {
+    if (is_null())
+        value = Object{};
+    if (JsonValue* existing = find(key)) {
+        *existing = std::move(member);
+        return;
+    }
+    as_object().emplace_back(std::string(key), std::move(member));
+}
+
+bool JsonValue::erase(std::string_view key) {
+    if (!is_object())
+        return false;
+    auto& members = as_object();
+    auto it = std::find_if(members.begin(), members.end(),
+                           [&](const Member& m) { return m.first == key; });
+    if (it == members.end())
+        return false;
+    members.erase(it);
+    return true;
+}
+
+bool JsonValue::operator==(const JsonValue& other) const {
+    if (type() != other.type())
+        return false;
+    if (!is_object())
+        return value == other.value;
+    const auto& mine = as_object();
+    if (mine.size() != other.as_object().size())
+        return false;
+    return std::all_of(mine.begin(), mine.end(), [&](const Member& m) {
+        const JsonValue* theirs = other.find(m.first);
+        return theirs && m.second == *theirs;
+    });
+}
+
+std::optional<JsonValue> JsonValue::parse(std::string_view text,
+                                          std::string* error) {
+    return Parser(text).document(error);
+}
+
+std::string JsonValue::dump() const {
+    std::string out;
+    dump_to(out);
+    return out;
+}
+
+void JsonValue::dump_to(std::string& out) const {
+    switch (type()) {
+    case Type::Null:
+        out += "null";
+        break;
+    case Type::Bool:
+        out += as_bool() ? "true" : "false";
+        break;
+    case Type::Number: {
+        const double n = as_number();
+        char buf[32];
+        if (!std::isfinite(n)) {
+            out += "null";
+        } else if (n == std::floor(n) && std::fabs(n) < 1e15) {
+            std::snprintf(buf, sizeof(buf), "%.0f", n);
+            out += buf;
+        } else {
+            std::snprintf(buf, sizeof(buf), "%.17g", n);
+            out += buf;
+        }
+        break;
+    }
+    case Type::String:
+        dump_string(out, as_string());
+        break;
+    case Type::Array: {
+        out += '[';
+        bool first = true;
+        for (const auto& item : as_array()) {
+            if (!first)
+                out += ',';
+            first = false;
+            item.dump_to(out);
+        }
+        out += ']';
+        break;
+    }
+    case Type::Object: {
+        out += '{';
+        bool first = true;
+        for (const auto& [name, member] : as_object()) {
+            if (!first)
+                out += ',';
+            first = false;
+            dump_string(out, name);
+            out += ':';
+            member.dump_to(out);
+        }
+        out += '}';
+        break;
+    }
+    }
+}
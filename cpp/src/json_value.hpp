@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// A small JSON document model for the style JSON the app handles itself
+// (the style cache, style diffs): parse, inspect, edit, write back. Objects
+// keep their members in source order, so an edited style serialises the way
+// it was written. Numbers are doubles, which covers everything a style
+// holds.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    using Array = std::vector<JsonValue>;
+    using Member = std::pair<std::string, JsonValue>;
+    using Object = std::vector<Member>;
+
+    JsonValue() = default;
+    JsonValue(std::nullptr_t) {
+    }
+    JsonValue(bool b) : value(b) {
+    }
+    JsonValue(double n) : value(n) {
+    }
+    JsonValue(int n) : value(static_cast<double>(n)) {
+    }
+    JsonValue(std::string s) : value(std::move(s)) {
+    }
+    JsonValue(const char* s) : value(std::string(s)) {
+    }
+    JsonValue(Array a) : value(std::move(a)) {
+    }
+    JsonValue(Object o) : value(std::move(o)) {
+    }
+
+    Type type() const {
+        return static_cast<Type>(value.index());
+    }
+    bool is_null() const {
+        return type() == Type::Null;
+    }
+    bool is_bool() const {
+        return type() == Type::Bool;
+    }
+    bool is_number() const {
+        return type() == Type::Number;
+    }
+    bool is_string() const {
+        return type() == Type::String;
+    }
+    bool is_array() const {
+        return type() == Type::Array;
+    }
+    bool is_object() const {
+        return type() == Type::Object;
+    }
+
+    // Accessors for the matching type; call only after checking it.
+    bool as_bool() const {
+        return std::get<bool>(value);
+    }
+    double as_number() const {
+        return std::get<double>(value);
+    }
+    const std::string& as_string() const {
+        return std::get<std::string>(value);
+    }
+    const Array& as_array() const {
+        return std::get<Array>(value);
+    }
+    Array& as_array() {
+        return std::get<Array>(value);
+    }
+    const Object& as_object() const {
+        return std::get<Object>(value);
+    }
+    Object& as_object() {
+        return std::get<Object>(value);
+    }
+
+    // Member of an object, or nullptr (also for non-objects).
+    const JsonValue* find(std::string_view key) const;
+    JsonValue* find(std::string_view key);
+    // String member, or nullptr.
+    const std::string* find_string(std::string_view key) const;
+    // Replaces or appends a member. A null value becomes an object first.
+    void set(std::string_view key, JsonValue member);
+    // Removes a member; false if there was none.
+    bool erase(std::string_view key);
+
+    // Deep equality; object member order does not matter.
+    bool operator==(const JsonValue& other) const;
+    bool operator!=(const JsonValue& other) const {
+        return !(*this == other);
+    }
+
+    // nullopt (and `error`, if given) for malformed input or trailing
+    // garbage.
+    static std::optional<JsonValue> parse(std::string_view text,
+                                          std::string* error = nullptr);
+    // Compact JSON.
+    std::string dump() const;
+
+private:
+    void dump_to(std::string& out) const;
+
+    std::variant<std::monostate, bool, double, std::string, Array, Object>
+        value;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// Time source for SlintMapLibre's own animations (fly_to). The default reads
+// std::chrono::steady_clock; a ManualMapClock only moves when advanced, so a
+// headless caller can step animations at a fixed timestep as fast as frames
+// render and get the same frame sequence on every run (video export, replay
+// benchmarks, golden-image tests).
+class MapClock {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+    using duration = std::chrono::steady_clock::duration;
+
+    virtual ~MapClock() = default;
+    virtual time_point now() const = 0;
+    // Manual clocks also switch off MapLibre's wall-clock style and symbol
+    // placement transitions (see SlintMapLibre::set_clock()).
+    virtual bool is_manual() const {
+        return false;
+    }
+};
+
+class SteadyMapClock final : public MapClock {
+public:
+    time_point now() const override {
+        return std::chrono::steady_clock::now();
+    }
+};
+
+class ManualMapClock final : public MapClock {
+public:
+    ManualMapClock() = default;
+    explicit ManualMapClock(time_point start)
+        : ticks(start.time_since_epoch().count()) {
+    }
+
+    time_point now() const override {
+        return time_point(duration(ticks.load(std::memory_order_relaxed)));
+    }
+    bool is_manual() const override {
+        return true;
+    }
+
+    void advance(duration step) {
+        ticks.fetch_add(step.count(), std::memory_order_relaxed);
+    }
+    void set(time_point t) {
+        ticks.store(t.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<duration::rep> ticks{0};
+};
@@ -0,0 +1,275 @@
+#include "marker_layer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMaxLat = 85.051128779806604;
+// MapLibre's world size at zoom 0, in logical pixels.
+constexpr double kTileSize = 512.0;
+
+double mercator_x(double lon) {
+    return (lon + 180.0) / 360.0;
+}
+
+double mercator_y(double lat) {
+    const double s =
+        std::sin(std::clamp(lat, -kMaxLat, kMaxLat) * kPi / 180.0);
+    return 0.5 - 0.25 * std::log((1.0 + s) / (1.0 - s)) / kPi;
+}
+
+}  // namespace
+
+void MarkerPositions::reserve(std::size_t n) {
+    ids.reserve(n);
+    lon.reserve(n);
+    lat.reserve(n);
+    priority.reserve(n);
+    kind.reserve(n);
+    labels.reserve(n);
+}
+
+void MarkerPositions::clear() {
+    ids.clear();
+    lon.clear();
+    lat.clear();
+    priority.clear();
+    kind.clear();
+    labels.clear();
+}
+
+void MarkerPositions::push(uint64_t id, double lon_, double lat_,
+                           float priority_, int32_t kind_, std::string label) {
+    ids.push_back(id);
+    lon.push_back(lon_);
+    lat.push_back(lat_);
+    priority.push_back(priority_);
+    kind.push_back(kind_);
+    labels.push_back(std::move(label));
+}
+
+void MarkerLayer::set_markers(MarkerPositions markers,
+                              const Options& options) {
+    positions = std::move(markers);
+    const std::size_t n = positions.size();
+    // Optional columns are all or nothing.
+    if (positions.priority.size() != n)
+        positions.priority.clear();
+    if (positions.kind.size() != n)
+        positions.kind.clear();
+    if (positions.labels.size() != n)
+        positions.labels.clear();
+    merc_x.resize(n);
+    merc_y.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        merc_x[i] = mercator_x(positions.lon[i]);
+        merc_y[i] = mercator_y(positions.lat[i]);
+    }
+    index.build(merc_x, merc_y);
+    by_priority.resize(n);
+    std::iota(by_priority.begin(), by_priority.end(), 0u);
+    if (!positions.priority.empty()) {
+        std::stable_sort(by_priority.begin(), by_priority.end(),
+                         [&](uint32_t a, uint32_t b) {
+                             return positions.priority[a] >
+                                    positions.priority[b];
+                         });
+    }
+    rank.resize(n);
+    for (std::size_t r = 0; r < n; ++r)
+        rank[by_priority[r]] = static_cast<uint32_t>(r);
+    slot.assign(n, 0);
+    opts = options;
+    shown.clear();
+    last_stats = {};
+}
+
+void MarkerLayer::set_options(const Options& options) {
+    opts = options;
+}
+
+void MarkerLayer::clear() {
+    set_markers({}, opts);
+}
+
+void MarkerLayer::query(PointRTree::Box box) {
+    candidates.clear();
+    if (!opts.spatial_index || box.max_x - box.min_x >= 1.0) {
+        candidates.resize(positions.size());
+        std::iota(candidates.begin(), candidates.end(), 0u);
+        return;
+    }
+    // Into the indexed world, then split where the box crosses the
+    // antimeridian; the two parts never overlap.
+    const double shift = std::floor(box.min_x);
+    box.min_x -= shift;
+    box.max_x -= shift;
+    if (box.max_x > 1.0) {
+        index.query({0.0, box.min_y, box.max_x - 1.0, box.max_y},
+                    candidates);
+        box.max_x = 1.0;
+    }
+    index.query(box, candidates);
+}
+
+const std::vector<VisibleMarker>& MarkerLayer::update(
+    const MarkerViewport& viewport) {
+    const double world = kTileSize * std::pow(2.0, viewport.zoom);
+    const double cx = mercator_x(viewport.lon);
+    const double cy = mercator_y(viewport.lat);
+    const double angle = viewport.bearing * kPi / 180.0;
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+
+    // The rotated view's bounding box, one marker wider on every side.
+    const double w = viewport.width;
+    const double h = viewport.height;
+    const double half_x =
+        (std::abs(w * c) + std::abs(h * s)) / 2.0 + opts.marker_width;
+    const double half_y =
+        (std::abs(w * s) + std::abs(h * c)) / 2.0 + opts.marker_height;
+    query(PointRTree::Box{cx - half_x / world, cy - half_y / world,
+                          cx + half_x / world, cy + half_y / world});
+
+    // Screen y grows down like Mercator y; a bearing turns the map
+    // counter-clockwise.
+    screen_x.resize(candidates.size());
+    screen_y.resize(candidates.size());
+    for (std::size_t k = 0; k < candidates.size(); ++k) {
+        const uint32_t i = candidates[k];
+        // The copy nearest the centre, so markers just across the
+        // antimeridian are placed beside it.
+        double wrapped = merc_x[i] - cx;
+        wrapped -= std::round(wrapped);
+        const double dx = wrapped * world;
+        const double dy = (merc_y[i] - cy) * world;
+        screen_x[k] = static_cast<float>(dx * c + dy * s + w / 2.0);
+        screen_y[k] = static_cast<float>(-dx * s + dy * c + h / 2.0);
+    }
+    place(viewport);
+    return shown;
+}
+
+const std::vector<VisibleMarker>& MarkerLayer::update(
+    const MarkerViewport& viewport, double west, double south, double east,
+    double north, const Projector& project) {
+    // West of `west` by longitude when the box crosses the antimeridian.
+    const double max_x = mercator_x(east) + (east < west ? 1.0 : 0.0);
+    query(PointRTree::Box{mercator_x(west), mercator_y(north), max_x,
+                          mercator_y(south)});
+    screen_x.resize(candidates.size());
+    screen_y.resize(candidates.size());
+    if (!candidates.empty())
+        project(positions, candidates, screen_x, screen_y);
+    place(viewport);
+    return shown;
+}
+
+void MarkerLayer::sort_by_priority() {
+    const std::size_t n = order.size();
+    if (n < 2)
+        return;
+    // With most markers on screen (zoomed out), walking the precomputed
+    // priority order is cheaper than sorting them.
+    if (n * 8 > by_priority.size()) {
+        for (uint32_t k : order)
+            slot[candidates[k]] = k + 1;
+        order.clear();
+        for (uint32_t i : by_priority) {
+            if (slot[i]) {
+                order.push_back(slot[i] - 1);
+                slot[i] = 0;
+            }
+        }
+        return;
+    }
+    keys.clear();
+    for (uint32_t k : order)
+        keys.push_back(static_cast<uint64_t>(rank[candidates[k]]) << 32 | k);
+    std::sort(keys.begin(), keys.end());
+    for (std::size_t j = 0; j < n; ++j)
+        order[j] = static_cast<uint32_t>(keys[j]);
+}
+
+void MarkerLayer::place(const MarkerViewport& viewport) {
+    const float mw = std::max(1.0f, opts.marker_width);
+    const float mh = std::max(1.0f, opts.marker_height);
+    last_stats = {};
+    last_stats.candidates = candidates.size();
+
+    order.clear();
+    for (std::size_t k = 0; k < candidates.size(); ++k) {
+        const float x = screen_x[k];
+        const float y = screen_y[k];
+        if (x < -mw / 2 || y < -mh / 2 || x > viewport.width + mw / 2 ||
+            y > viewport.height + mh / 2)
+            continue;
+        order.push_back(static_cast<uint32_t>(k));
+    }
+    last_stats.on_screen = order.size();
+    sort_by_priority();
+
+    // Placed markers by grid cell, one cell per marker, offset by a cell
+    // so markers hanging over the top/left edge have one too.
+    const auto cols =
+        static_cast<std::size_t>(std::ceil(viewport.width / mw)) + 3;
+    const auto rows =
+        static_cast<std::size_t>(std::ceil(viewport.height / mh)) + 3;
+    if (opts.collisions) {
+        grid.resize(cols * rows);
+        for (auto& cell : grid)
+            cell.clear();
+    }
+    auto cell_of = [&](float v, float size, std::size_t cells) {
+        const auto c = static_cast<long>(std::floor(v / size)) + 1;
+        return static_cast<std::size_t>(
+            std::clamp<long>(c, 0, static_cast<long>(cells) - 1));
+    };
+
+    std::vector<uint32_t> placed;
+    placed.reserve(std::min(order.size(), opts.max_visible));
+    for (uint32_t k : order) {
+        if (placed.size() >= opts.max_visible)
+            break;
+        if (opts.collisions) {
+            const float x = screen_x[k];
+            const float y = screen_y[k];
+            const std::size_t col = cell_of(x, mw, cols);
+            const std::size_t row = cell_of(y, mh, rows);
+            bool hit = false;
+            for (std::size_t r = row ? row - 1 : 0;
+                 !hit && r <= std::min(row + 1, rows - 1); ++r) {
+                for (std::size_t c = col ? col - 1 : 0;
+                     !hit && c <= std::min(col + 1, cols - 1); ++c) {
+                    for (uint32_t other : grid[r * cols + c]) {
+                        if (std::abs(screen_x[other] - x) < mw &&
+                            std::abs(screen_y[other] - y) < mh) {
+                            hit = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (hit) {
+                last_stats.collided++;
+                continue;
+            }
+            grid[row * cols + col].push_back(k);
+        }
+        placed.push_back(k);
+    }
+
+    // Lowest priority first, so Slint draws the winners on top.
+    shown.clear();
+    shown.reserve(placed.size());
+    for (auto it = placed.rbegin(); it != placed.rend(); ++it) {
+        const uint32_t i = candidates[*it];
+        shown.push_back(
+            VisibleMarker{i, positions.ids[i], screen_x[*it], screen_y[*it]});
+    }
+    last_stats.visible = shown.size();
+}
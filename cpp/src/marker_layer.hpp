@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "point_rtree.hpp"
+
+// Markers as parallel arrays (struct-of-arrays). `priority`, `kind` and
+// `labels` may be left empty (all 0 / no label) or hold one entry per
+// marker.
+struct MarkerPositions {
+    std::vector<uint64_t> ids;
+    std::vector<double> lon;
+    std::vector<double> lat;
+    std::vector<float> priority;  // wins collisions; drawn on top
+    std::vector<int32_t> kind;    // free for the app, e.g. an icon
+    std::vector<std::string> labels;
+
+    std::size_t size() const {
+        return ids.size();
+    }
+    void reserve(std::size_t n);
+    void clear();
+    void push(uint64_t id, double lon_, double lat_, float priority_ = 0.0f,
+              int32_t kind_ = 0, std::string label = {});
+};
+
+// A marker to draw this frame, centred on (x, y) in logical pixels from the
+// map's top-left.
+struct VisibleMarker {
+    uint32_t index;  // into MarkerPositions
+    uint64_t id;
+    float x;
+    float y;
+};
+
+// The camera as MapLibre reports it, for the flat (unpitched) projection.
+struct MarkerViewport {
+    double lat = 0.0;
+    double lon = 0.0;
+    double zoom = 0.0;
+    double bearing = 0.0;  // degrees, as CameraOptions::bearing
+    float width = 0.0f;    // logical pixels
+    float height = 0.0f;
+};
+
+// Which of thousands of markers to draw for a camera. The markers are
+// indexed once (PointRTree, in Web Mercator); each update() then
+//   1. queries the index for the ones inside the view, plus a margin,
+//   2. projects only those to screen pixels in one batch,
+//   3. drops markers overlapping a higher-priority one (a screen grid of
+//      marker-sized cells, so each marker checks a few neighbours),
+//   4. keeps at most `max_visible`, in draw order (lowest priority first).
+// Markers are not repeated across world copies: each is placed at the copy
+// nearest the view's centre, so a view across the antimeridian shows the
+// markers on both sides of it.
+class MarkerLayer {
+public:
+    struct Options {
+        float marker_width = 24.0f;  // collision box, logical pixels
+        float marker_height = 24.0f;
+        bool collisions = true;
+        std::size_t max_visible = 2000;
+        // Off: every marker is projected and tested against the view, as a
+        // baseline for measuring.
+        bool spatial_index = true;
+    };
+
+    struct Stats {
+        std::size_t candidates = 0;  // from the index
+        std::size_t on_screen = 0;   // after projection
+        std::size_t collided = 0;
+        std::size_t visible = 0;
+    };
+
+    // Projects the markers at `indices` to screen pixels, for cameras the
+    // flat projection does not cover (pitch): MapLibre's batch
+    // pixelsForLatLngs().
+    using Projector = std::function<void(const MarkerPositions& markers,
+                                         const std::vector<uint32_t>& indices,
+                                         std::vector<float>& x,
+                                         std::vector<float>& y)>;
+
+    void set_markers(MarkerPositions markers, const Options& options);
+    void set_options(const Options& options);
+    void clear();
+
+    const std::vector<VisibleMarker>& update(const MarkerViewport& viewport);
+    // Candidates are the markers within the lon/lat box (e.g. the corners
+    // of a pitched view); `project` places them. A box crossing the
+    // antimeridian has `west > east`, or longitudes beyond +-180.
+    const std::vector<VisibleMarker>& update(const MarkerViewport& viewport,
+                                             double west, double south,
+                                             double east, double north,
+                                             const Projector& project);
+
+    const MarkerPositions& markers() const {
+        return positions;
+    }
+    const std::vector<VisibleMarker>& visible() const {
+        return shown;
+    }
+    const Options& options() const {
+        return opts;
+    }
+    const Stats& stats() const {
+        return last_stats;
+    }
+    std::size_t size() const {
+        return positions.size();
+    }
+
+private:
+    // `box` may extend past the world's edges in x (Web Mercator).
+    void query(PointRTree::Box box);
+    void place(const MarkerViewport& viewport);
+    void sort_by_priority();
+
+    MarkerPositions positions;
+    Options opts;
+    // Web Mercator, 0..1 from the north-west corner.
+    std::vector<double> merc_x;
+    std::vector<double> merc_y;
+    PointRTree index;
+    // Marker indices by descending priority, and each marker's place in it.
+    std::vector<uint32_t> by_priority;
+    std::vector<uint32_t> rank;
+
+    // Scratch space reused across updates.
+    std::vector<uint32_t> candidates;
+    std::vector<float> screen_x;
+    std::vector<float> screen_y;
+    std::vector<uint32_t> order;  // into candidates
+    std::vector<uint64_t> keys;   // rank << 32 | position in candidates
+    std::vector<uint32_t> slot;   // per marker: position in candidates + 1
+    std::vector<std::vector<uint32_t>> grid;
+
+    std::vector<VisibleMarker> shown;
+    Stats last_stats;
+};
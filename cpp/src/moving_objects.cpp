@@ -0,0 +1,106 @@
+#include "moving_objects.hpp"
+
+#include <algorithm>
+
+void ObjectPositions::reserve(std::size_t n) {
+    ids.reserve(n);
+    lon.reserve(n);
+    lat.reserve(n);
+    bearing.reserve(n);
+}
+
+void ObjectPositions::clear() {
+    ids.clear();
+    lon.clear();
+    lat.clear();
+    bearing.clear();
+}
+
+void ObjectPositions::push(uint64_t id, double lon_, double lat_,
+                           float bearing_) {
+    ids.push_back(id);
+    lon.push_back(lon_);
+    lat.push_back(lat_);
+    bearing.push_back(bearing_);
+}
+
+std::size_t MovingObjects::apply(const ObjectPositions& deltas) {
+    const std::size_t n =
+        std::min({deltas.ids.size(), deltas.lon.size(), deltas.lat.size()});
+    std::size_t added = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const bool has_bearing = i < deltas.bearing.size();
+        auto [it, inserted] = slots.try_emplace(deltas.ids[i], current.size());
+        if (inserted) {
+            current.push(deltas.ids[i], deltas.lon[i], deltas.lat[i],
+                         has_bearing ? deltas.bearing[i] : 0.0f);
+            added++;
+            continue;
+        }
+        const std::size_t slot = it->second;
+        current.lon[slot] = deltas.lon[i];
+        current.lat[slot] = deltas.lat[i];
+        if (has_bearing)
+            current.bearing[slot] = deltas.bearing[i];
+    }
+    totals.deltas++;
+    totals.positions += n;
+    changed = changed || n > 0;
+    return added;
+}
+
+std::size_t MovingObjects::remove(const std::vector<uint64_t>& ids) {
+    std::size_t removed = 0;
+    for (const uint64_t id : ids) {
+        auto it = slots.find(id);
+        if (it == slots.end())
+            continue;
+        // Swap with the last object so the arrays stay dense.
+        const std::size_t slot = it->second;
+        const std::size_t last = current.size() - 1;
+        if (slot != last) {
+            current.ids[slot] = current.ids[last];
+            current.lon[slot] = current.lon[last];
+            current.lat[slot] = current.lat[last];
+            current.bearing[slot] = current.bearing[last];
+            slots[current.ids[slot]] = slot;
+        }
+        current.ids.pop_back();
+        current.lon.pop_back();
+        current.lat.pop_back();
+        current.bearing.pop_back();
+        slots.erase(it);
+        removed++;
+    }
+    changed = changed || removed > 0;
+    return removed;
+}
+
+void MovingObjects::clear() {
+    changed = changed || current.size() > 0;
+    current.clear();
+    slots.clear();
+}
+
+void MovingObjects::snapshot(ObjectPositions& out) {
+    out.ids.assign(current.ids.begin(), current.ids.end());
+    out.lon.assign(current.lon.begin(), current.lon.end());
+    out.lat.assign(current.lat.begin(), current.lat.end());
+    out.bearing.assign(current.bearing.begin(), current.bearing.end());
+    changed = false;
+    totals.snapshots++;
+}
+
+mbgl::GeoJSON to_point_features(const ObjectPositions& positions) {
+    mapbox::feature::feature_collection<double> features;
+    features.reserve(positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        auto& feature = features.emplace_back(
+            mapbox::geometry::point<double>(positions.lon[i],
+                                            positions.lat[i]));
+        feature.id = positions.ids[i];
+        feature.properties.emplace(
+            "bearing", static_cast<double>(positions.bearing[i]));
+    }
+    return features;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mbgl/util/geojson.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Positions of moving points as parallel arrays (struct of arrays): one
+// entry per object, `ids[i]` at (`lon[i]`, `lat[i]`) heading `bearing[i]`
+// degrees. Used both for the deltas an application pushes and for the
+// snapshots MovingObjects hands to the source.
+struct ObjectPositions {
+    std::vector<uint64_t> ids;
+    std::vector<double> lon;
+    std::vector<double> lat;
+    std::vector<float> bearing;
+
+    std::size_t size() const {
+        return ids.size();
+    }
+    void reserve(std::size_t n);
+    void clear();
+    void push(uint64_t id, double lon, double lat, float bearing = 0.0f);
+};
+
+// The live set of a moving-object layer (e.g. a vehicle fleet). Deltas are
+// applied in place, with no allocation once every object has been seen;
+// snapshot() copies the arrays when the map is ready for the next source
+// update, so any number of deltas between two frames cost one update.
+class MovingObjects {
+public:
+    struct Stats {
+        uint64_t deltas = 0;     // apply() calls
+        uint64_t positions = 0;  // object positions applied
+        uint64_t snapshots = 0;  // source updates they were coalesced into
+    };
+
+    // Moves known objects and adds unknown ones; returns how many objects
+    // were added. Entries of unequal-length arrays beyond the shortest of
+    // ids/lon/lat are ignored; a short `bearing` keeps the old heading.
+    std::size_t apply(const ObjectPositions& deltas);
+    // Returns how many of `ids` were present.
+    std::size_t remove(const std::vector<uint64_t>& ids);
+    void clear();
+
+    std::size_t size() const {
+        return current.size();
+    }
+    // Changed since the last snapshot().
+    bool dirty() const {
+        return changed;
+    }
+    // Marks the set changed, e.g. when a snapshot could not be used.
+    void touch() {
+        changed = true;
+    }
+    // The current positions (into `out`, reusing its capacity).
+    void snapshot(ObjectPositions& out);
+
+    const Stats& stats() const {
+        return totals;
+    }
+
+private:
+    ObjectPositions current;
+    std::unordered_map<uint64_t, std::size_t> slots;
+    bool changed = false;
+    Stats totals;
+};
+
+// One point feature per object: its ID as the feature ID (for
+// feature-state) and the heading as the "bearing" property (for
+// icon-rotate), built directly without going through GeoJSON text.
+mbgl::GeoJSON to_point_features(const ObjectPositions& positions);
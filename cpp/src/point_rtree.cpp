@@ -0,0 +1,104 @@
+#include "point_rtree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+bool intersects(const PointRTree::Box& a, const PointRTree::Box& b) {
+    return a.min_x <= b.max_x && a.max_x >= b.min_x && a.min_y <= b.max_y &&
+           a.max_y >= b.min_y;
+}
+
+}  // namespace
+
+void PointRTree::clear() {
+    count = 0;
+    boxes.clear();
+    refs.clear();
+    level_ends.clear();
+}
+
+void PointRTree::build(const std::vector<double>& x,
+                       const std::vector<double>& y,
+                       std::size_t node_size_) {
+    clear();
+    node_size = std::max<std::size_t>(2, node_size_);
+    count = std::min(x.size(), y.size());
+    if (count == 0)
+        return;
+
+    // Sort-Tile-Recursive: vertical slices by x, each sorted by y, so the
+    // runs of `node_size` points packed below are spatially compact.
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return x[a] < x[b]; });
+    const auto leaves = static_cast<std::size_t>(
+        std::ceil(static_cast<double>(count) / node_size));
+    const auto slices = static_cast<std::size_t>(
+        std::ceil(std::sqrt(static_cast<double>(leaves))));
+    const std::size_t per_slice = slices * node_size;
+    for (std::size_t start = 0; start < count; start += per_slice) {
+        const auto end = order.begin() +
+                         static_cast<std::ptrdiff_t>(
+                             std::min(count, start + per_slice));
+        std::sort(order.begin() + static_cast<std::ptrdiff_t>(start), end,
+                  [&](uint32_t a, uint32_t b) { return y[a] < y[b]; });
+    }
+
+    boxes.reserve(count + count / (node_size - 1) + 1);
+    refs.reserve(boxes.capacity());
+    for (uint32_t i : order) {
+        boxes.push_back(Box{x[i], y[i], x[i], y[i]});
+        refs.push_back(i);
+    }
+    level_ends.push_back(count);
+
+    // Parents of `node_size` consecutive entries, level by level, until one
+    // root is left (always at least one level above the points).
+    std::size_t level_start = 0;
+    do {
+        const std::size_t level_end = level_ends.back();
+        for (std::size_t child = level_start; child < level_end;
+             child += node_size) {
+            const std::size_t last = std::min(child + node_size, level_end);
+            Box box = boxes[child];
+            for (std::size_t i = child + 1; i < last; ++i) {
+                box.min_x = std::min(box.min_x, boxes[i].min_x);
+                box.min_y = std::min(box.min_y, boxes[i].min_y);
+                box.max_x = std::max(box.max_x, boxes[i].max_x);
+                box.max_y = std::max(box.max_y, boxes[i].max_y);
+            }
+            boxes.push_back(box);
+            refs.push_back(static_cast<uint32_t>(child));
+        }
+        level_start = level_end;
+        level_ends.push_back(boxes.size());
+    } while (level_ends.back() - level_start > 1);
+}
+
+void PointRTree::query(const Box& box, std::vector<uint32_t>& out) const {
+    if (count == 0 || !intersects(box, boxes.back()))
+        return;
+    // (entry, level) of nodes whose children still need checking.
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+    stack.emplace_back(boxes.size() - 1, level_ends.size() - 1);
+    while (!stack.empty()) {
+        const auto [node, level] = stack.back();
+        stack.pop_back();
+        const std::size_t first = refs[node];
+        const std::size_t last = std::min(first + node_size,
+                                          level_ends[level - 1]);
+        for (std::size_t i = first; i < last; ++i) {
+            if (!intersects(box, boxes[i]))
+                continue;
+            if (level == 1)
+                out.push_back(refs[i]);
+            else
+                stack.emplace_back(i, level - 1);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Static R-tree over points, packed bottom-up after sorting the points into
+// tiles (Sort-Tile-Recursive): one flat array of node boxes, no per-node
+// allocation, built in O(n log n) and queried without recursion. Rebuilt
+// as a whole when the points change.
+class PointRTree {
+public:
+    struct Box {
+        double min_x;
+        double min_y;
+        double max_x;
+        double max_y;
+    };
+
+    // Indexes points (x[i], y[i]); query() reports them by i.
+    void build(const std::vector<double>& x, const std::vector<double>& y,
+               std::size_t node_size = 16);
+    void clear();
+
+    // Appends the indices of the points inside `box` (edges included), in
+    // no particular order.
+    void query(const Box& box, std::vector<uint32_t>& out) const;
+
+    std::size_t size() const {
+        return count;
+    }
+
+private:
+    std::size_t count = 0;
+    std::size_t node_size = 16;
+    // Level 0 holds the points themselves, then every level's nodes up to
+    // the root (the last entry). For a point `refs` is its index, for a
+    // node the position of its first child in the level below.
+    std::vector<Box> boxes;
+    std::vector<uint32_t> refs;
+    std::vector<std::size_t> level_ends;
+};
@@ -6,7 +6,7 @@
 
 void SlintGLRenderableResource::bind() {
     backend.setFramebufferBinding(backend.fbo());
-    backend.setViewport(0, 0, backend.getSize());
+    backend.setViewport(0, backend.viewportY(), backend.getSize());
 }
 
 mbgl::gl::ProcAddress SlintGLBackend::getExtensionFunctionPointer(
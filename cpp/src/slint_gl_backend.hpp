@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <mbgl/gfx/renderable.hpp>
 #include <mbgl/gl/renderable_resource.hpp>
 #include <mbgl/gl/renderer_backend.hpp>
@@ -58,6 +59,14 @@ public:
     void setSize(mbgl::Size s) {
         size = s;
     }
+    // The map occupies the top of a larger, size-bucketed FBO; its viewport
+    // starts this many rows up from the bottom.
+    void setViewportY(int32_t y) {
+        viewport_y_ = y;
+    }
+    int32_t viewportY() const {
+        return viewport_y_;
+    }
 
 protected:
     // gfx::RendererBackend - Slint's context is already current, so no-ops.
@@ -71,11 +80,12 @@ protected:
         const char* name) override;
     void updateAssumedState() override {
         assumeFramebufferBinding(fbo_);
-        assumeViewport(0, 0, size);
+        assumeViewport(0, viewport_y_, size);
     }
 
 private:
     uint32_t fbo_ = 0;
+    int32_t viewport_y_ = 0;
 };
 
 // RendererFrontend mirroring GLFWRendererFrontend, but render() is driven
@@ -98,8 +108,16 @@ public:
             renderer->setObserver(&observer);
     }
 
+    // Like GLFWRendererFrontend::update(), which invalidates its view: the
+    // map changed, so the next render() draws something new.
     void update(std::shared_ptr<mbgl::UpdateParameters> params) override {
         updateParameters = std::move(params);
+        if (onUpdate)
+            onUpdate();
+    }
+
+    void setUpdateCallback(std::function<void()> callback) {
+        onUpdate = std::move(callback);
     }
 
     const mbgl::TaggedScheduler& getThreadPool() const override {
@@ -116,4 +134,5 @@ private:
     mbgl::gfx::RendererBackend& backend;
     std::unique_ptr<mbgl::Renderer> renderer;
     std::shared_ptr<mbgl::UpdateParameters> updateParameters;
+    std::function<void()> onUpdate;
 };
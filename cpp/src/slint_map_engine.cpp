@@ -0,0 +1,68 @@
+#include "slint_map_engine.hpp"
+
+#include <iostream>
+
+#include "custom_file_source.hpp"
+
+SlintMapEngine::SlintMapEngine() : SlintMapEngine(Options{}) {
+}
+
+SlintMapEngine::SlintMapEngine(Options options_)
+    : options(std::move(options_)) {
+    if (!options.use_custom_file_source)
+        return;
+
+    // FileSourceManager keeps one file source per distinct ResourceOptions,
+    // so every map of this engine ends up on the same CustomFileSource.
+    metrics = std::make_shared<mbgl::FileSourceMetrics>();
+    auto* manager = mbgl::FileSourceManager::get();
+    previous_network_factory =
+        manager->unRegisterFileSourceFactory(mbgl::FileSourceType::Network);
+    manager->registerFileSourceFactory(
+        mbgl::FileSourceType::Network,
+        [metrics = metrics](const mbgl::ResourceOptions& resourceOptions,
+                            const mbgl::ClientOptions& clientOptions)
+            -> std::unique_ptr<mbgl::FileSource> {
+            auto source = std::make_unique<mbgl::CustomFileSource>(metrics);
+            source->setResourceOptions(resourceOptions.clone());
+            source->setClientOptions(clientOptions.clone());
+            return source;
+        });
+    std::cout << "[SlintMapEngine] Using shared CustomFileSource" << std::endl;
+}
+
+SlintMapEngine::~SlintMapEngine() {
+    if (options.use_custom_file_source) {
+        auto* manager = mbgl::FileSourceManager::get();
+        manager->unRegisterFileSourceFactory(mbgl::FileSourceType::Network);
+        if (previous_network_factory) {
+            manager->registerFileSourceFactory(mbgl::FileSourceType::Network,
+                                               previous_network_factory);
+        }
+    }
+}
+
+mbgl::util::RunLoop* SlintMapEngine::run_loop() {
+#if defined(__APPLE__) && !defined(MLN_WITH_WEBGPU)
+    // macOS Metal/OpenGL: rely on winit's CFRunLoop
+    return nullptr;
+#else
+    if (!loop) {
+        loop = std::make_unique<mbgl::util::RunLoop>();
+    }
+    return loop.get();
+#endif
+}
+
+void SlintMapEngine::run_once() {
+    if (loop) {
+        loop->runOnce();
+    }
+}
+
+mbgl::ResourceOptions SlintMapEngine::resource_options() const {
+    mbgl::ResourceOptions resourceOptions;
+    resourceOptions.withCachePath(options.cache_path)
+        .withAssetPath(options.asset_path);
+    return resourceOptions;
+}
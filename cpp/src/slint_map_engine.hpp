@@ -0,0 +1,59 @@
+#pragma once
+
+#include <mbgl/storage/file_source_manager.hpp>
+#include <mbgl/storage/resource_options.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <memory>
+#include <string>
+
+#include "file_source_metrics.hpp"
+
+// State shared by every SlintMapLibre created for one UI thread: the RunLoop
+// the maps are pumped with and the resource options that key MapLibre's file
+// source cache. Maps created with equal ResourceOptions get the same database
+// and online file source from mbgl::FileSourceManager, so a dashboard with
+// several MMapViews downloads and caches each tile, glyph and sprite once;
+// MapLibre's worker thread pool is process-wide already.
+//
+// Glyph atlases and sprite images are owned by each map's style and cannot
+// be shared between mbgl::Map instances; only their downloads are.
+class SlintMapEngine {
+public:
+    struct Options {
+        std::string cache_path = "cache.sqlite";
+        std::string asset_path = ".";
+        // Serve http(s) through one mbgl::CustomFileSource (with request
+        // metrics) instead of MapLibre's built-in online file source.
+        bool use_custom_file_source = false;
+    };
+
+    SlintMapEngine();
+    explicit SlintMapEngine(Options options);
+    ~SlintMapEngine();
+
+    SlintMapEngine(const SlintMapEngine&) = delete;
+    SlintMapEngine& operator=(const SlintMapEngine&) = delete;
+
+    // The RunLoop shared by this engine's maps, created on first use. Must
+    // be called on the UI thread. nullptr where the platform event loop is
+    // used instead (macOS without WebGPU, see SlintMapLibre::create_map).
+    mbgl::util::RunLoop* run_loop();
+
+    // Processes pending work for all maps of this engine once.
+    void run_once();
+
+    mbgl::ResourceOptions resource_options() const;
+
+    // Request metrics of the shared CustomFileSource (empty unless
+    // use_custom_file_source is set).
+    const std::shared_ptr<mbgl::FileSourceMetrics>& file_source_metrics()
+        const {
+        return metrics;
+    }
+
+private:
+    Options options;
+    std::unique_ptr<mbgl::util::RunLoop> loop;
+    std::shared_ptr<mbgl::FileSourceMetrics> metrics;
+    mbgl::FileSourceManager::FileSourceFactory previous_network_factory;
+};
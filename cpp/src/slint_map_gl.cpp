@@ -4,6 +4,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <mbgl/map/camera.hpp>
 #include <mbgl/map/map_options.hpp>
@@ -12,6 +13,41 @@
 #include <mbgl/style/style.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/geo.hpp>
+#include <optional>
+#include <utility>
+
+namespace {
+
+// MapLibre owns the host it is given and drops it with the layer (on
+// removal or a style change); this one forwards to the app's shared host so
+// the same host can be added to the next style.
+class SharedCustomLayerHost final : public mbgl::style::CustomLayerHost {
+public:
+    explicit SharedCustomLayerHost(
+        std::shared_ptr<mbgl::style::CustomLayerHost> host_)
+        : host(std::move(host_)) {}
+
+    void initialize() override {
+        host->initialize();
+    }
+    void render(
+        const mbgl::style::CustomLayerRenderParameters& params) override {
+        host->render(params);
+    }
+    void contextLost() override {
+        host->contextLost();
+    }
+    void deinitialize() override {
+        host->deinitialize();
+    }
+
+private:
+    std::shared_ptr<mbgl::style::CustomLayerHost> host;
+};
+
+}  // namespace
+
+SlintMapGL::SlintMapGL() = default;
 
 SlintMapGL::~SlintMapGL() {
     // Orderly shutdown: detach observer, then drop map before frontend/backend.
@@ -24,22 +60,32 @@ SlintMapGL::~SlintMapGL() {
     run_loop.reset();
 }
 
-void SlintMapGL::setup(uint32_t fbo, int w, int h,
-                       const std::string& styleUrl) {
+void SlintMapGL::setup(int w, int h, const std::string& styleUrl) {
     if (!run_loop) {
         run_loop = std::make_unique<mbgl::util::RunLoop>();
     }
 
+    std::size_t ring_size = fbo_ring_ > 0 ? fbo_ring_ : 2;
+    if (const char* e = std::getenv("MAPLIBRE_GL_FBO_RING");
+        e && fbo_ring_ == 0) {
+        int v = std::atoi(e);
+        if (v > 0)
+            ring_size = static_cast<std::size_t>(v);
+    }
+    ring.set_count(ring_size);
+    ring.set_size(w, h);
+    map_w_ = w;
+    map_h_ = h;
     backend = std::make_unique<SlintGLBackend>(
         mbgl::Size{static_cast<uint32_t>(w), static_cast<uint32_t>(h)});
-    backend->setFbo(fbo);
 
     auto renderer = std::make_unique<mbgl::Renderer>(*backend, 1.0f);
     frontend = std::make_unique<SlintGLFrontend>(std::move(renderer), *backend);
 
     observer =
-        std::make_unique<SlintGLRendererObserver>([this]() { repaint = true; });
+        std::make_unique<SlintGLRendererObserver>([this]() { invalidate(); });
     frontend->setObserver(*observer);
+    frontend->setUpdateCallback([this]() { invalidate(); });
 
     mbgl::ResourceOptions ro;
     ro.withCachePath("cache.sqlite").withAssetPath(".");
@@ -52,8 +98,9 @@ void SlintMapGL::setup(uint32_t fbo, int w, int h,
             .withPixelRatio(1.0f),
         ro);
 
-    std::cout << "[SlintMapGL] setup fbo=" << fbo << " size=" << w << "x" << h
-              << " style=" << styleUrl << std::endl;
+    std::cout << "[SlintMapGL] setup size=" << w << "x" << h
+              << " fbo_ring=" << ring.count() << " style=" << styleUrl
+              << std::endl;
 
     if (const char* e = std::getenv("MAPLIBRE_FLY_MS")) {
         int v = std::atoi(e);
@@ -61,23 +108,108 @@ void SlintMapGL::setup(uint32_t fbo, int w, int h,
             fly_ms_ = v;
     }
 
-    map->getStyle().loadURL(styleUrl);
+    if (!styleUrl.empty())
+        map->getStyle().loadURL(styleUrl);
     map->jumpTo(mbgl::CameraOptions()
                     .withCenter(mbgl::LatLng{35.681, 139.767})
                     .withZoom(10.0));
 }
 
-void SlintMapGL::render() {
+void SlintMapGL::invalidate() {
+    if (!repaint.exchange(true) && on_redraw_needed)
+        on_redraw_needed();
+}
+
+void SlintMapGL::release_gl() {
+    ring.destroy();
+}
+
+void SlintMapGL::frame_composited() {
+    ring.fence_front();
+}
+
+void SlintMapGL::resize(int w, int h) {
+    if (w <= 0 || h <= 0)
+        return;
+    resize_pending_ = w != map_w_ || h != map_h_;
+    pending_w_ = w;
+    pending_h_ = h;
+    resize_requested_ = std::chrono::steady_clock::now();
+}
+
+bool SlintMapGL::resize_due() const {
+    if (!resize_pending_)
+        return false;
+    const auto waited = std::chrono::steady_clock::now() - resize_requested_;
+    return waited >= resize_debounce;
+}
+
+void SlintMapGL::apply_resize() {
+    if (!map || !backend)
+        return;
+    resize_pending_ = false;
+    map_w_ = pending_w_;
+    map_h_ = pending_h_;
+    // Buffers follow as they are acquired; the front one keeps its frame.
+    ring.set_size(map_w_, map_h_);
+    const mbgl::Size size{static_cast<uint32_t>(map_w_),
+                          static_cast<uint32_t>(map_h_)};
+    backend->setSize(size);
+    map->setSize(size);
+    std::cout << "[SlintMapGL] resize " << map_w_ << "x" << map_h_
+              << std::endl;
+}
+
+void SlintMapGL::poll() {
     if (run_loop) {
         run_loop->runOnce();
     }
-    if (frontend) {
-        frontend->render();
+    if (resize_due())
+        invalidate();
+}
+
+bool SlintMapGL::render(bool force) {
+    poll();
+    return draw(force);
+}
+
+bool SlintMapGL::draw(bool force) {
+    if (resize_due())
+        apply_resize();
+    // Show what the previous call drew; Slint composites it this frame.
+    bool changed = ring.present();
+    // Cleared before drawing: a frame that leaves work behind (an animation,
+    // fading symbols) invalidates again from onDidFinishRenderingFrame.
+    const bool stale = repaint.exchange(false);
+    if (!frontend || !(stale || force))
+        return changed;
+
+    GLRenderTarget& back = ring.acquire();
+    backend->setFbo(back.fbo());
+    backend->setViewportY(back.layout().viewport_y());
+    frontend->render();
+    ring.submit();
+    if (ring.count() > 1) {
+        // The new frame is shown by the next render(); make sure it happens
+        // when the map changed. A frame drawn only because of `force` looks
+        // like the shown one and can wait for the next frame Slint draws;
+        // asking for one would keep Slint drawing on a static map.
+        if (stale && on_redraw_needed)
+            on_redraw_needed();
+    } else {
+        changed = true;
     }
+
     if ((frame_count_++ % 300) == 0) {
+        const auto& stats = ring.stats();
         std::cout << "[SlintMapGL] render frame=" << frame_count_
-                  << " style_loaded=" << style_loaded.load() << std::endl;
+                  << " style_loaded=" << style_loaded.load()
+                  << " fence_waits=" << stats.fence_waits << " ("
+                  << stats.fence_wait_ms << " ms)" << std::endl;
     }
+    // The features under a pixel may have moved.
+    pick_cache_.begin_frame(static_cast<uint64_t>(frame_count_));
+    return changed;
 }
 
 // --- Pointer / touch interaction ---
@@ -110,7 +242,7 @@ void SlintMapGL::handle_mouse_move(float x, float y, bool pressed) {
     map->moveBy(cur - last_pos);
     last_pos = cur;
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::handle_wheel_zoom(float x, float y, float dy) {
@@ -120,7 +252,7 @@ void SlintMapGL::handle_wheel_zoom(float x, float y, float dy) {
     double scale = (dy < 0.0) ? step : (1.0 / step);
     map->scaleBy(scale, mbgl::ScreenCoordinate{x, y});
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::handle_double_click(float x, float y, bool shift) {
@@ -132,7 +264,7 @@ void SlintMapGL::handle_double_click(float x, float y, bool shift) {
     z = std::min(max_zoom_, std::max(min_zoom_, z));
     map->jumpTo(mbgl::CameraOptions().withCenter(ll).withZoom(z));
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
 }
 
 // --- Toolbar commands ---
@@ -140,7 +272,14 @@ void SlintMapGL::setStyleUrl(const std::string& url) {
     if (map) {
         std::cout << "[SlintMapGL] style change: " << url << std::endl;
         map->getStyle().loadURL(url);
-        repaint = true;
+        invalidate();
+    }
+}
+
+void SlintMapGL::setStyleJSON(const std::string& json) {
+    if (map) {
+        map->getStyle().loadJSON(json);
+        invalidate();
     }
 }
 
@@ -153,7 +292,7 @@ void SlintMapGL::fly_to(double lat, double lon, double zoom) {
         mbgl::CameraOptions().withCenter(mbgl::LatLng{lat, lon}).withZoom(zoom),
         anim);
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::set_zoom(double zoom) {
@@ -161,7 +300,7 @@ void SlintMapGL::set_zoom(double zoom) {
         return;
     map->jumpTo(mbgl::CameraOptions().withZoom(zoom));
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::set_pitch(double pitch) {
@@ -169,7 +308,7 @@ void SlintMapGL::set_pitch(double pitch) {
         return;
     map->jumpTo(mbgl::CameraOptions().withPitch(pitch));
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::set_bearing(double bearing) {
@@ -177,18 +316,133 @@ void SlintMapGL::set_bearing(double bearing) {
         return;
     map->jumpTo(mbgl::CameraOptions().withBearing(bearing));
     map->triggerRepaint();
-    repaint = true;
+    invalidate();
+}
+
+uint64_t SlintMapGL::request_pick(float x, float y, bool hover,
+                                  PickCallback callback) {
+    const uint64_t id = next_pick_id_++;
+    if (hover) {
+        // Only the latest hover position matters.
+        auto it = std::find_if(pick_requests_.begin(), pick_requests_.end(),
+                               [](const PickRequest& r) { return r.hover; });
+        if (it != pick_requests_.end()) {
+            *it = PickRequest{id, x, y, true, std::move(callback)};
+            return id;
+        }
+    }
+    pick_requests_.push_back(
+        PickRequest{id, x, y, hover, std::move(callback)});
+    return id;
+}
+
+std::size_t SlintMapGL::answer_picks() {
+    if (pick_requests_.empty())
+        return 0;
+    // Callbacks may queue new requests; those wait for the next call.
+    std::vector<PickRequest> requests;
+    requests.swap(pick_requests_);
+    auto* renderer = frontend ? frontend->getRenderer() : nullptr;
+    for (auto& request : requests) {
+        PickResult result;
+        result.id = request.id;
+        result.hover = request.hover;
+        result.x = request.x;
+        result.y = request.y;
+        result.frame = pick_cache_.frame();
+        if (map) {
+            const mbgl::LatLng ll = map->latLngForPixel(
+                mbgl::ScreenCoordinate{request.x, request.y});
+            result.lat = ll.latitude();
+            result.lon = ll.longitude();
+        }
+        if (const auto* cached = pick_cache_.find(request.x, request.y)) {
+            result.features = *cached;
+            result.cached = true;
+        } else if (renderer && style_loaded.load()) {
+            const auto start = std::chrono::steady_clock::now();
+            try {
+                result.features = query_picked_features(
+                    *renderer, request.x, request.y, pick_radius_, {});
+            } catch (const std::exception& e) {
+                std::cout << "[SlintMapGL] queryRenderedFeatures failed: "
+                          << e.what() << std::endl;
+            }
+            result.query_ms = std::chrono::duration<double, std::milli>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+            pick_cache_.insert(request.x, request.y, result.features);
+        }
+        if (request.callback)
+            request.callback(result);
+    }
+    return requests.size();
+}
+
+bool SlintMapGL::add_custom_layer(
+    const std::string& id, std::shared_ptr<mbgl::style::CustomLayerHost> host,
+    const std::string& before) {
+    if (!host)
+        return false;
+    for (const auto& entry : custom_layers_) {
+        if (entry.id == id)
+            return false;
+    }
+    custom_layers_.push_back({id, std::move(host), before});
+    attach_custom_layers();
+    return true;
+}
+
+bool SlintMapGL::remove_custom_layer(const std::string& id) {
+    auto it = std::find_if(
+        custom_layers_.begin(), custom_layers_.end(),
+        [&](const CustomLayerEntry& entry) { return entry.id == id; });
+    if (it == custom_layers_.end())
+        return false;
+    custom_layers_.erase(it);
+    if (map && map->getStyle().getLayer(id)) {
+        map->getStyle().removeLayer(id);
+        invalidate();
+    }
+    return true;
+}
+
+void SlintMapGL::attach_custom_layers() {
+    if (!map || !style_loaded)
+        return;
+    auto& style = map->getStyle();
+    bool added = false;
+    for (const auto& entry : custom_layers_) {
+        if (style.getLayer(entry.id))
+            continue;
+        std::optional<std::string> before;
+        if (!entry.before.empty() && style.getLayer(entry.before))
+            before = entry.before;
+        auto layer = std::make_unique<mbgl::style::CustomLayer>(
+            entry.id, std::make_unique<SharedCustomLayerHost>(entry.host));
+        try {
+            style.addLayer(std::move(layer), before);
+            added = true;
+        } catch (const std::exception& e) {
+            std::cout << "[SlintMapGL] custom layer " << entry.id
+                      << " not added: " << e.what() << std::endl;
+        }
+    }
+    if (added)
+        invalidate();
 }
 
 void SlintMapGL::onWillStartLoadingMap() {
     std::cout << "[MapObserver] Will start loading map" << std::endl;
     style_loaded = false;
     map_idle = false;
+    pick_cache_.clear();
 }
 
 void SlintMapGL::onDidFinishLoadingStyle() {
     std::cout << "[MapObserver] Did finish loading style" << std::endl;
     style_loaded = true;
+    attach_custom_layers();
 }
 
 void SlintMapGL::onDidBecomeIdle() {
@@ -218,14 +472,14 @@ void SlintMapGL::onDidFailLoadingMap(mbgl::MapLoadError error,
 }
 
 void SlintMapGL::onCameraDidChange(CameraChangeMode) {
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::onSourceChanged(mbgl::style::Source&) {
-    repaint = true;
+    invalidate();
 }
 
 void SlintMapGL::onDidFinishRenderingFrame(const RenderFrameStatus& status) {
     if (status.needsRepaint)
-        repaint = true;
+        invalidate();
 }
@@ -2,15 +2,20 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/map_observer.hpp>
 #include <mbgl/renderer/renderer_observer.hpp>
+#include <mbgl/style/layers/custom_layer.hpp>
 #include <mbgl/util/run_loop.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "feature_pick.hpp"
+#include "gl_framebuffer_ring.hpp"
 #include "slint_gl_backend.hpp"
 
 // No-op observer used during orderly shutdown.
@@ -45,14 +50,76 @@ private:
 
 class SlintMapGL : public mbgl::MapObserver {
 public:
-    SlintMapGL() = default;
+    // Out of line, like the destructor: the observers' vtables then stay in
+    // the -fno-rtti library, so consumers built with RTTI can link it.
+    SlintMapGL();
     ~SlintMapGL() override;
 
-    // Called from Slint's RenderingSetup (GL context current).
-    void setup(uint32_t fbo, int w, int h, const std::string& styleUrl);
+    // Called from Slint's RenderingSetup (GL context current). Sets up the
+    // FBO ring for a w x h map (physical pixels) and the map itself. The ring
+    // has MAPLIBRE_GL_FBO_RING buffers (1-3, default 2) unless
+    // set_fbo_ring() chose. An empty styleUrl loads no style.
+    void setup(int w, int h, const std::string& styleUrl);
 
-    // Called from Slint's BeforeRendering (GL context current).
-    void render();
+    // FBO ring length for the next setup(); 0 uses MAPLIBRE_GL_FBO_RING.
+    void set_fbo_ring(std::size_t count) {
+        fbo_ring_ = count;
+    }
+
+    // Called from Slint's RenderingTeardown (GL context current).
+    void release_gl();
+
+    // Requests a new map size. Applied on the first render() after the size
+    // has been stable for `resize_debounce`, so a drag-resize re-lays out the
+    // map once rather than per event; until then Slint scales the last frame.
+    void resize(int w, int h);
+
+    // The texture Slint should show (0 before the first frame) and the part
+    // of it holding the map. With a multi-buffer ring the texture alternates
+    // from frame to frame.
+    GLuint texture() const {
+        const GLRenderTarget* front = ring.front();
+        return front ? front->texture() : 0;
+    }
+    FramebufferLayout frame_layout() const {
+        const GLRenderTarget* front = ring.front();
+        return front ? front->layout() : FramebufferLayout{};
+    }
+
+    // Called from Slint's BeforeRendering (GL context current). Runs pending
+    // map work and shows the frame drawn last time; then, if the map changed
+    // (or `force`), draws a new frame into a back buffer. When the map
+    // changed it also requests the redraw that will show it; a frame drawn
+    // only because of `force` waits for the next frame Slint draws. With a
+    // one-buffer ring the new frame is shown immediately. Returns whether
+    // texture() changed.
+    bool render(bool force = false);
+    // render() without the poll(), for a host that already polled this
+    // frame (to decide from needs_render() whether to draw at all).
+    bool draw(bool force = false);
+
+    // Called from Slint's AfterRendering: fences the texture Slint just
+    // sampled so it is not drawn into before the GPU is done with it.
+    void frame_composited();
+
+    const GLFramebufferRing::Stats& ring_stats() const {
+        return ring.stats();
+    }
+
+    // Runs pending map work (tile loads, style parsing, animations) without
+    // drawing; call it from a timer so the map progresses between redraws.
+    void poll();
+
+    // True while the shown frame is stale or a drawn one awaits showing.
+    bool needs_render() const {
+        return repaint.load() || ring.has_pending();
+    }
+
+    // Called on the UI thread whenever the map goes from clean to stale; the
+    // host should request a redraw from it.
+    void set_redraw_callback(std::function<void()> callback) {
+        on_redraw_needed = std::move(callback);
+    }
 
     bool style_is_loaded() const {
         return style_loaded.load();
@@ -67,11 +134,34 @@ public:
 
     // Commands from the toolbar (dropdown / buttons / sliders).
     void setStyleUrl(const std::string& url);
+    void setStyleJSON(const std::string& json);
     void fly_to(double lat, double lon, double zoom);
     void set_zoom(double zoom);
     void set_pitch(double pitch);
     void set_bearing(double bearing);
 
+    // Click and hover picking, as SlintMapLibre::request_pick(): the
+    // request is queued and answer_picks() (called outside Slint's
+    // rendering, e.g. from the poll timer) runs the query against the last
+    // drawn frame. A hover replaces a hover still queued, and positions
+    // already queried in the current frame come from a PickCache.
+    using PickCallback = std::function<void(const PickResult&)>;
+    uint64_t request_pick(float x, float y, bool hover,
+                          PickCallback callback);
+    std::size_t answer_picks();
+
+    // App GL drawing inside the map's own render pass (e.g.
+    // GLPointCloudLayer): MapLibre calls the host between its layers, into
+    // the same FBO, so the result reaches Slint with the map's texture. The
+    // layer goes below `before` when the style has it, on top otherwise,
+    // and is added again whenever a style finishes loading. The host is
+    // shared so the app can keep it for its stats or data. False if `id` is
+    // taken.
+    bool add_custom_layer(const std::string& id,
+                          std::shared_ptr<mbgl::style::CustomLayerHost> host,
+                          const std::string& before = {});
+    bool remove_custom_layer(const std::string& id);
+
     // MapObserver overrides
     void onWillStartLoadingMap() override;
     void onDidFinishLoadingStyle() override;
@@ -83,7 +173,15 @@ public:
     void onDidFinishRenderingFrame(const RenderFrameStatus&) override;
 
 private:
+    // Marks the FBO stale and notifies the host on the first change.
+    void invalidate();
+    bool resize_due() const;
+    void apply_resize();
+    // Adds the custom layers the current style does not have yet.
+    void attach_custom_layers();
+
     std::unique_ptr<mbgl::util::RunLoop> run_loop;
+    GLFramebufferRing ring;
     std::unique_ptr<SlintGLBackend> backend;
     std::unique_ptr<SlintGLFrontend> frontend;
     std::unique_ptr<SlintGLRendererObserver> observer;
@@ -92,15 +190,44 @@ private:
 
     std::atomic<bool> style_loaded{false};
     std::atomic<bool> map_idle{false};
-    std::atomic<bool> repaint{false};
+    std::atomic<bool> repaint{true};
+    std::function<void()> on_redraw_needed;
     bool fallback_style_applied{false};
 
+    struct CustomLayerEntry {
+        std::string id;
+        std::shared_ptr<mbgl::style::CustomLayerHost> host;
+        std::string before;
+    };
+    std::vector<CustomLayerEntry> custom_layers_;
+
+    struct PickRequest {
+        uint64_t id;
+        float x;
+        float y;
+        bool hover;
+        PickCallback callback;
+    };
+    std::vector<PickRequest> pick_requests_;
+    uint64_t next_pick_id_ = 1;
+    PickCache pick_cache_;
+    static constexpr float pick_radius_ = 3.0f;
+
     mbgl::Point<double> last_pos{};
     double min_zoom_ = 0.0;
     double max_zoom_ = 22.0;
     int frame_count_ = 0;
     int fly_ms_ = 2500;  // flyTo duration; override with MAPLIBRE_FLY_MS
 
+    static constexpr std::chrono::milliseconds resize_debounce{100};
+    std::size_t fbo_ring_ = 0;
+    int map_w_ = 0;
+    int map_h_ = 0;
+    bool resize_pending_ = false;
+    int pending_w_ = 0;
+    int pending_h_ = 0;
+    std::chrono::steady_clock::time_point resize_requested_{};
+
     // Manual double-tap detection (touchscreens rarely emit Slint
     // double-clicked).
     std::chrono::steady_clock::time_point last_tap_{};
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mbgl/map/camera.hpp>
+#include <mbgl/util/geo.hpp>
+#include <memory>
+#include <slint.h>
+#include <string>
+#include <vector>
+
+#include "feature_model.hpp"
+#include "feature_pick.hpp"
+#include "marker_layer.hpp"
+#include "slint_map_engine.hpp"
+#include "slint_maplibre_headless.hpp"
+
+// Brings a persistent model of the application's MMapMarker up to date with
+// layer.visible(), row by row: Slint keeps the instances of rows that stay
+// and only updates their bindings, instead of recreating every marker.
+// Marker IDs are 64-bit and Slint's int is 32-bit, so an ID out of its range
+// is shown as -1 rather than truncated onto another marker's; `index` (into
+// layer.markers()) identifies every marker.
+template <typename Marker>
+void sync_marker_model(slint::VecModel<Marker>& model,
+                       const MarkerLayer& layer) {
+    const auto& visible = layer.visible();
+    const auto& markers = layer.markers();
+    constexpr auto kMaxId =
+        static_cast<uint64_t>(std::numeric_limits<int>::max());
+    for (std::size_t row = 0; row < visible.size(); ++row) {
+        const auto& shown = visible[row];
+        Marker marker;
+        marker.id = shown.id <= kMaxId ? static_cast<int>(shown.id) : -1;
+        marker.index = static_cast<int>(shown.index);
+        marker.x = shown.x;
+        marker.y = shown.y;
+        if (!markers.kind.empty())
+            marker.kind = markers.kind[shown.index];
+        if (!markers.labels.empty())
+            marker.label = slint::SharedString(markers.labels[shown.index]);
+        if (row < model.row_count())
+            model.set_row_data(row, marker);
+        else
+            model.push_back(std::move(marker));
+    }
+    while (model.row_count() > visible.size())
+        model.erase(model.row_count() - 1);
+}
+
+// Connects MMapAdapter's per-view API (MMapView with `map-id >= 0`) to one
+// SlintMapLibre per view, all created from the same SlintMapEngine. Header
+// only because MMapAdapter and MMapViewState are generated into each
+// application's Slint header:
+//
+//   auto views = SlintMapViews<MapWindow, MMapAdapter, MMapViewState>::bind(
+//       main_window, engine);
+//   main_window->global<MMapAdapter>().on_tick([=] { views->tick(); });
+//
+// The default view (`map-id: -1`) keeps using the scalar MMapAdapter API and
+// is wired separately (see cpp/main.cpp).
+template <typename Window, typename Adapter, typename ViewState>
+class SlintMapViews {
+public:
+    static std::shared_ptr<SlintMapViews> bind(
+        const slint::ComponentHandle<Window>& window,
+        std::shared_ptr<SlintMapEngine> engine) {
+        auto self = std::shared_ptr<SlintMapViews>(
+            new SlintMapViews(window, std::move(engine)));
+        self->weak_self = self;
+        self->connect();
+        return self;
+    }
+
+    // Pumps the shared run loop once, then advances every view (animation,
+    // finished GeoJSON loads and snapshots), renders it when needed, and
+    // answers its pick requests after the frame.
+    // Call from MMapAdapter.tick. Pass `pump_run_loop = false` when the
+    // default view's run_map_loop() already pumped the engine this tick.
+    void tick(bool pump_run_loop = true) {
+        if (pump_run_loop)
+            engine->run_once();
+        for (std::size_t id = 0; id < views.size(); ++id) {
+            auto& view = views[id];
+            if (!view.map || !view.initialized)
+                continue;
+            view.map->deliver_async();
+            if (view.map->take_repaint_request() ||
+                view.map->consume_forced_repaint()) {
+                auto frame = view.map->render_map();
+                if (view.map->markers_changed())
+                    sync_marker_model(*view.markers, view.map->markers());
+                if (view.map->last_frame_changed())
+                    publish(id, frame);
+            }
+            view.map->answer_picks();
+        }
+    }
+
+    SlintMapLibre* map(int id) const {
+        return valid(id) ? views[static_cast<std::size_t>(id)].map.get()
+                         : nullptr;
+    }
+
+private:
+    template <typename T>
+    struct ModelRow;
+    template <typename T>
+    struct ModelRow<std::shared_ptr<slint::Model<T>>> {
+        using type = T;
+    };
+    using Marker = typename ModelRow<decltype(ViewState::markers)>::type;
+
+    struct View {
+        std::shared_ptr<SlintMapLibre> map;
+        // Set in the view's row once; synced in place from then on.
+        std::shared_ptr<slint::VecModel<Marker>> markers =
+            std::make_shared<slint::VecModel<Marker>>();
+        mbgl::CameraOptions initial_camera;
+        bool initialized = false;
+    };
+
+    SlintMapViews(const slint::ComponentHandle<Window>& window_,
+                  std::shared_ptr<SlintMapEngine> engine_)
+        : window(window_),
+          engine(std::move(engine_)),
+          model(std::make_shared<slint::VecModel<ViewState>>()) {
+    }
+
+    const Adapter& adapter() const {
+        return (*window.lock())->template global<Adapter>();
+    }
+
+    bool valid(int id) const {
+        return id >= 0 && static_cast<std::size_t>(id) < views.size() &&
+               views[static_cast<std::size_t>(id)].map;
+    }
+
+    SlintMapLibre* initialized_map(int id) const {
+        return valid(id) && views[static_cast<std::size_t>(id)].initialized
+                   ? views[static_cast<std::size_t>(id)].map.get()
+                   : nullptr;
+    }
+
+    void ensure_row(std::size_t id) {
+        if (views.size() <= id) {
+            views.resize(id + 1);
+        }
+        while (model->row_count() <= id) {
+            ViewState state;
+            state.markers = views[model->row_count()].markers;
+            model->push_back(state);
+        }
+    }
+
+    void publish(std::size_t id, const slint::Image& frame) {
+        ViewState state = model->row_data(id).value_or(ViewState{});
+        state.frame = frame;
+        const auto& map = *views[id].map;
+        if (auto* m = map.get_map()) {
+            const auto cam = m->getCameraOptions();
+            if (cam.center) {
+                state.current_lat = static_cast<float>(cam.center->latitude());
+                state.current_lon =
+                    static_cast<float>(cam.center->longitude());
+            }
+            if (cam.zoom)
+                state.current_zoom = static_cast<float>(*cam.zoom);
+            if (cam.bearing)
+                state.current_bearing = static_cast<float>(*cam.bearing);
+            if (cam.pitch)
+                state.current_pitch = static_cast<float>(*cam.pitch);
+        }
+        state.style_loaded = map.style_is_loaded();
+        state.map_idle = map.map_is_idle();
+        model->set_row_data(id, state);
+    }
+
+    // Runs from answer_picks(), inside tick().
+    void picked(std::size_t id, const PickResult& result) {
+        if (id >= static_cast<std::size_t>(model->row_count()))
+            return;
+        ViewState state = model->row_data(id).value_or(ViewState{});
+        if (result.hover) {
+            assign_features(state.hovered_features, result.features);
+        } else {
+            state.clicked_lat = static_cast<float>(result.lat);
+            state.clicked_lon = static_cast<float>(result.lon);
+            assign_features(state.picked_features, result.features);
+            state.click_count++;
+        }
+        model->set_row_data(id, state);
+    }
+
+    template <typename Feature>
+    static void assign_features(std::shared_ptr<slint::Model<Feature>>& to,
+                                const std::vector<PickedFeature>& features) {
+        to = feature_model<Feature>(features);
+    }
+
+    void initialize(int id, const std::string& style_url, float lat,
+                    float lon, float zoom, float bearing, float pitch) {
+        if (id < 0)
+            return;
+        const auto index = static_cast<std::size_t>(id);
+        ensure_row(index);
+        auto& view = views[index];
+        if (view.map)
+            return;
+        view.map = std::make_shared<SlintMapLibre>(engine);
+        view.map->set_frame_logging(false);
+        view.initial_camera
+            .withCenter(mbgl::LatLng{static_cast<double>(lat),
+                                     static_cast<double>(lon)})
+            .withZoom(static_cast<double>(zoom))
+            .withBearing(static_cast<double>(bearing))
+            .withPitch(static_cast<double>(pitch));
+        // Start the style download before the view has a size.
+        view.map->prewarm(style_url.empty() ? SlintMapLibre::kDefaultStyleUrl
+                                            : style_url);
+    }
+
+    void resize(int id, float width, float height) {
+        const int w = static_cast<int>(width);
+        const int h = static_cast<int>(height);
+        if (!valid(id) || w <= 0 || h <= 0)
+            return;
+        auto& view = views[static_cast<std::size_t>(id)];
+        if (view.initialized) {
+            view.map->resize(w, h);
+            return;
+        }
+        view.map->initialize(w, h);
+        if (auto* m = view.map->get_map()) {
+            m->jumpTo(view.initial_camera);
+            m->triggerRepaint();
+        }
+        view.initialized = true;
+    }
+
+    void connect() {
+        const Adapter& a = adapter();
+        a.set_views(model);
+
+        // Callbacks hold a weak reference: the window owns them and must not
+        // keep this object (and its maps) alive on its own.
+        std::weak_ptr<SlintMapViews> weak = weak_self;
+        auto with = [weak](int id, auto&& fn) {
+            if (auto self = weak.lock()) {
+                if (auto* map = self->initialized_map(id))
+                    fn(*map);
+            }
+        };
+
+        a.on_view_initialized([weak](int id, const slint::SharedString& url,
+                                     float lat, float lon, float zoom,
+                                     float bearing, float pitch) {
+            if (auto self = weak.lock()) {
+                self->initialize(id, std::string(url.data(), url.size()), lat,
+                                 lon, zoom, bearing, pitch);
+            }
+        });
+        a.on_view_resized([weak](int id, float w, float h) {
+            if (auto self = weak.lock())
+                self->resize(id, w, h);
+        });
+
+        a.on_view_mouse_pressed([with](int id, float x, float y) {
+            with(id, [&](SlintMapLibre& m) { m.handle_mouse_press(x, y); });
+        });
+        a.on_view_mouse_released([with](int id, float x, float y) {
+            with(id, [&](SlintMapLibre& m) { m.handle_mouse_release(x, y); });
+        });
+        a.on_view_mouse_moved([with](int id, float x, float y) {
+            with(id,
+                 [&](SlintMapLibre& m) { m.handle_mouse_move(x, y, true); });
+        });
+        a.on_view_wheel_zoomed([with](int id, float x, float y, float dy) {
+            with(id,
+                 [&](SlintMapLibre& m) { m.handle_wheel_zoom(x, y, dy); });
+        });
+        a.on_view_double_clicked([with](int id, float x, float y, bool shift) {
+            with(id, [&](SlintMapLibre& m) {
+                m.handle_double_click(x, y, shift);
+            });
+        });
+
+        auto pick = [weak](int id, float x, float y, bool hover) {
+            auto self = weak.lock();
+            if (!self)
+                return;
+            if (auto* map = self->initialized_map(id)) {
+                map->request_pick(
+                    x, y, hover, [weak, id](const PickResult& result) {
+                        if (auto self = weak.lock())
+                            self->picked(static_cast<std::size_t>(id), result);
+                    });
+            }
+        };
+        a.on_view_map_clicked([pick](int id, float x, float y) {
+            pick(id, x, y, false);
+        });
+        a.on_view_mouse_hovered([pick](int id, float x, float y) {
+            pick(id, x, y, true);
+        });
+
+        a.on_view_request_style_change(
+            [with](int id, const slint::SharedString& url) {
+                with(id, [&](SlintMapLibre& m) {
+                    m.setStyleUrl(std::string(url.data(), url.size()));
+                });
+            });
+        a.on_view_request_fly_to(
+            [with](int id, float lat, float lon, float zoom) {
+                with(id, [&](SlintMapLibre& m) {
+                    m.fly_to(static_cast<double>(lat),
+                             static_cast<double>(lon),
+                             static_cast<double>(zoom));
+                });
+            });
+        // Same unit conversions as the default view in cpp/main.cpp.
+        a.on_view_request_pitch_change([with](int id, float pitch) {
+            with(id, [&](SlintMapLibre& m) {
+                m.set_pitch(static_cast<int>(pitch / 60.0f * 100.0f));
+            });
+        });
+        a.on_view_request_bearing_change([with](int id, float bearing) {
+            with(id, [&](SlintMapLibre& m) {
+                m.set_bearing(bearing / 360.0f * 100.0f);
+            });
+        });
+    }
+
+    slint::ComponentWeakHandle<Window> window;
+    std::shared_ptr<SlintMapEngine> engine;
+    std::shared_ptr<slint::VecModel<ViewState>> model;
+    std::vector<View> views;
+    std::weak_ptr<SlintMapViews> weak_self;
+};
@@ -4,19 +4,43 @@
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <string_view>
+#include <type_traits>
 
+#include "embedded_file_source.hpp"
+#include "frame_damage.hpp"
+#include "json_conversion.hpp"
 #include "mbgl/gfx/backend_scope.hpp"
 #include "mbgl/map/bound_options.hpp"
 #include "mbgl/map/camera.hpp"
+#include "mbgl/renderer/query.hpp"
+#include "mbgl/renderer/renderer.hpp"
+#include "mbgl/storage/file_source_manager.hpp"
+#include "mbgl/storage/resource.hpp"
+#include "mbgl/storage/response.hpp"
+#include "mbgl/style/conversion/layer.hpp"
+#include "mbgl/style/conversion/source.hpp"
+#include "mbgl/style/layer.hpp"
+#include "mbgl/style/layers/background_layer.hpp"
+#include "mbgl/style/source.hpp"
+#include "mbgl/style/sources/geojson_source.hpp"
 #include "mbgl/style/style.hpp"
+#include "mbgl/style/transition_options.hpp"
+#include "mbgl/util/constants.hpp"
+#include "mbgl/util/feature.hpp"
 #include "mbgl/util/geo.hpp"
+#include "mbgl/util/immutable.hpp"
 #include "mbgl/util/logging.hpp"
-#include "mbgl/util/premultiply.hpp"
 
-SlintMapLibre::SlintMapLibre() {
-    // Defer RunLoop creation until initialize() when we know sizes and
-    // the UI is set up. This reduces the chance of early event-loop
-    // interactions before the window exists.
+SlintMapLibre::SlintMapLibre()
+    : created_at(std::chrono::steady_clock::now()) {
+    // Defer RunLoop creation until initialize() (or prewarm()) so no
+    // event-loop interaction happens before the caller asks for it.
+}
+
+SlintMapLibre::SlintMapLibre(std::shared_ptr<SlintMapEngine> engine_)
+    : engine(std::move(engine_)),
+      created_at(std::chrono::steady_clock::now()) {
 }
 
 SlintMapLibre::~SlintMapLibre() {
@@ -34,25 +58,99 @@ SlintMapLibre::~SlintMapLibre() {
 void SlintMapLibre::initialize(int w, int h) {
     width = w;
     height = h;
+    if (input_recorder) {
+        input_recorder->record(InputEventType::Resize, static_cast<float>(w),
+                               static_cast<float>(h));
+    }
 
     std::cout << "[SlintMapLibre] initialize(" << w << "," << h << ")"
               << std::endl;
 
+    if (map) {
+        // Pre-warmed: the map, frontend and style load already exist, only
+        // the size-dependent part is left.
+        apply_size();
+        std::cout << "[SlintMapLibre] Map initialization completed "
+                     "(pre-warmed)"
+                  << std::endl;
+        return;
+    }
+
+    create_map(w, h);
+
+    // Set a more reliable background color style
+    std::cout << "Setting solid background color style..." << std::endl;
+    std::string simple_style = R"JSON({
+        "version": 8,
+        "name": "solid-background",
+        "sources": {},
+        "layers": [
+            {
+                "id": "background",
+                "type": "background",
+                "paint": {
+                    "background-color": "rgb(255, 0, 0)",
+                    "background-opacity": 1.0
+                }
+            }
+        ]
+    })JSON";
+    // Try remote MapLibre demo style first; fall back to local JSON on error
+    std::cout << "Loading remote MapLibre style..." << std::endl;
+    current_style_url = kDefaultStyleUrl;
+    map->getStyle().loadURL(current_style_url);
+
+    // Set initial display position (around Tokyo)
+    // std::cout << "Setting initial map position..." << std::endl;
+    // map->jumpTo(mbgl::CameraOptions()
+    //     .withCenter(mbgl::LatLng{35.6762, 139.6503}) // Tokyo
+    //    .withZoom(10.0));
+
+    std::cout << "[SlintMapLibre] Map initialization completed" << std::endl;
+}
+
+void SlintMapLibre::prewarm(const std::string& style_url, int width_hint,
+                            int height_hint) {
+    if (map)
+        return;
+    std::cout << "[SlintMapLibre] prewarm(" << style_url << ")" << std::endl;
+
+    // A provisional size is enough to start loading; initialize() applies
+    // the real one.
+    create_map(std::max(1, width_hint), std::max(1, height_hint));
+
+    // Bring the GL context up now instead of on the first render_map().
+    if (auto* backend = frontend->getBackend()) {
+        mbgl::gfx::BackendScope scope{*backend};
+    }
+
+    // The style request runs on MapLibre's file source threads while the
+    // caller creates its window; sprite and glyph requests follow as soon as
+    // the run loop delivers the style.
+    current_style_url = style_url;
+    map->getStyle().loadURL(style_url);
+}
+
+void SlintMapLibre::create_map(int w, int h) {
     // Initialize RunLoop.
     // On macOS with Metal/OpenGL, winit manages the CFRunLoop so we skip
     // creation. With WebGPU (libuv), we always need our own RunLoop.
+    if (engine) {
+        // Shared with the engine's other maps.
+        engine->run_loop();
+    } else {
 #if defined(__APPLE__) && !defined(MLN_WITH_WEBGPU)
-    // macOS Metal/OpenGL: rely on winit's CFRunLoop
+        // macOS Metal/OpenGL: rely on winit's CFRunLoop
 #else
-    if (!run_loop) {
-        run_loop = std::make_unique<mbgl::util::RunLoop>();
-    }
+        if (!run_loop) {
+            run_loop = std::make_unique<mbgl::util::RunLoop>();
+        }
 #endif
+    }
 
     // Create HeadlessFrontend with the exact same parameters as mbgl-render
     frontend = std::make_unique<mbgl::HeadlessFrontend>(
-        mbgl::Size{static_cast<uint32_t>(width), static_cast<uint32_t>(height)},
-        1.0f);
+        mbgl::Size{static_cast<uint32_t>(w), static_cast<uint32_t>(h)}, 1.0f);
 
     // Set the observer to receive repaint requests (flag-based, UI-safe)
     m_renderer_observer = std::make_unique<SlintRendererObserver>([this]() {
@@ -62,9 +160,9 @@ void SlintMapLibre::initialize(int w, int h) {
     });
     frontend->setObserver(*m_renderer_observer);
 
-    // Set ResourceOptions same as mbgl-render
-    mbgl::ResourceOptions resourceOptions;
-    resourceOptions.withCachePath("cache.sqlite").withAssetPath(".");
+    // Set ResourceOptions same as mbgl-render. Maps of one engine use equal
+    // options and therefore share MapLibre's file sources and cache.
+    mbgl::ResourceOptions resourceOptions = resource_options();
 
     // Set MapOptions same as mbgl-render
     map = std::make_unique<mbgl::Map>(
@@ -80,56 +178,83 @@ void SlintMapLibre::initialize(int w, int h) {
     // Constrain zoom range
     map->setBounds(
         mbgl::BoundOptions().withMinZoom(min_zoom).withMaxZoom(max_zoom));
+}
 
-    // Set a more reliable background color style
-    std::cout << "Setting solid background color style..." << std::endl;
-    std::string simple_style = R"JSON({
-        "version": 8,
-        "name": "solid-background",
-        "sources": {},
-        "layers": [
-            {
-                "id": "background",
-                "type": "background",
-                "paint": {
-                    "background-color": "rgb(255, 0, 0)",
-                    "background-opacity": 1.0
-                }
-            }
-        ]
-    })JSON";
-    // Try remote MapLibre demo style first; fall back to local JSON on error
-    std::cout << "Loading remote MapLibre style..." << std::endl;
-    map->getStyle().loadURL("https://demotiles.maplibre.org/style.json");
-
-    // Set initial display position (around Tokyo)
-    // std::cout << "Setting initial map position..." << std::endl;
-    // map->jumpTo(mbgl::CameraOptions()
-    //     .withCenter(mbgl::LatLng{35.6762, 139.6503}) // Tokyo
-    //    .withZoom(10.0));
-
-    std::cout << "[SlintMapLibre] Map initialization completed" << std::endl;
+mbgl::ResourceOptions SlintMapLibre::resource_options() const {
+    if (engine) {
+        return engine->resource_options();
+    }
+    mbgl::ResourceOptions resourceOptions;
+    resourceOptions.withCachePath("cache.sqlite").withAssetPath(".");
+    return resourceOptions;
 }
 
 void SlintMapLibre::setRenderCallback(std::function<void()> callback) {
     m_renderCallback = std::move(callback);
 }
 
+void SlintMapLibre::set_input_recorder(
+    std::shared_ptr<InputRecorder> recorder) {
+    input_recorder = std::move(recorder);
+    if (input_recorder && width > 0 && height > 0) {
+        // Seed the recording with the current size so a replay starts from
+        // the same viewport.
+        input_recorder->record(InputEventType::Resize,
+                               static_cast<float>(width),
+                               static_cast<float>(height));
+    }
+}
+
+void SlintMapLibre::set_frame_observer(
+    std::function<void(const mbgl::PremultipliedImage&)> observer) {
+    frame_observer = std::move(observer);
+}
+
 // MapObserver implementation
 void SlintMapLibre::onWillStartLoadingMap() {
     std::cout << "[MapObserver] Will start loading map" << std::endl;
     style_loaded = false;
+    style_document.reset();
+    pick_cache.clear();
+    // The next style starts without the overlays; attached again once it
+    // has loaded.
+    for (auto& [id, overlay] : overlays) {
+        overlay.attached = false;
+        overlay.layer_ids.clear();
+    }
     map_idle = false;
 }
 
 void SlintMapLibre::onDidFinishLoadingStyle() {
     std::cout << "[MapObserver] Did finish loading style" << std::endl;
     style_loaded = true;
+    // A new style brings its own transition options.
+    style_transitions.reset();
+    apply_clock_transitions();
+    update_style_opacity();
+    for (auto& [id, overlay] : overlays) {
+        if (overlay.data)
+            attach_geojson(id, overlay);
+    }
+    if (style_swap_pending && style_swap.style_loaded_ms < 0.0)
+        style_swap.style_loaded_ms = ms_since_style_swap();
+    if (startup.style_loaded_ms < 0.0) {
+        startup.style_loaded_ms = ms_since_creation();
+    }
 }
 
 void SlintMapLibre::onDidBecomeIdle() {
     std::cout << "[MapObserver] Did become idle" << std::endl;
     map_idle = true;
+    if (style_swap_pending && style_swap.style_loaded_ms >= 0.0) {
+        style_swap_pending = false;
+        style_swap.idle_ms = ms_since_style_swap();
+        std::cout << "[SlintMapLibre] style swap to " << style_swap.url
+                  << ": idle after " << style_swap.idle_ms << " ms ("
+                  << (style_swap.cache_hit ? "cached" : "fetched") << ", "
+                  << style_swap.sources_kept << " source(s) kept)"
+                  << std::endl;
+    }
 }
 
 void SlintMapLibre::onDidFailLoadingMap(mbgl::MapLoadError error,
@@ -139,8 +264,21 @@ void SlintMapLibre::onDidFailLoadingMap(mbgl::MapLoadError error,
     std::cout << "    Error type: " << static_cast<int>(error) << std::endl;
     std::cout << "    What: " << what << std::endl;
     std::cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+    // Whatever loads next is a fallback, not the style at the current URL.
+    style_failed = true;
+    style_swap_pending = false;
     if (!fallback_style_applied && map) {
         fallback_style_applied = true;
+        // Prefer a style compiled into the binary over the solid background.
+        const std::string embedded_style =
+            std::string(mbgl::EmbeddedFileSource::kScheme) + "style.json";
+        if (current_style_url != embedded_style &&
+            mbgl::EmbeddedResources::contains("style.json")) {
+            std::cout << "[MapObserver] Applying fallback " << embedded_style
+                      << std::endl;
+            map->getStyle().loadURL(embedded_style);
+            return;
+        }
         std::cout << "[MapObserver] Applying fallback local JSON style"
                   << std::endl;
         const std::string fallback_json = R"JSON({
@@ -174,13 +312,213 @@ void SlintMapLibre::onDidFinishRenderingFrame(const RenderFrameStatus& status) {
 }
 
 void SlintMapLibre::setStyleUrl(const std::string& url) {
-    if (map) {
+    if (input_recorder) {
+        input_recorder->record(InputEventType::StyleChange, 0.0f, 0.0f, 0.0f,
+                               false, url);
+    }
+    if (!map)
+        return;
+    // Keep the outgoing style for switching back to it.
+    if (style_loaded.load() && !style_failed && !style_edited &&
+        !current_style_url.empty())
+        styles.insert(current_style_url, style_as_fetched.empty()
+                                             ? map->getStyle().getJSON()
+                                             : style_as_fetched);
+    current_style_url = url;
+    style_as_fetched.clear();
+    style_failed = false;
+    style_edited = false;
+    style_request.reset();
+    style_swap = StyleSwapMetrics{};
+    style_swap.url = url;
+    style_swap_start = std::chrono::steady_clock::now();
+    style_swap_pending = true;
+
+    if (const std::string* json = styles.find(url)) {
+        style_swap.cache_hit = true;
+        load_style_json(*json);
+        return;
+    }
+    if (!style_source) {
+        style_source = mbgl::FileSourceManager::get()->getFileSource(
+            mbgl::FileSourceType::ResourceLoader, resource_options());
+    }
+    if (!style_source) {
         map->getStyle().loadURL(url);
+        return;
+    }
+    style_request = style_source->request(
+        mbgl::Resource::style(url), [this, url](mbgl::Response res) {
+            if (res.notModified)
+                return;
+            // One answer is enough; MapLibre's cache revalidates it.
+            style_request.reset();
+            if (res.error || !res.data) {
+                // Let MapLibre retry and report the failure (which applies
+                // the fallback style).
+                std::cout << "[SlintMapLibre] style fetch failed: " << url
+                          << std::endl;
+                map->getStyle().loadURL(url);
+                return;
+            }
+            styles.insert(url, *res.data);
+            load_style_json(*res.data);
+        });
+}
+
+void SlintMapLibre::load_style_json(const std::string& json) {
+    style_as_fetched = json;
+    std::size_t kept = 0;
+    if (align_style_sources && style_loaded.load()) {
+        map->getStyle().loadJSON(
+            align_source_ids(json, current_style_json(), &kept));
+    } else {
+        map->getStyle().loadJSON(json);
+    }
+    style_swap.sources_kept = kept;
+}
+
+std::string SlintMapLibre::current_style_json() const {
+    return style_document ? style_document->dump()
+                          : map->getStyle().getJSON();
+}
+
+SlintMapLibre::StyleUpdateResult SlintMapLibre::update_style(
+    const std::string& json) {
+    StyleUpdateResult result;
+    if (!map) {
+        result.error = "no map";
+        return result;
+    }
+    auto next = JsonValue::parse(json, &result.error);
+    if (!next) {
+        std::cout << "[SlintMapLibre] update_style: " << result.error
+                  << std::endl;
+        return result;
+    }
+
+    StyleDiff diff;
+    if (!style_loaded.load()) {
+        diff.reload_reasons.push_back("no style loaded");
+    } else if (style_document) {
+        diff = diff_styles(*style_document, *next);
+    } else if (auto current = JsonValue::parse(map->getStyle().getJSON())) {
+        diff = diff_styles(*current, *next);
+    } else {
+        diff.reload_reasons.push_back("current style does not parse");
+    }
+
+    // Every op lands before the next render_map(), so the renderer sees
+    // them as one style update in one frame.
+    const auto t0 = std::chrono::steady_clock::now();
+    for (const auto& op : diff.ops) {
+        std::string error;
+        if (!apply_style_op(op, error)) {
+            // The style is now partway between the two; reloading it in
+            // full gets it right.
+            diff.reload_reasons.push_back(op.id + ": " + error);
+            break;
+        }
+        result.ops++;
+    }
+    result.reload_reasons = std::move(diff.reload_reasons);
+    result.applied = true;
+    if (!result.reload_reasons.empty()) {
+        std::cout << "[SlintMapLibre] update_style: reloading ("
+                  << result.reload_reasons.front() << ")" << std::endl;
+        result.reloaded = true;
+        style_edited = true;
+        // As given: the next update_style() diffs against these IDs, so
+        // they must not be aligned to the current style's.
+        map->getStyle().loadJSON(json);
+        return result;
+    }
+    style_document = std::move(*next);
+    update_style_opacity();
+    request_repaint();
+    if (frame_logging) {
+        std::cout << "[SlintMapLibre] update_style: " << result.ops
+                  << " op(s) in "
+                  << std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - t0)
+                         .count()
+                  << " ms" << std::endl;
+    }
+    return result;
+}
+
+bool SlintMapLibre::apply_style_op(const StyleOp& op, std::string& error) {
+    namespace conversion = mbgl::style::conversion;
+    auto& style = map->getStyle();
+    const conversion::Convertible value(&op.value);
+    conversion::Error conversion_error;
+    // Style throws on duplicate IDs; diff_styles() removes before adding,
+    // but an ID can still clash with something added outside the diff.
+    try {
+        switch (op.type) {
+        case StyleOp::Type::RemoveLayer:
+            style.removeLayer(op.id);
+            return true;
+        case StyleOp::Type::RemoveSource:
+            // Null when a layer still uses it, e.g. a GeoJSON overlay's.
+            if (!style.removeSource(op.id)) {
+                error = "source is still in use";
+                return false;
+            }
+            return true;
+        case StyleOp::Type::AddSource: {
+            auto source =
+                conversion::convert<std::unique_ptr<mbgl::style::Source>>(
+                    value, conversion_error, op.id);
+            if (!source)
+                break;
+            style.addSource(std::move(*source));
+            return true;
+        }
+        case StyleOp::Type::AddLayer: {
+            auto layer =
+                conversion::convert<std::unique_ptr<mbgl::style::Layer>>(
+                    value, conversion_error);
+            if (!layer)
+                break;
+            // The top of the style is the top of its own layers, which is
+            // below the overlays.
+            std::optional<std::string> before = first_overlay_layer();
+            if (!op.before.empty())
+                before = op.before;
+            style.addLayer(std::move(*layer), before);
+            return true;
+        }
+        case StyleOp::Type::SetProperty: {
+            mbgl::style::Layer* layer = style.getLayer(op.id);
+            if (!layer) {
+                error = "no such layer";
+                return false;
+            }
+            if (auto failed = layer->setProperty(op.property, value)) {
+                error = op.property + ": " + failed->message;
+                return false;
+            }
+            return true;
+        }
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
     }
+    error = conversion_error.message;
+    return false;
+}
+
+double SlintMapLibre::ms_since_style_swap() const {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - style_swap_start)
+        .count();
 }
 
 slint::Image SlintMapLibre::render_map() {
-    std::cout << "render_map() called" << std::endl;
+    if (frame_logging)
+        std::cout << "render_map() called" << std::endl;
 
     if (!map || !frontend) {
         std::cout << "ERROR: map or frontend is null" << std::endl;
@@ -189,26 +527,35 @@ slint::Image SlintMapLibre::render_map() {
 
     // Wait for style to finish loading
     if (!style_loaded.load()) {
-        std::cout << "Style not loaded yet, returning empty image" << std::endl;
+        if (frame_logging)
+            std::cout << "Style not loaded yet, returning empty image"
+                      << std::endl;
         return {};  // Return an empty image
     }
+    // One source update per moving-object layer and frame at most.
+    flush_moving_objects();
 
-    std::cout << "Style loaded, proceeding with rendering..." << std::endl;
-
-    // Use the exact same rendering method as mbgl-render
-    std::cout << "Using frontend.render(map) like mbgl-render..." << std::endl;
+    if (frame_logging) {
+        std::cout << "Style loaded, proceeding with rendering..." << std::endl;
+        // Use the exact same rendering method as mbgl-render
+        std::cout << "Using frontend.render(map) like mbgl-render..."
+                  << std::endl;
+    }
     // Ensure a valid backend scope is active for rendering (required on some
     // platforms/drivers, notably Windows) to make the GL context current.
     if (auto* backend = frontend->getBackend()) {
         mbgl::gfx::BackendScope scope{*backend};
         frontend->renderOnce(*map);
-        std::cout << "Rendered one frame, reading still image..." << std::endl;
         mbgl::PremultipliedImage rendered_image = frontend->readStillImage();
-        std::cout << "Image size: " << rendered_image.size.width << "x"
-                  << rendered_image.size.height << std::endl;
-        std::cout << "Image data pointer: "
-                  << (rendered_image.data.get() ? "valid" : "null")
-                  << std::endl;
+        if (frame_logging) {
+            std::cout << "Rendered one frame, reading still image..."
+                      << std::endl;
+            std::cout << "Image size: " << rendered_image.size.width << "x"
+                      << rendered_image.size.height << std::endl;
+            std::cout << "Image data pointer: "
+                      << (rendered_image.data.get() ? "valid" : "null")
+                      << std::endl;
+        }
 
         if (rendered_image.data == nullptr || rendered_image.size.isEmpty()) {
             std::cout << "ERROR: frontend->render() returned empty data"
@@ -216,59 +563,195 @@ slint::Image SlintMapLibre::render_map() {
             return {};
         }
 
-        std::cout << "Converting from premultiplied to unpremultiplied..."
-                  << std::endl;
-        mbgl::UnassociatedImage unpremult_image =
-            mbgl::util::unpremultiply(std::move(rendered_image));
-
-        std::cout << "Creating Slint pixel buffer..." << std::endl;
-        auto pixel_buffer = slint::SharedPixelBuffer<slint::Rgba8Pixel>(
-            unpremult_image.size.width, unpremult_image.size.height);
-
-        std::cout << "Copying unpremultiplied pixel data..." << std::endl;
-        memcpy(pixel_buffer.begin(), unpremult_image.data.get(),
-               unpremult_image.size.width * unpremult_image.size.height *
-                   sizeof(slint::Rgba8Pixel));
-
-        const uint8_t* raw_data = unpremult_image.data.get();
-        std::cout << "Pixel samples (RGBA): ";
-        for (int i = 0; i < 20 && i < unpremult_image.size.width *
-                                          unpremult_image.size.height;
-             i += 5) {
-            int offset = i * 4;
-            std::cout << "(" << (int)raw_data[offset] << ","
-                      << (int)raw_data[offset + 1] << ","
-                      << (int)raw_data[offset + 2] << ","
-                      << (int)raw_data[offset + 3] << ") ";
+        if (frame_observer) {
+            frame_observer(rendered_image);
         }
-        std::cout << std::endl;
-
-        int non_transparent_count = 0;
-        for (int i = 0;
-             i < unpremult_image.size.width * unpremult_image.size.height;
-             i++) {
-            if (raw_data[i * 4 + 3] > 0) {
-                non_transparent_count++;
+        record_startup_frame();
+
+        const int frame_w = static_cast<int>(rendered_image.size.width);
+        const int frame_h = static_cast<int>(rendered_image.size.height);
+        update_frame_buffers(std::move(rendered_image));
+        if (!last_damage.empty())
+            pick_cache.begin_frame(++frame_serial);
+        update_markers();
+
+        if (frame_logging) {
+            std::cout << "Frame damage: " << last_damage.size() << " rect(s), "
+                      << damage_area(last_damage) << " / "
+                      << (frame_w * frame_h) << " px" << std::endl;
+            std::cout << "Frame format: " << (frame_opaque ? "RGB" : "RGBA")
+                      << std::endl;
+            const uint8_t* raw_data = previous_frame.data.get();
+            std::cout << "Pixel samples (premultiplied RGBA): ";
+            for (int i = 0; i < 20 && i < frame_w * frame_h; i += 5) {
+                int offset = i * 4;
+                std::cout << "(" << (int)raw_data[offset] << ","
+                          << (int)raw_data[offset + 1] << ","
+                          << (int)raw_data[offset + 2] << ","
+                          << (int)raw_data[offset + 3] << ") ";
             }
-        }
-        std::cout << "Non-transparent pixels: " << non_transparent_count
-                  << " / "
-                  << (unpremult_image.size.width * unpremult_image.size.height)
-                  << std::endl;
+            std::cout << std::endl;
 
-        std::cout << "Image created successfully" << std::endl;
-        return slint::Image(pixel_buffer);
+            int non_transparent_count = 0;
+            for (int i = 0; i < frame_w * frame_h; i++) {
+                if (raw_data[i * 4 + 3] > 0) {
+                    non_transparent_count++;
+                }
+            }
+            std::cout << "Non-transparent pixels: " << non_transparent_count
+                      << " / " << (frame_w * frame_h) << std::endl;
+
+            std::cout << "Image created successfully" << std::endl;
+        }
+        return front_image;
     } else {
         std::cout << "ERROR: frontend->getBackend() returned null" << std::endl;
         return {};
     }
 }
 
+void SlintMapLibre::set_partial_updates(bool enabled) {
+    partial_updates = enabled;
+}
+
+void SlintMapLibre::set_opaque_fast_path(bool enabled) {
+    opaque_fast_path = enabled;
+}
+
+void SlintMapLibre::update_frame_buffers(mbgl::PremultipliedImage&& frame) {
+    const int w = static_cast<int>(frame.size.width);
+    const int h = static_cast<int>(frame.size.height);
+    const DamageRect full{0, 0, w, h};
+
+    const bool resized =
+        !previous_frame.valid() || previous_frame.size != frame.size;
+    if (resized || !partial_updates) {
+        last_damage.assign(1, full);
+    } else {
+        last_damage = diff_frames(previous_frame.data.get(), frame.data.get(),
+                                  w, h);
+    }
+    if (last_damage.empty()) {
+        // Unchanged: keep showing the same image.
+        previous_frame = std::move(frame);
+        return;
+    }
+
+    // Opaque when the style guarantees it; otherwise from the alpha of the
+    // changed rects when the rest is known to be opaque, else a full scan.
+    bool opaque = false;
+    if (opaque_fast_path) {
+        if (style_opaque) {
+            opaque = true;
+        } else if (frame_opaque && !resized) {
+            opaque = std::all_of(
+                last_damage.begin(), last_damage.end(),
+                [&](const DamageRect& rect) {
+                    return rect_is_opaque(frame.data.get(), w, rect);
+                });
+        } else {
+            opaque = rect_is_opaque(frame.data.get(), w, full);
+        }
+    }
+    if (resized || opaque != frame_opaque) {
+        // The pair taking over starts from a full frame; the other's pixels
+        // are released.
+        rgba_frames = {};
+        rgb_frames = {};
+        frame_opaque = opaque;
+    }
+
+    if (opaque)
+        write_frame(rgb_frames, frame);
+    else
+        write_frame(rgba_frames, frame);
+    previous_frame = std::move(frame);
+}
+
+template <typename Pixel>
+void SlintMapLibre::write_frame(FrameBufferPair<Pixel>& pair,
+                                const mbgl::PremultipliedImage& frame) {
+    const int w = static_cast<int>(frame.size.width);
+    const int h = static_cast<int>(frame.size.height);
+    const DamageRect full{0, 0, w, h};
+    auto add_damage = [&](std::vector<DamageRect>& stale) {
+        stale.insert(stale.end(), last_damage.begin(), last_damage.end());
+        if (stale.size() > kMaxDamageRects)
+            stale.assign(1, full);
+    };
+
+    // Write into the buffer Slint is not holding (it still shows the other
+    // one), so SharedPixelBuffer::begin() does not copy it first. That
+    // buffer is two frames old: bring it up to date with the damage it
+    // missed while the other was shown, plus this frame's.
+    const std::size_t back = 1 - pair.front;
+    auto& buffer = pair.buffers[back];
+    if (buffer.width() != frame.size.width ||
+        buffer.height() != frame.size.height) {
+        buffer = slint::SharedPixelBuffer<Pixel>(frame.size.width,
+                                                 frame.size.height);
+        pair.stale[back].assign(1, full);
+    } else {
+        add_damage(pair.stale[back]);
+    }
+    auto* dst = reinterpret_cast<uint8_t*>(buffer.begin());
+    for (const auto& rect : pair.stale[back]) {
+        if constexpr (std::is_same_v<Pixel, slint::Rgb8Pixel>)
+            pack_rgb_rect(frame.data.get(), dst, w, rect);
+        else
+            unpremultiply_rect(frame.data.get(), dst, w, rect);
+    }
+    pair.stale[back].clear();
+    add_damage(pair.stale[pair.front]);
+
+    pair.front = back;
+    front_image = slint::Image(buffer);
+}
+
+void SlintMapLibre::update_style_opacity() {
+    style_opaque = false;
+    if (!map)
+        return;
+    // One visible, unpatterned background layer with opaque colour and
+    // opacity at every zoom covers the whole frame; anything drawn over it
+    // keeps alpha at 1.
+    for (auto* layer : map->getStyle().getLayers()) {
+        if (std::string_view(layer->getTypeInfo()->type) != "background" ||
+            layer->getVisibility() != mbgl::style::VisibilityType::Visible ||
+            layer->getMinZoom() > mbgl::util::MIN_ZOOM ||
+            layer->getMaxZoom() < mbgl::util::MAX_ZOOM)
+            continue;
+        auto* background = static_cast<mbgl::style::BackgroundLayer*>(layer);
+        const auto& color = background->getBackgroundColor();
+        const auto& opacity = background->getBackgroundOpacity();
+        // Undefined means the defaults: opaque black at opacity 1.
+        const bool opaque_color =
+            color.isUndefined() ||
+            (color.isConstant() && color.asConstant().a >= 1.0f);
+        const bool opaque_opacity =
+            opacity.isUndefined() ||
+            (opacity.isConstant() && opacity.asConstant() >= 1.0f);
+        if (opaque_color && opaque_opacity &&
+            background->getBackgroundPattern().isUndefined()) {
+            style_opaque = true;
+            return;
+        }
+    }
+}
+
 void SlintMapLibre::resize(int w, int h) {
     width = w;
     height = h;
+    if (input_recorder) {
+        input_recorder->record(InputEventType::Resize, static_cast<float>(w),
+                               static_cast<float>(h));
+    }
 
-    if (frontend && map) {
+    apply_size();
+}
+
+void SlintMapLibre::apply_size() {
+    if (frontend && map && width > 0 && height > 0) {
         frontend->setSize(
             {static_cast<uint32_t>(width), static_cast<uint32_t>(height)});
         map->setSize(
@@ -276,7 +759,31 @@ void SlintMapLibre::resize(int w, int h) {
     }
 }
 
+double SlintMapLibre::ms_since_creation() const {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - created_at)
+        .count();
+}
+
+void SlintMapLibre::record_startup_frame() {
+    if (startup.first_frame_ms < 0.0) {
+        startup.first_frame_ms = ms_since_creation();
+    }
+    // "Meaningful" = the first frame rendered once the style, sources and
+    // visible tiles had all finished loading (the map reported idle).
+    if (startup.first_meaningful_frame_ms < 0.0 && map_idle.load()) {
+        startup.first_meaningful_frame_ms = ms_since_creation();
+        std::cout << "[SlintMapLibre] time-to-first-meaningful-frame: "
+                  << startup.first_meaningful_frame_ms
+                  << " ms (style loaded at " << startup.style_loaded_ms
+                  << " ms, first frame at " << startup.first_frame_ms
+                  << " ms)" << std::endl;
+    }
+}
+
 void SlintMapLibre::handle_mouse_press(float x, float y) {
+    if (input_recorder)
+        input_recorder->record(InputEventType::MousePressed, x, y);
     last_pos = {x, y};
     // Trigger a redraw after interaction starts for responsiveness
     request_repaint();
@@ -284,10 +791,14 @@ void SlintMapLibre::handle_mouse_press(float x, float y) {
 }
 
 void SlintMapLibre::handle_mouse_release(float x, float y) {
+    if (input_recorder)
+        input_recorder->record(InputEventType::MouseReleased, x, y);
     // No action needed for release
 }
 
 void SlintMapLibre::handle_mouse_move(float x, float y, bool pressed) {
+    if (input_recorder && pressed)
+        input_recorder->record(InputEventType::MouseMoved, x, y);
     if (pressed) {
         mbgl::Point<double> current_pos = {x, y};
         mbgl::Point<double> delta = current_pos - last_pos;
@@ -299,6 +810,9 @@ void SlintMapLibre::handle_mouse_move(float x, float y, bool pressed) {
 }
 
 void SlintMapLibre::handle_double_click(float x, float y, bool shift) {
+    if (input_recorder)
+        input_recorder->record(InputEventType::DoubleClicked, x, y, 0.0f,
+                               shift);
     if (!map)
         return;
     // Center the map on the clicked location and zoom by one level (+/- with
@@ -318,6 +832,8 @@ void SlintMapLibre::handle_double_click(float x, float y, bool shift) {
 }
 
 void SlintMapLibre::handle_wheel_zoom(float x, float y, float dy) {
+    if (input_recorder)
+        input_recorder->record(InputEventType::WheelZoomed, x, y, dy);
     if (!map)
         return;
     // Lower sensitivity: dy < 0 => zoom in, dy > 0 => zoom out
@@ -328,6 +844,9 @@ void SlintMapLibre::handle_wheel_zoom(float x, float y, float dy) {
 }
 
 void SlintMapLibre::set_pitch(int pitch_value) {
+    if (input_recorder)
+        input_recorder->record(InputEventType::PitchChange,
+                               static_cast<float>(pitch_value));
     if (!map)
         return;
     // Convert slider value (0-100) to pitch in degrees (0-60)
@@ -346,6 +865,8 @@ void SlintMapLibre::set_pitch(int pitch_value) {
 }
 
 void SlintMapLibre::set_bearing(float bearing_value) {
+    if (input_recorder)
+        input_recorder->record(InputEventType::BearingChange, bearing_value);
     if (!map)
         return;
     // Convert slider value (0-100) to bearing in degrees (0-360)
@@ -363,14 +884,493 @@ void SlintMapLibre::set_bearing(float bearing_value) {
     map->triggerRepaint();
 }
 
+uint64_t SlintMapLibre::request_pick(float x, float y, bool hover,
+                                     PickCallback callback) {
+    const uint64_t id = next_pick_id++;
+    if (hover) {
+        // Only the latest hover position matters.
+        auto it = std::find_if(pick_requests.begin(), pick_requests.end(),
+                               [](const PickRequest& r) { return r.hover; });
+        if (it != pick_requests.end()) {
+            *it = PickRequest{id, x, y, true, std::move(callback)};
+            return id;
+        }
+    }
+    pick_requests.push_back(PickRequest{id, x, y, hover, std::move(callback)});
+    return id;
+}
+
+std::size_t SlintMapLibre::answer_picks() {
+    if (pick_requests.empty())
+        return 0;
+    // Callbacks may queue new requests; those wait for the next call.
+    std::vector<PickRequest> requests;
+    requests.swap(pick_requests);
+    for (auto& request : requests) {
+        PickResult result;
+        result.id = request.id;
+        result.hover = request.hover;
+        result.x = request.x;
+        result.y = request.y;
+        result.frame = frame_serial;
+        if (map) {
+            const mbgl::LatLng ll = map->latLngForPixel(
+                mbgl::ScreenCoordinate{request.x, request.y});
+            result.lat = ll.latitude();
+            result.lon = ll.longitude();
+        }
+        if (const auto* cached = pick_cache.find(request.x, request.y)) {
+            result.features = *cached;
+            result.cached = true;
+        } else {
+            const auto start = std::chrono::steady_clock::now();
+            result.features = query_features(request.x, request.y);
+            result.query_ms = std::chrono::duration<double, std::milli>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+            pick_cache.insert(request.x, request.y, result.features);
+        }
+        if (request.callback)
+            request.callback(result);
+    }
+    return requests.size();
+}
+
+std::vector<PickedFeature> SlintMapLibre::query_features(float x, float y) {
+    std::vector<PickedFeature> picked;
+    if (!frontend || !style_loaded.load())
+        return picked;
+    auto* renderer = frontend->getRenderer();
+    if (!renderer)
+        return picked;
+    try {
+        picked = query_picked_features(*renderer, x, y, pick_radius,
+                                       pick_layers);
+    } catch (const std::exception& e) {
+        std::cout << "[SlintMapLibre] queryRenderedFeatures failed: "
+                  << e.what() << std::endl;
+    }
+    return picked;
+}
+
+void SlintMapLibre::set_pick_layers(std::vector<std::string> layer_ids) {
+    pick_layers = std::move(layer_ids);
+    pick_cache.clear();
+}
+
+void SlintMapLibre::set_pick_radius(float radius) {
+    pick_radius = std::max(0.0f, radius);
+    pick_cache.clear();
+}
+
+void SlintMapLibre::set_markers(MarkerPositions markers,
+                                const MarkerLayer::Options& options) {
+    marker_overlay.set_markers(std::move(markers), options);
+    markers_dirty = true;
+    request_repaint();
+}
+
+void SlintMapLibre::clear_markers() {
+    set_markers({}, marker_overlay.options());
+}
+
+void SlintMapLibre::update_markers() {
+    markers_updated = false;
+    if (!map || (!markers_dirty && marker_overlay.size() == 0))
+        return;
+    const auto cam = map->getCameraOptions();
+    MarkerViewport view;
+    if (cam.center) {
+        view.lat = cam.center->latitude();
+        view.lon = cam.center->longitude();
+    }
+    view.zoom = cam.zoom.value_or(0.0);
+    view.bearing = cam.bearing.value_or(0.0);
+    view.width = static_cast<float>(width);
+    view.height = static_cast<float>(height);
+    const double pitch = cam.pitch.value_or(0.0);
+    if (!markers_dirty && pitch == marker_pitch &&
+        view.lat == marker_view.lat && view.lon == marker_view.lon &&
+        view.zoom == marker_view.zoom && view.bearing == marker_view.bearing &&
+        view.width == marker_view.width && view.height == marker_view.height)
+        return;
+    markers_dirty = false;
+    marker_view = view;
+    marker_pitch = pitch;
+    markers_updated = true;
+    if (pitch <= 0.0) {
+        marker_overlay.update(view);
+        return;
+    }
+    // Pitched: candidates from the lon/lat box of the view's corners
+    // (clamped where they are above the horizon), placed by MapLibre. The
+    // corners are taken within 180 degrees of the centre, so a view across
+    // the antimeridian gives a box past +-180 rather than the rest of the
+    // world.
+    double west = 540.0, south = 90.0, east = -540.0, north = -90.0;
+    for (const auto& corner :
+         {mbgl::ScreenCoordinate{0.0, 0.0},
+          mbgl::ScreenCoordinate{static_cast<double>(width), 0.0},
+          mbgl::ScreenCoordinate{0.0, static_cast<double>(height)},
+          mbgl::ScreenCoordinate{static_cast<double>(width),
+                                 static_cast<double>(height)}}) {
+        const mbgl::LatLng ll = map->latLngForPixel(corner);
+        double lon = ll.longitude();
+        lon -= 360.0 * std::round((lon - view.lon) / 360.0);
+        west = std::min(west, lon);
+        east = std::max(east, lon);
+        south = std::min(south, ll.latitude());
+        north = std::max(north, ll.latitude());
+    }
+    marker_overlay.update(
+        view, west, south, east, north,
+        [this](const MarkerPositions& markers,
+               const std::vector<uint32_t>& indices, std::vector<float>& x,
+               std::vector<float>& y) {
+            std::vector<mbgl::LatLng> points;
+            points.reserve(indices.size());
+            for (uint32_t i : indices)
+                points.emplace_back(markers.lat[i], markers.lon[i]);
+            const auto pixels = map->pixelsForLatLngs(points);
+            for (std::size_t k = 0; k < pixels.size(); ++k) {
+                x[k] = static_cast<float>(pixels[k].x);
+                y[k] = static_cast<float>(pixels[k].y);
+            }
+        });
+}
+
 void SlintMapLibre::run_map_loop() {
-    if (run_loop) {
+    if (engine) {
+        engine->run_once();
+    } else if (run_loop) {
         run_loop->runOnce();
     } else {
         // Not initialized yet; nothing to pump.
     }
+    deliver_async();
+}
+
+void SlintMapLibre::deliver_async() {
     // Drive custom animation if active
     tick_animation();
+    if (geojson_loader) {
+        geojson_loader->deliver_completed();
+    }
+    if (snapshots) {
+        snapshots->deliver_completed();
+    }
+}
+
+namespace {
+
+// Whether a GeoJSON source made with `a` can take data indexed with `b`.
+bool same_geojson_options(const mbgl::style::GeoJSONOptions& a,
+                          const mbgl::style::GeoJSONOptions& b) {
+    return a.minzoom == b.minzoom && a.maxzoom == b.maxzoom &&
+           a.tileSize == b.tileSize && a.buffer == b.buffer &&
+           a.tolerance == b.tolerance && a.lineMetrics == b.lineMetrics &&
+           a.cluster == b.cluster && a.clusterRadius == b.clusterRadius &&
+           a.clusterMaxZoom == b.clusterMaxZoom &&
+           a.clusterProperties.empty() && b.clusterProperties.empty();
+}
+
+}  // namespace
+
+uint64_t SlintMapLibre::set_geojson(const std::string& id,
+                                    GeoJsonInput input,
+                                    const GeoJsonOverlayOptions& options,
+                                    GeoJsonLoader::Callback callback) {
+    std::optional<JsonValue> layers;
+    if (!options.layers_json.empty()) {
+        std::string error = "not an array";
+        layers = JsonValue::parse(options.layers_json, &error);
+        if (!layers || !layers->is_array()) {
+            std::cout << "[SlintMapLibre] set_geojson(" << id
+                      << "): bad layers: " << error << std::endl;
+            return 0;
+        }
+    }
+    // The overlay would take over the style's own source, and removing the
+    // overlay would then remove it.
+    auto existing = overlays.find(id);
+    if (map && style_loaded.load() && map->getStyle().getSource(id) &&
+        (existing == overlays.end() || !existing->second.attached)) {
+        std::cout << "[SlintMapLibre] set_geojson(" << id
+                  << "): the style has a source with this id" << std::endl;
+        return 0;
+    }
+    if (!geojson_loader)
+        geojson_loader = std::make_unique<GeoJsonLoader>();
+    const uint64_t generation = geojson_loader->load(
+        id, std::move(input),
+        mbgl::makeMutable<mbgl::style::GeoJSONOptions>(options.source),
+        [this, source = options.source,
+         callback = std::move(callback)](GeoJsonLoadResult&& result) mutable {
+            apply_geojson(result, source);
+            if (callback)
+                callback(std::move(result));
+        });
+    // Results are delivered on this thread, so no load can land before its
+    // generation is recorded.
+    if (generation) {
+        auto& overlay = overlays[id];
+        overlay.generation = generation;
+        // Kept on the overlay rather than the load, so a later load without
+        // layers that overtakes this one still applies them.
+        if (layers)
+            overlay.pending_layers = std::move(layers);
+    }
+    return generation;
+}
+
+bool SlintMapLibre::remove_geojson(const std::string& id) {
+    auto it = overlays.find(id);
+    if (it == overlays.end())
+        return false;
+    if (it->second.attached && map)
+        detach_geojson(id, it->second);
+    overlays.erase(it);
+    moving_layers.erase(id);
+    request_repaint();
+    return true;
+}
+
+bool SlintMapLibre::add_moving_objects(const std::string& id,
+                                       const GeoJsonOverlayOptions& options) {
+    const auto layers = JsonValue::parse(options.layers_json);
+    if (!layers || !layers->is_array()) {
+        std::cout << "[SlintMapLibre] add_moving_objects(" << id
+                  << "): layers must be a JSON array" << std::endl;
+        return false;
+    }
+    auto& layer = moving_layers[id];
+    layer.options = options;
+    layer.layers_sent = false;
+    // Restyling resends the layers with the next update.
+    layer.objects.touch();
+    request_repaint();
+    return true;
+}
+
+std::size_t SlintMapLibre::update_moving_objects(
+    const std::string& id, const ObjectPositions& deltas) {
+    auto it = moving_layers.find(id);
+    if (it == moving_layers.end())
+        return 0;
+    const std::size_t added = it->second.objects.apply(deltas);
+    if (it->second.objects.dirty())
+        request_repaint();
+    return added;
+}
+
+std::size_t SlintMapLibre::remove_moving_objects(
+    const std::string& id, const std::vector<uint64_t>& ids) {
+    auto it = moving_layers.find(id);
+    if (it == moving_layers.end())
+        return 0;
+    const std::size_t removed = it->second.objects.remove(ids);
+    if (removed)
+        request_repaint();
+    return removed;
+}
+
+const MovingObjects* SlintMapLibre::moving_objects(
+    const std::string& id) const {
+    auto it = moving_layers.find(id);
+    return it == moving_layers.end() ? nullptr : &it->second.objects;
+}
+
+void SlintMapLibre::flush_moving_objects() {
+    for (auto& [id, layer] : moving_layers) {
+        // One update in flight per layer: deltas arriving meanwhile are
+        // merged into the next one instead of queueing builds.
+        if (layer.in_flight || !layer.objects.dirty())
+            continue;
+        auto positions = std::make_shared<ObjectPositions>();
+        layer.objects.snapshot(*positions);
+        GeoJsonInput input;
+        input.generate = [positions] { return to_point_features(*positions); };
+        GeoJsonOverlayOptions options = layer.options;
+        if (layer.layers_sent)
+            options.layers_json.clear();
+        const std::string key = id;
+        const uint64_t generation = set_geojson(
+            key, std::move(input), options,
+            [this, key](GeoJsonLoadResult&& result) {
+                auto it = moving_layers.find(key);
+                if (it == moving_layers.end())
+                    return;
+                it->second.in_flight = false;
+                // The snapshot cleared dirty(); without this the layer
+                // would show stale positions until the next delta.
+                if (!result.data)
+                    it->second.objects.touch();
+                if (it->second.objects.dirty())
+                    request_repaint();
+            });
+        if (!generation) {
+            // Loader busy: try again next frame.
+            layer.objects.touch();
+            continue;
+        }
+        layer.in_flight = true;
+        layer.layers_sent = true;
+    }
+}
+
+void SlintMapLibre::apply_geojson(GeoJsonLoadResult& result,
+                                  const mbgl::style::GeoJSONOptions& options) {
+    auto it = overlays.find(result.id);
+    // Removed since, or overtaken by a later load.
+    if (it == overlays.end() || result.generation < it->second.generation)
+        return;
+    if (!result.data) {
+        std::cout << "[SlintMapLibre] geojson " << result.id << ": "
+                  << result.error << std::endl;
+        return;
+    }
+    if (frame_logging) {
+        std::cout << "[SlintMapLibre] geojson " << result.id << ": "
+                  << result.features << " feature(s), read "
+                  << result.read_ms << " ms, parse " << result.parse_ms
+                  << " ms, index " << result.index_ms << " ms" << std::endl;
+    }
+    auto& overlay = it->second;
+    std::optional<JsonValue> layers = std::move(overlay.pending_layers);
+    overlay.pending_layers.reset();
+    mbgl::style::GeoJSONSource* source = nullptr;
+    if (overlay.attached && map) {
+        if (auto* existing = map->getStyle().getSource(result.id))
+            source = existing->as<mbgl::style::GeoJSONSource>();
+    }
+    // Same source options: swap the index under the existing source and
+    // its loaded tiles. Otherwise the source is replaced, which takes its
+    // layers along; either way within this one pass.
+    if (source && same_geojson_options(overlay.options, options)) {
+        source->setGeoJSONData(result.data);
+        if (layers) {
+            for (const auto& layer_id : overlay.layer_ids)
+                map->getStyle().removeLayer(layer_id);
+            overlay.layer_ids.clear();
+        }
+    } else if (overlay.attached && map) {
+        detach_geojson(result.id, overlay);
+    }
+    overlay.options = options;
+    overlay.data = result.data;
+    if (layers)
+        overlay.layers = std::move(*layers);
+    if (map && style_loaded.load())
+        attach_geojson(result.id, overlay);
+}
+
+void SlintMapLibre::attach_geojson(const std::string& id,
+                                   GeoJsonOverlay& overlay) {
+    namespace conversion = mbgl::style::conversion;
+    auto& style = map->getStyle();
+    try {
+        if (style.getSource(id) && !overlay.attached) {
+            // The style's own source; detach_geojson() must not remove it.
+            std::cout << "[SlintMapLibre] geojson " << id
+                      << ": the style has a source with this id" << std::endl;
+            return;
+        }
+        if (!style.getSource(id)) {
+            auto source = std::make_unique<mbgl::style::GeoJSONSource>(
+                id, mbgl::makeMutable<mbgl::style::GeoJSONOptions>(
+                        overlay.options));
+            source->setGeoJSONData(overlay.data);
+            style.addSource(std::move(source));
+        }
+        overlay.attached = true;
+        if (!overlay.layer_ids.empty() || !overlay.layers.is_array())
+            return;
+        for (JsonValue layer : overlay.layers.as_array()) {
+            layer.set("source", id);
+            const std::string* layer_id = layer.find_string("id");
+            if (!layer_id || style.getLayer(*layer_id)) {
+                std::cout << "[SlintMapLibre] geojson " << id
+                          << ": skipping layer without a unique id"
+                          << std::endl;
+                continue;
+            }
+            conversion::Error error;
+            auto converted =
+                conversion::convert<std::unique_ptr<mbgl::style::Layer>>(
+                    conversion::Convertible(&layer), error);
+            if (!converted) {
+                std::cout << "[SlintMapLibre] geojson " << id << " layer "
+                          << *layer_id << ": " << error.message << std::endl;
+                continue;
+            }
+            overlay.layer_ids.push_back(*layer_id);
+            style.addLayer(std::move(*converted));
+        }
+    } catch (const std::exception& e) {
+        std::cout << "[SlintMapLibre] geojson " << id << ": " << e.what()
+                  << std::endl;
+    }
+    request_repaint();
+}
+
+std::optional<std::string> SlintMapLibre::first_overlay_layer() const {
+    for (const auto* layer : map->getStyle().getLayers()) {
+        for (const auto& [id, overlay] : overlays) {
+            if (std::find(overlay.layer_ids.begin(), overlay.layer_ids.end(),
+                          layer->getID()) != overlay.layer_ids.end())
+                return layer->getID();
+        }
+    }
+    return std::nullopt;
+}
+
+void SlintMapLibre::detach_geojson(const std::string& id,
+                                   GeoJsonOverlay& overlay) {
+    auto& style = map->getStyle();
+    for (const auto& layer_id : overlay.layer_ids)
+        style.removeLayer(layer_id);
+    overlay.layer_ids.clear();
+    style.removeSource(id);
+    overlay.attached = false;
+}
+
+uint64_t SlintMapLibre::request_snapshot(const mbgl::CameraOptions& camera,
+                                         int w, int h, float pixel_ratio,
+                                         SnapshotCallback callback) {
+    if (!map || w <= 0 || h <= 0 || pixel_ratio <= 0.0f)
+        return 0;
+    SnapshotRenderer::Request request;
+    // The loaded JSON (with any update_style() edits) also covers styles
+    // set with loadJSON() (e.g. the fallback style), which have no URL to
+    // reload from.
+    if (style_loaded.load()) {
+        request.style_json = current_style_json();
+    }
+    request.style_url = current_style_url;
+    if (request.style_json.empty() && request.style_url.empty())
+        return 0;
+    request.camera = camera;
+    request.width = static_cast<uint32_t>(w);
+    request.height = static_cast<uint32_t>(h);
+    request.pixel_ratio = pixel_ratio;
+
+    if (!snapshots) {
+        // Same cache and asset paths as the interactive map, so both use
+        // the same MapLibre file sources and on-disk cache.
+        const mbgl::ResourceOptions resources = resource_options();
+        SnapshotRenderer::Options options;
+        options.cache_path = resources.cachePath();
+        options.asset_path = resources.assetPath();
+        snapshots = std::make_unique<SnapshotRenderer>(options);
+    }
+    return snapshots->request(std::move(request), std::move(callback));
+}
+
+uint64_t SlintMapLibre::request_snapshot(SnapshotCallback callback) {
+    if (!map)
+        return 0;
+    return request_snapshot(map->getCameraOptions(), width, height, 1.0f,
+                            std::move(callback));
 }
 
 bool SlintMapLibre::take_repaint_request() {
@@ -401,156 +1401,70 @@ void SlintMapLibre::arm_forced_repaint_ms(int ms) {
 }
 
 void SlintMapLibre::fly_to(double lat, double lon, double target_zoom_value) {
+    if (input_recorder)
+        input_recorder->record(
+            InputEventType::FlyTo, static_cast<float>(lat),
+            static_cast<float>(lon), static_cast<float>(target_zoom_value));
     if (!map)
         return;
 
-    mbgl::LatLng target{lat, lon};
-
-    // Capture start camera
+    const mbgl::LatLng target{lat, lon};
     const auto cam = map->getCameraOptions();
-    mbgl::LatLng start_center = cam.center.value_or(target);
-    double start_zoom = cam.zoom.value_or(10.0);
-
-    auto deg2rad = [](double d) { return d * M_PI / 180.0; };
-    auto approx_distance_deg = [&](const mbgl::LatLng& a,
-                                   const mbgl::LatLng& b) {
-        double lat1r = deg2rad(a.latitude());
-        double lat2r = deg2rad(b.latitude());
-        double dlatr = lat2r - lat1r;
-        double dlonr = deg2rad(b.longitude() - a.longitude());
-        double x = dlonr * std::cos((lat1r + lat2r) * 0.5);
-        double y = dlatr;
-        return std::sqrt(x * x + y * y) * 180.0 / M_PI;
-    };
-    double dist = approx_distance_deg(start_center, target);
-    double zoom_out_delta = std::max(2.0, 8.0 + std::min(3.0, dist / 8.0));
-    double mid_zoom =
-        std::max(min_zoom, std::min(max_zoom, start_zoom - zoom_out_delta));
-
-    custom_anim.active = true;
-    custom_anim.start_center = start_center;
-    custom_anim.target_center = target;
-    custom_anim.start_zoom = start_zoom;
-    custom_anim.target_zoom = target_zoom_value;
-    custom_anim.mid_zoom = mid_zoom;
-    custom_anim.mid_ratio = 0.60;
-    custom_anim.center_hold_ratio = 0.20;
-    custom_anim.start_time = std::chrono::steady_clock::now();
-    custom_anim.duration_ms = 2500;
+    fly_anim = FlyToAnimation::plan(cam.center.value_or(target),
+                                    cam.zoom.value_or(10.0), target,
+                                    target_zoom_value, min_zoom, max_zoom);
+    fly_start = clock->now();
     request_repaint();
-    arm_forced_repaint_ms(custom_anim.duration_ms + 600);
+    arm_forced_repaint_ms(static_cast<int>(fly_anim->duration.count()) + 600);
 }
 
 void SlintMapLibre::fly_to(const std::string& location) {
     if (!map)
         return;
 
-    // Determine target
-    mbgl::LatLng target;
     if (location == "paris") {
-        target = mbgl::LatLng{48.8566, 2.3522};
+        fly_to(48.8566, 2.3522, 10.0);
     } else if (location == "new_york") {
-        target = mbgl::LatLng{40.7128, -74.0060};
+        fly_to(40.7128, -74.0060, 10.0);
     } else {  // tokyo or default
-        target = mbgl::LatLng{35.6895, 139.6917};
+        fly_to(35.6895, 139.6917, 10.0);
     }
-
-    // Capture start camera
-    const auto cam = map->getCameraOptions();
-    mbgl::LatLng start_center = cam.center.value_or(target);
-    double start_zoom = cam.zoom.value_or(10.0);
-    double target_zoom = 10.0;
-    // Dynamic zoom-out amount based on approximate great-circle distance
-    auto deg2rad = [](double d) { return d * M_PI / 180.0; };
-    auto approx_distance_deg = [&](const mbgl::LatLng& a,
-                                   const mbgl::LatLng& b) {
-        double lat1 = deg2rad(a.latitude());
-        double lat2 = deg2rad(b.latitude());
-        double dlat = lat2 - lat1;
-        double dlon = deg2rad(b.longitude() - a.longitude());
-        double x = dlon * std::cos((lat1 + lat2) * 0.5);
-        double y = dlat;
-        return std::sqrt(x * x + y * y) * 180.0 / M_PI;
-    };
-    double dist = approx_distance_deg(start_center, target);
-    // Bolder zoom-out: higher base, stronger distance gain, higher cap
-    double zoom_out_delta = 8.0 + std::min(3.0, dist / 8.0);
-    // Ensure at least a meaningful pull-back even for short hops
-    zoom_out_delta = std::max(2.0, zoom_out_delta);
-    // Plan zoom-out then zoom-in: first zoom to a lower mid level, then in
-    double mid_zoom =
-        std::max(min_zoom, std::min(max_zoom, start_zoom - zoom_out_delta));
-
-    // Setup custom animation state (2.5s)
-    custom_anim.active = true;
-    custom_anim.start_center = start_center;
-    custom_anim.target_center = target;
-    custom_anim.start_zoom = start_zoom;
-    custom_anim.target_zoom = target_zoom;
-    custom_anim.mid_zoom = mid_zoom;
-    custom_anim.mid_ratio =
-        0.60;  // 60% zoom-out, 40% zoom-in (emphasize pull-back)
-    custom_anim.center_hold_ratio = 0.20;  // keep center almost still at first
-    custom_anim.start_time = std::chrono::steady_clock::now();
-    custom_anim.duration_ms = 2500;
-    request_repaint();
-    arm_forced_repaint_ms(custom_anim.duration_ms + 600);
 }
 
-static inline double ease_in_out(double t) {
-    // Smoothstep-like cubic easing
-    return t < 0.5 ? 4 * t * t * t : 1 - std::pow(-2 * t + 2, 3) / 2;
+void SlintMapLibre::set_clock(std::shared_ptr<MapClock> clock_) {
+    clock = clock_ ? std::move(clock_) : std::make_shared<SteadyMapClock>();
+    apply_clock_transitions();
 }
 
-void SlintMapLibre::tick_animation() {
-    if (!custom_anim.active || !map)
+void SlintMapLibre::apply_clock_transitions() {
+    if (!map)
+        return;
+    auto& style = map->getStyle();
+    if (!clock->is_manual()) {
+        // Back on a real clock: the style's own transitions again.
+        if (style_transitions) {
+            style.setTransitionOptions(*style_transitions);
+            style_transitions.reset();
+        }
         return;
-    const auto now = std::chrono::steady_clock::now();
-    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                             now - custom_anim.start_time)
-                             .count();
-    double t = std::clamp(
-        elapsed / static_cast<double>(custom_anim.duration_ms), 0.0, 1.0);
-    double k = ease_in_out(t);
-
-    auto lerp = [](double a, double b, double k) { return a + (b - a) * k; };
-    // Delay center movement at the beginning to accentuate zoom-out
-    double k_center;
-    if (t <= custom_anim.center_hold_ratio) {
-        double t_hold = (custom_anim.center_hold_ratio > 0.0)
-                            ? t / custom_anim.center_hold_ratio
-                            : 1.0;
-        k_center = 0.10 * ease_in_out(t_hold);  // only 10% move during hold
-    } else {
-        double t_rest = (t - custom_anim.center_hold_ratio) /
-                        std::max(1e-6, 1.0 - custom_anim.center_hold_ratio);
-        k_center = 0.10 + 0.90 * ease_in_out(t_rest);
-    }
-    mbgl::LatLng c{lerp(custom_anim.start_center.latitude(),
-                        custom_anim.target_center.latitude(), k_center),
-                   lerp(custom_anim.start_center.longitude(),
-                        custom_anim.target_center.longitude(), k_center)};
-    // Two-phase zoom: out then in
-    double z;
-    if (t <= custom_anim.mid_ratio) {
-        double t0 =
-            (custom_anim.mid_ratio > 0.0) ? t / custom_anim.mid_ratio : 1.0;
-        double k0 = ease_in_out(t0);
-        z = lerp(custom_anim.start_zoom, custom_anim.mid_zoom, k0);
-    } else {
-        double t1 = (t - custom_anim.mid_ratio) /
-                    std::max(1e-6, 1.0 - custom_anim.mid_ratio);
-        double k1 = ease_in_out(t1);
-        z = lerp(custom_anim.mid_zoom, custom_anim.target_zoom, k1);
     }
+    // MapLibre times style transitions and symbol fade-in with its own wall
+    // clock. Under a manual clock they would depend on how fast frames
+    // render, so make every change take effect immediately instead.
+    if (!style_transitions)
+        style_transitions = style.getTransitionOptions();
+    style.setTransitionOptions(mbgl::style::TransitionOptions{
+        mbgl::Duration::zero(), mbgl::Duration::zero(), false});
+}
 
-    mbgl::CameraOptions next;
-    next.center = c;
-    next.zoom = z;
-    map->jumpTo(next);
+void SlintMapLibre::tick_animation() {
+    if (!fly_anim || !map)
+        return;
+    const double t = fly_anim->progress(clock->now() - fly_start);
+    map->jumpTo(fly_anim->sample(t));
     request_repaint();
 
     if (t >= 1.0) {
-        custom_anim.active = false;
+        fly_anim.reset();
     }
 }
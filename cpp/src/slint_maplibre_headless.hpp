@@ -1,10 +1,15 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <slint.h>
 #include <string>
+#include <vector>
 
 // All required MapLibre headers
 #include <mbgl/gfx/headless_frontend.hpp>
@@ -12,9 +17,27 @@
 #include <mbgl/map/map_observer.hpp>
 #include <mbgl/map/map_options.hpp>
 #include <mbgl/renderer/renderer_observer.hpp>
+#include <mbgl/storage/file_source.hpp>
 #include <mbgl/storage/resource_options.hpp>
+#include <mbgl/style/transition_options.hpp>
+#include <mbgl/util/async_request.hpp>
+#include <mbgl/util/image.hpp>
 #include <mbgl/util/run_loop.hpp>
 
+#include "feature_pick.hpp"
+#include "fly_to_animation.hpp"
+#include "frame_damage.hpp"
+#include "geojson_loader.hpp"
+#include "input_recording.hpp"
+#include "json_value.hpp"
+#include "map_clock.hpp"
+#include "marker_layer.hpp"
+#include "moving_objects.hpp"
+#include "slint_map_engine.hpp"
+#include "snapshot_renderer.hpp"
+#include "style_cache.hpp"
+#include "style_diff.hpp"
+
 // Custom file source is implemented, but not required for core rendering
 // paths used here. We avoid constructing it eagerly to reduce startup
 // complexity.
@@ -56,9 +79,31 @@ private:
 // --- Main MapLibre Integration Class ---
 class SlintMapLibre : public mbgl::MapObserver {
 public:
+    static constexpr const char* kDefaultStyleUrl =
+        "https://demotiles.maplibre.org/style.json";
+
+    // Startup milestones in milliseconds since construction (-1 = not
+    // reached yet).
+    struct StartupMetrics {
+        double style_loaded_ms = -1.0;
+        double first_frame_ms = -1.0;
+        // First frame rendered after the map became idle (style, sources and
+        // visible tiles loaded).
+        double first_meaningful_frame_ms = -1.0;
+    };
+
     SlintMapLibre();
+    // Shares the engine's RunLoop and file sources with every other map
+    // created from it (e.g. several MMapViews in one window).
+    explicit SlintMapLibre(std::shared_ptr<SlintMapEngine> engine);
     ~SlintMapLibre();
 
+    // Starts the size-independent startup work before the window exists:
+    // creates the RunLoop, the frontend (and its GL context) and the map at
+    // a provisional size, and starts loading `style_url`. A later
+    // initialize() then only applies the real size.
+    void prewarm(const std::string& style_url, int width_hint = 1,
+                 int height_hint = 1);
     void initialize(int width, int height);
     void setRenderCallback(std::function<void()> callback);
     slint::Image render_map();
@@ -74,9 +119,124 @@ public:
     void fly_to(const std::string& location);
     void fly_to(double lat, double lon, double zoom);
 
+    // Renders `camera` at width x height logical pixels on a background
+    // StaticMapRenderer with the current style, without touching the
+    // interactive frontend. `callback` runs on the UI thread from a later
+    // run_map_loop(); StaticMapResult::index is the returned id. Returns 0
+    // when the snapshot queue is full or the map has no style yet.
+    using SnapshotCallback = SnapshotRenderer::Callback;
+    uint64_t request_snapshot(const mbgl::CameraOptions& camera, int width,
+                              int height, float pixel_ratio,
+                              SnapshotCallback callback);
+    // Snapshot of the current view at the current size.
+    uint64_t request_snapshot(SnapshotCallback callback);
+    std::size_t pending_snapshots() const {
+        return snapshots ? snapshots->pending() : 0;
+    }
+
+    // Application data as GeoJSON sources. The data is read, parsed and
+    // indexed (simplified, and clustered when `source.cluster` is set) on a
+    // GeoJsonLoader, never on the UI thread. run_map_loop() then swaps the
+    // finished index into the source in one step, so a frame shows the old
+    // dataset or the new one, never a mix. `layers_json` is a JSON array of
+    // style layers drawing the dataset, added on top of the style with
+    // their "source" set to `id`; empty keeps the layers of the previous
+    // set_geojson() (even if that load was overtaken). Datasets and their
+    // layers survive style switches. `id` must not be a source of the style.
+    // Returns the load's generation, or 0 when the loader's queue is full
+    // or `id` is taken.
+    // A load overtaken by a later one for the same `id` is dropped.
+    struct GeoJsonOverlayOptions {
+        mbgl::style::GeoJSONOptions source;
+        std::string layers_json;
+    };
+    uint64_t set_geojson(const std::string& id, GeoJsonInput input,
+                         const GeoJsonOverlayOptions& options,
+                         GeoJsonLoader::Callback callback = {});
+    // Removes the dataset and its layers; false if there is no such one.
+    bool remove_geojson(const std::string& id);
+    std::size_t pending_geojson() const {
+        return geojson_loader ? geojson_loader->pending() : 0;
+    }
+
+    // Moving points (e.g. live fleet tracking) in the GeoJSON source `id`,
+    // drawn by `options.layers_json`. Positions arrive as struct-of-arrays
+    // deltas and are applied in place. Once per render_map() at most, the
+    // positions changed since the last source update become one new
+    // update. It is built as features directly (no GeoJSON text) and
+    // indexed on the GeoJsonLoader while the previous positions stay on
+    // screen. Object IDs are the feature IDs, so per-object styling can go
+    // through feature-state without touching the positions.
+    // add_moving_objects() again restyles; remove_geojson() removes it.
+    bool add_moving_objects(const std::string& id,
+                            const GeoJsonOverlayOptions& options);
+    // Returns how many objects were new (0 for an unknown `id`).
+    std::size_t update_moving_objects(const std::string& id,
+                                      const ObjectPositions& deltas);
+    std::size_t remove_moving_objects(const std::string& id,
+                                      const std::vector<uint64_t>& ids);
+    // The layer's objects and update counts, or nullptr.
+    const MovingObjects* moving_objects(const std::string& id) const;
+
+    // Click and hover picking: the LatLng under a position (logical
+    // pixels) and the rendered features within the pick radius of it.
+    // request_pick() only queues the request; answer_picks(), called once
+    // the frame has been handed to Slint, runs the queries and calls
+    // `callback`. A hover request replaces one still queued, so sweeping
+    // the pointer over dense data costs at most one query per tick, and
+    // positions already queried in the current frame come from a
+    // PickCache. Returns the request's id.
+    using PickCallback = std::function<void(const PickResult&)>;
+    uint64_t request_pick(float x, float y, bool hover,
+                          PickCallback callback);
+    std::size_t answer_picks();
+    std::size_t pending_picks() const {
+        return pick_requests.size();
+    }
+    // Style layers queried (all when empty), e.g. only the POI layers.
+    void set_pick_layers(std::vector<std::string> layer_ids);
+    void set_pick_radius(float radius);
+    const PickCache::Stats& pick_stats() const {
+        return pick_cache.stats();
+    }
+
+    // Markers drawn by Slint over the map (MMapView.markers), for thousands
+    // of interactive points. render_map() recomputes which ones to draw
+    // whenever the camera, the size or the markers changed, through the
+    // MarkerLayer's index, projection and collision culling; the app only
+    // receives the visible ones. Pitched views are projected by MapLibre.
+    void set_markers(MarkerPositions markers,
+                     const MarkerLayer::Options& options = {});
+    void clear_markers();
+    const MarkerLayer& markers() const {
+        return marker_overlay;
+    }
+    // The last render_map() changed markers().visible().
+    bool markers_changed() const {
+        return markers_updated;
+    }
+
     // Manually drive the map's run loop
     void run_map_loop();
     void tick_animation();
+    // run_map_loop() without pumping the run loop: tick_animation(), then
+    // finished GeoJSON loads (overlays, moving objects) and snapshots are
+    // handed over. For maps whose shared engine is pumped elsewhere (the
+    // per-view maps of SlintMapViews).
+    void deliver_async();
+
+    // Time source for fly_to and other animations driven by
+    // tick_animation(). Passing a ManualMapClock also disables MapLibre's
+    // wall-clock style/placement transitions, making frame sequences
+    // reproducible; switching back to a real clock (or nullptr, the steady
+    // clock) restores the style's transitions.
+    void set_clock(std::shared_ptr<MapClock> clock);
+    const std::shared_ptr<MapClock>& get_clock() const {
+        return clock;
+    }
+    bool is_animating() const {
+        return fly_anim.has_value();
+    }
 
     // Repaint signaling consumed by UI thread (timer)
     bool take_repaint_request();
@@ -84,6 +244,94 @@ public:
     bool consume_forced_repaint();
     void arm_forced_repaint_ms(int ms);
 
+    bool style_is_loaded() const {
+        return style_loaded.load();
+    }
+    bool map_is_idle() const {
+        return map_idle.load();
+    }
+    const std::string& style_url() const {
+        return current_style_url;
+    }
+    StartupMetrics startup_metrics() const {
+        return startup;
+    }
+
+    // setStyleUrl() keeps recently used styles in a StyleCache. With
+    // set_align_style_sources(true) it also renames the incoming style's
+    // sources to the IDs identical sources have in the current one, so
+    // their loaded tiles survive the switch (see align_source_ids()); the
+    // source IDs the app sees then depend on the previous style. Times are
+    // from the setStyleUrl() call.
+    struct StyleSwapMetrics {
+        std::string url;
+        bool cache_hit = false;
+        std::size_t sources_kept = 0;
+        double style_loaded_ms = -1.0;
+        double idle_ms = -1.0;  // time-to-idle: style, sources, tiles in
+    };
+    const StyleSwapMetrics& last_style_swap() const {
+        return style_swap;
+    }
+    StyleCache& style_cache() {
+        return styles;
+    }
+    // Off by default: styles load with the source IDs they were written
+    // with.
+    void set_align_style_sources(bool enabled) {
+        align_style_sources = enabled;
+    }
+
+    // Live style edits: diffs `json` against the current style and applies
+    // the difference in place (diff_styles(): paint/layout properties,
+    // filters, added/removed/moved layers and sources), all before the next
+    // frame, so loaded sources and tiles stay. Changes that cannot be
+    // applied that way (sprite, glyphs, light, a rejected op...) load `json`
+    // in full instead and are listed in `reload_reasons`.
+    struct StyleUpdateResult {
+        bool applied = false;   // `json` is the style now
+        bool reloaded = false;  // through a full load
+        std::size_t ops = 0;    // edits applied in place
+        std::vector<std::string> reload_reasons;
+        std::string error;  // `json` does not parse; nothing changed
+    };
+    StyleUpdateResult update_style(const std::string& json);
+
+    // Input recording: every interaction/command reaching this instance is
+    // appended to the recorder (see input_recording.hpp). Pass nullptr to
+    // stop recording.
+    void set_input_recorder(std::shared_ptr<InputRecorder> recorder);
+
+    // Called from render_map() with each premultiplied readback before it is
+    // converted for Slint (used for frame dumps by the replay harness).
+    void set_frame_observer(
+        std::function<void(const mbgl::PremultipliedImage&)> observer);
+
+    // What the last render_map() changed, in physical pixels from the
+    // top-left. Empty when it returned the previous image unchanged: the
+    // caller can skip setting it, so Slint's renderer has nothing to redraw.
+    // The whole frame after a resize.
+    const std::vector<DamageRect>& last_frame_damage() const {
+        return last_damage;
+    }
+    bool last_frame_changed() const {
+        return !last_damage.empty();
+    }
+    // Off: every frame is unpremultiplied and copied in full, as a baseline
+    // for measuring (on by default).
+    void set_partial_updates(bool enabled);
+    // Whether the last changed frame was opaque and handed to Slint as RGB.
+    bool last_frame_opaque() const {
+        return frame_opaque;
+    }
+    // Off: frames are always RGBA, even when opaque (on by default).
+    void set_opaque_fast_path(bool enabled);
+
+    // Per-frame diagnostics printed by render_map() (on by default).
+    void set_frame_logging(bool enabled) {
+        frame_logging = enabled;
+    }
+
     // MapObserver implementation
     void onWillStartLoadingMap() override;
     void onDidFinishLoadingStyle() override;
@@ -97,6 +345,7 @@ public:
 private:
     // Declaration order matters for destruction order (bottom-up).
     // The observer must outlive the frontend.
+    std::shared_ptr<SlintMapEngine> engine;  // optional, owns the shared loop
     std::unique_ptr<mbgl::util::RunLoop> run_loop;  // created in initialize()
     std::function<void()> m_renderCallback;
 
@@ -130,17 +379,136 @@ private:
     bool fallback_style_applied{false};
     std::atomic<int> forced_repaint_frames{0};
 
-    struct CustomAnim {
-        bool active = false;
-        mbgl::LatLng start_center{};
-        mbgl::LatLng target_center{};
-        double start_zoom = 0.0;
-        double target_zoom = 0.0;
-        double mid_zoom = 0.0;
-        double mid_ratio = 0.35;  // fraction of duration for zoom-out phase
-        double center_hold_ratio =
-            0.2;  // hold center early to emphasize zoom-out
-        std::chrono::steady_clock::time_point start_time{};
-        int duration_ms = 0;
-    } custom_anim;
+    std::shared_ptr<InputRecorder> input_recorder;
+    std::function<void(const mbgl::PremultipliedImage&)> frame_observer;
+    bool frame_logging = true;
+
+    // render_map() output. Frames are diffed against the previous readback
+    // and only the damaged rects are converted into one of two persistent
+    // buffers, alternating so the one written is never the one Slint holds.
+    // `stale` is the damage each buffer missed. Opaque frames go to the
+    // RGB pair (no unpremultiply, 3/4 of the bytes), others to the RGBA
+    // pair; only the pair in use holds pixels.
+    template <typename Pixel>
+    struct FrameBufferPair {
+        std::array<slint::SharedPixelBuffer<Pixel>, 2> buffers;
+        std::array<std::vector<DamageRect>, 2> stale;
+        std::size_t front = 0;
+    };
+    bool partial_updates = true;
+    bool opaque_fast_path = true;
+    // The style has a visible, fully opaque background layer, so every
+    // frame is opaque without scanning it.
+    bool style_opaque = false;
+    bool frame_opaque = false;
+    mbgl::PremultipliedImage previous_frame;
+    FrameBufferPair<slint::Rgba8Pixel> rgba_frames;
+    FrameBufferPair<slint::Rgb8Pixel> rgb_frames;
+    slint::Image front_image;
+    std::vector<DamageRect> last_damage;
+    void update_frame_buffers(mbgl::PremultipliedImage&& frame);
+    template <typename Pixel>
+    void write_frame(FrameBufferPair<Pixel>& pair,
+                     const mbgl::PremultipliedImage& frame);
+    void update_style_opacity();
+
+    std::string current_style_url;
+    // current_style_url's JSON as fetched, before align_source_ids(); empty
+    // when MapLibre loaded the URL itself.
+    std::string style_as_fetched;
+    StyleCache styles;
+    bool align_style_sources = false;
+    StyleSwapMetrics style_swap;
+    bool style_swap_pending = false;
+    // The current URL failed to load; its fallback must not be cached.
+    bool style_failed = false;
+    std::chrono::steady_clock::time_point style_swap_start;
+    // setStyleUrl() fetches styles itself so their sources can be aligned
+    // before MapLibre parses them.
+    std::shared_ptr<mbgl::FileSource> style_source;
+    std::unique_ptr<mbgl::AsyncRequest> style_request;
+    // The current style after update_style() edited it in place;
+    // Style::getJSON() still returns what was loaded. Reset on every load.
+    std::optional<JsonValue> style_document;
+    // update_style() reloaded the style: it no longer is the one at
+    // current_style_url and must not be cached under it.
+    bool style_edited = false;
+    void load_style_json(const std::string& json);
+    std::string current_style_json() const;
+    bool apply_style_op(const StyleOp& op, std::string& error);
+    double ms_since_style_swap() const;
+
+    std::chrono::steady_clock::time_point created_at;
+    StartupMetrics startup;
+
+    void create_map(int w, int h);
+    mbgl::ResourceOptions resource_options() const;
+    void apply_size();
+    double ms_since_creation() const;
+    void record_startup_frame();
+
+    std::shared_ptr<MapClock> clock = std::make_shared<SteadyMapClock>();
+    std::optional<FlyToAnimation> fly_anim;
+    MapClock::time_point fly_start{};
+    void apply_clock_transitions();
+    // The style's transitions while a manual clock overrides them.
+    std::optional<mbgl::style::TransitionOptions> style_transitions;
+
+    // set_geojson() datasets, by source ID, kept for attaching them to
+    // every style that loads. `generation` is the latest load requested.
+    struct GeoJsonOverlay {
+        mbgl::style::GeoJSONOptions options;
+        JsonValue layers;  // array
+        // From the latest set_geojson() that had layers, until a load lands.
+        std::optional<JsonValue> pending_layers;
+        std::vector<std::string> layer_ids;  // added to the current style
+        std::shared_ptr<mbgl::style::GeoJSONData> data;
+        uint64_t generation = 0;
+        bool attached = false;  // `options` and `data` are in the style
+    };
+    std::map<std::string, GeoJsonOverlay> overlays;
+    void apply_geojson(GeoJsonLoadResult& result,
+                       const mbgl::style::GeoJSONOptions& options);
+    void attach_geojson(const std::string& id, GeoJsonOverlay& overlay);
+    void detach_geojson(const std::string& id, GeoJsonOverlay& overlay);
+    // The lowest overlay layer in the style, which update_style() adds its
+    // top layers below.
+    std::optional<std::string> first_overlay_layer() const;
+
+    struct MovingLayer {
+        MovingObjects objects;
+        GeoJsonOverlayOptions options;
+        bool layers_sent = false;  // with an earlier update
+        bool in_flight = false;    // an update is being built
+    };
+    std::map<std::string, MovingLayer> moving_layers;
+    void flush_moving_objects();
+
+    MarkerLayer marker_overlay;
+    MarkerViewport marker_view;  // of the current visible set
+    double marker_pitch = 0.0;
+    bool markers_dirty = false;
+    bool markers_updated = false;
+    void update_markers();
+
+    struct PickRequest {
+        uint64_t id;
+        float x;
+        float y;
+        bool hover;
+        PickCallback callback;
+    };
+    std::vector<PickRequest> pick_requests;
+    uint64_t next_pick_id = 1;
+    // Counts frames whose pixels changed; the PickCache is per such frame.
+    uint64_t frame_serial = 0;
+    PickCache pick_cache;
+    std::vector<std::string> pick_layers;
+    float pick_radius = 3.0f;
+    std::vector<PickedFeature> query_features(float x, float y);
+
+    // Created on first use. Declared last so their workers are joined
+    // before anything their callbacks might reference goes away.
+    std::unique_ptr<GeoJsonLoader> geojson_loader;
+    std::unique_ptr<SnapshotRenderer> snapshots;
 };
@@ -0,0 +1,126 @@
+#include "snapshot_renderer.hpp"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Linux applies nice values per thread: let the UI thread win whenever both
+// want the same core. A failure here only costs scheduling fairness.
+void lower_thread_priority() {
+#ifdef __linux__
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, 10) != 0) {
+        std::cout << "[SnapshotRenderer] could not lower worker priority"
+                  << std::endl;
+    }
+#endif
+}
+
+}  // namespace
+
+SnapshotRenderer::SnapshotRenderer() : SnapshotRenderer(Options{}) {
+}
+
+SnapshotRenderer::SnapshotRenderer(Options options_)
+    : options(std::move(options_)),
+      jobs(options.max_pending),
+      worker([this] { run(); }) {
+}
+
+SnapshotRenderer::~SnapshotRenderer() {
+    stopping = true;
+    jobs.close();
+    worker.join();
+}
+
+uint64_t SnapshotRenderer::request(Request request, Callback callback) {
+    Job job;
+    job.id = next_id.fetch_add(1, std::memory_order_relaxed);
+    job.request = std::move(request);
+    job.callback = std::move(callback);
+    const uint64_t id = job.id;
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+    if (!jobs.try_push(std::move(job))) {
+        outstanding.fetch_sub(1, std::memory_order_relaxed);
+        std::cout << "[SnapshotRenderer] queue full, snapshot rejected"
+                  << std::endl;
+        return 0;
+    }
+    return id;
+}
+
+std::size_t SnapshotRenderer::deliver_completed() {
+    std::vector<std::pair<Callback, StaticMapResult>> ready;
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        if (completed.empty())
+            return 0;
+        ready.swap(completed);
+    }
+    for (auto& [callback, result] : ready) {
+        outstanding.fetch_sub(1, std::memory_order_relaxed);
+        if (callback)
+            callback(std::move(result));
+    }
+    return ready.size();
+}
+
+void SnapshotRenderer::run() {
+    lower_thread_priority();
+
+    // Created lazily on this thread: the renderer's RunLoop and GL context
+    // belong to it.
+    std::unique_ptr<StaticMapRenderer> renderer;
+    float renderer_ratio = 0.0f;
+    std::string loaded_style;
+
+    while (auto job = jobs.pop()) {
+        if (stopping) {
+            // Dropped on shutdown: no callback, but no longer pending.
+            outstanding.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        const Request& req = job->request;
+        if (!renderer || renderer_ratio != req.pixel_ratio) {
+            StaticMapRenderer::Options renderer_options;
+            renderer_options.pixel_ratio = req.pixel_ratio;
+            renderer_options.cache_path = options.cache_path;
+            renderer_options.asset_path = options.asset_path;
+            renderer.reset();
+            renderer = std::make_unique<StaticMapRenderer>(renderer_options);
+            renderer_ratio = req.pixel_ratio;
+            loaded_style.clear();
+        }
+        const std::string& style =
+            req.style_json.empty() ? req.style_url : req.style_json;
+        if (style != loaded_style) {
+            if (req.style_json.empty())
+                renderer->load_style_url(req.style_url);
+            else
+                renderer->load_style_json(req.style_json);
+            loaded_style = style;
+        }
+
+        StaticMapRequest view;
+        view.camera = req.camera;
+        view.width = req.width;
+        view.height = req.height;
+        StaticMapResult result = renderer->render(view);
+        result.index = static_cast<std::size_t>(job->id);
+        if (!result.ok()) {
+            std::cout << "[SnapshotRenderer] snapshot " << job->id
+                      << " failed: " << result.error << std::endl;
+            // Force a reload next time; the style may have been the cause.
+            loaded_style.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        completed.emplace_back(std::move(job->callback), std::move(result));
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mbgl/map/camera.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "static_map_renderer.hpp"
+
+// Renders snapshots on a background thread so the interactive map never
+// waits for them. The thread owns a StaticMapRenderer (its own RunLoop,
+// HeadlessFrontend and GL context); with the same cache/asset paths as the
+// interactive map it gets the same file sources from mbgl::FileSourceManager,
+// so tiles the interactive map already loaded come from the shared cache.
+//
+// request() is thread-safe. Finished snapshots are parked until the owner
+// calls deliver_completed() (SlintMapLibre does so from run_map_loop()), so
+// callbacks always run on the UI thread.
+class SnapshotRenderer {
+public:
+    struct Options {
+        std::string cache_path = "cache.sqlite";
+        std::string asset_path = ".";
+        // Requests beyond this many queued ones are rejected.
+        std::size_t max_pending = 8;
+    };
+
+    struct Request {
+        // The style to render: JSON takes precedence over the URL. The
+        // worker only reloads when it differs from the previous snapshot's.
+        std::string style_json;
+        std::string style_url;
+        mbgl::CameraOptions camera;
+        uint32_t width = 512;  // logical pixels
+        uint32_t height = 512;
+        float pixel_ratio = 1.0f;
+    };
+
+    // StaticMapResult::index carries the id returned by request().
+    using Callback = std::function<void(StaticMapResult&&)>;
+
+    SnapshotRenderer();
+    explicit SnapshotRenderer(Options options);
+    // Finishes the snapshot in progress, drops the queued ones without
+    // calling their callbacks, and joins.
+    ~SnapshotRenderer();
+
+    SnapshotRenderer(const SnapshotRenderer&) = delete;
+    SnapshotRenderer& operator=(const SnapshotRenderer&) = delete;
+
+    // Returns the snapshot id, or 0 if the queue is full.
+    uint64_t request(Request request, Callback callback);
+
+    // Runs the callbacks of finished snapshots on the calling thread and
+    // returns how many were delivered.
+    std::size_t deliver_completed();
+
+    // Requested but not yet delivered.
+    std::size_t pending() const {
+        return outstanding.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Job {
+        uint64_t id = 0;
+        Request request;
+        Callback callback;
+    };
+
+    void run();
+
+    Options options;
+    BoundedQueue<Job> jobs;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> next_id{1};
+    std::atomic<std::size_t> outstanding{0};
+
+    std::mutex completed_mutex;
+    std::vector<std::pair<Callback, StaticMapResult>> completed;
+
+    // Started last, joined first.
+    std::thread worker;
+};
@@ -0,0 +1,138 @@
+#include "static_map_renderer.hpp"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+#include "mbgl/map/map_options.hpp"
+#include "mbgl/storage/resource_options.hpp"
+#include "mbgl/style/style.hpp"
+
+namespace {
+
+double ms_between(std::chrono::steady_clock::time_point from,
+                  std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}  // namespace
+
+StaticMapRenderer::StaticMapRenderer() : StaticMapRenderer(Options{}) {
+}
+
+StaticMapRenderer::StaticMapRenderer(Options options_)
+    : options(std::move(options_)) {
+    frontend = std::make_unique<mbgl::HeadlessFrontend>(mbgl::Size{512, 512},
+                                                        options.pixel_ratio);
+
+    mbgl::ResourceOptions resourceOptions;
+    resourceOptions.withCachePath(options.cache_path)
+        .withAssetPath(options.asset_path);
+
+    map = std::make_unique<mbgl::Map>(
+        *frontend, *this,
+        mbgl::MapOptions()
+            .withMapMode(mbgl::MapMode::Static)
+            .withSize(frontend->getSize())
+            .withPixelRatio(options.pixel_ratio),
+        resourceOptions);
+}
+
+StaticMapRenderer::~StaticMapRenderer() {
+    // The map references the frontend; tear it down first.
+    map.reset();
+    frontend.reset();
+}
+
+void StaticMapRenderer::load_style_url(const std::string& url) {
+    load_error.clear();
+    map->getStyle().loadURL(url);
+}
+
+void StaticMapRenderer::load_style_json(const std::string& json) {
+    load_error.clear();
+    map->getStyle().loadJSON(json);
+}
+
+void StaticMapRenderer::resize(uint32_t width, uint32_t height) {
+    const mbgl::Size size{width, height};
+    if (frontend->getSize() == size)
+        return;
+    frontend->setSize(size);
+    map->setSize(size);
+}
+
+StaticMapResult StaticMapRenderer::render(const StaticMapRequest& request) {
+    StaticMapResult result;
+    if (request.width == 0 || request.height == 0) {
+        result.error = "empty size";
+        return result;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    resize(request.width, request.height);
+    map->jumpTo(request.camera);
+    try {
+        // Runs this thread's RunLoop until the style and every tile, glyph
+        // and sprite the frame needs are loaded, then reads the frame back.
+        result.image = frontend->render(*map).image;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    if (result.error.empty() && !result.image.valid()) {
+        result.error = load_error.empty() ? "render failed" : load_error;
+    }
+    result.render_ms = ms_between(t0, std::chrono::steady_clock::now());
+    return result;
+}
+
+StaticBatchStats StaticMapRenderer::render_batch(
+    const std::vector<StaticMapRequest>& requests,
+    const ResultCallback& on_result) {
+    StaticBatchStats stats;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        StaticMapResult result = render(requests[i]);
+        result.index = i;
+        if (result.ok()) {
+            ++stats.rendered;
+        } else {
+            ++stats.failed;
+            std::cout << "[StaticMapRenderer] item " << i
+                      << " failed: " << result.error << std::endl;
+        }
+        if (on_result) {
+            on_result(std::move(result));
+        }
+    }
+    stats.total_ms = ms_between(t0, std::chrono::steady_clock::now());
+    if (stats.total_ms > 0.0) {
+        stats.images_per_second =
+            static_cast<double>(stats.rendered) * 1000.0 / stats.total_ms;
+    }
+    std::cout << "[StaticMapRenderer] rendered " << stats.rendered << "/"
+              << requests.size() << " images in " << stats.total_ms << " ms ("
+              << stats.images_per_second << " images/s)" << std::endl;
+    return stats;
+}
+
+std::vector<StaticMapResult> StaticMapRenderer::render_batch(
+    const std::vector<StaticMapRequest>& requests, StaticBatchStats* stats) {
+    std::vector<StaticMapResult> results;
+    results.reserve(requests.size());
+    const StaticBatchStats s =
+        render_batch(requests, [&results](StaticMapResult&& result) {
+            results.push_back(std::move(result));
+        });
+    if (stats) {
+        *stats = s;
+    }
+    return results;
+}
+
+void StaticMapRenderer::onDidFailLoadingMap(mbgl::MapLoadError error,
+                                            const std::string& what) {
+    std::cout << "[StaticMapRenderer] FAILED loading map. type="
+              << static_cast<int>(error) << " what=" << what << std::endl;
+    load_error = what;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mbgl/gfx/headless_frontend.hpp>
+#include <mbgl/map/camera.hpp>
+#include <mbgl/map/map.hpp>
+#include <mbgl/map/map_observer.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One still image to render: a camera and an output size in logical pixels
+// (the image is size * pixel_ratio physical pixels).
+struct StaticMapRequest {
+    mbgl::CameraOptions camera;
+    uint32_t width = 512;
+    uint32_t height = 512;
+};
+
+struct StaticMapResult {
+    std::size_t index = 0;  // position in the batch
+    mbgl::PremultipliedImage image;
+    double render_ms = 0.0;
+    std::string error;  // empty on success
+
+    bool ok() const {
+        return error.empty() && image.valid();
+    }
+};
+
+struct StaticBatchStats {
+    std::size_t rendered = 0;
+    std::size_t failed = 0;
+    double total_ms = 0.0;
+    double images_per_second = 0.0;
+};
+
+// Renders still images (thumbnails, static map tiles) with a single
+// HeadlessFrontend and Map in MapMode::Static. The style, the tile/glyph/
+// sprite caches and the GL context live as long as the renderer, so a batch
+// only pays for loading them once. Not thread-safe: create, use and destroy
+// a renderer on one thread (it owns that thread's RunLoop).
+class StaticMapRenderer : public mbgl::MapObserver {
+public:
+    struct Options {
+        float pixel_ratio = 1.0f;
+        std::string cache_path = "cache.sqlite";
+        std::string asset_path = ".";
+    };
+
+    using ResultCallback = std::function<void(StaticMapResult&&)>;
+
+    StaticMapRenderer();
+    explicit StaticMapRenderer(Options options);
+    ~StaticMapRenderer();
+
+    // The style is loaded lazily by the first render().
+    void load_style_url(const std::string& url);
+    void load_style_json(const std::string& json);
+
+    StaticMapResult render(const StaticMapRequest& request);
+
+    // Renders every request in order and hands each result to `on_result` as
+    // soon as it is ready, so callers can encode/write while the next image
+    // renders instead of holding the whole batch in memory.
+    StaticBatchStats render_batch(const std::vector<StaticMapRequest>& requests,
+                                  const ResultCallback& on_result);
+    std::vector<StaticMapResult> render_batch(
+        const std::vector<StaticMapRequest>& requests,
+        StaticBatchStats* stats = nullptr);
+
+    float pixel_ratio() const {
+        return options.pixel_ratio;
+    }
+    mbgl::Map* get_map() const {
+        return map.get();
+    }
+
+    // MapObserver implementation
+    void onDidFailLoadingMap(mbgl::MapLoadError error,
+                             const std::string& what) override;
+
+private:
+    Options options;
+    // The RunLoop must outlive the frontend and the map.
+    mbgl::util::RunLoop run_loop;
+    std::unique_ptr<mbgl::HeadlessFrontend> frontend;
+    std::unique_ptr<mbgl::Map> map;
+    std::string load_error;
+
+    void resize(uint32_t width, uint32_t height);
+};
@@ -0,0 +1,136 @@
+#include "style_cache.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "json_value.hpp"
+
+StyleCache::StyleCache(std::size_t capacity) : capacity_(capacity) {
+}
+
+const std::string* StyleCache::find(const std::string& url) {
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](const auto& e) { return e.first == url; });
+    if (it == entries.end()) {
+        totals.misses++;
+        return nullptr;
+    }
+    totals.hits++;
+    entries.splice(entries.begin(), entries, it);
+    return &entries.front().second;
+}
+
+void StyleCache::insert(const std::string& url, std::string json) {
+    if (capacity_ == 0 || json.empty())
+        return;
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](const auto& e) { return e.first == url; });
+    if (it != entries.end())
+        entries.erase(it);
+    entries.emplace_front(url, std::move(json));
+    trim();
+}
+
+void StyleCache::clear() {
+    entries.clear();
+}
+
+void StyleCache::set_capacity(std::size_t capacity) {
+    capacity_ = capacity;
+    trim();
+}
+
+void StyleCache::trim() {
+    while (entries.size() > capacity_)
+        entries.pop_back();
+}
+
+namespace {
+
+// What makes two style sources the same to MapLibre's renderer: a source
+// with these equal keeps its tiles when only its ID and layers change. The
+// tile scheme, zoom range, bounds and DEM encoding all change which tiles
+// are requested or how they decode, so they must match too.
+bool same_source(const JsonValue& a, const JsonValue& b) {
+    for (const char* key : {"type", "url", "tiles", "tileSize", "scheme",
+                            "minzoom", "maxzoom", "bounds", "encoding"}) {
+        const JsonValue* x = a.find(key);
+        const JsonValue* y = b.find(key);
+        if ((x == nullptr) != (y == nullptr) || (x && *x != *y))
+            return false;
+    }
+    // GeoJSON by URL can be shared; inline data is not worth comparing.
+    const JsonValue* data = a.find("data");
+    if (data && !data->is_string())
+        return false;
+    const JsonValue* other = b.find("data");
+    if ((data == nullptr) != (other == nullptr) || (data && *data != *other))
+        return false;
+    // Nothing to load means nothing to keep.
+    return a.find("url") || a.find("tiles") || data;
+}
+
+}  // namespace
+
+std::string align_source_ids(const std::string& next,
+                             const std::string& current,
+                             std::size_t* kept) {
+    if (kept)
+        *kept = 0;
+    auto next_doc = JsonValue::parse(next);
+    const auto current_doc = JsonValue::parse(current);
+    if (!next_doc || !current_doc)
+        return next;
+    JsonValue* next_sources = next_doc->find("sources");
+    const JsonValue* current_sources = current_doc->find("sources");
+    if (!next_sources || !next_sources->is_object() || !current_sources ||
+        !current_sources->is_object())
+        return next;
+
+    std::vector<std::pair<std::string, std::string>> renames;
+    std::vector<const std::string*> claimed;
+    std::size_t shared = 0;
+    for (auto& [id, source] : next_sources->as_object()) {
+        for (const auto& [current_id, current_source] :
+             current_sources->as_object()) {
+            if (std::find(claimed.begin(), claimed.end(), &current_id) !=
+                    claimed.end() ||
+                !same_source(source, current_source))
+                continue;
+            // Renaming onto an ID that `next` uses for another source would
+            // merge two sources.
+            if (current_id != id && next_sources->find(current_id))
+                continue;
+            claimed.push_back(&current_id);
+            shared++;
+            if (current_id != id)
+                renames.emplace_back(id, current_id);
+            break;
+        }
+    }
+    if (kept)
+        *kept = shared;
+    if (renames.empty())
+        return next;
+
+    for (const auto& [from, to] : renames) {
+        for (auto& member : next_sources->as_object()) {
+            if (member.first == from)
+                member.first = to;
+        }
+    }
+    if (JsonValue* layers = next_doc->find("layers");
+        layers && layers->is_array()) {
+        for (auto& layer : layers->as_array()) {
+            const std::string* source = layer.find_string("source");
+            if (!source)
+                continue;
+            auto rename = std::find_if(
+                renames.begin(), renames.end(),
+                [&](const auto& r) { return r.first == *source; });
+            if (rename != renames.end())
+                layer.set("source", rename->second);
+        }
+    }
+    return next_doc->dump();
+}
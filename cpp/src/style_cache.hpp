@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <utility>
+
+// The style JSON of recently used style URLs, most recent first, so
+// switching back to a style (the style selector) skips the download and
+// revalidation. mbgl::Map owns its parsed Style and drops it on a switch,
+// so the JSON is what can be kept; parsing it again takes milliseconds.
+class StyleCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    explicit StyleCache(std::size_t capacity = 4);
+
+    // The cached JSON for `url` (now the most recent), or nullptr.
+    const std::string* find(const std::string& url);
+    // Adds or refreshes `url`, evicting the least recently used beyond
+    // capacity.
+    void insert(const std::string& url, std::string json);
+    void clear();
+
+    // 0 disables the cache.
+    void set_capacity(std::size_t capacity);
+    std::size_t capacity() const {
+        return capacity_;
+    }
+    std::size_t size() const {
+        return entries.size();
+    }
+    const Stats& stats() const {
+        return totals;
+    }
+
+private:
+    void trim();
+
+    std::size_t capacity_;
+    std::list<std::pair<std::string, std::string>> entries;
+    Stats totals;
+};
+
+// Renames sources of `next` to the ID the same source has in `current`
+// (same type, tile URL or TileJSON URL, data URL, tile size, scheme, zoom
+// range, bounds and encoding), and points `next`'s layers at the new IDs.
+// MapLibre keys render sources (and their loaded tiles) by ID, so a style
+// switch then keeps the tiles of every source the two styles share instead
+// of downloading them again. The renamed IDs are what getSource(), picked
+// features and source-keyed filters see afterwards, and they depend on the
+// previous style, so SlintMapLibre only does this when asked to
+// (set_align_style_sources()). `kept` receives the number of shared
+// sources. Returns `next` unchanged when either document does not parse.
+std::string align_source_ids(const std::string& next,
+                             const std::string& current,
+                             std::size_t* kept = nullptr);
@@ -0,0 +1,249 @@
+#include "style_diff.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+const JsonValue kNull;
+
+const JsonValue& member(const JsonValue& value, std::string_view key) {
+    const JsonValue* found = value.find(key);
+    return found ? *found : kNull;
+}
+
+bool is_one_of(std::string_view key,
+               std::initializer_list<std::string_view> keys) {
+    return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+// Layer keys that SetProperty updates in place.
+bool is_property_key(std::string_view key) {
+    return is_one_of(key, {"id", "paint", "layout", "filter", "minzoom",
+                           "maxzoom", "metadata"});
+}
+
+// Whether `next` can be reached from `current` by setting properties:
+// the same type, source and source-layer, and no other unhandled change.
+bool same_structure(const JsonValue& current, const JsonValue& next) {
+    for (const auto* layer : {&current, &next}) {
+        for (const auto& [key, value] : layer->as_object()) {
+            if (!is_property_key(key) &&
+                member(current, key) != member(next, key))
+                return false;
+        }
+    }
+    return true;
+}
+
+// SetProperty for each key of the paint or layout objects that differs;
+// removed keys are reset.
+void diff_properties(const JsonValue& current, const JsonValue& next,
+                     const std::string& id, std::vector<StyleOp>& ops) {
+    if (next.is_object()) {
+        for (const auto& [key, value] : next.as_object()) {
+            if (member(current, key) != value)
+                ops.push_back({StyleOp::Type::SetProperty, id, key, value, {}});
+        }
+    }
+    if (current.is_object()) {
+        for (const auto& [key, value] : current.as_object()) {
+            if (!next.find(key))
+                ops.push_back({StyleOp::Type::SetProperty, id, key, {}, {}});
+        }
+    }
+}
+
+// Positions in `seq` forming a longest strictly increasing subsequence
+// (patience sorting).
+std::vector<std::size_t> longest_increasing(
+    const std::vector<std::size_t>& seq) {
+    std::vector<std::size_t> tails;  // positions in seq
+    std::vector<std::size_t> parent(seq.size(), seq.size());
+    for (std::size_t i = 0; i < seq.size(); ++i) {
+        auto it = std::lower_bound(
+            tails.begin(), tails.end(), seq[i],
+            [&](std::size_t pos, std::size_t v) { return seq[pos] < v; });
+        if (it != tails.begin())
+            parent[i] = *(it - 1);
+        if (it == tails.end())
+            tails.push_back(i);
+        else
+            *it = i;
+    }
+    std::vector<std::size_t> result(tails.size());
+    std::size_t pos = tails.empty() ? seq.size() : tails.back();
+    for (std::size_t k = result.size(); k-- > 0;) {
+        result[k] = pos;
+        pos = parent[pos];
+    }
+    return result;
+}
+
+// The layers of a style by ID, or a reason they cannot be diffed.
+bool index_layers(const JsonValue& style, const char* which,
+                  std::vector<const JsonValue*>& layers,
+                  std::unordered_map<std::string, std::size_t>& by_id,
+                  std::vector<std::string>& reasons) {
+    const JsonValue& list = member(style, "layers");
+    if (list.is_null())
+        return true;
+    if (!list.is_array()) {
+        reasons.push_back(std::string(which) + " layers are not an array");
+        return false;
+    }
+    for (const auto& layer : list.as_array()) {
+        const std::string* id = layer.find_string("id");
+        if (!id) {
+            reasons.push_back(std::string(which) + " has a layer without id");
+            return false;
+        }
+        if (!by_id.emplace(*id, layers.size()).second) {
+            reasons.push_back(std::string(which) + " has duplicate layer " +
+                              *id);
+            return false;
+        }
+        layers.push_back(&layer);
+    }
+    return true;
+}
+
+}  // namespace
+
+StyleDiff diff_styles(const JsonValue& current, const JsonValue& next) {
+    StyleDiff diff;
+    auto& reasons = diff.reload_reasons;
+    if (!current.is_object() || !next.is_object()) {
+        reasons.push_back("not a style document");
+        return diff;
+    }
+
+    // Top level: the camera, name and metadata do not affect rendering the
+    // style; sprite, glyphs, light, terrain, transition... have no in-place
+    // update here.
+    for (const auto* style : {&current, &next}) {
+        for (const auto& [key, value] : style->as_object()) {
+            if (is_one_of(key, {"sources", "layers", "name", "metadata",
+                                "center", "zoom", "bearing", "pitch"}))
+                continue;
+            const std::string reason = key + " changed";
+            if (member(current, key) != member(next, key) &&
+                std::find(reasons.begin(), reasons.end(), reason) ==
+                    reasons.end())
+                reasons.push_back(reason);
+        }
+    }
+
+    const JsonValue& current_sources = member(current, "sources");
+    const JsonValue& next_sources = member(next, "sources");
+    for (const auto* sources : {&current_sources, &next_sources}) {
+        if (!sources->is_null() && !sources->is_object()) {
+            reasons.push_back("sources are not an object");
+            return diff;
+        }
+    }
+    std::vector<const JsonValue*> current_layers;
+    std::vector<const JsonValue*> next_layers;
+    std::unordered_map<std::string, std::size_t> current_ids;
+    std::unordered_map<std::string, std::size_t> next_ids;
+    if (!index_layers(current, "current style", current_layers, current_ids,
+                      reasons) ||
+        !index_layers(next, "new style", next_layers, next_ids, reasons) ||
+        !reasons.empty()) {
+        return diff;
+    }
+
+    // Sources: a changed definition replaces the source, and with it every
+    // layer drawing from it.
+    std::unordered_set<std::string> replaced;
+    std::vector<StyleOp> source_removals;
+    std::vector<StyleOp> source_additions;
+    if (current_sources.is_object()) {
+        for (const auto& [id, source] : current_sources.as_object()) {
+            const JsonValue* other = next_sources.find(id);
+            if (!other || *other != source)
+                source_removals.push_back(
+                    {StyleOp::Type::RemoveSource, id, {}, {}, {}});
+            if (other && *other != source)
+                replaced.insert(id);
+        }
+    }
+    if (next_sources.is_object()) {
+        for (const auto& [id, source] : next_sources.as_object()) {
+            const JsonValue* other = current_sources.find(id);
+            if (!other || *other != source)
+                source_additions.push_back(
+                    {StyleOp::Type::AddSource, id, {}, source, {}});
+        }
+    }
+
+    // Layers that can stay, in the new order with their current position.
+    // Only an increasing run of those positions can stay without moving;
+    // the longest such run moves the fewest layers.
+    std::vector<std::size_t> candidates;  // indices into next_layers
+    std::vector<std::size_t> positions;   // their indices in current
+    for (std::size_t i = 0; i < next_layers.size(); ++i) {
+        const JsonValue& layer = *next_layers[i];
+        auto it = current_ids.find(*layer.find_string("id"));
+        if (it == current_ids.end())
+            continue;
+        const JsonValue& before = *current_layers[it->second];
+        const std::string* source = layer.find_string("source");
+        if (!same_structure(before, layer) ||
+            (source && replaced.count(*source)))
+            continue;
+        candidates.push_back(i);
+        positions.push_back(it->second);
+    }
+    std::vector<bool> kept(next_layers.size(), false);
+    std::vector<bool> current_kept(current_layers.size(), false);
+    for (std::size_t k : longest_increasing(positions)) {
+        kept[candidates[k]] = true;
+        current_kept[positions[k]] = true;
+    }
+
+    for (std::size_t i = 0; i < current_layers.size(); ++i) {
+        if (!current_kept[i])
+            diff.ops.push_back({StyleOp::Type::RemoveLayer,
+                                *current_layers[i]->find_string("id"),
+                                {},
+                                {},
+                                {}});
+    }
+    diff.ops.insert(diff.ops.end(), source_removals.begin(),
+                    source_removals.end());
+    diff.ops.insert(diff.ops.end(), source_additions.begin(),
+                    source_additions.end());
+    // Top down, so the layer each one goes below is already in place.
+    for (std::size_t i = next_layers.size(); i-- > 0;) {
+        if (kept[i])
+            continue;
+        std::string before;
+        if (i + 1 < next_layers.size())
+            before = *next_layers[i + 1]->find_string("id");
+        diff.ops.push_back({StyleOp::Type::AddLayer,
+                            *next_layers[i]->find_string("id"), {},
+                            *next_layers[i], std::move(before)});
+    }
+    for (std::size_t i = 0; i < next_layers.size(); ++i) {
+        if (!kept[i])
+            continue;
+        const JsonValue& layer = *next_layers[i];
+        const std::string& id = *layer.find_string("id");
+        const JsonValue& before =
+            *current_layers[current_ids.find(id)->second];
+        diff_properties(member(before, "layout"), member(layer, "layout"),
+                        id, diff.ops);
+        diff_properties(member(before, "paint"), member(layer, "paint"), id,
+                        diff.ops);
+        for (const char* key : {"filter", "minzoom", "maxzoom"}) {
+            if (member(before, key) != member(layer, key))
+                diff.ops.push_back({StyleOp::Type::SetProperty, id, key,
+                                    member(layer, key), {}});
+        }
+    }
+    return diff;
+}
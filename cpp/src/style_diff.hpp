@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "json_value.hpp"
+
+// One edit that turns the current style into the next without reloading it,
+// in terms of what mbgl::style::Style offers.
+struct StyleOp {
+    enum class Type {
+        RemoveLayer,
+        RemoveSource,
+        AddSource,    // `value` is the source definition
+        AddLayer,     // `value` is the layer; inserted below `before`
+        SetProperty,  // paint/layout property, "filter", "minzoom",
+                      // "maxzoom"; a null `value` resets it
+    };
+    Type type;
+    std::string id;  // layer or source ID
+    std::string property;
+    JsonValue value;
+    std::string before;  // empty: on top
+};
+
+struct StyleDiff {
+    // In the order they must be applied: removals, sources, layers (each
+    // one's `before` exists when it is added), then property changes.
+    std::vector<StyleOp> ops;
+    // Changes the ops cannot express ("sprite changed", ...). Any of these
+    // means the style has to be loaded again in full; `ops` is then empty.
+    std::vector<std::string> reload_reasons;
+
+    bool needs_reload() const {
+        return !reload_reasons.empty();
+    }
+};
+
+// The edits from `current` to `next`, two parsed style documents, along
+// the lines of MapLibre GL JS's diffStyles(): changed paint/layout keys,
+// filters and zoom ranges become SetProperty; new layers, and layers whose
+// type, source or source-layer changed, are (re)added; layers whose order
+// changed are removed and added back at their new position (the fewest
+// possible). A changed source is replaced together with its layers.
+// Top-level changes other than camera, name and metadata need a reload.
+StyleDiff diff_styles(const JsonValue& current, const JsonValue& next);
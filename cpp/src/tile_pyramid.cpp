@@ -0,0 +1,158 @@
+#include "tile_pyramid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "mbgl/util/geo.hpp"
+
+namespace {
+
+constexpr double kMaxLat = 85.0511287798066;
+
+double lon_to_x(double lon, double scale) {
+    return (lon + 180.0) / 360.0 * scale;
+}
+
+double lat_to_y(double lat, double scale) {
+    const double rad = std::clamp(lat, -kMaxLat, kMaxLat) * M_PI / 180.0;
+    return (1.0 - std::log(std::tan(rad) + 1.0 / std::cos(rad)) / M_PI) /
+           2.0 * scale;
+}
+
+uint32_t clamp_tile(double v, uint32_t tiles) {
+    const auto i = static_cast<int64_t>(std::floor(v));
+    return static_cast<uint32_t>(
+        std::clamp<int64_t>(i, 0, static_cast<int64_t>(tiles) - 1));
+}
+
+// Averages factor x factor blocks (premultiplied, so plain averaging is
+// correct for partially transparent pixels).
+mbgl::PremultipliedImage box_downsample(const mbgl::PremultipliedImage& src,
+                                        uint32_t factor) {
+    mbgl::PremultipliedImage dst(
+        {src.size.width / factor, src.size.height / factor});
+    const uint32_t area = factor * factor;
+    for (uint32_t y = 0; y < dst.size.height; ++y) {
+        for (uint32_t x = 0; x < dst.size.width; ++x) {
+            uint32_t sum[4] = {0, 0, 0, 0};
+            for (uint32_t dy = 0; dy < factor; ++dy) {
+                const uint8_t* row =
+                    src.data.get() +
+                    ((y * factor + dy) * src.size.width + x * factor) * 4;
+                for (uint32_t dx = 0; dx < factor * 4; ++dx) {
+                    sum[dx % 4] += row[dx];
+                }
+            }
+            uint8_t* out = dst.data.get() + (y * dst.size.width + x) * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[c] = static_cast<uint8_t>((sum[c] + area / 2) / area);
+            }
+        }
+    }
+    return dst;
+}
+
+}  // namespace
+
+std::optional<TileBounds> parse_tile_bounds(const std::string& text) {
+    std::istringstream in(text);
+    TileBounds b;
+    char c1 = 0, c2 = 0, c3 = 0;
+    if (!(in >> b.min_lon >> c1 >> b.min_lat >> c2 >> b.max_lon >> c3 >>
+          b.max_lat) ||
+        c1 != ',' || c2 != ',' || c3 != ',')
+        return std::nullopt;
+    if (b.min_lon > b.max_lon || b.min_lat > b.max_lat)
+        return std::nullopt;
+    return b;
+}
+
+TileRange tile_range(const TileBounds& bounds, uint8_t z) {
+    const uint32_t tiles = uint32_t{1} << z;
+    const double scale = static_cast<double>(tiles);
+    TileRange r;
+    r.z = z;
+    r.min_x = clamp_tile(lon_to_x(bounds.min_lon, scale), tiles);
+    r.max_x = clamp_tile(lon_to_x(bounds.max_lon, scale), tiles);
+    // North edge -> smallest y.
+    r.min_y = clamp_tile(lat_to_y(bounds.max_lat, scale), tiles);
+    r.max_y = clamp_tile(lat_to_y(bounds.min_lat, scale), tiles);
+    return r;
+}
+
+std::vector<Metatile> metatiles_for_range(const TileRange& range,
+                                          uint32_t metatile) {
+    metatile = std::max<uint32_t>(1, metatile);
+    std::vector<Metatile> out;
+    const uint32_t first_x = range.min_x / metatile * metatile;
+    const uint32_t first_y = range.min_y / metatile * metatile;
+    for (uint32_t by = first_y; by <= range.max_y; by += metatile) {
+        for (uint32_t bx = first_x; bx <= range.max_x; bx += metatile) {
+            Metatile mt;
+            mt.z = range.z;
+            mt.x = std::max(bx, range.min_x);
+            mt.y = std::max(by, range.min_y);
+            mt.width = std::min(bx + metatile - 1, range.max_x) - mt.x + 1;
+            mt.height = std::min(by + metatile - 1, range.max_y) - mt.y + 1;
+            out.push_back(mt);
+        }
+    }
+    return out;
+}
+
+MetatileRender metatile_render(const Metatile& mt, uint32_t tile_size) {
+    const double scale = static_cast<double>(uint32_t{1} << mt.z);
+    const double cx = (mt.x + mt.width / 2.0) / scale;
+    const double cy = (mt.y + mt.height / 2.0) / scale;
+    const double lon = cx * 360.0 - 180.0;
+    const double lat =
+        std::atan(std::sinh(M_PI * (1.0 - 2.0 * cy))) * 180.0 / M_PI;
+
+    MetatileRender r;
+    double zoom = mt.z + std::log2(static_cast<double>(tile_size) / 512.0);
+    while (zoom < 0.0) {
+        r.downsample *= 2;
+        zoom += 1.0;
+    }
+    r.width = mt.width * tile_size * r.downsample;
+    r.height = mt.height * tile_size * r.downsample;
+    r.camera = mbgl::CameraOptions()
+                   .withCenter(mbgl::LatLng{lat, lon})
+                   .withZoom(zoom)
+                   .withBearing(0.0)
+                   .withPitch(0.0);
+    return r;
+}
+
+std::vector<RenderedTile> split_metatile(const Metatile& mt,
+                                         const mbgl::PremultipliedImage& image,
+                                         uint32_t tile_px,
+                                         uint32_t downsample) {
+    std::vector<RenderedTile> tiles;
+    if (!image.valid() || tile_px == 0)
+        return tiles;
+    mbgl::PremultipliedImage scaled;
+    const mbgl::PremultipliedImage* src = &image;
+    if (downsample > 1) {
+        scaled = box_downsample(image, downsample);
+        src = &scaled;
+    }
+    if (src->size.width < mt.width * tile_px ||
+        src->size.height < mt.height * tile_px)
+        return tiles;
+
+    tiles.reserve(static_cast<std::size_t>(mt.width) * mt.height);
+    for (uint32_t ty = 0; ty < mt.height; ++ty) {
+        for (uint32_t tx = 0; tx < mt.width; ++tx) {
+            RenderedTile tile;
+            tile.id = TileID{mt.z, mt.x + tx, mt.y + ty};
+            tile.image = mbgl::PremultipliedImage({tile_px, tile_px});
+            mbgl::PremultipliedImage::copy(*src, tile.image,
+                                           {tx * tile_px, ty * tile_px},
+                                           {0, 0}, {tile_px, tile_px});
+            tiles.push_back(std::move(tile));
+        }
+    }
+    return tiles;
+}
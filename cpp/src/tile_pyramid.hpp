@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <mbgl/map/camera.hpp>
+#include <mbgl/util/image.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Web Mercator z/x/y tile math for pre-rendering raster tile pyramids
+// (mbgl-slint-tiles). Tiles use the XYZ scheme: y grows southwards.
+
+struct TileBounds {
+    double min_lon = -180.0;
+    double min_lat = -85.0511287798066;
+    double max_lon = 180.0;
+    double max_lat = 85.0511287798066;
+};
+
+struct TileID {
+    uint8_t z = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+
+    bool operator==(const TileID&) const = default;
+};
+
+// A block of up to size x size tiles rendered as one image and then split,
+// so labels are placed and vector tiles decoded once per block instead of
+// once per tile. Blocks at the edge of the requested range are smaller.
+struct Metatile {
+    uint8_t z = 0;
+    uint32_t x = 0;  // top-left tile
+    uint32_t y = 0;
+    uint32_t width = 1;  // in tiles
+    uint32_t height = 1;
+};
+
+struct TileRange {
+    uint8_t z = 0;
+    uint32_t min_x = 0;
+    uint32_t min_y = 0;
+    uint32_t max_x = 0;  // inclusive
+    uint32_t max_y = 0;
+
+    uint64_t count() const {
+        return uint64_t{max_x - min_x + 1} * (max_y - min_y + 1);
+    }
+};
+
+// "minlon,minlat,maxlon,maxlat"
+std::optional<TileBounds> parse_tile_bounds(const std::string& text);
+
+// Tiles at zoom `z` intersecting `bounds` (latitudes are clamped to the
+// Mercator limit).
+TileRange tile_range(const TileBounds& bounds, uint8_t z);
+
+// Covers `range` with metatiles of at most metatile x metatile tiles, aligned
+// to multiples of `metatile` so neighbouring runs produce identical blocks.
+std::vector<Metatile> metatiles_for_range(const TileRange& range,
+                                          uint32_t metatile);
+
+// How to render one metatile: the camera and the logical image size. MapLibre
+// zoom levels are defined for 512 px tiles, so 256 px tiles at z render at
+// zoom z - 1. Where that would be below zoom 0 (z0 with 256 px tiles) the
+// block is rendered `downsample` times larger at zoom 0 and scaled down.
+struct MetatileRender {
+    mbgl::CameraOptions camera;
+    uint32_t width = 0;  // logical pixels, before downsampling
+    uint32_t height = 0;
+    uint32_t downsample = 1;
+};
+
+MetatileRender metatile_render(const Metatile& mt, uint32_t tile_size);
+
+struct RenderedTile {
+    TileID id;
+    mbgl::PremultipliedImage image;
+};
+
+// Cuts a rendered metatile into its tiles of tile_px x tile_px physical
+// pixels (tile size * pixel ratio), box-filtering by `downsample` first.
+std::vector<RenderedTile> split_metatile(const Metatile& mt,
+                                         const mbgl::PremultipliedImage& image,
+                                         uint32_t tile_px,
+                                         uint32_t downsample = 1);
+
+// MBTiles stores rows in TMS order (y grows northwards).
+inline uint32_t tms_row(const TileID& tile) {
+    return (uint32_t{1} << tile.z) - 1 - tile.y;
+}
@@ -0,0 +1,241 @@
+#include "video_pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+namespace {
+
+uint8_t clamp_u8(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// BT.601 limited range, 8-bit fixed point.
+uint8_t luma(int r, int g, int b) {
+    return clamp_u8(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+uint8_t chroma_u(int r, int g, int b) {
+    return clamp_u8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+uint8_t chroma_v(int r, int g, int b) {
+    return clamp_u8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+double ms_since(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - from)
+        .count();
+}
+
+}  // namespace
+
+std::optional<VideoFormat> parse_video_format(const std::string& name) {
+    if (name == "y4m")
+        return VideoFormat::Y4M;
+    if (name == "rgb")
+        return VideoFormat::RGB;
+    return std::nullopt;
+}
+
+void rgba_to_yuv420(const mbgl::PremultipliedImage& image,
+                    uint8_t* y,
+                    uint8_t* u,
+                    uint8_t* v) {
+    const uint32_t w = image.size.width;
+    const uint32_t h = image.size.height;
+    const uint32_t cw = (w + 1) / 2;
+    const uint32_t ch = (h + 1) / 2;
+    const uint8_t* px = image.data.get();
+
+    for (uint32_t i = 0; i < w * h; ++i) {
+        y[i] = luma(px[i * 4], px[i * 4 + 1], px[i * 4 + 2]);
+    }
+    for (uint32_t cy = 0; cy < ch; ++cy) {
+        const uint32_t y0 = cy * 2;
+        const uint32_t y1 = std::min(y0 + 1, h - 1);
+        for (uint32_t cx = 0; cx < cw; ++cx) {
+            const uint32_t x0 = cx * 2;
+            const uint32_t x1 = std::min(x0 + 1, w - 1);
+            int sum[3] = {0, 0, 0};
+            for (const uint32_t row : {y0, y1}) {
+                for (const uint32_t col : {x0, x1}) {
+                    const uint8_t* p = px + (row * w + col) * 4;
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                }
+            }
+            const int r = (sum[0] + 2) / 4;
+            const int g = (sum[1] + 2) / 4;
+            const int b = (sum[2] + 2) / 4;
+            u[cy * cw + cx] = chroma_u(r, g, b);
+            v[cy * cw + cx] = chroma_v(r, g, b);
+        }
+    }
+}
+
+VideoPipeline::VideoPipeline(const std::string& path,
+                             uint32_t width_,
+                             uint32_t height_,
+                             Options options_)
+    : width(width_),
+      height(height_),
+      options(options_),
+      frames(options.queue_depth),
+      packets(options.queue_depth) {
+    if (path == "-") {
+        file = stdout;
+    } else {
+        file = std::fopen(path.c_str(), "wb");
+        owns_file = file != nullptr;
+    }
+    if (!file) {
+        fail("cannot open " + path);
+        finished = true;
+        return;
+    }
+
+    const std::string head = header();
+    if (!head.empty() &&
+        std::fwrite(head.data(), 1, head.size(), file) != head.size()) {
+        fail("cannot write the stream header");
+    }
+
+    const std::size_t threads =
+        std::max<std::size_t>(1, options.convert_threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        converters.emplace_back([this] { convert_loop(); });
+    }
+    writer = std::thread([this] { write_loop(); });
+}
+
+VideoPipeline::~VideoPipeline() {
+    finish();
+}
+
+std::string VideoPipeline::header() const {
+    if (options.format != VideoFormat::Y4M)
+        return {};
+    // C420jpeg: 4:2:0 with centred chroma, matching the 2x2 averaging.
+    return "YUV4MPEG2 W" + std::to_string(width) + " H" +
+           std::to_string(height) + " F" + std::to_string(options.fps) +
+           ":1 Ip A1:1 C420jpeg\n";
+}
+
+std::string VideoPipeline::convert(
+    const mbgl::PremultipliedImage& image) const {
+    const std::size_t pixels = std::size_t{width} * height;
+    std::string out;
+    if (options.format == VideoFormat::Y4M) {
+        static const char kFrame[] = "FRAME\n";
+        const std::size_t chroma =
+            std::size_t{(width + 1) / 2} * ((height + 1) / 2);
+        out.resize(sizeof(kFrame) - 1 + pixels + chroma * 2);
+        auto* p = reinterpret_cast<uint8_t*>(out.data());
+        std::copy(kFrame, kFrame + sizeof(kFrame) - 1, p);
+        p += sizeof(kFrame) - 1;
+        rgba_to_yuv420(image, p, p + pixels, p + pixels + chroma);
+    } else {
+        out.resize(pixels * 3);
+        auto* dst = reinterpret_cast<uint8_t*>(out.data());
+        const uint8_t* src = image.data.get();
+        for (std::size_t i = 0; i < pixels; ++i) {
+            dst[i * 3] = src[i * 4];
+            dst[i * 3 + 1] = src[i * 4 + 1];
+            dst[i * 3 + 2] = src[i * 4 + 2];
+        }
+    }
+    return out;
+}
+
+bool VideoPipeline::push(mbgl::PremultipliedImage&& frame) {
+    if (finished || !frame.valid() || frame.size.width != width ||
+        frame.size.height != height) {
+        fail("rejected frame " + std::to_string(next_index) +
+             (finished ? ": already finished" : ": wrong size"));
+        return false;
+    }
+    Frame f;
+    f.index = next_index++;
+    f.image = std::move(frame);
+    return frames.push(std::move(f));
+}
+
+void VideoPipeline::convert_loop() {
+    while (auto frame = frames.pop()) {
+        const auto t0 = std::chrono::steady_clock::now();
+        Packet packet;
+        packet.index = frame->index;
+        packet.data = convert(frame->image);
+        // Free the RGBA frame before possibly blocking on the writer.
+        frame->image = mbgl::PremultipliedImage();
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            totals.convert_ms += ms_since(t0);
+        }
+        packets.push(std::move(packet));
+    }
+}
+
+void VideoPipeline::write_loop() {
+    // Converters finish out of order; hold packets until their turn. At most
+    // the in-flight frames (queue depths plus converters) wait here.
+    std::map<uint64_t, std::string> pending;
+    uint64_t next = 0;
+    while (auto packet = packets.pop()) {
+        pending.emplace(packet->index, std::move(packet->data));
+        for (auto it = pending.find(next); it != pending.end();
+             it = pending.find(next)) {
+            const auto t0 = std::chrono::steady_clock::now();
+            const std::string& data = it->second;
+            if (std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+                fail("write failed at frame " + std::to_string(next));
+            }
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            totals.write_ms += ms_since(t0);
+            totals.bytes += data.size();
+            ++totals.frames;
+            pending.erase(it);
+            ++next;
+        }
+    }
+    if (!pending.empty()) {
+        fail("frame " + std::to_string(next) + " was lost");
+    }
+}
+
+bool VideoPipeline::finish() {
+    if (finished)
+        return ok();
+    finished = true;
+    frames.close();
+    for (auto& t : converters) {
+        t.join();
+    }
+    packets.close();
+    writer.join();
+    if (std::fflush(file) != 0)
+        fail("flush failed");
+    if (owns_file && std::fclose(file) != 0)
+        fail("close failed");
+    file = nullptr;
+    owns_file = false;
+    return ok();
+}
+
+void VideoPipeline::fail(std::string message) {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (first_error.empty())
+        first_error = std::move(message);
+    failed = true;
+}
+
+std::string VideoPipeline::error() const {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    return first_error;
+}
+
+VideoPipeline::Stats VideoPipeline::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return totals;
+}
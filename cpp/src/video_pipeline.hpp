@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mbgl/util/image.hpp>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+
+enum class VideoFormat {
+    Y4M,  // YUV4MPEG2, 4:2:0, BT.601 limited range; playable and ffmpeg-ready
+    RGB,  // headerless rgb24 frames for `ffmpeg -f rawvideo -pix_fmt rgb24`
+};
+
+std::optional<VideoFormat> parse_video_format(const std::string& name);
+
+// Converts one premultiplied RGBA frame to planar 4:2:0. Premultiplied
+// colour is the frame composited over black, which is what a video without
+// alpha should show. Chroma is the average of each 2x2 block (odd sizes
+// round up). `y` needs w*h bytes, `u` and `v` ((w+1)/2)*((h+1)/2) each.
+void rgba_to_yuv420(const mbgl::PremultipliedImage& image,
+                    uint8_t* y,
+                    uint8_t* u,
+                    uint8_t* v);
+
+// Streams rendered frames to a file or pipe without keeping the sequence in
+// memory. push() hands a frame over by move; conversion (RGBA -> YUV/RGB)
+// runs on `convert_threads` workers and a dedicated writer thread puts the
+// packets back in order and writes them. Both queues are bounded, so a
+// renderer that outpaces the disk or pipe blocks in push().
+//
+//   VideoPipeline video("flight.y4m", 1280, 720, {});
+//   for (...) video.push(renderer.render(request).image);
+//   video.finish();
+class VideoPipeline {
+public:
+    struct Options {
+        VideoFormat format = VideoFormat::Y4M;
+        int fps = 30;
+        std::size_t convert_threads = 2;
+        std::size_t queue_depth = 4;
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        double convert_ms = 0.0;  // summed over converter threads
+        double write_ms = 0.0;
+    };
+
+    // `path` "-" writes to stdout. Every frame must be width x height.
+    VideoPipeline(const std::string& path,
+                  uint32_t width,
+                  uint32_t height,
+                  Options options);
+    // Calls finish().
+    ~VideoPipeline();
+
+    VideoPipeline(const VideoPipeline&) = delete;
+    VideoPipeline& operator=(const VideoPipeline&) = delete;
+
+    // False if the output could not be opened or a frame was lost; error()
+    // then says what went wrong first. The pipeline never logs: with "-" its
+    // output is stdout.
+    bool ok() const {
+        return !failed;
+    }
+    std::string error() const;
+
+    // Blocks while the conversion queue is full. A frame of the wrong size
+    // is rejected.
+    bool push(mbgl::PremultipliedImage&& frame);
+
+    // Drains both stages, flushes and closes the output. Returns false if
+    // any frame failed to convert or write.
+    bool finish();
+
+    Stats stats() const;
+
+private:
+    struct Frame {
+        uint64_t index = 0;
+        mbgl::PremultipliedImage image;
+    };
+    struct Packet {
+        uint64_t index = 0;
+        std::string data;
+    };
+
+    std::string header() const;
+    std::string convert(const mbgl::PremultipliedImage& image) const;
+    void convert_loop();
+    void write_loop();
+    void fail(std::string message);
+
+    const uint32_t width;
+    const uint32_t height;
+    const Options options;
+
+    std::FILE* file = nullptr;
+    bool owns_file = false;
+    bool finished = false;
+    std::atomic<bool> failed{false};
+    mutable std::mutex error_mutex;
+    std::string first_error;
+    uint64_t next_index = 0;
+
+    BoundedQueue<Frame> frames;
+    BoundedQueue<Packet> packets;
+
+    mutable std::mutex stats_mutex;
+    Stats totals;
+
+    std::vector<std::thread> converters;
+    std::thread writer;
+};
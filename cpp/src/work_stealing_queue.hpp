@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Fixed set of per-worker job deques. A worker takes jobs from the front of
+// its own deque (in the order they were pushed, which keeps neighbouring
+// tiles on one worker and its caches warm) and, once that is empty, steals
+// from the back of the others'. Jobs are known up front, so there is no
+// blocking: pop() returning nullopt means all work has been handed out.
+template <typename T>
+class WorkStealingQueue {
+public:
+    explicit WorkStealingQueue(std::size_t workers)
+        : queues(workers == 0 ? 1 : workers) {
+    }
+
+    std::size_t workers() const {
+        return queues.size();
+    }
+
+    void push(std::size_t worker, T job) {
+        auto& q = queues[worker % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.jobs.push_back(std::move(job));
+    }
+
+    // Splits `jobs` into contiguous runs, one per worker.
+    void distribute(std::vector<T> jobs) {
+        const std::size_t n = queues.size();
+        const std::size_t per = (jobs.size() + n - 1) / n;
+        for (std::size_t i = 0; i < jobs.size(); ++i) {
+            push(per ? i / per : 0, std::move(jobs[i]));
+        }
+    }
+
+    std::optional<T> pop(std::size_t worker) {
+        const std::size_t n = queues.size();
+        worker %= n;
+        {
+            auto& own = queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                T job = std::move(own.jobs.front());
+                own.jobs.pop_front();
+                return job;
+            }
+        }
+        for (std::size_t i = 1; i < n; ++i) {
+            auto& victim = queues[(worker + i) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                T job = std::move(victim.jobs.back());
+                victim.jobs.pop_back();
+                steal_count.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Number of jobs taken from another worker's deque (approximate while
+    // workers are running).
+    std::size_t steals() const {
+        return steal_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Deque {
+        std::mutex mutex;
+        std::deque<T> jobs;
+    };
+
+    std::vector<Deque> queues;
+    std::atomic<std::size_t> steal_count{0};
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+
+// Fixed number of threads running tasks from a BoundedQueue. submit() blocks
+// while `queue_depth` tasks are already waiting, so a producer that outpaces
+// the workers is slowed down instead of piling up memory. The destructor
+// finishes every task that was accepted, then joins.
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkerPool(std::size_t threads, std::size_t queue_depth)
+        : tasks(queue_depth) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] {
+                while (auto task = tasks.pop()) {
+                    (*task)();
+                }
+            });
+        }
+    }
+
+    ~WorkerPool() {
+        tasks.close();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Returns false once the pool is shutting down.
+    bool submit(Task task) {
+        return tasks.push(std::move(task));
+    }
+    // Fails instead of waiting when `queue_depth` tasks are waiting (for
+    // callers that must not block, e.g. the UI thread).
+    bool try_submit(Task task) {
+        return tasks.try_push(std::move(task));
+    }
+
+    std::size_t threads() const {
+        return workers.size();
+    }
+    std::size_t pending() const {
+        return tasks.size();
+    }
+
+private:
+    BoundedQueue<Task> tasks;
+    std::vector<std::thread> workers;
+};
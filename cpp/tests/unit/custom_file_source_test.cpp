@@ -3,6 +3,13 @@
 #include <gtest/gtest.h>
 #include <mbgl/storage/resource.hpp>
 
+namespace {
+
+// Discard port on the loopback interface: refused locally, never routed.
+const std::string kLoopback = "http://127.0.0.1:9";
+
+}  // namespace
+
 class CustomFileSourceTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -327,4 +334,93 @@ TEST_F(CustomFileSourceTest, HttpAndHttpsComparison) {
 
     EXPECT_TRUE(file_source->canRequest(http_resource));
     EXPECT_TRUE(file_source->canRequest(https_resource));
-}
\ No newline at end of file
+}
+
+TEST_F(CustomFileSourceTest, MetricsCountRequestsPerKind) {
+    // Requests are counted when issued. They go to a closed loopback port,
+    // so the test never leaves the machine.
+    auto tile = file_source->request(
+        mbgl::Resource(mbgl::Resource::Kind::Tile,
+                       kLoopback + "/tiles/1/2/3.mvt"),
+        [](mbgl::Response) {});
+    auto glyphs = file_source->request(
+        mbgl::Resource(mbgl::Resource::Kind::Glyphs,
+                       kLoopback + "/fonts/Arial/0-255.pbf"),
+        [](mbgl::Response) {});
+
+    auto snapshot = file_source->metrics_snapshot();
+    EXPECT_EQ(snapshot.kind(mbgl::Resource::Kind::Tile).requests, 1u);
+    EXPECT_EQ(snapshot.kind(mbgl::Resource::Kind::Glyphs).requests, 1u);
+    EXPECT_EQ(snapshot.kind(mbgl::Resource::Kind::Style).requests, 0u);
+    EXPECT_EQ(snapshot.total().requests, 2u);
+}
+
+TEST_F(CustomFileSourceTest, MetricsCanBeShared) {
+    // Two file sources feeding one set of counters
+    auto metrics = std::make_shared<mbgl::FileSourceMetrics>();
+    mbgl::CustomFileSource a(metrics);
+    mbgl::CustomFileSource b(metrics);
+    auto ra = a.request(mbgl::Resource(mbgl::Resource::Kind::Style,
+                                       kLoopback + "/a.json"),
+                        [](mbgl::Response) {});
+    auto rb = b.request(mbgl::Resource(mbgl::Resource::Kind::Style,
+                                       kLoopback + "/b.json"),
+                        [](mbgl::Response) {});
+
+    EXPECT_EQ(&a.metrics(), metrics.get());
+    EXPECT_EQ(metrics->snapshot().kind(mbgl::Resource::Kind::Style).requests,
+              2u);
+}
+
+TEST(FileSourceMetricsTest, LatencyBucketsAreLog2Microseconds) {
+    using us = std::chrono::microseconds;
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(us(0)), 0u);
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(us(1)), 0u);
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(us(2)), 1u);
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(us(1023)), 9u);
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(us(1024)), 10u);
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(us(-5)), 0u);
+    EXPECT_EQ(mbgl::FileSourceMetrics::bucket_for(std::chrono::hours(24)),
+              mbgl::FileSourceMetrics::kLatencyBuckets - 1);
+}
+
+TEST(FileSourceMetricsTest, SnapshotAggregatesCounters) {
+    using Kind = mbgl::Resource::Kind;
+    using Phase = mbgl::FileSourceMetrics::Phase;
+    using Reason = mbgl::Response::Error::Reason;
+    mbgl::FileSourceMetrics metrics;
+
+    for (int i = 1; i <= 100; ++i) {
+        metrics.record_request(Kind::Tile);
+        metrics.record_latency(Kind::Tile, Phase::Total,
+                               std::chrono::milliseconds(i));
+    }
+    metrics.record_response(Kind::Tile, 1000, false);
+    metrics.record_response(Kind::Tile, 0, true);
+    metrics.record_response(Kind::Tile, 0, false);
+    metrics.record_error(Kind::Tile, Reason::NotFound);
+    metrics.record_cancelled(Kind::Tile);
+    metrics.record_error(Kind::Style, Reason::Connection);
+
+    const auto snapshot = metrics.snapshot();
+    const auto& tiles = snapshot.kind(Kind::Tile);
+    EXPECT_EQ(tiles.requests, 100u);
+    EXPECT_EQ(tiles.completed, 3u);
+    EXPECT_EQ(tiles.bytes, 1000u);
+    EXPECT_EQ(tiles.errors, 1u);
+    EXPECT_EQ(tiles.cancelled, 1u);
+    EXPECT_DOUBLE_EQ(tiles.cache_hit_ratio(), 1.0 / 3.0);
+    EXPECT_EQ(snapshot.errors(Reason::NotFound), 1u);
+    EXPECT_EQ(snapshot.errors(Reason::Connection), 1u);
+    EXPECT_EQ(snapshot.total().errors, 2u);
+
+    // Percentiles resolve to the upper bound of a power-of-two bucket
+    const auto& total = tiles.histogram(Phase::Total);
+    EXPECT_EQ(total.count, 100u);
+    EXPECT_DOUBLE_EQ(total.mean_ms(), 50.5);
+    EXPECT_DOUBLE_EQ(total.percentile_ms(0.5), 65.536);
+    EXPECT_DOUBLE_EQ(total.percentile_ms(0.99), 131.072);
+
+    metrics.reset();
+    EXPECT_EQ(metrics.snapshot().total().requests, 0u);
+}
@@ -0,0 +1,111 @@
+#include "embedded_file_source.hpp"
+
+#include <gtest/gtest.h>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+const std::string kStyleJson =
+    R"JSON({"version": 8, "sources": {}, "layers": []})JSON";
+const std::string kSpriteJson = R"JSON({"dot": {"width": 8, "height": 8}})JSON";
+
+// Same encoding embed_resources.cmake produces: a gzip member.
+std::vector<unsigned char> gzip(const std::string& input) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                 Z_DEFAULT_STRATEGY);
+    std::vector<unsigned char> out(deflateBound(&stream, input.size()) + 32);
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = out.data();
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+}  // namespace
+
+class EmbeddedFileSourceTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        static const auto compressed = gzip(kSpriteJson);
+        static const mbgl::EmbeddedResource resources[] = {
+            {"test/style.json",
+             reinterpret_cast<const unsigned char*>(kStyleJson.data()),
+             kStyleJson.size(), kStyleJson.size(), false},
+            {"test/sprite.json", compressed.data(), compressed.size(),
+             kSpriteJson.size(), true},
+        };
+        mbgl::EmbeddedResources::add(resources, 2);
+    }
+
+    // Issues one request and runs the loop until its callback fires.
+    mbgl::Response fetch(mbgl::Resource::Kind kind, const std::string& url) {
+        mbgl::Response result;
+        auto request = file_source.request(
+            mbgl::Resource(kind, url), [&](mbgl::Response response) {
+                result = response;
+                loop.stop();
+            });
+        EXPECT_NE(request, nullptr);
+        loop.run();
+        return result;
+    }
+
+    mbgl::util::RunLoop loop;
+    mbgl::EmbeddedFileSource file_source;
+};
+
+TEST_F(EmbeddedFileSourceTest, RegistryDecodesRawAndGzip) {
+    EXPECT_TRUE(mbgl::EmbeddedResources::contains("test/style.json"));
+    EXPECT_FALSE(mbgl::EmbeddedResources::contains("test/missing.json"));
+
+    auto style = mbgl::EmbeddedResources::get("test/style.json");
+    ASSERT_NE(style, nullptr);
+    EXPECT_EQ(*style, kStyleJson);
+
+    // Decompressed once and shared afterwards.
+    auto sprite = mbgl::EmbeddedResources::get("test/sprite.json");
+    ASSERT_NE(sprite, nullptr);
+    EXPECT_EQ(*sprite, kSpriteJson);
+    EXPECT_EQ(sprite, mbgl::EmbeddedResources::get("test/sprite.json"));
+}
+
+TEST_F(EmbeddedFileSourceTest, CanRequestOnlyEmbeddedScheme) {
+    EXPECT_TRUE(file_source.canRequest(mbgl::Resource(
+        mbgl::Resource::Kind::Style, "embedded://test/style.json")));
+    // Without a fallback nothing else is handled.
+    EXPECT_FALSE(file_source.canRequest(mbgl::Resource(
+        mbgl::Resource::Kind::Style, "https://example.com/style.json")));
+}
+
+TEST_F(EmbeddedFileSourceTest, ServesEmbeddedResource) {
+    auto response = fetch(mbgl::Resource::Kind::SpriteJSON,
+                          "embedded://test/sprite.json?fresh=true");
+    EXPECT_EQ(response.error, nullptr);
+    ASSERT_NE(response.data, nullptr);
+    EXPECT_EQ(*response.data, kSpriteJson);
+}
+
+TEST_F(EmbeddedFileSourceTest, MissingResourceIsNotFound) {
+    auto response =
+        fetch(mbgl::Resource::Kind::Style, "embedded://test/missing.json");
+    ASSERT_NE(response.error, nullptr);
+    EXPECT_EQ(response.error->reason,
+              mbgl::Response::Error::Reason::NotFound);
+}
+
+TEST_F(EmbeddedFileSourceTest, MissingTileIsNoContent) {
+    auto response =
+        fetch(mbgl::Resource::Kind::Tile, "embedded://test/tiles/9/1/1.pbf");
+    EXPECT_EQ(response.error, nullptr);
+    EXPECT_TRUE(response.noContent);
+}
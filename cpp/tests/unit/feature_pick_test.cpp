@@ -0,0 +1,54 @@
+#include "feature_pick.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<PickedFeature> features(const std::string& name) {
+    PickedFeature feature;
+    feature.source_id = "pois";
+    feature.name = name;
+    return {feature};
+}
+
+}  // namespace
+
+TEST(PickCacheTest, AnswersRepeatedQueriesWithinAFrame) {
+    PickCache cache;
+    cache.begin_frame(1);
+    EXPECT_EQ(cache.find(10.2f, 20.4f), nullptr);
+    cache.insert(10.2f, 20.4f, features("cafe"));
+    // Sub-pixel pointer jitter hits the same entry.
+    const auto* hit = cache.find(9.8f, 19.6f);
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->front().name, "cafe");
+    EXPECT_EQ(cache.find(12.0f, 20.0f), nullptr);
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 2u);
+}
+
+TEST(PickCacheTest, ANewFrameDropsEverything) {
+    PickCache cache;
+    cache.begin_frame(1);
+    cache.insert(1.0f, 1.0f, features("a"));
+    cache.begin_frame(2);
+    EXPECT_EQ(cache.frame(), 2u);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.find(1.0f, 1.0f), nullptr);
+}
+
+TEST(PickCacheTest, ReplacesTheOldestWhenFull) {
+    PickCache cache(2);
+    cache.insert(1.0f, 0.0f, features("a"));
+    cache.insert(2.0f, 0.0f, features("b"));
+    cache.insert(3.0f, 0.0f, features("c"));  // replaces a
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(1.0f, 0.0f), nullptr);
+    ASSERT_NE(cache.find(2.0f, 0.0f), nullptr);
+    ASSERT_NE(cache.find(3.0f, 0.0f), nullptr);
+    cache.insert(4.0f, 0.0f, features("d"));  // replaces b
+    EXPECT_EQ(cache.find(2.0f, 0.0f), nullptr);
+    EXPECT_EQ(cache.find(3.0f, 0.0f)->front().name, "c");
+}
@@ -0,0 +1,145 @@
+#include "frame_damage.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> make_frame(int width, int height) {
+    std::vector<uint8_t> frame(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < frame.size(); ++i)
+        frame[i] = static_cast<uint8_t>(i * 31 % 251);
+    return frame;
+}
+
+void touch(std::vector<uint8_t>& frame, int width, int x, int y) {
+    frame[(static_cast<std::size_t>(y) * width + x) * 4 + 1] ^= 0x40;
+}
+
+}  // namespace
+
+TEST(FrameDamageTest, SpansEqualFindsADifferenceAtAnyOffset) {
+    std::vector<uint8_t> a(203, 7), b(203, 7);
+    EXPECT_TRUE(spans_equal(a.data(), b.data(), a.size()));
+    // Covers the 64-byte, 16-byte, 8-byte and byte-wise tails.
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        b[i] = 8;
+        EXPECT_FALSE(spans_equal(a.data(), b.data(), a.size())) << i;
+        b[i] = 7;
+    }
+}
+
+TEST(FrameDamageTest, EqualFramesHaveNoDamage) {
+    const auto a = make_frame(200, 120);
+    const auto b = a;
+    EXPECT_TRUE(diff_frames(a.data(), b.data(), 200, 120).empty());
+}
+
+TEST(FrameDamageTest, OnePixelDamagesItsTile) {
+    const auto a = make_frame(200, 120);
+    auto b = a;
+    touch(b, 200, 70, 40);
+    const auto rects = diff_frames(a.data(), b.data(), 200, 120);
+    ASSERT_EQ(rects.size(), 1u);
+    EXPECT_EQ(rects[0], (DamageRect{64, 32, 32, 32}));
+}
+
+TEST(FrameDamageTest, EdgeTilesAreClippedToTheFrame) {
+    const auto a = make_frame(200, 120);
+    auto b = a;
+    touch(b, 200, 199, 119);
+    const auto rects = diff_frames(a.data(), b.data(), 200, 120);
+    ASSERT_EQ(rects.size(), 1u);
+    EXPECT_EQ(rects[0], (DamageRect{192, 96, 8, 24}));
+}
+
+TEST(FrameDamageTest, AdjacentTilesMergeIntoOneRect) {
+    const auto a = make_frame(256, 256);
+    auto b = a;
+    // A 2x3-tile block: one rect, not six.
+    for (int y = 40; y < 130; y += 20)
+        for (int x = 70; x < 130; x += 10)
+            touch(b, 256, x, y);
+    const auto rects = diff_frames(a.data(), b.data(), 256, 256);
+    ASSERT_EQ(rects.size(), 1u);
+    EXPECT_EQ(rects[0], (DamageRect{64, 32, 64, 96}));
+    EXPECT_EQ(damage_area(rects), 64 * 96);
+}
+
+TEST(FrameDamageTest, SeparateChangesStaySeparate) {
+    const auto a = make_frame(256, 256);
+    auto b = a;
+    touch(b, 256, 5, 5);
+    touch(b, 256, 250, 250);
+    const auto rects = diff_frames(a.data(), b.data(), 256, 256);
+    ASSERT_EQ(rects.size(), 2u);
+    EXPECT_EQ(rects[0], (DamageRect{0, 0, 32, 32}));
+    EXPECT_EQ(rects[1], (DamageRect{224, 224, 32, 32}));
+}
+
+TEST(FrameDamageTest, ScatteredDamageCollapsesToItsBoundingBox) {
+    // A checkerboard of dirty tiles is more rects than kMaxDamageRects.
+    const int columns = 8, rows = 8;
+    std::vector<uint8_t> dirty(columns * rows, 0);
+    for (int r = 1; r < rows; ++r)
+        for (int c = (r % 2); c < columns - 1; c += 2)
+            dirty[r * columns + c] = 1;
+    const auto rects =
+        merge_damage_tiles(dirty, columns, rows, 32, 8 * 32, 8 * 32);
+    ASSERT_EQ(rects.size(), 1u);
+    EXPECT_EQ(rects[0], (DamageRect{0, 32, 224, 224}));
+}
+
+TEST(FrameDamageTest, UnpremultiplyRectTouchesOnlyTheRect) {
+    const int width = 4;
+    std::vector<uint8_t> src(width * 2 * 4), dst(src.size(), 0xee);
+    for (std::size_t i = 0; i < src.size(); i += 4) {
+        src[i] = 64;
+        src[i + 1] = 0;
+        src[i + 2] = 128;
+        src[i + 3] = 128;
+    }
+    unpremultiply_rect(src.data(), dst.data(), width, {1, 1, 2, 1});
+
+    const uint8_t* px = &dst[(1 * width + 1) * 4];
+    EXPECT_EQ(px[0], 128);
+    EXPECT_EQ(px[1], 0);
+    EXPECT_EQ(px[2], 255);
+    EXPECT_EQ(px[3], 128);
+    EXPECT_EQ(dst[(1 * width + 3) * 4], 0xee);
+    EXPECT_EQ(dst[(0 * width + 1) * 4], 0xee);
+}
+
+TEST(FrameDamageTest, OpacityScanFindsAnyTranslucentPixel) {
+    const int width = 37, height = 3;
+    std::vector<uint8_t> frame(width * height * 4, 0xff);
+    const DamageRect all{0, 0, width, height};
+    EXPECT_TRUE(rect_is_opaque(frame.data(), width, all));
+    for (int x = 0; x < width; ++x) {
+        frame[(width + x) * 4 + 3] = 0xfe;
+        EXPECT_FALSE(rect_is_opaque(frame.data(), width, all)) << x;
+        // Outside the scanned rect it does not count.
+        EXPECT_TRUE(rect_is_opaque(frame.data(), width, {0, 2, width, 1}));
+        frame[(width + x) * 4 + 3] = 0xff;
+    }
+}
+
+TEST(FrameDamageTest, PackRgbDropsAlphaInsideTheRect) {
+    const int width = 40, height = 2;
+    const auto rgba = make_frame(width, height);
+    std::vector<uint8_t> rgb(width * height * 3, 0xee);
+    // Odd offsets and widths cover the vector body and the scalar tail.
+    const DamageRect rect{3, 1, 33, 1};
+    pack_rgb_rect(rgba.data(), rgb.data(), width, rect);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::size_t i = static_cast<std::size_t>(y) * width + x;
+            const bool inside = y == 1 && x >= 3 && x < 36;
+            for (int c = 0; c < 3; ++c) {
+                EXPECT_EQ(rgb[i * 3 + c], inside ? rgba[i * 4 + c] : 0xee)
+                    << x << "," << y;
+            }
+        }
+    }
+}
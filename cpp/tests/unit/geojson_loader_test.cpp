@@ -0,0 +1,107 @@
+#include "geojson_loader.hpp"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::string points(int count) {
+    std::string json = R"({"type":"FeatureCollection","features":[)";
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            json += ',';
+        json += R"({"type":"Feature","properties":{"n":)" +
+                std::to_string(i) +
+                R"(},"geometry":{"type":"Point","coordinates":[)" +
+                std::to_string(-170.0 + (i % 340)) + ',' +
+                std::to_string(-80.0 + (i % 160)) + "]}}";
+    }
+    return json + "]}";
+}
+
+mbgl::Immutable<mbgl::style::GeoJSONOptions> options(bool cluster) {
+    auto mutable_options = mbgl::makeMutable<mbgl::style::GeoJSONOptions>();
+    mutable_options->cluster = cluster;
+    return mutable_options;
+}
+
+// Delivers on this thread until `count` loads came back (or 10 s passed).
+void wait_for(GeoJsonLoader& loader,
+              const std::vector<GeoJsonLoadResult>& delivered,
+              std::size_t count) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (delivered.size() < count &&
+           std::chrono::steady_clock::now() < deadline) {
+        loader.deliver_completed();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}  // namespace
+
+TEST(GeoJsonLoaderTest, BuildsTheIndexFromText) {
+    GeoJsonInput input;
+    input.json = points(1000);
+    const auto result = build_geojson_data(std::move(input), options(false));
+    ASSERT_TRUE(result.data) << result.error;
+    EXPECT_EQ(result.features, 1000u);
+}
+
+TEST(GeoJsonLoaderTest, ClustersBuiltFeatures) {
+    GeoJsonInput input;
+    mapbox::feature::feature_collection<double> features;
+    for (int i = 0; i < 500; ++i)
+        features.emplace_back(mapbox::geometry::point<double>(i * 0.01, 0.0));
+    input.features = mbgl::GeoJSON(std::move(features));
+    const auto result = build_geojson_data(std::move(input), options(true));
+    ASSERT_TRUE(result.data) << result.error;
+    EXPECT_EQ(result.features, 500u);
+    EXPECT_EQ(result.parse_ms, 0.0);
+}
+
+TEST(GeoJsonLoaderTest, ReportsBadInput) {
+    GeoJsonInput text;
+    text.json = "{\"type\":";
+    const auto malformed = build_geojson_data(std::move(text), options(false));
+    EXPECT_FALSE(malformed.data);
+    EXPECT_FALSE(malformed.error.empty());
+    GeoJsonInput file;
+    file.path = "/nonexistent/data.geojson";
+    const auto missing = build_geojson_data(std::move(file), options(false));
+    EXPECT_FALSE(missing.data);
+    EXPECT_NE(missing.error.find("cannot read"), std::string::npos);
+    EXPECT_FALSE(build_geojson_data(GeoJsonInput{}, options(false)).data);
+}
+
+TEST(GeoJsonLoaderTest, DeliversOnTheCallingThread) {
+    GeoJsonLoader loader;
+    std::vector<GeoJsonLoadResult> results;
+    const auto caller = std::this_thread::get_id();
+    std::vector<uint64_t> generations;
+    for (int i = 0; i < 3; ++i) {
+        GeoJsonInput input;
+        input.json = points(100 * (i + 1));
+        generations.push_back(loader.load(
+            "data", std::move(input), options(i == 2),
+            [&](GeoJsonLoadResult&& result) {
+                EXPECT_EQ(std::this_thread::get_id(), caller);
+                results.push_back(std::move(result));
+            }));
+    }
+    EXPECT_LT(generations[0], generations[1]);
+    EXPECT_LT(generations[1], generations[2]);
+    wait_for(loader, results, 3);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(loader.pending(), 0u);
+    for (const auto& result : results) {
+        EXPECT_EQ(result.id, "data");
+        EXPECT_TRUE(result.data) << result.error;
+        EXPECT_EQ(result.features, 100u * (result.generation -
+                                           generations[0] + 1));
+    }
+}
@@ -0,0 +1,58 @@
+#include "gl_instanced_points.hpp"
+
+#include <GLES3/gl3.h>
+#include <array>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "egl_headless_context.hpp"
+#include "gl_render_target.hpp"
+
+namespace {
+
+constexpr int kSize = 64;
+
+// Identity: offsets are clip coordinates.
+constexpr std::array<float, 16> kIdentity{1, 0, 0, 0, 0, 1, 0, 0,
+                                          0, 0, 1, 0, 0, 0, 0, 1};
+
+std::array<uint8_t, 4> pixel(int x, int y) {
+    std::array<uint8_t, 4> rgba{};
+    glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    return rgba;
+}
+
+}  // namespace
+
+TEST(GLInstancedPointsTest, DrawsEveryPointInOneCall) {
+    EGLHeadlessContext gl;
+    if (!gl.ok())
+        GTEST_SKIP() << "no GLES 3 context: " << gl.error();
+    GLRenderTarget target;
+    target.resize(kSize, kSize);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo());
+    glViewport(0, 0, kSize, kSize);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    GLInstancedPoints points;
+    ASSERT_TRUE(points.init());
+    // Left and right of the centre; nothing at the centre itself.
+    points.set_points({-0.5f, 0.0f, 0.5f, 0.0f});
+    EXPECT_EQ(points.size(), 2u);
+    points.draw(kIdentity, kSize, kSize, 8.0f, {1.0f, 0.0f, 0.0f, 1.0f});
+    glFinish();
+
+    EXPECT_EQ(points.stats().draw_calls, 1u);
+    EXPECT_EQ(points.stats().instances, 2u);
+    EXPECT_EQ(pixel(kSize / 4, kSize / 2)[0], 255);
+    EXPECT_EQ(pixel(kSize * 3 / 4, kSize / 2)[0], 255);
+    EXPECT_EQ(pixel(kSize / 2, kSize / 2)[0], 0);
+    // Round: the quad's corner stays clear.
+    EXPECT_EQ(pixel(kSize / 4 + 3, kSize / 2 + 3)[0], 0);
+
+    points.release();
+    EXPECT_FALSE(points.ready());
+    target.destroy();
+}
@@ -0,0 +1,64 @@
+#include "gl_layer_projection.hpp"
+
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace {
+
+// An orthographic stand-in for MapLibre's matrix: world pixels around
+// (cx, cy) to clip space for a w x h view (y up, like GL).
+GLLayerProjection::Matrix ortho(double cx, double cy, double w, double h) {
+    GLLayerProjection::Matrix m{};
+    m[0] = 2.0 / w;
+    m[5] = -2.0 / h;
+    m[10] = 1.0;
+    m[12] = -cx * 2.0 / w;
+    m[13] = cy * 2.0 / h;
+    m[15] = 1.0;
+    return m;
+}
+
+std::array<double, 4> apply(const std::array<float, 16>& m, float x,
+                            float y) {
+    std::array<double, 4> out{};
+    for (int row = 0; row < 4; ++row)
+        out[row] = double(m[row]) * x + double(m[4 + row]) * y + m[12 + row];
+    return out;
+}
+
+}  // namespace
+
+TEST(GLLayerProjectionTest, MercatorMatchesKnownPoints) {
+    const auto origin = GLLayerProjection::mercator(0.0, 0.0);
+    EXPECT_DOUBLE_EQ(origin[0], 0.5);
+    EXPECT_NEAR(origin[1], 0.5, 1e-12);
+    const auto north_west = GLLayerProjection::mercator(85.0511287798, -180.0);
+    EXPECT_NEAR(north_west[0], 0.0, 1e-12);
+    EXPECT_NEAR(north_west[1], 0.0, 1e-9);
+}
+
+TEST(GLLayerProjectionTest, OffsetsFromAnOriginStayPreciseAtStreetLevel) {
+    // Zoom 18 over Tokyo: world pixels are ~6.7e7, beyond float precision.
+    const double zoom = 18.0;
+    const double world = 512.0 * std::pow(2.0, zoom);
+    const auto centre = GLLayerProjection::mercator(35.681, 139.767);
+    GLLayerProjection view(
+        ortho(centre[0] * world, centre[1] * world, 800.0, 600.0), zoom);
+    EXPECT_DOUBLE_EQ(view.world_size(), world);
+
+    const auto point = GLLayerProjection::mercator(35.6812, 139.7673);
+    const auto expected = view.clip(point[0], point[1]);
+    const auto m = view.matrix_from(centre[0], centre[1]);
+    const auto got =
+        apply(m, static_cast<float>(point[0] - centre[0]),
+              static_cast<float>(point[1] - centre[1]));
+    // Within a tenth of a pixel of an 800 x 600 view.
+    EXPECT_NEAR(got[0], expected[0], 0.1 * 2.0 / 800.0);
+    EXPECT_NEAR(got[1], expected[1], 0.1 * 2.0 / 600.0);
+    EXPECT_DOUBLE_EQ(got[3], 1.0);
+    // And on screen, right of and above the centre.
+    EXPECT_GT(got[0], 0.0);
+    EXPECT_GT(got[1], 0.0);
+    EXPECT_LT(got[0], 1.0);
+}
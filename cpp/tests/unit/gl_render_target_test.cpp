@@ -0,0 +1,28 @@
+#include "gl_render_target.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(FramebufferLayoutTest, RoundsTexturesUpToBuckets) {
+    EXPECT_EQ(FramebufferLayout::round_up(1), 256);
+    EXPECT_EQ(FramebufferLayout::round_up(256), 256);
+    EXPECT_EQ(FramebufferLayout::round_up(257), 512);
+    EXPECT_EQ(FramebufferLayout::round_up(0), 256);
+
+    const auto layout = FramebufferLayout::for_size(700, 420);
+    EXPECT_EQ(layout.texture_width, 768);
+    EXPECT_EQ(layout.texture_height, 512);
+    // The map sits at the top of the bottom-left-origin texture.
+    EXPECT_EQ(layout.viewport_y(), 92);
+}
+
+TEST(FramebufferLayoutTest, DragResizeStaysInOneBucket) {
+    // A drag from 520 to 760 px wide produces one texture size.
+    const auto first = FramebufferLayout::for_size(520, 400);
+    for (int w = 520; w <= 760; w += 7) {
+        const auto layout = FramebufferLayout::for_size(w, 400);
+        EXPECT_EQ(layout.texture_width, first.texture_width) << w;
+        EXPECT_EQ(layout.texture_height, first.texture_height);
+    }
+    EXPECT_NE(FramebufferLayout::for_size(769, 400).texture_width,
+              first.texture_width);
+}
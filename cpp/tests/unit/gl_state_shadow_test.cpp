@@ -0,0 +1,193 @@
+#include "gl_state_shadow.hpp"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A fake GL that records every call, standing in for Slint's context.
+struct FakeGL {
+    std::map<GLenum, GLint> integers;
+    std::map<GLenum, bool> enabled;
+    std::vector<std::string> calls;
+    int queries = 0;
+};
+FakeGL* fake = nullptr;
+
+void GL_APIENTRY fake_get_integerv(GLenum pname, GLint* data) {
+    fake->queries++;
+    fake->calls.push_back("glGetIntegerv");
+    if (pname == GL_VIEWPORT) {
+        data[0] = 0;
+        data[1] = 0;
+        data[2] = fake->integers[GL_VIEWPORT];
+        data[3] = fake->integers[GL_VIEWPORT] / 2;
+        return;
+    }
+    *data = fake->integers[pname];
+}
+GLboolean GL_APIENTRY fake_is_enabled(GLenum cap) {
+    fake->queries++;
+    fake->calls.push_back("glIsEnabled");
+    return fake->enabled[cap] ? GL_TRUE : GL_FALSE;
+}
+void GL_APIENTRY fake_bind_framebuffer(GLenum, GLuint fbo) {
+    fake->calls.push_back("glBindFramebuffer");
+    fake->integers[GL_FRAMEBUFFER_BINDING] = static_cast<GLint>(fbo);
+}
+void GL_APIENTRY fake_viewport(GLint, GLint, GLsizei w, GLsizei) {
+    fake->calls.push_back("glViewport");
+    fake->integers[GL_VIEWPORT] = w;
+}
+void GL_APIENTRY fake_use_program(GLuint program) {
+    fake->calls.push_back("glUseProgram");
+    fake->integers[GL_CURRENT_PROGRAM] = static_cast<GLint>(program);
+}
+void GL_APIENTRY fake_bind_buffer(GLenum target, GLuint buffer) {
+    fake->calls.push_back("glBindBuffer");
+    const GLenum binding = target == GL_ARRAY_BUFFER
+                               ? GL_ARRAY_BUFFER_BINDING
+                               : GL_ELEMENT_ARRAY_BUFFER_BINDING;
+    fake->integers[binding] = static_cast<GLint>(buffer);
+}
+void GL_APIENTRY fake_bind_vertex_array(GLuint vao) {
+    fake->calls.push_back("glBindVertexArray");
+    fake->integers[GL_VERTEX_ARRAY_BINDING] = static_cast<GLint>(vao);
+}
+void GL_APIENTRY fake_active_texture(GLenum unit) {
+    fake->calls.push_back("glActiveTexture");
+    fake->integers[GL_ACTIVE_TEXTURE] = static_cast<GLint>(unit);
+}
+void GL_APIENTRY fake_bind_texture(GLenum, GLuint texture) {
+    fake->calls.push_back("glBindTexture");
+    fake->integers[GL_TEXTURE_BINDING_2D] = static_cast<GLint>(texture);
+}
+void GL_APIENTRY fake_enable(GLenum cap) {
+    fake->calls.push_back("glEnable");
+    fake->enabled[cap] = true;
+}
+void GL_APIENTRY fake_disable(GLenum cap) {
+    fake->calls.push_back("glDisable");
+    fake->enabled[cap] = false;
+}
+
+GLStateShadow::Functions fake_functions() {
+    return {fake_get_integerv,      fake_is_enabled,     fake_bind_framebuffer,
+            fake_viewport,          fake_use_program,    fake_bind_buffer,
+            fake_bind_vertex_array, fake_active_texture, fake_bind_texture,
+            fake_enable,            fake_disable};
+}
+
+// What the map render does to the context: its own FBO, program, buffers,
+// VAO, textures and depth testing.
+void fake_map_render() {
+    fake_bind_framebuffer(GL_FRAMEBUFFER, 7);
+    fake_viewport(0, 0, 512, 512);
+    fake_use_program(42);
+    fake_bind_vertex_array(11);
+    fake_bind_buffer(GL_ARRAY_BUFFER, 9);
+    fake_active_texture(GL_TEXTURE3);
+    fake_bind_texture(GL_TEXTURE_2D, 13);
+    fake_enable(GL_DEPTH_TEST);
+    fake_disable(GL_BLEND);
+}
+
+class GLStateShadowTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        gl.integers[GL_FRAMEBUFFER_BINDING] = 1;
+        gl.integers[GL_VIEWPORT] = 800;
+        gl.integers[GL_CURRENT_PROGRAM] = 5;
+        gl.integers[GL_ARRAY_BUFFER_BINDING] = 2;
+        gl.integers[GL_ELEMENT_ARRAY_BUFFER_BINDING] = 3;
+        gl.integers[GL_VERTEX_ARRAY_BINDING] = 4;
+        gl.integers[GL_ACTIVE_TEXTURE] = GL_TEXTURE0;
+        gl.integers[GL_TEXTURE_BINDING_2D] = 6;
+        gl.enabled[GL_BLEND] = true;
+        fake = &gl;
+    }
+    void TearDown() override {
+        fake = nullptr;
+    }
+
+    FakeGL gl;
+};
+
+}  // namespace
+
+TEST_F(GLStateShadowTest, SteadyFramesQueryOnlyBindings) {
+    GLStateShadow shadow(fake_functions());
+    const auto host = gl.integers;
+    const auto host_enabled = gl.enabled;
+
+    for (int frame = 0; frame < 100; ++frame) {
+        if (!shadow.valid())
+            shadow.capture();
+        else
+            shadow.refresh_bindings();
+        fake_map_render();
+        shadow.restore();
+        ASSERT_EQ(gl.integers, host) << "frame " << frame;
+        ASSERT_EQ(gl.enabled[GL_BLEND], host_enabled.at(GL_BLEND));
+        ASSERT_FALSE(gl.enabled[GL_DEPTH_TEST]);
+    }
+
+    // A full capture is 12 queries; later frames only re-read the six
+    // object bindings.
+    EXPECT_EQ(gl.queries, 12 + 99 * 6);
+    EXPECT_EQ(shadow.stats().queries, 12u + 99u * 6u);
+    EXPECT_EQ(shadow.stats().captures, 1u);
+    EXPECT_EQ(shadow.stats().restores, 100u);
+}
+
+TEST_F(GLStateShadowTest, RestoreIssuesOnlySetCalls) {
+    GLStateShadow shadow(fake_functions());
+    shadow.restore();  // nothing captured yet
+    EXPECT_TRUE(gl.calls.empty());
+
+    shadow.capture();
+    gl.calls.clear();
+    shadow.restore();
+    for (const auto& call : gl.calls) {
+        EXPECT_NE(call, "glGetIntegerv");
+        EXPECT_NE(call, "glIsEnabled");
+    }
+    EXPECT_EQ(gl.calls.size(), 12u);
+}
+
+TEST_F(GLStateShadowTest, RestoresBindingsTheHostChangedBetweenFrames) {
+    GLStateShadow shadow(fake_functions());
+    shadow.capture();
+    fake_map_render();
+    shadow.restore();
+
+    // Slint's renderer ends its next frame with other objects bound.
+    gl.integers[GL_CURRENT_PROGRAM] = 8;
+    gl.integers[GL_VERTEX_ARRAY_BINDING] = 10;
+    gl.integers[GL_TEXTURE_BINDING_2D] = 12;
+    const auto host = gl.integers;
+    shadow.refresh_bindings();
+    fake_map_render();
+    shadow.restore();
+    EXPECT_EQ(gl.integers, host);
+    EXPECT_EQ(shadow.stats().captures, 1u);
+}
+
+TEST_F(GLStateShadowTest, InvalidateAndVerifyRecapture) {
+    GLStateShadow shadow(fake_functions());
+    shadow.capture();
+    EXPECT_TRUE(shadow.verify());
+
+    // The host resized: the viewport no longer matches the shadow.
+    gl.integers[GL_VIEWPORT] = 1024;
+    EXPECT_FALSE(shadow.verify());
+    EXPECT_EQ(shadow.state().viewport[2], 1024);
+    EXPECT_TRUE(shadow.verify());
+
+    shadow.invalidate();
+    EXPECT_FALSE(shadow.valid());
+    shadow.capture();
+    EXPECT_EQ(shadow.stats().queries, 60u);
+}
@@ -0,0 +1,174 @@
+#include "image_encoder.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+
+namespace {
+
+mbgl::PremultipliedImage make_image(uint32_t width, uint32_t height) {
+    mbgl::PremultipliedImage image({width, height});
+    uint8_t* p = image.data.get();
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x, p += 4) {
+            // Smooth gradients (DIFF/LUMA ops), flat runs (RUN) and a
+            // translucent band (RGBA ops).
+            const uint8_t a = (y % 16 == 3) ? 128 : 255;
+            p[0] = static_cast<uint8_t>(x * 255 / width * a / 255);
+            p[1] = static_cast<uint8_t>((x < width / 2 ? 40 : y) * a / 255);
+            p[2] = static_cast<uint8_t>((x * 7 + y * 13) % 256 * a / 255);
+            p[3] = a;
+        }
+    }
+    return image;
+}
+
+// Minimal reference decoder for the format written by encode_qoi().
+std::vector<uint8_t> decode_qoi(const std::string& data,
+                                uint32_t& width,
+                                uint32_t& height) {
+    auto be32 = [&](std::size_t at) {
+        return uint32_t(uint8_t(data[at])) << 24 |
+               uint32_t(uint8_t(data[at + 1])) << 16 |
+               uint32_t(uint8_t(data[at + 2])) << 8 |
+               uint32_t(uint8_t(data[at + 3]));
+    };
+    width = be32(4);
+    height = be32(8);
+    std::vector<uint8_t> px(std::size_t{width} * height * 4);
+    uint8_t index[64][4] = {};
+    uint8_t cur[4] = {0, 0, 0, 255};
+    std::size_t pos = 14;
+    int run = 0;
+    for (std::size_t i = 0; i < px.size(); i += 4) {
+        if (run > 0) {
+            --run;
+        } else {
+            const uint8_t b1 = uint8_t(data[pos++]);
+            if (b1 == 0xfe || b1 == 0xff) {
+                cur[0] = uint8_t(data[pos++]);
+                cur[1] = uint8_t(data[pos++]);
+                cur[2] = uint8_t(data[pos++]);
+                if (b1 == 0xff)
+                    cur[3] = uint8_t(data[pos++]);
+            } else if ((b1 & 0xc0) == 0x00) {
+                std::copy(index[b1], index[b1] + 4, cur);
+            } else if ((b1 & 0xc0) == 0x40) {
+                cur[0] += ((b1 >> 4) & 3) - 2;
+                cur[1] += ((b1 >> 2) & 3) - 2;
+                cur[2] += (b1 & 3) - 2;
+            } else if ((b1 & 0xc0) == 0x80) {
+                const uint8_t b2 = uint8_t(data[pos++]);
+                const int vg = (b1 & 0x3f) - 32;
+                cur[0] += vg - 8 + ((b2 >> 4) & 0x0f);
+                cur[1] += vg;
+                cur[2] += vg - 8 + (b2 & 0x0f);
+            } else {
+                run = b1 & 0x3f;
+            }
+            const int h =
+                (cur[0] * 3 + cur[1] * 5 + cur[2] * 7 + cur[3] * 11) % 64;
+            std::copy(cur, cur + 4, index[h]);
+        }
+        std::copy(cur, cur + 4, px.begin() + i);
+    }
+    return px;
+}
+
+}  // namespace
+
+TEST(ImageEncoderTest, QoiRoundTrip) {
+    const auto image = make_image(97, 61);
+    const std::string qoi = encode_qoi(image);
+    ASSERT_GT(qoi.size(), 22u);
+    EXPECT_EQ(qoi.substr(0, 4), "qoif");
+    EXPECT_EQ(qoi.substr(qoi.size() - 8), std::string("\0\0\0\0\0\0\0\1", 8));
+
+    uint32_t width = 0, height = 0;
+    const auto rgba = decode_qoi(qoi, width, height);
+    ASSERT_EQ(width, 97u);
+    ASSERT_EQ(height, 61u);
+    const uint8_t* src = image.data.get();
+    for (std::size_t i = 0; i < rgba.size(); i += 4) {
+        ASSERT_EQ(rgba[i + 3], src[i + 3]) << "pixel " << i / 4;
+        // Unpremultiplying a translucent pixel loses at most one step of
+        // precision per channel relative to the premultiplied input.
+        for (int c = 0; c < 3; ++c) {
+            const int premul = (rgba[i + c] * rgba[i + 3] + 127) / 255;
+            ASSERT_NEAR(premul, src[i + c], 1) << "pixel " << i / 4;
+        }
+    }
+}
+
+TEST(ImageEncoderTest, FormatNames) {
+    EXPECT_EQ(parse_image_format("qoi"), ImageFormat::QOI);
+    EXPECT_EQ(parse_image_format("png"), ImageFormat::PNG);
+    EXPECT_FALSE(parse_image_format("gif").has_value());
+    EXPECT_STREQ(image_format_extension(ImageFormat::WebP), "webp");
+    EXPECT_TRUE(image_format_supported(ImageFormat::PNG));
+    EXPECT_TRUE(encode_image(mbgl::PremultipliedImage(), ImageFormat::QOI)
+                    .empty());
+}
+
+TEST(ImageEncoderTest, PoolMatchesSynchronousEncode) {
+    const auto image = make_image(128, 128);
+    const std::string expected = encode_image(image, ImageFormat::QOI);
+
+    ImageEncoder::Options options;
+    options.threads = 3;
+    options.queue_depth = 2;
+    options.format = ImageFormat::QOI;
+    ImageEncoder encoder(options);
+
+    std::vector<std::future<EncodedImage>> futures;
+    for (uint64_t i = 0; i < 16; ++i) {
+        futures.push_back(encoder.submit(image.clone(), i));
+    }
+    for (uint64_t i = 0; i < futures.size(); ++i) {
+        EncodedImage result = futures[i].get();
+        EXPECT_EQ(result.id, i);
+        EXPECT_TRUE(result.ok());
+        EXPECT_EQ(result.data, expected);
+    }
+
+    std::atomic<int> delivered{0};
+    for (uint64_t i = 0; i < 16; ++i) {
+        encoder.submit(
+            image.clone(), [&](EncodedImage&& r) { delivered += r.ok(); }, i);
+    }
+    encoder.wait_idle();
+    EXPECT_EQ(delivered.load(), 16);
+    EXPECT_EQ(encoder.in_flight(), 0u);
+    const auto stats = encoder.stats();
+    EXPECT_EQ(stats.images, 32u);
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_EQ(stats.bytes_in, 32u * 128 * 128 * 4);
+}
+
+TEST(ImageEncoderTest, BoundedQueueAppliesBackpressure) {
+    BoundedQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_FALSE(queue.try_push(3));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        queue.push(3);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(pushed.load());
+    EXPECT_EQ(queue.pop(), 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+
+    queue.close();
+    EXPECT_FALSE(queue.push(4));
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), 3);
+    EXPECT_FALSE(queue.pop().has_value());
+}
@@ -0,0 +1,117 @@
+#include "input_replay.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "input_recording.hpp"
+#include "slint_maplibre_headless.hpp"
+
+namespace {
+
+// Background-only style written to disk so replays need no network.
+std::string write_local_style() {
+    const auto path =
+        std::filesystem::temp_directory_path() / "mbgl_slint_replay_style.json";
+    std::ofstream out(path);
+    out << R"JSON({
+        "version": 8,
+        "sources": {},
+        "layers": [{"id": "background", "type": "background",
+                    "paint": {"background-color": "rgb(0, 128, 255)"}}]
+    })JSON";
+    return "file://" + path.string();
+}
+
+}  // namespace
+
+TEST(InputRecordingTest, RoundTripPreservesEvents) {
+    std::vector<InputEvent> events(4);
+    events[0] = {InputEventType::Resize, 0, 800.0f, 600.0f};
+    events[1] = {InputEventType::MousePressed, 1000, 10.5f, 20.25f};
+    events[2] = {InputEventType::DoubleClicked, 250000, 1.0f, 2.0f, 0.0f,
+                 true};
+    events[3] = {InputEventType::StyleChange, 3000000, 0.0f, 0.0f, 0.0f,
+                 false, "https://demotiles.maplibre.org/style.json"};
+
+    std::stringstream buf;
+    ASSERT_TRUE(write_input_events(buf, events));
+    auto decoded = read_input_events(buf);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->size(), events.size());
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        EXPECT_EQ((*decoded)[i].type, events[i].type);
+        EXPECT_EQ((*decoded)[i].time_us, events[i].time_us);
+        EXPECT_FLOAT_EQ((*decoded)[i].a, events[i].a);
+        EXPECT_FLOAT_EQ((*decoded)[i].b, events[i].b);
+        EXPECT_EQ((*decoded)[i].flag, events[i].flag);
+        EXPECT_EQ((*decoded)[i].text, events[i].text);
+    }
+}
+
+TEST(InputRecordingTest, RejectsGarbage) {
+    std::stringstream buf("not a recording");
+    EXPECT_FALSE(read_input_events(buf).has_value());
+}
+
+TEST(InputRecordingTest, RecorderCapturesMapInteractions) {
+    auto recorder = std::make_shared<InputRecorder>();
+    SlintMapLibre map;
+    map.set_frame_logging(false);
+    map.set_input_recorder(recorder);
+    map.initialize(320, 240);
+    map.handle_mouse_press(10.0f, 10.0f);
+    map.handle_mouse_move(20.0f, 15.0f, true);
+    map.handle_mouse_release(20.0f, 15.0f);
+    map.handle_wheel_zoom(160.0f, 120.0f, -1.0f);
+
+    const auto events = recorder->events();
+    ASSERT_EQ(events.size(), 5u);
+    EXPECT_EQ(events[0].type, InputEventType::Resize);
+    EXPECT_EQ(events[1].type, InputEventType::MousePressed);
+    EXPECT_EQ(events[2].type, InputEventType::MouseMoved);
+    EXPECT_EQ(events[3].type, InputEventType::MouseReleased);
+    EXPECT_EQ(events[4].type, InputEventType::WheelZoomed);
+    for (std::size_t i = 1; i < events.size(); ++i) {
+        EXPECT_GE(events[i].time_us, events[i - 1].time_us);
+    }
+}
+
+TEST(InputReplayTest, ReplaysPanAndZoomWithLocalStyle) {
+    std::vector<InputEvent> events;
+    events.push_back({InputEventType::Resize, 0, 256.0f, 256.0f});
+    int64_t t = 0;
+    events.push_back({InputEventType::MousePressed, t, 128.0f, 128.0f});
+    for (int i = 1; i <= 30; ++i) {
+        t += 16000;
+        events.push_back({InputEventType::MouseMoved, t, 128.0f + 2.0f * i,
+                          128.0f + 1.0f * i});
+    }
+    events.push_back({InputEventType::MouseReleased, t, 188.0f, 158.0f});
+    events.push_back({InputEventType::WheelZoomed, t + 50000, 128.0f, 128.0f,
+                      -1.0f});
+
+    ReplayOptions options;
+    options.style_url = write_local_style();
+    options.tail = std::chrono::milliseconds(200);
+
+    SlintMapLibre map;
+    const FrameTimeStats stats = replay_input_events(map, events, options);
+    ASSERT_TRUE(stats.style_loaded);
+    EXPECT_GT(stats.frames, 0u);
+    EXPECT_LE(stats.p50_ms, stats.p95_ms);
+    EXPECT_LE(stats.p95_ms, stats.max_ms);
+}
+
+TEST(InputReplayTest, FrameTimeStatsPercentiles) {
+    std::vector<double> ms;
+    for (int i = 1; i <= 100; ++i) {
+        ms.push_back(static_cast<double>(i));
+    }
+    const auto stats = compute_frame_time_stats(ms);
+    EXPECT_EQ(stats.frames, 100u);
+    EXPECT_DOUBLE_EQ(stats.mean_ms, 50.5);
+    EXPECT_DOUBLE_EQ(stats.max_ms, 100.0);
+    EXPECT_NEAR(stats.p95_ms, 95.05, 1e-9);
+}
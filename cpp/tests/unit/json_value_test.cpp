@@ -0,0 +1,71 @@
+#include "json_value.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(JsonValueTest, ParsesAStyleLikeDocument) {
+    const auto doc = JsonValue::parse(R"({
+        "version": 8,
+        "sources": {"osm": {"type": "vector", "url": "https://x/t.json"}},
+        "layers": [{"id": "bg", "type": "background",
+                    "paint": {"background-color": "#fff",
+                              "background-opacity": 0.5}}],
+        "center": [139.7, -35.5e0], "bearing": null, "pitch": false
+    })");
+    ASSERT_TRUE(doc);
+    EXPECT_EQ(doc->find("version")->as_number(), 8);
+    EXPECT_EQ(*doc->find("sources")->find("osm")->find_string("url"),
+              "https://x/t.json");
+    const auto& layers = doc->find("layers")->as_array();
+    ASSERT_EQ(layers.size(), 1u);
+    EXPECT_EQ(layers[0].find("paint")->find("background-opacity")->as_number(),
+              0.5);
+    EXPECT_EQ(doc->find("center")->as_array()[1].as_number(), -35.5);
+    EXPECT_TRUE(doc->find("bearing")->is_null());
+    EXPECT_FALSE(doc->find("pitch")->as_bool());
+    EXPECT_EQ(doc->find("missing"), nullptr);
+}
+
+TEST(JsonValueTest, RoundTripsKeepingMemberOrder) {
+    const std::string text =
+        R"({"b":1,"a":[true,null,"x\"y\\z\n"],"c":{"z":-2.25,"y":"é"}})";
+    const auto doc = JsonValue::parse(text);
+    ASSERT_TRUE(doc);
+    EXPECT_EQ(doc->dump(), text);
+}
+
+TEST(JsonValueTest, DecodesUnicodeEscapes) {
+    const auto doc = JsonValue::parse(R"(["\u00e9\u6771\ud83d\uddfa"])");
+    ASSERT_TRUE(doc);
+    EXPECT_EQ(doc->as_array()[0].as_string(), "é東🗺");
+}
+
+TEST(JsonValueTest, EqualityIgnoresMemberOrder) {
+    const auto a = JsonValue::parse(R"({"x":1,"y":[1,2]})");
+    const auto b = JsonValue::parse(R"({"y":[1,2],"x":1})");
+    const auto c = JsonValue::parse(R"({"y":[2,1],"x":1})");
+    EXPECT_EQ(*a, *b);
+    EXPECT_NE(*a, *c);
+}
+
+TEST(JsonValueTest, EditsMembers) {
+    JsonValue doc;
+    doc.set("id", "water");
+    doc.set("minzoom", 3);
+    doc.set("id", "lakes");
+    EXPECT_EQ(doc.dump(), R"({"id":"lakes","minzoom":3})");
+    EXPECT_TRUE(doc.erase("minzoom"));
+    EXPECT_FALSE(doc.erase("minzoom"));
+    EXPECT_EQ(doc.dump(), R"({"id":"lakes"})");
+}
+
+TEST(JsonValueTest, RejectsMalformedInput) {
+    std::string error;
+    EXPECT_FALSE(JsonValue::parse(R"({"a":1,})", &error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(JsonValue::parse(R"([1 2])"));
+    EXPECT_FALSE(JsonValue::parse(R"("open)"));
+    EXPECT_FALSE(JsonValue::parse(R"({"a":1} x)"));
+    EXPECT_FALSE(JsonValue::parse(std::string(1000, '[')));
+    EXPECT_FALSE(JsonValue::parse(""));
+}
@@ -0,0 +1,101 @@
+#include "map_clock.hpp"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "fly_to_animation.hpp"
+#include "slint_maplibre_headless.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(MapClockTest, ManualClockOnlyMovesWhenAdvanced) {
+    ManualMapClock clock;
+    const auto t0 = clock.now();
+    EXPECT_EQ(clock.now(), t0);
+    clock.advance(16ms);
+    EXPECT_EQ(clock.now() - t0, MapClock::duration(16ms));
+    clock.set(t0 + 1s);
+    EXPECT_EQ(clock.now() - t0, MapClock::duration(1s));
+    EXPECT_TRUE(clock.is_manual());
+    EXPECT_FALSE(SteadyMapClock().is_manual());
+}
+
+TEST(FlyToAnimationTest, StartsAndEndsOnTheRequestedCameras) {
+    const mbgl::LatLng tokyo{35.6895, 139.6917};
+    const mbgl::LatLng paris{48.8566, 2.3522};
+    const auto anim = FlyToAnimation::plan(tokyo, 10.0, paris, 12.0, 0.0, 22.0);
+
+    const auto start = anim.sample(0.0);
+    EXPECT_DOUBLE_EQ(start.center->latitude(), tokyo.latitude());
+    EXPECT_DOUBLE_EQ(*start.zoom, 10.0);
+    const auto end = anim.sample(1.0);
+    EXPECT_DOUBLE_EQ(end.center->longitude(), paris.longitude());
+    EXPECT_DOUBLE_EQ(*end.zoom, 12.0);
+    // Pulls back between the two.
+    EXPECT_LT(*anim.sample(anim.mid_ratio).zoom, 10.0);
+    EXPECT_GE(anim.mid_zoom, 0.0);
+
+    EXPECT_DOUBLE_EQ(anim.progress(0ms), 0.0);
+    EXPECT_DOUBLE_EQ(anim.progress(anim.duration / 2), 0.5);
+    EXPECT_DOUBLE_EQ(anim.progress(anim.duration * 2), 1.0);
+}
+
+namespace {
+
+std::vector<double> fly_zooms(int steps) {
+    SlintMapLibre map;
+    map.set_frame_logging(false);
+    auto clock = std::make_shared<ManualMapClock>();
+    map.set_clock(clock);
+    map.initialize(256, 256);
+    map.get_map()->jumpTo(mbgl::CameraOptions()
+                              .withCenter(mbgl::LatLng{35.68, 139.69})
+                              .withZoom(10.0));
+    map.fly_to("paris");
+
+    std::vector<double> zooms;
+    for (int i = 0; i < steps; ++i) {
+        map.tick_animation();
+        zooms.push_back(map.get_map()->getCameraOptions().zoom.value_or(-1));
+        clock->advance(100ms);
+    }
+    EXPECT_FALSE(map.is_animating());
+    return zooms;
+}
+
+}  // namespace
+
+TEST(MapClockTest, FlyToFollowsTheManualClock) {
+    // 2.5 s of animation in 100 ms steps, with no real waiting.
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto first = fly_zooms(27);
+    const auto second = fly_zooms(27);
+    EXPECT_LT(std::chrono::steady_clock::now() - t0, 2500ms);
+
+    EXPECT_DOUBLE_EQ(first.front(), 10.0);
+    EXPECT_NEAR(first.back(), 10.0, 1e-9);
+    EXPECT_EQ(first, second);
+}
+
+TEST(MapClockTest, LeavingTheManualClockRestoresStyleTransitions) {
+    SlintMapLibre map;
+    map.set_frame_logging(false);
+    map.initialize(256, 256);
+    map.get_map()->getStyle().loadJSON(R"JSON({
+        "version": 8, "sources": {},
+        "transition": {"duration": 300, "delay": 50},
+        "layers": [{"id": "background", "type": "background"}]})JSON");
+    auto& style = map.get_map()->getStyle();
+    ASSERT_EQ(style.getTransitionOptions().duration, mbgl::Duration(300ms));
+
+    map.set_clock(std::make_shared<ManualMapClock>());
+    EXPECT_EQ(style.getTransitionOptions().duration, mbgl::Duration::zero());
+    EXPECT_FALSE(style.getTransitionOptions().enablePlacementTransitions);
+
+    map.set_clock(nullptr);
+    EXPECT_EQ(style.getTransitionOptions().duration, mbgl::Duration(300ms));
+    EXPECT_EQ(style.getTransitionOptions().delay, mbgl::Duration(50ms));
+    EXPECT_TRUE(style.getTransitionOptions().enablePlacementTransitions);
+}
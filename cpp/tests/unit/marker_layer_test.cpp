@@ -0,0 +1,180 @@
+#include "marker_layer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+MarkerViewport viewport(double zoom, double bearing = 0.0) {
+    MarkerViewport view;
+    view.zoom = zoom;
+    view.bearing = bearing;
+    view.width = 800.0f;
+    view.height = 600.0f;
+    return view;
+}
+
+std::vector<uint64_t> visible_ids(const MarkerLayer& layer) {
+    std::vector<uint64_t> ids;
+    for (const auto& marker : layer.visible())
+        ids.push_back(marker.id);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+}  // namespace
+
+TEST(MarkerLayerTest, ProjectsLikeTheMap) {
+    MarkerPositions markers;
+    markers.push(1, 0.0, 0.0);
+    // 1/512 of the world east of the centre: 1 px at zoom 0, 4 px at 2.
+    markers.push(2, 360.0 / 512.0, 0.0);
+    MarkerLayer layer;
+    layer.set_markers(markers, {});
+
+    layer.update(viewport(2.0));
+    ASSERT_EQ(layer.visible().size(), 1u);  // 4 px apart: one collides
+    layer.set_options({0.0f, 0.0f, false});
+    const auto& shown = layer.update(viewport(2.0));
+    ASSERT_EQ(shown.size(), 2u);
+    const auto& centre = shown[0].id == 1 ? shown[0] : shown[1];
+    const auto& east = shown[0].id == 2 ? shown[0] : shown[1];
+    EXPECT_FLOAT_EQ(centre.x, 400.0f);
+    EXPECT_FLOAT_EQ(centre.y, 300.0f);
+    EXPECT_NEAR(east.x, 404.0f, 1e-3);
+    EXPECT_NEAR(east.y, 300.0f, 1e-3);
+
+    // Bearing 90: east is up.
+    layer.update(viewport(2.0, 90.0));
+    const auto& turned = layer.visible()[0].id == 2 ? layer.visible()[0]
+                                                    : layer.visible()[1];
+    EXPECT_NEAR(turned.x, 400.0f, 1e-3);
+    EXPECT_NEAR(turned.y, 296.0f, 1e-3);
+}
+
+TEST(MarkerLayerTest, CullsToTheViewThroughTheIndex) {
+    MarkerPositions markers;
+    for (int i = 0; i < 100; ++i) {
+        for (int j = 0; j < 100; ++j)
+            markers.push(i * 100 + j, -50.0 + i, -50.0 + j);
+    }
+    MarkerLayer::Options options;
+    options.collisions = false;
+    MarkerLayer layer;
+    layer.set_markers(markers, options);
+
+    // At zoom 6 one degree is ~91 px: about 9 x 7 markers fit.
+    layer.update(viewport(6.0));
+    EXPECT_LT(layer.stats().candidates, 200u);
+    EXPECT_GT(layer.stats().visible, 40u);
+    for (const auto& marker : layer.visible()) {
+        EXPECT_GE(marker.x, -12.0f);
+        EXPECT_LE(marker.x, 812.0f);
+    }
+
+    // Same markers without the index, just slower.
+    const auto indexed = visible_ids(layer);
+    options.spatial_index = false;
+    layer.set_options(options);
+    layer.update(viewport(6.0));
+    EXPECT_EQ(layer.stats().candidates, markers.size());
+    EXPECT_EQ(visible_ids(layer), indexed);
+}
+
+TEST(MarkerLayerTest, HigherPriorityWinsCollisionsAndIsDrawnLast) {
+    MarkerPositions markers;
+    markers.push(1, 0.0, 0.0, 1.0f);
+    markers.push(2, 0.0001, 0.0, 5.0f);  // overlaps 1
+    markers.push(3, 10.0, 0.0, 0.0f);    // off screen at zoom 8
+    markers.push(4, 0.2, 0.0, 2.0f);     // ~73 px east
+    MarkerLayer layer;
+    layer.set_markers(markers, {});
+    const auto& shown = layer.update(viewport(8.0));
+    ASSERT_EQ(shown.size(), 2u);
+    EXPECT_EQ(shown[0].id, 4u);
+    EXPECT_EQ(shown[1].id, 2u);
+    EXPECT_EQ(layer.stats().collided, 1u);
+    EXPECT_EQ(layer.stats().on_screen, 3u);
+
+    MarkerLayer::Options options;
+    options.max_visible = 1;
+    layer.set_options(options);
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{2, 4}));
+    layer.update(viewport(8.0));
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{2}));
+}
+
+TEST(MarkerLayerTest, UsesTheProjectorForOtherCameras) {
+    MarkerPositions markers;
+    markers.push(1, 1.0, 1.0);
+    markers.push(2, 20.0, 20.0);
+    MarkerLayer layer;
+    layer.set_markers(markers, {});
+    std::size_t projected = 0;
+    layer.update(viewport(4.0), 0.0, 0.0, 5.0, 5.0,
+                 [&](const MarkerPositions&,
+                     const std::vector<uint32_t>& indices,
+                     std::vector<float>& x, std::vector<float>& y) {
+                     projected += indices.size();
+                     for (std::size_t k = 0; k < indices.size(); ++k) {
+                         x[k] = 10.0f;
+                         y[k] = 20.0f;
+                     }
+                 });
+    EXPECT_EQ(projected, 1u);
+    ASSERT_EQ(layer.visible().size(), 1u);
+    EXPECT_EQ(layer.visible()[0].id, 1u);
+    EXPECT_EQ(layer.visible()[0].x, 10.0f);
+}
+
+TEST(MarkerLayerTest, ShowsMarkersAcrossTheAntimeridian) {
+    MarkerPositions markers;
+    markers.push(1, 179.9, 0.0);
+    markers.push(2, -179.9, 0.0);
+    markers.push(3, 0.0, 0.0);
+    MarkerLayer layer;
+    layer.set_markers(markers, {});
+
+    // Centred on 180 at zoom 8: 0.2 degrees is about 73 px.
+    MarkerViewport view = viewport(8.0);
+    view.lon = 180.0;
+    const auto& shown = layer.update(view);
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{1, 2}));
+    const auto& west = shown[0].id == 1 ? shown[0] : shown[1];
+    const auto& east = shown[0].id == 2 ? shown[0] : shown[1];
+    EXPECT_LT(west.x, 400.0f);
+    EXPECT_GT(east.x, 400.0f);
+    EXPECT_NEAR(east.x - 400.0f, 400.0f - west.x, 1e-3);
+
+    // The same from the other side of the seam.
+    view.lon = -180.0;
+    layer.update(view);
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{1, 2}));
+}
+
+TEST(MarkerLayerTest, SplitsAProjectorBoxAcrossTheAntimeridian) {
+    MarkerPositions markers;
+    markers.push(1, 179.0, 0.0);
+    markers.push(2, -179.0, 0.0);
+    markers.push(3, 0.0, 0.0);
+    MarkerLayer layer;
+    layer.set_markers(markers, {});
+    const auto project = [](const MarkerPositions&,
+                            const std::vector<uint32_t>& indices,
+                            std::vector<float>& x, std::vector<float>& y) {
+        for (std::size_t k = 0; k < indices.size(); ++k) {
+            x[k] = 100.0f * static_cast<float>(k);
+            y[k] = 0.0f;
+        }
+    };
+    // West > east, as wrapped longitudes give it.
+    layer.update(viewport(4.0), 178.0, -1.0, -178.0, 1.0, project);
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{1, 2}));
+    // Unwrapped past 180.
+    layer.update(viewport(4.0), 178.0, -1.0, 182.0, 1.0, project);
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{1, 2}));
+    layer.update(viewport(4.0), -182.0, -1.0, -178.0, 1.0, project);
+    EXPECT_EQ(visible_ids(layer), (std::vector<uint64_t>{1, 2}));
+}
@@ -0,0 +1,78 @@
+#include "moving_objects.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(MovingObjectsTest, MovesKnownObjectsAndAddsNewOnes) {
+    MovingObjects objects;
+    ObjectPositions deltas;
+    deltas.push(7, 139.0, 35.0, 90.0f);
+    deltas.push(9, 135.0, 34.0, 180.0f);
+    EXPECT_EQ(objects.apply(deltas), 2u);
+
+    deltas.clear();
+    deltas.ids = {9};
+    deltas.lon = {135.5};
+    deltas.lat = {34.5};  // no bearing: heading kept
+    EXPECT_EQ(objects.apply(deltas), 0u);
+
+    ObjectPositions snapshot;
+    objects.snapshot(snapshot);
+    ASSERT_EQ(snapshot.size(), 2u);
+    EXPECT_EQ(snapshot.ids, (std::vector<uint64_t>{7, 9}));
+    EXPECT_EQ(snapshot.lon[1], 135.5);
+    EXPECT_EQ(snapshot.lat[1], 34.5);
+    EXPECT_EQ(snapshot.bearing[1], 180.0f);
+}
+
+TEST(MovingObjectsTest, CoalescesDeltasUntilTheNextSnapshot) {
+    MovingObjects objects;
+    EXPECT_FALSE(objects.dirty());
+    ObjectPositions deltas;
+    for (int tick = 0; tick < 5; ++tick) {
+        deltas.clear();
+        for (uint64_t id = 0; id < 100; ++id)
+            deltas.push(id, tick * 0.1, id * 0.01);
+        objects.apply(deltas);
+    }
+    EXPECT_TRUE(objects.dirty());
+    ObjectPositions snapshot;
+    objects.snapshot(snapshot);
+    EXPECT_FALSE(objects.dirty());
+    EXPECT_EQ(snapshot.lon[42], 4 * 0.1);
+    EXPECT_EQ(objects.stats().deltas, 5u);
+    EXPECT_EQ(objects.stats().positions, 500u);
+    EXPECT_EQ(objects.stats().snapshots, 1u);
+
+    objects.apply(ObjectPositions{});  // nothing moved
+    EXPECT_FALSE(objects.dirty());
+}
+
+TEST(MovingObjectsTest, RemoveKeepsTheArraysDense) {
+    MovingObjects objects;
+    ObjectPositions deltas;
+    for (uint64_t id = 1; id <= 4; ++id)
+        deltas.push(id, static_cast<double>(id), 0.0);
+    objects.apply(deltas);
+    ObjectPositions snapshot;
+    objects.snapshot(snapshot);
+
+    EXPECT_EQ(objects.remove({2, 5}), 1u);
+    EXPECT_TRUE(objects.dirty());
+    EXPECT_EQ(objects.size(), 3u);
+    objects.snapshot(snapshot);
+    EXPECT_EQ(snapshot.ids, (std::vector<uint64_t>{1, 4, 3}));
+    EXPECT_EQ(snapshot.lon, (std::vector<double>{1.0, 4.0, 3.0}));
+
+    // The moved object is still found by its ID.
+    deltas.clear();
+    deltas.push(4, 40.0, 0.0);
+    EXPECT_EQ(objects.apply(deltas), 0u);
+    objects.snapshot(snapshot);
+    EXPECT_EQ(snapshot.lon[1], 40.0);
+
+    objects.clear();
+    EXPECT_EQ(objects.size(), 0u);
+    EXPECT_TRUE(objects.dirty());
+}
@@ -0,0 +1,59 @@
+#include "point_rtree.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+TEST(PointRTreeTest, MatchesABruteForceScan) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coord(0.0, 1.0);
+    std::vector<double> x(5000), y(5000);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = coord(rng);
+        y[i] = coord(rng);
+    }
+    PointRTree tree;
+    tree.build(x, y, 8);
+    EXPECT_EQ(tree.size(), x.size());
+
+    for (int q = 0; q < 50; ++q) {
+        const double x0 = coord(rng), y0 = coord(rng);
+        const double size = coord(rng) * 0.2;
+        const PointRTree::Box box{x0, y0, x0 + size, y0 + size};
+        std::vector<uint32_t> found;
+        tree.query(box, found);
+        std::sort(found.begin(), found.end());
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < x.size(); ++i) {
+            if (x[i] >= box.min_x && x[i] <= box.max_x &&
+                y[i] >= box.min_y && y[i] <= box.max_y)
+                expected.push_back(i);
+        }
+        EXPECT_EQ(found, expected);
+    }
+}
+
+TEST(PointRTreeTest, HandlesTinyAndEmptyInputs) {
+    PointRTree tree;
+    std::vector<uint32_t> found;
+    tree.query({0, 0, 1, 1}, found);
+    EXPECT_TRUE(found.empty());
+
+    tree.build({0.5}, {0.5});
+    tree.query({0, 0, 1, 1}, found);
+    EXPECT_EQ(found, (std::vector<uint32_t>{0}));
+    found.clear();
+    tree.query({0.6, 0.6, 1, 1}, found);
+    EXPECT_TRUE(found.empty());
+
+    // Points on a box edge count as inside.
+    tree.build({0.0, 1.0, 2.0}, {0.0, 1.0, 2.0});
+    tree.query({1.0, 1.0, 3.0, 3.0}, found);
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, (std::vector<uint32_t>{1, 2}));
+
+    tree.clear();
+    EXPECT_EQ(tree.size(), 0u);
+}
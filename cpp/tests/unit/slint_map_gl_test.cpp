@@ -0,0 +1,281 @@
+#include "slint_map_gl.hpp"
+
+#include <GLES3/gl3.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "egl_headless_context.hpp"
+#include "gl_point_cloud_layer.hpp"
+#include "gl_state_shadow.hpp"
+
+namespace {
+
+// Background-only style: renders without any network access.
+const char* kBackgroundStyle = R"JSON({
+    "version": 8,
+    "sources": {},
+    "layers": [{"id": "background", "type": "background",
+                "paint": {"background-color": "rgb(0, 128, 255)"}}]
+})JSON";
+
+// Drives SlintMapGL the way main_gl.cpp does, minus Slint: a surfaceless
+// EGL context (llvmpipe in CI) stands in for Slint's, and the test reads the
+// shown texture back instead of compositing it.
+class SlintMapGLTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        gl = std::make_unique<EGLHeadlessContext>();
+        if (!gl->ok())
+            GTEST_SKIP() << "no EGL/GLES 3 context: " << gl->error();
+    }
+
+    void TearDown() override {
+        // GL objects go while the context is still current.
+        if (map)
+            map->release_gl();
+        map.reset();
+        gl.reset();
+    }
+
+    void start(int w, int h, std::size_t ring) {
+        map = std::make_unique<SlintMapGL>();
+        map->set_fbo_ring(ring);
+        map->setup(w, h, "");
+        map->setStyleJSON(kBackgroundStyle);
+    }
+
+    // One Slint frame: render, then "composite" the shown texture.
+    void frame() {
+        map->render();
+        map->frame_composited();
+    }
+
+    // Frames until `done` holds (or 5 s pass).
+    bool frames_until(const std::function<bool()>& done) {
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            frame();
+            if (done())
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    bool settle() {
+        return frames_until([this] {
+            return map->style_is_loaded() && map->texture() != 0 &&
+                   !map->needs_render();
+        });
+    }
+
+    // RGBA of a pixel of the map, from its top-left.
+    std::array<uint8_t, 4> pixel(int x, int y) {
+        const auto layout = map->frame_layout();
+        GLuint fbo = 0;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, map->texture(), 0);
+        std::array<uint8_t, 4> rgba{};
+        glReadPixels(x, layout.texture_height - 1 - y, 1, 1, GL_RGBA,
+                     GL_UNSIGNED_BYTE, rgba.data());
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &fbo);
+        return rgba;
+    }
+
+    std::unique_ptr<EGLHeadlessContext> gl;
+    std::unique_ptr<SlintMapGL> map;
+};
+
+}  // namespace
+
+TEST_F(SlintMapGLTest, RendersStyleIntoTheShownTexture) {
+    start(256, 256, 2);
+    ASSERT_TRUE(settle());
+
+    const auto rgba = pixel(128, 128);
+    EXPECT_EQ(rgba[0], 0);
+    EXPECT_NEAR(rgba[1], 128, 1);
+    EXPECT_EQ(rgba[2], 255);
+    EXPECT_EQ(rgba[3], 255);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+}
+
+TEST_F(SlintMapGLTest, DrawsOnlyWhenTheMapChanges) {
+    start(256, 256, 2);
+    ASSERT_TRUE(settle());
+
+    const auto drawn = map->ring_stats().frames;
+    for (int i = 0; i < 20; ++i)
+        frame();
+    EXPECT_EQ(map->ring_stats().frames, drawn);
+
+    // A camera change draws into the back buffer, shown one frame later.
+    const GLuint shown = map->texture();
+    map->set_bearing(30.0);
+    ASSERT_TRUE(map->needs_render());
+    frame();
+    EXPECT_GT(map->ring_stats().frames, drawn);
+    EXPECT_EQ(map->texture(), shown);
+    ASSERT_TRUE(settle());
+    EXPECT_NE(map->texture(), shown);
+}
+
+TEST_F(SlintMapGLTest, RingRotatesThroughItsTextures) {
+    start(256, 256, 3);
+    ASSERT_TRUE(settle());
+
+    std::set<GLuint> textures;
+    for (int i = 0; i < 9; ++i) {
+        map->set_bearing(i * 10.0);
+        frame();
+        frame();
+        textures.insert(map->texture());
+    }
+    EXPECT_EQ(textures.size(), 3u);
+}
+
+TEST_F(SlintMapGLTest, SingleBufferShowsFramesImmediately) {
+    start(256, 256, 1);
+    ASSERT_TRUE(settle());
+
+    const GLuint shown = map->texture();
+    const auto drawn = map->ring_stats().frames;
+    map->set_bearing(45.0);
+    frame();
+    // Drawn and shown in the same frame, in the same texture.
+    EXPECT_GT(map->ring_stats().frames, drawn);
+    EXPECT_EQ(map->texture(), shown);
+    EXPECT_FALSE(map->needs_render());
+}
+
+TEST_F(SlintMapGLTest, ResizeReusesTheTextureWithinABucket) {
+    start(256, 256, 1);
+    ASSERT_TRUE(settle());
+
+    map->resize(300, 200);
+    ASSERT_TRUE(frames_until([this] {
+        return map->frame_layout().width == 300 && !map->needs_render();
+    }));
+    const auto layout = map->frame_layout();
+    EXPECT_EQ(layout.height, 200);
+    EXPECT_EQ(layout.texture_width, 512);
+    EXPECT_EQ(layout.texture_height, 256);
+
+    // Debounced: nothing changes until the size has settled.
+    map->resize(310, 210);
+    frame();
+    EXPECT_EQ(map->frame_layout().width, 300);
+    ASSERT_TRUE(frames_until([this] {
+        return map->frame_layout().width == 310 && !map->needs_render();
+    }));
+    EXPECT_EQ(map->frame_layout().texture_width, 512);
+    EXPECT_EQ(map->frame_layout().texture_height, 256);
+
+    const auto rgba = pixel(305, 205);
+    EXPECT_EQ(rgba[2], 255);
+}
+
+namespace {
+
+// Real GL entry points, counted: the call trace for GLStateShadow.
+int traced_queries = 0;
+
+GLStateShadow::Functions traced_functions() {
+    auto functions = GLStateShadow::Functions::native();
+    functions.get_integerv = [](GLenum pname, GLint* data) {
+        ++traced_queries;
+        glGetIntegerv(pname, data);
+    };
+    functions.is_enabled = [](GLenum cap) -> GLboolean {
+        ++traced_queries;
+        return glIsEnabled(cap);
+    };
+    return functions;
+}
+
+}  // namespace
+
+TEST_F(SlintMapGLTest, StateShadowRestoresHostStateWithFewQueries) {
+    start(256, 256, 2);
+    ASSERT_TRUE(settle());
+
+    // Host (Slint) state the map render must not leak into.
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(1, 2, 33, 44);
+    glEnable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+
+    traced_queries = 0;
+    GLStateShadow shadow(traced_functions());
+    for (int i = 0; i < 50; ++i) {
+        if (!shadow.valid())
+            shadow.capture();
+        else
+            shadow.refresh_bindings();
+        map->set_bearing(i * 7.0);
+        map->render();
+        shadow.restore();
+        map->frame_composited();
+    }
+    // One full capture, then only the object bindings per frame.
+    EXPECT_EQ(traced_queries, 12 + 49 * 6);
+
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    EXPECT_EQ(viewport[2], 33);
+    EXPECT_EQ(viewport[3], 44);
+    EXPECT_TRUE(glIsEnabled(GL_BLEND));
+    EXPECT_FALSE(glIsEnabled(GL_DEPTH_TEST));
+}
+
+TEST_F(SlintMapGLTest, CustomLayerDrawsInstancedPointsIntoTheMap) {
+    start(256, 256, 2);
+    // Around the camera setup() starts at.
+    std::vector<double> lat;
+    std::vector<double> lon;
+    for (int i = 0; i < 100; ++i) {
+        lat.push_back(35.681 + (i % 10 - 4.5) * 0.001);
+        lon.push_back(139.767 + (i / 10 - 4.5) * 0.001);
+    }
+    GLPointCloudLayer::Style style;
+    style.size = 24.0f;
+    style.color = {1.0f, 0.0f, 0.0f, 1.0f};
+    auto points = std::make_shared<GLPointCloudLayer>(lat, lon, style);
+    ASSERT_TRUE(map->add_custom_layer("points", points));
+    EXPECT_FALSE(map->add_custom_layer("points", points));
+    ASSERT_TRUE(settle());
+
+    auto rgba = pixel(128, 128);
+    EXPECT_EQ(rgba[0], 255);
+    EXPECT_EQ(rgba[1], 0);
+    EXPECT_EQ(rgba[2], 0);
+    // Away from the points the background shows.
+    EXPECT_EQ(pixel(10, 10)[2], 255);
+    // Every frame draws all the points in one call.
+    const auto& stats = points->stats();
+    EXPECT_GT(stats.draw_calls, 0u);
+    EXPECT_EQ(stats.instances, stats.draw_calls * 100);
+
+    // A new style gets the layer back.
+    map->setStyleJSON(kBackgroundStyle);
+    ASSERT_TRUE(settle());
+    EXPECT_EQ(pixel(128, 128)[0], 255);
+
+    EXPECT_TRUE(map->remove_custom_layer("points"));
+    map->set_bearing(1.0);
+    ASSERT_TRUE(settle());
+    EXPECT_EQ(pixel(128, 128)[0], 0);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+}
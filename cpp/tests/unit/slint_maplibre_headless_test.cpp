@@ -1,7 +1,12 @@
 #include "slint_maplibre_headless.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
+
+#include "mbgl/style/style.hpp"
 
 class SlintMapLibreTest : public ::testing::Test {
 protected:
@@ -279,3 +284,273 @@ TEST_F(SlintMapLibreTest, ExtremeBearingValues) {
     EXPECT_NO_THROW(slint_map->set_bearing(720.0f));   // Double rotation
     EXPECT_NO_THROW(slint_map->set_bearing(-360.0f));  // Negative full rotation
 }
+
+TEST_F(SlintMapLibreTest, PrewarmThenInitialize) {
+    // Pre-warming creates the map before the size is known; initialize()
+    // must then only apply the size.
+    EXPECT_NO_THROW(slint_map->prewarm(SlintMapLibre::kDefaultStyleUrl));
+    ASSERT_NE(slint_map->get_map(), nullptr);
+    const auto* prewarmed = slint_map->get_map();
+    EXPECT_NO_THROW(slint_map->initialize(800, 600));
+    EXPECT_EQ(slint_map->get_map(), prewarmed);
+    EXPECT_EQ(slint_map->get_map()->getMapOptions().size(),
+              (mbgl::Size{800, 600}));
+    EXPECT_EQ(slint_map->style_url(), SlintMapLibre::kDefaultStyleUrl);
+}
+
+TEST_F(SlintMapLibreTest, StartupMetricsStartUnset) {
+    const auto metrics = slint_map->startup_metrics();
+    EXPECT_LT(metrics.style_loaded_ms, 0.0);
+    EXPECT_LT(metrics.first_frame_ms, 0.0);
+    EXPECT_LT(metrics.first_meaningful_frame_ms, 0.0);
+}
+
+TEST_F(SlintMapLibreTest, UpdateStyleReloadKeepsTheGivenSourceIds) {
+    slint_map->set_frame_logging(false);
+    slint_map->set_align_style_sources(true);
+    slint_map->initialize(256, 256);
+    auto& style = slint_map->get_map()->getStyle();
+    style.loadJSON(R"JSON({"version": 8,
+        "sprite": "https://example.com/a",
+        "sources": {"omt": {"type": "vector",
+                            "url": "https://example.com/v.json"}},
+        "layers": []})JSON");
+    ASSERT_TRUE(slint_map->style_is_loaded());
+
+    // A new sprite cannot be applied in place, so this reloads; the
+    // reloaded source keeps the ID the caller gave it.
+    const auto result = slint_map->update_style(R"JSON({"version": 8,
+        "sprite": "https://example.com/b",
+        "sources": {"tiles": {"type": "vector",
+                              "url": "https://example.com/v.json"}},
+        "layers": []})JSON");
+    EXPECT_TRUE(result.reloaded);
+    EXPECT_NE(style.getSource("tiles"), nullptr);
+    EXPECT_EQ(style.getSource("omt"), nullptr);
+}
+
+TEST_F(SlintMapLibreTest, AlignedStyleIsCachedAsFetched) {
+    slint_map->set_frame_logging(false);
+    slint_map->set_align_style_sources(true);
+    slint_map->initialize(256, 256);
+    const std::string first = R"JSON({"version": 8,
+        "sources": {"omt": {"type": "vector",
+                            "url": "https://example.com/v.json"}},
+        "layers": []})JSON";
+    const std::string second = R"JSON({"version": 8,
+        "sources": {"tiles": {"type": "vector",
+                              "url": "https://example.com/v.json"}},
+        "layers": []})JSON";
+    slint_map->style_cache().insert("test://first", first);
+    slint_map->style_cache().insert("test://second", second);
+
+    slint_map->setStyleUrl("test://first");
+    ASSERT_TRUE(slint_map->style_is_loaded());
+    // Loaded with its source renamed to "omt"...
+    slint_map->setStyleUrl("test://second");
+    EXPECT_NE(slint_map->get_map()->getStyle().getSource("omt"), nullptr);
+    // ...but cached as fetched when switching away.
+    slint_map->setStyleUrl("test://first");
+    const std::string* cached = slint_map->style_cache().find("test://second");
+    ASSERT_NE(cached, nullptr);
+    EXPECT_EQ(*cached, second);
+}
+
+TEST_F(SlintMapLibreTest, GeoJsonRejectsAStyleSourceId) {
+    slint_map->set_frame_logging(false);
+    slint_map->initialize(256, 256);
+    slint_map->get_map()->getStyle().loadJSON(R"JSON({"version": 8,
+        "sources": {"places": {"type": "geojson", "data": {
+            "type": "FeatureCollection", "features": []}}},
+        "layers": []})JSON");
+    ASSERT_TRUE(slint_map->style_is_loaded());
+
+    GeoJsonInput input;
+    input.json = R"({"type":"FeatureCollection","features":[]})";
+    EXPECT_EQ(slint_map->set_geojson("places", std::move(input), {}), 0u);
+    EXPECT_FALSE(slint_map->remove_geojson("places"));
+    EXPECT_NE(slint_map->get_map()->getStyle().getSource("places"), nullptr);
+}
+
+TEST(SlintMapEngineTest, MapsShareOneRunLoop) {
+    // Two maps of one engine (e.g. a main view and a minimap) are pumped by
+    // the same loop and render independently.
+    auto engine = std::make_shared<SlintMapEngine>();
+    SlintMapLibre main_map(engine);
+    SlintMapLibre minimap(engine);
+    main_map.set_frame_logging(false);
+    minimap.set_frame_logging(false);
+    main_map.initialize(320, 240);
+    minimap.initialize(128, 96);
+
+#if !defined(__APPLE__) || defined(MLN_WITH_WEBGPU)
+    EXPECT_NE(engine->run_loop(), nullptr);
+#endif
+    ASSERT_NE(main_map.get_map(), nullptr);
+    ASSERT_NE(minimap.get_map(), nullptr);
+    EXPECT_NE(main_map.get_map(), minimap.get_map());
+    EXPECT_EQ(minimap.get_map()->getMapOptions().size(),
+              (mbgl::Size{128, 96}));
+
+    EXPECT_NO_THROW(main_map.run_map_loop());
+    EXPECT_NO_THROW(minimap.run_map_loop());
+    EXPECT_NO_THROW(minimap.render_map());
+}
+
+namespace {
+
+// Background-only style: renders without any network access.
+const char* kSnapshotStyle = R"JSON({
+    "version": 8,
+    "sources": {},
+    "layers": [{"id": "background", "type": "background",
+                "paint": {"background-color": "rgb(0, 128, 255)"}}]
+})JSON";
+
+// One interactive frame: a drag step, then a render.
+void interactive_frame(SlintMapLibre& map, int i) {
+    map.handle_mouse_press(100.0f, 100.0f);
+    map.handle_mouse_move(101.0f + (i % 2), 100.0f, true);
+    map.render_map();
+}
+
+}  // namespace
+
+TEST(SlintMapLibreSnapshotTest, BurstDoesNotBlockInteractiveFrames) {
+    SlintMapLibre map;
+    map.set_frame_logging(false);
+    map.initialize(256, 256);
+    map.get_map()->getStyle().loadJSON(kSnapshotStyle);
+    for (int i = 0; i < 100 && !map.style_is_loaded(); ++i) {
+        map.run_map_loop();
+    }
+    ASSERT_TRUE(map.style_is_loaded());
+
+    std::vector<uint64_t> delivered;
+    int ok = 0;
+    for (int i = 0; i < 6; ++i) {
+        mbgl::CameraOptions camera;
+        camera.withCenter(mbgl::LatLng{35.68, 139.76}).withZoom(4.0 + i);
+        const uint64_t id = map.request_snapshot(
+            camera, 512, 384, 2.0f, [&](StaticMapResult&& result) {
+                delivered.push_back(result.index);
+                if (result.ok() && result.image.size.width == 1024 &&
+                    result.image.size.height == 768)
+                    ++ok;
+            });
+        EXPECT_NE(id, 0u);
+    }
+    // Requesting only queues the work.
+    EXPECT_TRUE(delivered.empty());
+    EXPECT_EQ(map.pending_snapshots(), 6u);
+
+    // Interactive frames go on while the snapshots are in flight, and
+    // results only arrive from run_map_loop(), never inside a frame.
+    int frames = 0;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (map.pending_snapshots() > 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        map.run_map_loop();
+        const std::size_t before = delivered.size();
+        interactive_frame(map, frames++);
+        EXPECT_EQ(delivered.size(), before);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_GT(frames, 0);
+    EXPECT_EQ(delivered.size(), 6u);
+    EXPECT_EQ(ok, 6);
+    EXPECT_TRUE(std::is_sorted(delivered.begin(), delivered.end()));
+}
+
+namespace {
+
+// A map as SlintMapViews runs it for a view with `map-id >= 0`: the shared
+// engine is pumped once per tick, and the map itself only delivers and
+// renders.
+class EngineViewTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        engine = std::make_shared<SlintMapEngine>();
+        map = std::make_unique<SlintMapLibre>(engine);
+        map->set_frame_logging(false);
+        map->initialize(256, 256);
+        map->get_map()->getStyle().loadJSON(kSnapshotStyle);
+        ASSERT_TRUE(map->style_is_loaded());
+    }
+
+    void view_tick() {
+        engine->run_once();
+        map->deliver_async();
+        if (map->take_repaint_request() || map->consume_forced_repaint())
+            map->render_map();
+    }
+
+    // Ticks until `done` or a timeout; returns `done()`.
+    template <typename Done>
+    bool tick_until(Done done) {
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!done() && std::chrono::steady_clock::now() < deadline) {
+            view_tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return done();
+    }
+
+    std::shared_ptr<SlintMapEngine> engine;
+    std::unique_ptr<SlintMapLibre> map;
+};
+
+const char* kPointLayers = R"JSON([{"id": "dots", "type": "circle"}])JSON";
+
+}  // namespace
+
+TEST_F(EngineViewTest, GeoJsonOverlayLands) {
+    GeoJsonInput input;
+    input.json = R"({"type":"FeatureCollection","features":[
+        {"type":"Feature","properties":{},
+         "geometry":{"type":"Point","coordinates":[139.76,35.68]}}]})";
+    SlintMapLibre::GeoJsonOverlayOptions options;
+    options.layers_json = kPointLayers;
+    bool loaded = false;
+    ASSERT_NE(map->set_geojson("places", std::move(input), options,
+                               [&](GeoJsonLoadResult&& result) {
+                                   loaded = result.data != nullptr;
+                               }),
+              0u);
+
+    auto& style = map->get_map()->getStyle();
+    EXPECT_TRUE(tick_until([&] { return style.getSource("places"); }));
+    EXPECT_TRUE(loaded);
+    EXPECT_NE(style.getLayer("dots"), nullptr);
+    EXPECT_EQ(map->pending_geojson(), 0u);
+}
+
+TEST_F(EngineViewTest, MovingObjectsLand) {
+    SlintMapLibre::GeoJsonOverlayOptions options;
+    options.layers_json = kPointLayers;
+    ASSERT_TRUE(map->add_moving_objects("fleet", options));
+    ObjectPositions positions;
+    positions.push(1, 139.76, 35.68, 90.0f);
+    positions.push(2, 139.70, 35.66, 180.0f);
+    EXPECT_EQ(map->update_moving_objects("fleet", positions), 2u);
+
+    auto& style = map->get_map()->getStyle();
+    EXPECT_TRUE(tick_until([&] { return style.getSource("fleet"); }));
+    EXPECT_NE(style.getLayer("dots"), nullptr);
+    EXPECT_FALSE(map->moving_objects("fleet")->dirty());
+}
+
+TEST_F(EngineViewTest, SnapshotsCallBack) {
+    mbgl::CameraOptions camera;
+    camera.withCenter(mbgl::LatLng{35.68, 139.76}).withZoom(4.0);
+    bool ok = false;
+    ASSERT_NE(map->request_snapshot(camera, 64, 64, 1.0f,
+                                    [&](StaticMapResult&& result) {
+                                        ok = result.ok();
+                                    }),
+              0u);
+    EXPECT_TRUE(tick_until([&] { return map->pending_snapshots() == 0; }));
+    EXPECT_TRUE(ok);
+}
@@ -0,0 +1,72 @@
+#include "static_map_renderer.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Background-only style: renders without any network access.
+const char* kBackgroundStyle = R"JSON({
+    "version": 8,
+    "sources": {},
+    "layers": [{"id": "background", "type": "background",
+                "paint": {"background-color": "rgb(0, 128, 255)"}}]
+})JSON";
+
+StaticMapRequest make_request(double lat, double lon, double zoom,
+                              uint32_t w, uint32_t h) {
+    StaticMapRequest request;
+    request.camera.withCenter(mbgl::LatLng{lat, lon}).withZoom(zoom);
+    request.width = w;
+    request.height = h;
+    return request;
+}
+
+}  // namespace
+
+TEST(StaticMapRendererTest, RendersBatchWithOneStyle) {
+    StaticMapRenderer renderer;
+    renderer.load_style_json(kBackgroundStyle);
+
+    const std::vector<StaticMapRequest> requests = {
+        make_request(35.68, 139.76, 10.0, 256, 256),
+        make_request(51.50, -0.12, 4.0, 320, 200),
+        make_request(0.0, 0.0, 0.0, 64, 64),
+    };
+
+    std::vector<std::size_t> order;
+    const StaticBatchStats stats = renderer.render_batch(
+        requests, [&](StaticMapResult&& result) {
+            ASSERT_TRUE(result.ok()) << result.error;
+            const auto& req = requests[result.index];
+            EXPECT_EQ(result.image.size.width, req.width);
+            EXPECT_EQ(result.image.size.height, req.height);
+            // Opaque background colour in the centre pixel (RGBA).
+            const std::size_t centre =
+                (result.image.size.height / 2 * result.image.size.width +
+                 result.image.size.width / 2) *
+                4;
+            EXPECT_EQ(result.image.data[centre + 0], 0);
+            EXPECT_NEAR(result.image.data[centre + 1], 128, 1);
+            EXPECT_EQ(result.image.data[centre + 2], 255);
+            EXPECT_EQ(result.image.data[centre + 3], 255);
+            order.push_back(result.index);
+        });
+
+    EXPECT_EQ(stats.rendered, requests.size());
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_GT(stats.images_per_second, 0.0);
+    EXPECT_EQ(order, (std::vector<std::size_t>{0, 1, 2}));
+}
+
+TEST(StaticMapRendererTest, ReportsInvalidStyle) {
+    StaticMapRenderer renderer;
+    renderer.load_style_json("{ not json");
+
+    StaticBatchStats stats;
+    const auto results =
+        renderer.render_batch({make_request(0.0, 0.0, 1.0, 64, 64)}, &stats);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_FALSE(results[0].ok());
+    EXPECT_FALSE(results[0].error.empty());
+    EXPECT_EQ(stats.failed, 1u);
+}
@@ -0,0 +1,100 @@
+#include "style_cache.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "json_value.hpp"
+
+TEST(StyleCacheTest, KeepsTheMostRecentlyUsedStyles) {
+    StyleCache cache(2);
+    cache.insert("a", "{\"a\":1}");
+    cache.insert("b", "{\"b\":1}");
+    ASSERT_NE(cache.find("a"), nullptr);  // a is now the most recent
+    cache.insert("c", "{\"c\":1}");       // evicts b
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find("b"), nullptr);
+    ASSERT_NE(cache.find("a"), nullptr);
+    EXPECT_EQ(*cache.find("c"), "{\"c\":1}");
+    EXPECT_EQ(cache.stats().hits, 3u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST(StyleCacheTest, ZeroCapacityDisablesIt) {
+    StyleCache cache(1);
+    cache.insert("a", "{}");
+    cache.set_capacity(0);
+    EXPECT_EQ(cache.size(), 0u);
+    cache.insert("b", "{}");
+    EXPECT_EQ(cache.find("b"), nullptr);
+}
+
+namespace {
+
+const char* kCurrent = R"({"version":8,"sources":{
+    "openmaptiles":{"type":"vector","url":"https://tiles.example/v.json"},
+    "hillshade":{"type":"raster","tiles":["https://h.example/{z}/{x}/{y}.png"],
+                 "tileSize":256}},
+  "layers":[{"id":"water","type":"fill","source":"openmaptiles",
+             "source-layer":"water"}]})";
+
+}  // namespace
+
+TEST(StyleCacheTest, AlignsSharedSourcesToTheCurrentIds) {
+    const std::string next = R"({"version":8,"sources":{
+        "omt":{"type":"vector","url":"https://tiles.example/v.json"},
+        "hills":{"type":"raster","tiles":["https://h.example/{z}/{x}/{y}.png"],
+                 "tileSize":512},
+        "extra":{"type":"geojson","data":{"type":"FeatureCollection",
+                                          "features":[]}}},
+      "layers":[{"id":"bg","type":"background"},
+                {"id":"roads","type":"line","source":"omt",
+                 "source-layer":"transportation"},
+                {"id":"hills","type":"raster","source":"hills"}]})";
+    std::size_t kept = 0;
+    const auto aligned = JsonValue::parse(align_source_ids(next, kCurrent,
+                                                           &kept));
+    ASSERT_TRUE(aligned);
+    // Same TileJSON URL: renamed. Different tile size: a different source.
+    EXPECT_EQ(kept, 1u);
+    const JsonValue* sources = aligned->find("sources");
+    EXPECT_NE(sources->find("openmaptiles"), nullptr);
+    EXPECT_EQ(sources->find("omt"), nullptr);
+    EXPECT_NE(sources->find("hills"), nullptr);
+    const auto& layers = aligned->find("layers")->as_array();
+    EXPECT_EQ(*layers[1].find_string("source"), "openmaptiles");
+    EXPECT_EQ(*layers[2].find_string("source"), "hills");
+    EXPECT_EQ(layers[0].find("source"), nullptr);
+}
+
+TEST(StyleCacheTest, DoesNotRenameOntoAnIdInUse) {
+    // `next` already has an "openmaptiles" that is a different source.
+    const std::string next = R"({"version":8,"sources":{
+        "openmaptiles":{"type":"vector","url":"https://other.example/v.json"},
+        "omt":{"type":"vector","url":"https://tiles.example/v.json"}},
+      "layers":[]})";
+    std::size_t kept = 7;
+    EXPECT_EQ(align_source_ids(next, kCurrent, &kept), next);
+    EXPECT_EQ(kept, 0u);
+}
+
+TEST(StyleCacheTest, SourcesWithOtherTileParametersAreNotShared) {
+    // Same TileJSON URL, but each differs in what it requests or decodes.
+    const std::string next = R"({"version":8,"sources":{
+        "tms":{"type":"vector","url":"https://tiles.example/v.json",
+               "scheme":"tms"},
+        "low":{"type":"vector","url":"https://tiles.example/v.json",
+               "maxzoom":10},
+        "box":{"type":"vector","url":"https://tiles.example/v.json",
+               "bounds":[0,0,10,10]},
+        "dem":{"type":"vector","url":"https://tiles.example/v.json",
+               "encoding":"terrarium"}},
+      "layers":[]})";
+    std::size_t kept = 7;
+    EXPECT_EQ(align_source_ids(next, kCurrent, &kept), next);
+    EXPECT_EQ(kept, 0u);
+}
+
+TEST(StyleCacheTest, LeavesUnparsableStylesAlone) {
+    EXPECT_EQ(align_source_ids("{oops", kCurrent), "{oops");
+    EXPECT_EQ(align_source_ids(kCurrent, "{oops"), kCurrent);
+}
@@ -0,0 +1,146 @@
+#include "style_diff.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "json_value.hpp"
+
+namespace {
+
+const char* kStyle = R"({"version":8,"name":"base",
+  "sources":{"v":{"type":"vector","url":"https://tiles.example/v.json"}},
+  "layers":[
+    {"id":"bg","type":"background","paint":{"background-color":"#fff"}},
+    {"id":"water","type":"fill","source":"v","source-layer":"water",
+     "paint":{"fill-color":"#00f","fill-opacity":0.5}},
+    {"id":"roads","type":"line","source":"v","source-layer":"roads",
+     "filter":["==","class","motorway"]},
+    {"id":"labels","type":"symbol","source":"v","source-layer":"place",
+     "layout":{"text-field":"{name}"}}]})";
+
+JsonValue style() {
+    return *JsonValue::parse(kStyle);
+}
+
+JsonValue& layer(JsonValue& doc, std::size_t i) {
+    return doc.find("layers")->as_array()[i];
+}
+
+std::vector<std::string> describe(const StyleDiff& diff) {
+    std::vector<std::string> out;
+    for (const auto& op : diff.ops) {
+        switch (op.type) {
+        case StyleOp::Type::RemoveLayer:
+            out.push_back("-layer " + op.id);
+            break;
+        case StyleOp::Type::RemoveSource:
+            out.push_back("-source " + op.id);
+            break;
+        case StyleOp::Type::AddSource:
+            out.push_back("+source " + op.id);
+            break;
+        case StyleOp::Type::AddLayer:
+            out.push_back("+layer " + op.id + " below " + op.before);
+            break;
+        case StyleOp::Type::SetProperty:
+            out.push_back(op.id + "." + op.property + "=" + op.value.dump());
+            break;
+        }
+    }
+    return out;
+}
+
+using Ops = std::vector<std::string>;
+
+}  // namespace
+
+TEST(StyleDiffTest, IdenticalStylesNeedNothing) {
+    auto next = style();
+    next.set("name", "renamed");
+    next.set("zoom", 4);
+    const auto diff = diff_styles(style(), next);
+    EXPECT_FALSE(diff.needs_reload());
+    EXPECT_TRUE(diff.ops.empty());
+}
+
+TEST(StyleDiffTest, PaintLayoutAndFilterChangesAreSetInPlace) {
+    auto next = style();
+    layer(next, 1).find("paint")->set("fill-color", "#f00");
+    layer(next, 1).find("paint")->erase("fill-opacity");
+    layer(next, 2).set("layout", JsonValue::Object{{"visibility", "none"}});
+    layer(next, 2).erase("filter");
+    layer(next, 3).set("minzoom", 6);
+    const auto diff = diff_styles(style(), next);
+    ASSERT_FALSE(diff.needs_reload());
+    EXPECT_EQ(describe(diff), (Ops{"water.fill-color=\"#f00\"",
+                                   "water.fill-opacity=null",
+                                   "roads.visibility=\"none\"",
+                                   "roads.filter=null", "labels.minzoom=6"}));
+}
+
+TEST(StyleDiffTest, AddsAndRemovesLayersInPlace) {
+    auto next = style();
+    auto& layers = next.find("layers")->as_array();
+    layers.erase(layers.begin() + 2);  // roads
+    layers.insert(layers.begin() + 1, *JsonValue::parse(
+        R"({"id":"land","type":"fill","source":"v","source-layer":"land"})"));
+    const auto diff = diff_styles(style(), next);
+    ASSERT_FALSE(diff.needs_reload());
+    EXPECT_EQ(describe(diff), (Ops{"-layer roads", "+layer land below water"}));
+}
+
+TEST(StyleDiffTest, MovesTheFewestLayers) {
+    auto next = style();
+    auto& layers = next.find("layers")->as_array();
+    // bg water roads labels -> bg labels water roads: only labels moves.
+    std::rotate(layers.begin() + 1, layers.begin() + 3, layers.end());
+    const auto diff = diff_styles(style(), next);
+    ASSERT_FALSE(diff.needs_reload());
+    EXPECT_EQ(describe(diff),
+              (Ops{"-layer labels", "+layer labels below water"}));
+}
+
+TEST(StyleDiffTest, ChangedLayerTypeIsReadded) {
+    auto next = style();
+    layer(next, 3).set("type", "circle");
+    layer(next, 3).erase("layout");
+    const auto diff = diff_styles(style(), next);
+    EXPECT_EQ(describe(diff), (Ops{"-layer labels", "+layer labels below "}));
+}
+
+TEST(StyleDiffTest, ChangedSourceIsReplacedWithItsLayers) {
+    auto next = style();
+    next.find("sources")->find("v")->set("url", "https://tiles.example/w.json");
+    next.find("sources")->set(
+        "dem", *JsonValue::parse(R"({"type":"raster-dem","url":"d.json"})"));
+    const auto diff = diff_styles(style(), next);
+    ASSERT_FALSE(diff.needs_reload());
+    EXPECT_EQ(describe(diff),
+              (Ops{"-layer water", "-layer roads", "-layer labels",
+                   "-source v", "+source v", "+source dem",
+                   "+layer labels below ", "+layer roads below labels",
+                   "+layer water below roads"}));
+}
+
+TEST(StyleDiffTest, TopLevelChangesNeedAReload) {
+    auto next = style();
+    next.set("sprite", "https://sprites.example/s");
+    next.set("glyphs", "https://glyphs.example/{fontstack}/{range}.pbf");
+    layer(next, 1).find("paint")->set("fill-color", "#f00");
+    const auto diff = diff_styles(style(), next);
+    EXPECT_TRUE(diff.needs_reload());
+    EXPECT_TRUE(diff.ops.empty());
+    EXPECT_EQ(diff.reload_reasons,
+              (std::vector<std::string>{"sprite changed", "glyphs changed"}));
+}
+
+TEST(StyleDiffTest, MalformedLayersNeedAReload) {
+    auto next = style();
+    layer(next, 2).set("id", "water");
+    EXPECT_EQ(
+        diff_styles(style(), next).reload_reasons,
+        (std::vector<std::string>{"new style has duplicate layer water"}));
+    EXPECT_TRUE(diff_styles(style(), JsonValue(3)).needs_reload());
+}
@@ -0,0 +1,143 @@
+#include "tile_pyramid.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+
+#include "work_stealing_queue.hpp"
+
+TEST(TilePyramidTest, ParsesBounds) {
+    auto b = parse_tile_bounds("122,24.5,154,46");
+    ASSERT_TRUE(b.has_value());
+    EXPECT_DOUBLE_EQ(b->min_lon, 122.0);
+    EXPECT_DOUBLE_EQ(b->min_lat, 24.5);
+    EXPECT_DOUBLE_EQ(b->max_lon, 154.0);
+    EXPECT_DOUBLE_EQ(b->max_lat, 46.0);
+    EXPECT_FALSE(parse_tile_bounds("1,2,3").has_value());
+    EXPECT_FALSE(parse_tile_bounds("10,0,0,10").has_value());
+}
+
+TEST(TilePyramidTest, WorldRangePerZoom) {
+    const TileBounds world;
+    for (uint8_t z = 0; z <= 4; ++z) {
+        const TileRange r = tile_range(world, z);
+        EXPECT_EQ(r.min_x, 0u);
+        EXPECT_EQ(r.min_y, 0u);
+        EXPECT_EQ(r.max_x, (1u << z) - 1);
+        EXPECT_EQ(r.max_y, (1u << z) - 1);
+        EXPECT_EQ(r.count(), uint64_t{1} << (2 * z));
+    }
+}
+
+TEST(TilePyramidTest, KnownTileForTokyo) {
+    // Tokyo station is tile 14/14552/6451.
+    const TileBounds tokyo{139.767, 35.681, 139.767, 35.681};
+    const TileRange r = tile_range(tokyo, 14);
+    EXPECT_EQ(r.min_x, 14552u);
+    EXPECT_EQ(r.max_x, 14552u);
+    EXPECT_EQ(r.min_y, 6451u);
+    EXPECT_EQ(r.max_y, 6451u);
+    EXPECT_EQ(tms_row({14, 14552, 6451}), (1u << 14) - 1 - 6451);
+}
+
+TEST(TilePyramidTest, MetatilesCoverRangeExactlyOnce) {
+    TileRange range;
+    range.z = 5;
+    range.min_x = 3;
+    range.max_x = 10;
+    range.min_y = 7;
+    range.max_y = 9;
+    const auto blocks = metatiles_for_range(range, 4);
+
+    std::set<std::pair<uint32_t, uint32_t>> seen;
+    for (const auto& mt : blocks) {
+        EXPECT_LE(mt.width, 4u);
+        EXPECT_LE(mt.height, 4u);
+        for (uint32_t y = mt.y; y < mt.y + mt.height; ++y) {
+            for (uint32_t x = mt.x; x < mt.x + mt.width; ++x) {
+                EXPECT_TRUE(seen.insert({x, y}).second);
+            }
+        }
+    }
+    EXPECT_EQ(seen.size(), range.count());
+    // Blocks are aligned to multiples of the metatile size.
+    EXPECT_EQ(blocks.front().x, 3u);
+    EXPECT_EQ(blocks.front().width, 1u);
+}
+
+TEST(TilePyramidTest, RenderPlanMapsTileSizeToZoom) {
+    const Metatile mt{3, 2, 2, 4, 4};
+    const auto r256 = metatile_render(mt, 256);
+    EXPECT_DOUBLE_EQ(*r256.camera.zoom, 2.0);
+    EXPECT_EQ(r256.width, 1024u);
+    EXPECT_EQ(r256.downsample, 1u);
+    // Block centre is the corner shared by tiles 3/3/3 and 3/4/4: lon 0.
+    EXPECT_NEAR(r256.camera.center->longitude(), 0.0, 1e-9);
+    EXPECT_NEAR(r256.camera.center->latitude(), 0.0, 1e-9);
+
+    // z0 with 256 px tiles would need zoom -1: render 2x at zoom 0.
+    const auto r0 = metatile_render(Metatile{0, 0, 0, 1, 1}, 256);
+    EXPECT_DOUBLE_EQ(*r0.camera.zoom, 0.0);
+    EXPECT_EQ(r0.downsample, 2u);
+    EXPECT_EQ(r0.width, 512u);
+}
+
+TEST(TilePyramidTest, SplitsMetatileIntoTiles) {
+    const Metatile mt{4, 8, 6, 2, 1};
+    mbgl::PremultipliedImage image({16, 8});
+    for (uint32_t y = 0; y < 8; ++y) {
+        for (uint32_t x = 0; x < 16; ++x) {
+            uint8_t* px = image.data.get() + (y * 16 + x) * 4;
+            px[0] = x < 8 ? 255 : 0;
+            px[1] = 0;
+            px[2] = x < 8 ? 0 : 255;
+            px[3] = 255;
+        }
+    }
+    const auto tiles = split_metatile(mt, image, 8);
+    ASSERT_EQ(tiles.size(), 2u);
+    EXPECT_EQ(tiles[0].id, (TileID{4, 8, 6}));
+    EXPECT_EQ(tiles[1].id, (TileID{4, 9, 6}));
+    EXPECT_EQ(tiles[0].image.data[0], 255);
+    EXPECT_EQ(tiles[1].image.data[2], 255);
+
+    // Downsampling halves the tile before splitting.
+    const auto half = split_metatile(Metatile{0, 0, 0, 1, 1}, image, 4, 2);
+    ASSERT_EQ(half.size(), 1u);
+    EXPECT_EQ(half[0].image.size, (mbgl::Size{4, 4}));
+}
+
+TEST(WorkStealingQueueTest, EveryJobRunsOnce) {
+    WorkStealingQueue<int> queue(4);
+    std::vector<int> jobs(1000);
+    for (int i = 0; i < 1000; ++i) {
+        jobs[i] = i;
+    }
+    queue.distribute(jobs);
+
+    std::vector<std::vector<int>> taken(4);
+    std::vector<std::thread> workers;
+    for (std::size_t w = 0; w < 4; ++w) {
+        workers.emplace_back([&, w]() {
+            while (auto job = queue.pop(w)) {
+                taken[w].push_back(*job);
+                if (w == 0) {
+                    // A slow worker forces the others to steal its jobs.
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    std::vector<int> all;
+    for (const auto& t : taken) {
+        all.insert(all.end(), t.begin(), t.end());
+    }
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(all, jobs);
+    EXPECT_GT(queue.steals(), 0u);
+}
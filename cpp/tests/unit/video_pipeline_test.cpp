@@ -0,0 +1,135 @@
+#include "video_pipeline.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <sstream>
+
+#include "camera_path.hpp"
+
+namespace {
+
+mbgl::PremultipliedImage solid(uint32_t w, uint32_t h, uint8_t r, uint8_t g,
+                               uint8_t b) {
+    mbgl::PremultipliedImage image({w, h});
+    for (uint32_t i = 0; i < w * h; ++i) {
+        image.data[i * 4] = r;
+        image.data[i * 4 + 1] = g;
+        image.data[i * 4 + 2] = b;
+        image.data[i * 4 + 3] = 255;
+    }
+    return image;
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+}  // namespace
+
+TEST(VideoPipelineTest, ConvertsBt601LimitedRange) {
+    struct Case {
+        uint8_t r, g, b, y, u, v;
+    };
+    const Case cases[] = {
+        {255, 255, 255, 235, 128, 128},
+        {0, 0, 0, 16, 128, 128},
+        {255, 0, 0, 82, 90, 240},
+        {0, 0, 255, 41, 240, 110},
+    };
+    for (const auto& c : cases) {
+        const auto image = solid(3, 3, c.r, c.g, c.b);
+        uint8_t y[9], u[4], v[4];
+        rgba_to_yuv420(image, y, u, v);
+        EXPECT_EQ(y[8], c.y);
+        EXPECT_EQ(u[3], c.u);
+        EXPECT_EQ(v[3], c.v);
+    }
+}
+
+TEST(VideoPipelineTest, WritesY4mFramesInOrder) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "mbgl_slint_video_test.y4m";
+    VideoPipeline::Options options;
+    options.fps = 25;
+    options.convert_threads = 3;
+    options.queue_depth = 2;
+    {
+        VideoPipeline video(path.string(), 4, 2, options);
+        ASSERT_TRUE(video.ok());
+        for (int i = 0; i < 20; ++i) {
+            // Grey level encodes the frame number.
+            const auto level = static_cast<uint8_t>(i * 10);
+            EXPECT_TRUE(video.push(solid(4, 2, level, level, level)));
+        }
+        EXPECT_FALSE(video.push(solid(2, 2, 0, 0, 0)));  // wrong size
+        EXPECT_EQ(video.error(), "rejected frame 20: wrong size");
+        video.finish();
+        EXPECT_EQ(video.stats().frames, 20u);
+    }
+
+    const std::string data = read_file(path);
+    const std::string header = "YUV4MPEG2 W4 H2 F25:1 Ip A1:1 C420jpeg\n";
+    ASSERT_EQ(data.compare(0, header.size(), header), 0);
+    const std::size_t frame_size = 6 + 8 + 2 + 2;
+    ASSERT_EQ(data.size(), header.size() + 20 * frame_size);
+    int previous_luma = -1;
+    for (int i = 0; i < 20; ++i) {
+        const std::size_t at = header.size() + i * frame_size;
+        EXPECT_EQ(data.compare(at, 6, "FRAME\n"), 0);
+        const int y = static_cast<uint8_t>(data[at + 6]);
+        EXPECT_GT(y, previous_luma) << "frame " << i << " out of order";
+        previous_luma = y;
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(VideoPipelineTest, WritesRawRgb) {
+    const auto path =
+        std::filesystem::temp_directory_path() / "mbgl_slint_video_test.rgb";
+    VideoPipeline::Options options;
+    options.format = VideoFormat::RGB;
+    {
+        VideoPipeline video(path.string(), 2, 2, options);
+        video.push(solid(2, 2, 1, 2, 3));
+    }
+    EXPECT_EQ(read_file(path), std::string("\1\2\3\1\2\3\1\2\3\1\2\3"));
+    std::filesystem::remove(path);
+}
+
+TEST(CameraPathTest, ParsesAndInterpolatesKeyframes) {
+    std::istringstream text(
+        "# t lat lon zoom bearing pitch\n"
+        "0 35 139 4\n"
+        "\n"
+        "2 36 140 6 350 30\n"
+        "4 36 140 6 10\n");
+    const auto path = CameraPath::parse(text);
+    ASSERT_TRUE(path.has_value());
+    EXPECT_DOUBLE_EQ(path->duration_s(), 4.0);
+
+    const auto start = path->sample(-1.0);
+    EXPECT_DOUBLE_EQ(*start.zoom, 4.0);
+    const auto mid = path->sample(1.0);
+    EXPECT_DOUBLE_EQ(*mid.zoom, 5.0);
+    EXPECT_DOUBLE_EQ(mid.center->latitude(), 35.5);
+    // 350 -> 10 goes through north, not all the way round.
+    const auto turn = path->sample(3.0);
+    EXPECT_NEAR(std::fmod(*turn.bearing + 360.0, 360.0), 0.0, 1e-9);
+
+    std::istringstream backwards("1 0 0 1\n0 0 0 1\n");
+    EXPECT_FALSE(CameraPath::parse(backwards).has_value());
+}
+
+TEST(VideoPipelineTest, ReportsAnUnopenableOutput) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      "no_such_dir" / "out.y4m";
+    VideoPipeline video(path.string(), 2, 2, {});
+    EXPECT_FALSE(video.ok());
+    EXPECT_EQ(video.error(), "cannot open " + path.string());
+    EXPECT_FALSE(video.push(solid(2, 2, 0, 0, 0)));
+    EXPECT_FALSE(video.finish());
+}
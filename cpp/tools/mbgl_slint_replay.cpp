@@ -0,0 +1,103 @@
+// Headless replay runner for recorded MMapAdapter interaction streams.
+//
+// Record a session with the example app:
+//   MAPLIBRE_RECORD_INPUT=pan_tokyo.mlsi ./build/cpp/maplibre-slint-example
+//
+// Replay it against local tiles and fail when the frame-time budget regresses:
+//   mbgl-slint-replay pan_tokyo.mlsi --style file:///data/style.json \
+//       --map-style https://demotiles.maplibre.org/style.json=file:///... \
+//       --max-p95-ms 12 --dump frames/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "input_replay.hpp"
+#include "slint_maplibre_headless.hpp"
+
+namespace {
+
+void usage(const char* argv0) {
+    std::cerr
+        << "usage: " << argv0 << " <recording> [options]\n"
+        << "  --style URL           style loaded before replay\n"
+        << "  --map-style FROM=TO   rewrite a recorded style URL\n"
+        << "  --fps N               virtual frame rate (default 60)\n"
+        << "  --tail-ms N           virtual time after the last event\n"
+        << "  --dump DIR            write every rendered frame as PNG\n"
+        << "  --max-p95-ms N        exit 1 if p95 frame time exceeds N\n"
+        << "  --max-mean-ms N       exit 1 if mean frame time exceeds N\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    ReplayOptions options;
+    double max_p95_ms = 0.0;
+    double max_mean_ms = 0.0;
+    const std::string recording = argv[1];
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--style" && has_value) {
+            options.style_url = argv[++i];
+        } else if (arg == "--map-style" && has_value) {
+            const std::string spec = argv[++i];
+            const auto eq = spec.find('=');
+            if (eq == std::string::npos) {
+                usage(argv[0]);
+                return 2;
+            }
+            options.style_url_map[spec.substr(0, eq)] = spec.substr(eq + 1);
+        } else if (arg == "--fps" && has_value) {
+            const double fps = std::atof(argv[++i]);
+            if (fps > 0.0) {
+                options.frame_interval = std::chrono::microseconds(
+                    static_cast<int64_t>(1e6 / fps));
+            }
+        } else if (arg == "--tail-ms" && has_value) {
+            options.tail = std::chrono::milliseconds(std::atoi(argv[++i]));
+        } else if (arg == "--dump" && has_value) {
+            options.frame_dump_dir = argv[++i];
+        } else if (arg == "--max-p95-ms" && has_value) {
+            max_p95_ms = std::atof(argv[++i]);
+        } else if (arg == "--max-mean-ms" && has_value) {
+            max_mean_ms = std::atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    auto events = load_input_events(recording);
+    if (!events) {
+        std::cerr << "[replay] cannot read recording: " << recording
+                  << std::endl;
+        return 2;
+    }
+
+    SlintMapLibre map;
+    const FrameTimeStats stats = replay_input_events(map, *events, options);
+    if (!stats.style_loaded) {
+        return 2;
+    }
+
+    std::cout << "[replay] events=" << events->size()
+              << " frames=" << stats.frames << " mean=" << stats.mean_ms
+              << "ms p50=" << stats.p50_ms << "ms p95=" << stats.p95_ms
+              << "ms p99=" << stats.p99_ms << "ms max=" << stats.max_ms
+              << "ms" << std::endl;
+
+    if ((max_p95_ms > 0.0 && stats.p95_ms > max_p95_ms) ||
+        (max_mean_ms > 0.0 && stats.mean_ms > max_mean_ms)) {
+        std::cerr << "[replay] frame-time budget exceeded" << std::endl;
+        return 1;
+    }
+    return 0;
+}
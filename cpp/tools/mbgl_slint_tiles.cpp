@@ -0,0 +1,381 @@
+// Raster tile pyramid generator on top of the headless backend.
+//
+// Renders z/x/y PNG tiles for a bounding box and zoom range with the same
+// renderer as the live app, e.g.:
+//
+//   mbgl-slint-tiles --style https://demotiles.maplibre.org/style.json \
+//       --bbox 122,24,154,46 --zoom 0-8 --metatile 4 --out tiles/
+//   mbgl-slint-tiles --style file:///data/style.json --bbox ... \
+//       --zoom 0-12 --scale 2 --out basemap.mbtiles
+//
+// Each worker thread owns a StaticMapRenderer (RunLoop, frontend, map, GL
+// context) and takes metatiles from a work-stealing queue; every metatile is
+// rendered once and split into its tiles. PNG encoding runs on a separate
+// ImageEncoder pool, so a renderer moves on to its next metatile while the
+// previous one is still being compressed.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mbgl/util/image.hpp>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef MLN_SLINT_HAS_SQLITE3
+#include <sqlite3.h>
+#endif
+
+#include "image_encoder.hpp"
+#include "static_map_renderer.hpp"
+#include "tile_pyramid.hpp"
+#include "work_stealing_queue.hpp"
+
+namespace {
+
+struct Options {
+    std::string style_url;
+    TileBounds bounds;
+    int min_zoom = 0;
+    int max_zoom = 4;
+    uint32_t tile_size = 256;
+    float scale = 1.0f;
+    uint32_t metatile = 4;
+    unsigned threads = 0;
+    unsigned encode_threads = 0;
+    std::string out;
+};
+
+void usage(const char* argv0) {
+    std::cerr
+        << "usage: " << argv0 << " --style URL --out DIR|FILE.mbtiles "
+        << "[options]\n"
+        << "  --bbox W,S,E,N        bounds in degrees (default: world)\n"
+        << "  --zoom MIN-MAX        zoom range (default 0-4)\n"
+        << "  --tile-size N         256 or 512 (default 256)\n"
+        << "  --scale N             pixel ratio, e.g. 2 for @2x tiles\n"
+        << "  --metatile N          render NxN tiles at once (default 4)\n"
+        << "  --threads N           worker threads (default: all cores)\n"
+        << "  --encode-threads N    PNG encoder threads (default: --threads)\n";
+}
+
+class TileSink {
+public:
+    virtual ~TileSink() = default;
+    virtual bool write(const TileID& tile, const std::string& png) = 0;
+    virtual bool finish() {
+        return true;
+    }
+};
+
+// out/z/x/y.png
+class DirectorySink : public TileSink {
+public:
+    explicit DirectorySink(std::filesystem::path root_)
+        : root(std::move(root_)) {
+    }
+
+    bool write(const TileID& tile, const std::string& png) override {
+        const auto dir = root / std::to_string(tile.z) / std::to_string(tile.x);
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        std::ofstream out(dir / (std::to_string(tile.y) + ".png"),
+                          std::ios::binary);
+        out.write(png.data(), static_cast<std::streamsize>(png.size()));
+        return static_cast<bool>(out);
+    }
+
+private:
+    std::filesystem::path root;
+};
+
+#ifdef MLN_SLINT_HAS_SQLITE3
+// MBTiles 1.3: one transaction for the whole run, rows in TMS order.
+class MBTilesSink : public TileSink {
+public:
+    static std::unique_ptr<MBTilesSink> open(const std::string& path,
+                                             const Options& options) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        sqlite3* db = nullptr;
+        if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+            std::cerr << "[tiles] cannot open " << path << ": "
+                      << sqlite3_errmsg(db) << std::endl;
+            sqlite3_close(db);
+            return nullptr;
+        }
+        auto sink = std::unique_ptr<MBTilesSink>(new MBTilesSink(db));
+        if (!sink->exec("PRAGMA synchronous=OFF;"
+                        "CREATE TABLE metadata (name TEXT, value TEXT);"
+                        "CREATE TABLE tiles (zoom_level INTEGER, "
+                        "tile_column INTEGER, tile_row INTEGER, "
+                        "tile_data BLOB);"
+                        "CREATE UNIQUE INDEX tile_index ON tiles "
+                        "(zoom_level, tile_column, tile_row);"
+                        "BEGIN;") ||
+            !sink->write_metadata(options) ||
+            sqlite3_prepare_v2(db,
+                               "INSERT OR REPLACE INTO tiles VALUES "
+                               "(?, ?, ?, ?);",
+                               -1, &sink->insert, nullptr) != SQLITE_OK) {
+            return nullptr;
+        }
+        return sink;
+    }
+
+    ~MBTilesSink() override {
+        sqlite3_finalize(insert);
+        sqlite3_close(db);
+    }
+
+    bool write(const TileID& tile, const std::string& png) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        sqlite3_bind_int(insert, 1, tile.z);
+        sqlite3_bind_int64(insert, 2, tile.x);
+        sqlite3_bind_int64(insert, 3, tms_row(tile));
+        sqlite3_bind_blob(insert, 4, png.data(), static_cast<int>(png.size()),
+                          SQLITE_STATIC);
+        const bool ok = sqlite3_step(insert) == SQLITE_DONE;
+        sqlite3_reset(insert);
+        return ok;
+    }
+
+    bool finish() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        return exec("COMMIT;");
+    }
+
+private:
+    explicit MBTilesSink(sqlite3* db_) : db(db_) {
+    }
+
+    bool exec(const char* sql) {
+        char* error = nullptr;
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+            std::cerr << "[tiles] sqlite: " << (error ? error : "?")
+                      << std::endl;
+            sqlite3_free(error);
+            return false;
+        }
+        return true;
+    }
+
+    bool write_metadata(const Options& o) {
+        std::ostringstream bounds;
+        bounds << o.bounds.min_lon << "," << o.bounds.min_lat << ","
+               << o.bounds.max_lon << "," << o.bounds.max_lat;
+        const std::pair<std::string, std::string> rows[] = {
+            {"name", "mbgl-slint-tiles"},
+            {"format", "png"},
+            {"type", "baselayer"},
+            {"minzoom", std::to_string(o.min_zoom)},
+            {"maxzoom", std::to_string(o.max_zoom)},
+            {"bounds", bounds.str()},
+        };
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, "INSERT INTO metadata VALUES (?, ?);", -1,
+                               &stmt, nullptr) != SQLITE_OK)
+            return false;
+        bool ok = true;
+        for (const auto& [name, value] : rows) {
+            sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
+            ok = ok && sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        return ok;
+    }
+
+    sqlite3* db = nullptr;
+    sqlite3_stmt* insert = nullptr;
+    std::mutex mutex;
+};
+#endif
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::unique_ptr<TileSink> open_sink(const Options& options) {
+    if (ends_with(options.out, ".pmtiles")) {
+        std::cerr << "[tiles] PMTiles output is not supported; write an "
+                     "MBTiles file and convert it (pmtiles convert)"
+                  << std::endl;
+        return nullptr;
+    }
+    if (ends_with(options.out, ".mbtiles")) {
+#ifdef MLN_SLINT_HAS_SQLITE3
+        return MBTilesSink::open(options.out, options);
+#else
+        std::cerr << "[tiles] built without SQLite3; MBTiles output is "
+                     "unavailable"
+                  << std::endl;
+        return nullptr;
+#endif
+    }
+    return std::make_unique<DirectorySink>(options.out);
+}
+
+bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        const std::string value = argv[++i];
+        if (arg == "--style") {
+            o.style_url = value;
+        } else if (arg == "--out") {
+            o.out = value;
+        } else if (arg == "--bbox") {
+            auto bounds = parse_tile_bounds(value);
+            if (!bounds)
+                return false;
+            o.bounds = *bounds;
+        } else if (arg == "--zoom") {
+            const auto dash = value.find('-');
+            o.min_zoom = std::atoi(value.substr(0, dash).c_str());
+            o.max_zoom = dash == std::string::npos
+                             ? o.min_zoom
+                             : std::atoi(value.substr(dash + 1).c_str());
+        } else if (arg == "--tile-size") {
+            o.tile_size = static_cast<uint32_t>(std::atoi(value.c_str()));
+        } else if (arg == "--scale") {
+            o.scale = static_cast<float>(std::atof(value.c_str()));
+        } else if (arg == "--metatile") {
+            o.metatile = static_cast<uint32_t>(std::atoi(value.c_str()));
+        } else if (arg == "--threads") {
+            o.threads = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "--encode-threads") {
+            o.encode_threads =
+                static_cast<unsigned>(std::atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+    return !o.style_url.empty() && !o.out.empty() && o.min_zoom >= 0 &&
+           o.max_zoom <= 24 && o.min_zoom <= o.max_zoom &&
+           (o.tile_size == 256 || o.tile_size == 512) && o.scale > 0.0f &&
+           o.metatile > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    auto sink = open_sink(options);
+    if (!sink)
+        return 2;
+
+    // Low zooms first: they are cheap and give early feedback.
+    std::vector<Metatile> jobs;
+    uint64_t tile_count = 0;
+    for (int z = options.min_zoom; z <= options.max_zoom; ++z) {
+        const TileRange range =
+            tile_range(options.bounds, static_cast<uint8_t>(z));
+        tile_count += range.count();
+        auto blocks = metatiles_for_range(range, options.metatile);
+        jobs.insert(jobs.end(), blocks.begin(), blocks.end());
+    }
+
+    const unsigned threads =
+        std::max(1u, options.threads ? options.threads
+                                     : std::thread::hardware_concurrency());
+    std::cout << "[tiles] " << tile_count << " tiles in " << jobs.size()
+              << " metatiles, " << threads << " threads" << std::endl;
+
+    const std::size_t job_count = jobs.size();
+    WorkStealingQueue<Metatile> queue(threads);
+    queue.distribute(std::move(jobs));
+
+    const auto tile_px = static_cast<uint32_t>(
+        static_cast<float>(options.tile_size) * options.scale);
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<std::size_t> done{0};
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Up to two tiles per encoder thread wait in the queue; beyond that the
+    // renderers block, which keeps memory flat on large pyramids.
+    ImageEncoder::Options encoder_options;
+    encoder_options.threads =
+        options.encode_threads ? options.encode_threads : threads;
+    encoder_options.queue_depth = encoder_options.threads * 2;
+    encoder_options.format = ImageFormat::PNG;
+    ImageEncoder encoder(encoder_options);
+    auto write_tile = [&](const TileID& id) {
+        return [&, id](EncodedImage&& png) {
+            if (png.ok() && sink->write(id, png.data))
+                ++written;
+            else
+                ++failed;
+        };
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < threads; ++w) {
+        workers.emplace_back([&, w]() {
+            StaticMapRenderer::Options renderer_options;
+            renderer_options.pixel_ratio = options.scale;
+            StaticMapRenderer renderer(renderer_options);
+            renderer.load_style_url(options.style_url);
+
+            while (auto mt = queue.pop(w)) {
+                const MetatileRender plan =
+                    metatile_render(*mt, options.tile_size);
+                StaticMapRequest request;
+                request.camera = plan.camera;
+                request.width = plan.width;
+                request.height = plan.height;
+                const StaticMapResult result = renderer.render(request);
+                const uint64_t tiles = uint64_t{mt->width} * mt->height;
+                if (!result.ok()) {
+                    failed += tiles;
+                    std::cerr << "[tiles] " << int(mt->z) << "/" << mt->x
+                              << "/" << mt->y << ": " << result.error
+                              << std::endl;
+                } else {
+                    for (auto& tile : split_metatile(*mt, result.image, tile_px,
+                                                     plan.downsample)) {
+                        if (!encoder.submit(std::move(tile.image),
+                                            write_tile(tile.id)))
+                            ++failed;
+                    }
+                }
+                const std::size_t n = ++done;
+                if (n % 64 == 0 || n == job_count) {
+                    std::cout << "[tiles] " << n << "/" << job_count
+                              << " metatiles" << std::endl;
+                }
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    encoder.wait_idle();
+    const bool finished = sink->finish();
+
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - t0)
+                               .count();
+    std::cout << "[tiles] wrote " << written << " tiles (" << failed
+              << " failed) in " << seconds << " s, "
+              << (seconds > 0.0 ? static_cast<double>(written) / seconds : 0.0)
+              << " tiles/s, " << queue.steals() << " steals, "
+              << encoder.stats().encode_ms / 1000.0 << " s encoding"
+              << std::endl;
+    return finished && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Fixed-timestep video export of a fly_to animation or a scripted camera
+// path, e.g.:
+//
+//   mbgl-slint-video --style https://demotiles.maplibre.org/style.json \
+//       --from 35.68,139.69,10 --fly-to 48.85,2.35,10 --out flight.y4m
+//   mbgl-slint-video --style file:///data/style.json --path tour.txt \
+//       --size 1920x1080 --fps 60 --format rgb --out - |
+//       ffmpeg -f rawvideo -pix_fmt rgb24 -s 1920x1080 -r 60 -i - tour.mp4
+//
+// Frames are rendered with a StaticMapRenderer (MapMode::Static), so every
+// frame waits for its tiles and the sequence is identical on every run, at
+// whatever speed the renderer manages. Each frame is handed to a
+// VideoPipeline, which converts and writes on other threads while the next
+// one renders; memory use does not grow with the length of the video.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "camera_path.hpp"
+#include "fly_to_animation.hpp"
+#include "static_map_renderer.hpp"
+#include "video_pipeline.hpp"
+
+namespace {
+
+struct Options {
+    std::string style_url;
+    std::string out;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    int fps = 30;
+    float scale = 1.0f;
+    VideoFormat format = VideoFormat::Y4M;
+    std::size_t convert_threads = 2;
+    // fly_to mode
+    std::optional<CameraKeyframe> from;
+    std::optional<CameraKeyframe> fly_to;
+    double duration_s = 2.5;
+    // path mode
+    std::string path_file;
+};
+
+void usage(const char* argv0) {
+    std::cerr
+        << "usage: " << argv0 << " --style URL --out FILE|- "
+        << "(--fly-to LAT,LON,ZOOM [--from LAT,LON,ZOOM] | --path FILE) "
+        << "[options]\n"
+        << "  --size WxH            frame size in logical pixels "
+           "(default 1280x720)\n"
+        << "  --scale N             pixel ratio (frame is size * N)\n"
+        << "  --fps N               frame rate (default 30)\n"
+        << "  --duration S          fly-to duration in seconds (default "
+           "2.5)\n"
+        << "  --format y4m|rgb      output format (default y4m)\n"
+        << "  --convert-threads N   RGBA->YUV threads (default 2)\n"
+        << "path file: one keyframe per line, "
+           "\"time_s lat lon zoom [bearing [pitch]]\"\n";
+}
+
+std::optional<CameraKeyframe> parse_view(const std::string& text) {
+    std::istringstream in(text);
+    double lat = 0.0, lon = 0.0;
+    CameraKeyframe k;
+    char c1 = 0, c2 = 0;
+    if (!(in >> lat >> c1 >> lon >> c2 >> k.zoom) || c1 != ',' || c2 != ',')
+        return std::nullopt;
+    k.center = mbgl::LatLng{lat, lon};
+    return k;
+}
+
+bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        const std::string value = argv[++i];
+        if (arg == "--style") {
+            o.style_url = value;
+        } else if (arg == "--out") {
+            o.out = value;
+        } else if (arg == "--size") {
+            const auto x = value.find('x');
+            if (x == std::string::npos)
+                return false;
+            o.width = static_cast<uint32_t>(std::atoi(value.c_str()));
+            o.height =
+                static_cast<uint32_t>(std::atoi(value.c_str() + x + 1));
+        } else if (arg == "--scale") {
+            o.scale = static_cast<float>(std::atof(value.c_str()));
+        } else if (arg == "--fps") {
+            o.fps = std::atoi(value.c_str());
+        } else if (arg == "--duration") {
+            o.duration_s = std::atof(value.c_str());
+        } else if (arg == "--format") {
+            const auto format = parse_video_format(value);
+            if (!format)
+                return false;
+            o.format = *format;
+        } else if (arg == "--convert-threads") {
+            o.convert_threads =
+                static_cast<std::size_t>(std::atoi(value.c_str()));
+        } else if (arg == "--from") {
+            o.from = parse_view(value);
+            if (!o.from)
+                return false;
+        } else if (arg == "--fly-to") {
+            o.fly_to = parse_view(value);
+            if (!o.fly_to)
+                return false;
+        } else if (arg == "--path") {
+            o.path_file = value;
+        } else {
+            return false;
+        }
+    }
+    return !o.style_url.empty() && !o.out.empty() && o.width > 0 &&
+           o.height > 0 && o.fps > 0 && o.scale > 0.0f &&
+           o.duration_s > 0.0 && (o.fly_to.has_value() != !o.path_file.empty());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (options.out == "-") {
+        // The video goes to stdout; keep the libraries' logging off it.
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    // Camera as a function of time, from either source.
+    CameraPath path;
+    std::optional<FlyToAnimation> flight;
+    double duration_s = options.duration_s;
+    if (!options.path_file.empty()) {
+        std::ifstream in(options.path_file);
+        auto parsed = CameraPath::parse(in);
+        if (!parsed) {
+            std::cerr << "[video] cannot parse " << options.path_file
+                      << std::endl;
+            return 2;
+        }
+        path = std::move(*parsed);
+        duration_s = path.duration_s();
+    } else {
+        const CameraKeyframe from = options.from.value_or(*options.fly_to);
+        flight = FlyToAnimation::plan(from.center, from.zoom,
+                                      options.fly_to->center,
+                                      options.fly_to->zoom, 0.0, 22.0);
+    }
+
+    // Physical frame size; 4:2:0 output wants even dimensions.
+    const auto physical = [&](uint32_t logical) {
+        const auto px = static_cast<uint32_t>(std::lround(
+            static_cast<double>(logical) * options.scale));
+        return options.format == VideoFormat::Y4M ? (px + 1) & ~1u : px;
+    };
+    const uint32_t frame_w = physical(options.width);
+    const uint32_t frame_h = physical(options.height);
+
+    StaticMapRenderer::Options renderer_options;
+    renderer_options.pixel_ratio = options.scale;
+    StaticMapRenderer renderer(renderer_options);
+    renderer.load_style_url(options.style_url);
+
+    VideoPipeline::Options video_options;
+    video_options.format = options.format;
+    video_options.fps = options.fps;
+    video_options.convert_threads = options.convert_threads;
+    VideoPipeline video(options.out, frame_w, frame_h, video_options);
+    if (!video.ok()) {
+        std::cerr << "[video] " << video.error() << std::endl;
+        return 1;
+    }
+
+    const auto frame_count =
+        static_cast<int64_t>(std::ceil(duration_s * options.fps)) + 1;
+    std::cerr << "[video] " << frame_count << " frames, " << frame_w << "x"
+              << frame_h << " @ " << options.fps << " fps" << std::endl;
+
+    StaticMapRequest request;
+    request.width = static_cast<uint32_t>(frame_w / options.scale);
+    request.height = static_cast<uint32_t>(frame_h / options.scale);
+    double render_ms = 0.0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < frame_count; ++i) {
+        const double t = static_cast<double>(i) / options.fps;
+        request.camera = flight ? flight->sample(t / duration_s)
+                                : path.sample(t);
+        StaticMapResult result = renderer.render(request);
+        if (!result.ok()) {
+            std::cerr << "[video] frame " << i << ": " << result.error
+                      << std::endl;
+            return 1;
+        }
+        render_ms += result.render_ms;
+        if (result.image.size.width != frame_w ||
+            result.image.size.height != frame_h) {
+            // Rounding of size / scale; crop or pad into the frame.
+            mbgl::PremultipliedImage fitted({frame_w, frame_h});
+            mbgl::PremultipliedImage::copy(
+                result.image, fitted, {0, 0}, {0, 0},
+                {std::min(frame_w, result.image.size.width),
+                 std::min(frame_h, result.image.size.height)});
+            result.image = std::move(fitted);
+        }
+        if (!video.push(std::move(result.image))) {
+            std::cerr << "[video] " << video.error() << std::endl;
+            return 1;
+        }
+        if ((i + 1) % options.fps == 0) {
+            std::cerr << "[video] " << (i + 1) << "/" << frame_count
+                      << std::endl;
+        }
+    }
+    const bool ok = video.finish();
+    if (!ok)
+        std::cerr << "[video] " << video.error() << std::endl;
+
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - t0)
+                               .count();
+    const auto stats = video.stats();
+    std::cerr << "[video] " << stats.frames << " frames in " << seconds
+              << " s (" << (seconds > 0.0 ? stats.frames / seconds : 0.0)
+              << " fps; render " << render_ms / 1000.0 << " s, convert "
+              << stats.convert_ms / 1000.0 << " s, write "
+              << stats.write_ms / 1000.0 << " s)" << std::endl;
+    return ok ? 0 : 1;
+}